@@ -0,0 +1,54 @@
+#ifndef AGGREGATION_H
+#define AGGREGATION_H
+
+#include "column_store.h"
+#include "linked_list.h"
+#include <cstdint>
+
+// Type filter for aggregation queries
+#define AGG_DEPOSITS     1
+#define AGG_WITHDRAWALS  2
+#define AGG_ALL          (AGG_DEPOSITS | AGG_WITHDRAWALS)
+
+// Plain C layout so it can be filled directly across FFI
+struct AggregateResult {
+    double totalDeposits;
+    double totalWithdrawals;
+    int depositCount;
+    int withdrawalCount;
+    double minAmount;       // 0 when nothing matched
+    double maxAmount;
+    double avgAmount;
+};
+
+// Which kernel the dispatcher picked on this CPU
+enum AggregationKernel {
+    KERNEL_SCALAR = 0,
+    KERNEL_SSE42 = 1,
+    KERNEL_AVX2 = 2
+};
+
+// Aggregate rows whose type is in typeMask and whose timestamp lies in [fromTs, toTs].
+// Runs one pass over the columns using the best kernel the CPU supports.
+AggregateResult aggregateTransactions(const TransactionColumns& cols, int typeMask,
+                                      int64_t fromTs, int64_t toTs);
+
+// Same query with an explicit kernel (clamped to what the CPU supports)
+AggregateResult aggregateWithKernel(const TransactionColumns& cols, int typeMask,
+                                    int64_t fromTs, int64_t toTs, AggregationKernel kernel);
+
+// Reference implementation walking the LinkedList nodes (benchmark baseline)
+AggregateResult aggregateListScalar(LinkedList& list, int typeMask,
+                                    int64_t fromTs, int64_t toTs);
+
+// Same scan over an array of postings (ledgers built without a column store)
+AggregateResult aggregateArrayScalar(Transaction* const* items, int n, int typeMask,
+                                     int64_t fromTs, int64_t toTs);
+
+// Merge two results over disjoint row sets (hot and archived tiers)
+AggregateResult combineAggregates(const AggregateResult& a, const AggregateResult& b);
+
+AggregationKernel detectAggregationKernel();
+const char* aggregationKernelName(AggregationKernel kernel);
+
+#endif
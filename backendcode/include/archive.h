@@ -0,0 +1,94 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include "transaction.h"
+#include "aggregation.h"
+#include "hash_chain.h"
+#include "segment_codec.h"
+#include <cstdint>
+#include <list>
+#include <string>
+#include <vector>
+
+// Rows per segment: whole checkpoint blocks, so archived ranges can still be
+// verified against the hash chain's Merkle checkpoints
+#define ARCHIVE_SEGMENT_ROWS (4 * HashChain::CHECKPOINT_INTERVAL)
+
+// Kept in memory for every segment, so most queries never touch the disk
+struct SegmentInfo {
+    std::string path;
+    uint64_t firstPosition;      // posting position of the first row
+    uint32_t rows;
+    uint64_t bytes;              // encoded size on disk
+    int firstID;
+    int lastID;
+    int64_t minTimestamp;
+    int64_t maxTimestamp;
+    double depositTotal;
+    double withdrawalTotal;
+    int64_t depositCount;
+    int64_t withdrawalCount;
+    double minDeposit;
+    double maxDeposit;
+    double minWithdrawal;
+    double maxWithdrawal;
+};
+
+// Cold tier of the ledger: immutable segment files (segment_codec.h) in one
+// directory plus a small LRU cache of decoded segments. Segment files belong to the archive
+// and are removed when it is destroyed.
+class HistoryArchive {
+private:
+    struct LoadedSegment {
+        size_t index;
+        std::vector<Transaction*> rows;
+    };
+
+    std::string directory;
+    std::vector<SegmentInfo> segments;
+    std::list<LoadedSegment> cache;      // front = most recently used
+    size_t cacheLimit;
+    bool usable;
+
+    void evict(std::list<LoadedSegment>::iterator it);
+    bool readFile(size_t index, std::string& data) const;
+
+public:
+    HistoryArchive(const std::string& directory, int cacheSegments);
+    ~HistoryArchive();
+
+    HistoryArchive(const HistoryArchive&) = delete;
+    HistoryArchive& operator=(const HistoryArchive&) = delete;
+
+    // False if the directory could not be created
+    bool isUsable() const { return usable; }
+
+    // Write rows [0, n) (posting order) as a new segment
+    bool append(Transaction* const* rows, size_t n, uint64_t firstPosition);
+
+    // Decoded rows of one segment, loaded on demand. Valid until the
+    // segment is evicted by a later load; nullptr if it can't be read.
+    const std::vector<Transaction*>* load(size_t index);
+
+    // Selected columns (SEG_WANT bits) of one segment, decoded straight
+    // from disk without going through the row cache
+    bool decodeColumns(size_t index, unsigned columns, SegmentColumns& out) const;
+
+    // Archived transaction by ID (owned by the cache, see load())
+    Transaction* find(int id);
+
+    // First segment whose ID range ends at or after id (segmentCount() if none)
+    size_t segmentFor(int id) const;
+
+    // Segments wholly inside the window use their summary; partial
+    // overlaps decode only the columns the scan needs. False if one of
+    // those can't be read (out is then incomplete).
+    bool aggregate(int typeMask, int64_t fromTs, int64_t toTs, AggregateResult& out) const;
+
+    size_t segmentCount() const { return segments.size(); }
+    const SegmentInfo& segment(size_t index) const { return segments[index]; }
+    uint64_t rowCount() const;
+    uint64_t byteCount() const;
+};
+
+#endif
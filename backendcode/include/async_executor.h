@@ -0,0 +1,96 @@
+#ifndef ASYNC_EXECUTOR_H
+#define ASYNC_EXECUTOR_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Completion record, plain C layout so it can be copied across FFI
+#define ASYNC_MESSAGE_SIZE 128
+
+struct AsyncCompletion {
+    long long requestId;
+    int status;                  // 1 = success, 0 = failure
+    long long value;             // operation specific (rows exported, ...)
+    char message[ASYNC_MESSAGE_SIZE];
+};
+
+// What a job reports back
+struct AsyncResult {
+    int status;
+    long long value;
+    std::string message;
+};
+
+// Mirror of Dart_CObject (dart_native_api.h) for the kInt64 case, so the
+// bridge can post to a Dart NativePort without the SDK headers
+struct PortMessage {
+    int32_t type;                // Dart_CObject_kInt64
+    int64_t asInt64;
+};
+#define PORT_MESSAGE_INT64 3
+
+// Signature of Dart_PostCObject / NativeApi.postCObject. Tests and tools can
+// pass any function with this shape as a local stand-in.
+typedef bool (*PostCObjectFn)(int64_t port, PortMessage* message);
+
+// Fixed pool of workers running queued jobs. Every job gets a request id;
+// its completion is queued for polling and, when a port is registered, the
+// request id is posted to it so the receiver knows to collect it.
+class AsyncExecutor {
+private:
+    struct Job {
+        long long requestId;
+        void* owner;
+        std::function<AsyncResult()> work;
+    };
+
+    std::vector<std::thread> workers;
+    std::deque<Job> jobs;
+    std::deque<AsyncCompletion> completions;
+    std::map<void*, int> pending;        // owner -> queued + running jobs
+    std::set<long long> inFlight;        // request ids queued or running
+    std::mutex lock;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    long long nextRequestId;
+    bool stopping;
+
+    PostCObjectFn postFn;
+    int64_t port;
+
+    void workerLoop();
+
+public:
+    explicit AsyncExecutor(int threads);
+    ~AsyncExecutor();
+
+    AsyncExecutor(const AsyncExecutor&) = delete;
+    AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+
+    // Queue work on behalf of `owner`; returns the request id (> 0)
+    long long submit(void* owner, std::function<AsyncResult()> work);
+
+    // Deliver completions to a port as well (postFn == nullptr detaches)
+    void setCompletionPort(int64_t port, PostCObjectFn postFn);
+
+    // Pop the oldest completion; false if none is ready
+    bool poll(AsyncCompletion& out);
+
+    // Remove the completion of one request; waits up to timeoutMs
+    // (-1 = forever, 0 = don't wait). False on timeout, or at once if the
+    // request was never issued or its completion was already collected.
+    bool take(long long requestId, int timeoutMs, AsyncCompletion& out);
+
+    // Block until every job submitted for `owner` has finished
+    void drain(void* owner);
+};
+
+#endif
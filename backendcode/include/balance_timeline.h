@@ -0,0 +1,85 @@
+#ifndef BALANCE_TIMELINE_H
+#define BALANCE_TIMELINE_H
+
+#include "clock.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// Pyramid shape: level 0 buckets are one minute wide, each level above is
+// TIMELINE_FANOUT times wider (the top level is about 8 years)
+#define TIMELINE_LEVELS 12
+#define TIMELINE_FANOUT 4
+#define TIMELINE_BASE_WIDTH (60 * MICROS_PER_SECOND)
+
+// Most points one query returns
+#define TIMELINE_MAX_POINTS 4096
+
+// One chart point, plain C layout so a batch can be copied across FFI
+struct TimelinePoint {
+    int64_t timestamp;             // start of the slice (microseconds)
+    double minBalance;             // balance range within the slice
+    double maxBalance;
+    double closeBalance;           // balance at the end of the slice
+    int count;                     // postings in the slice (0 = balance unchanged)
+};
+
+// Balance-over-time pyramid for charts. Every posting updates one bucket
+// per level (min, max, closing balance), so a query for N points over any
+// range reads about N * TIMELINE_FANOUT buckets at the coarsest level that
+// still resolves it: O(points), never O(history). Min/max per slice keeps
+// spikes visible that averaging or point sampling would drop. Resolution
+// is the bucket width of the level used (never finer than a minute).
+// Undo restores the exact previous buckets from a journal kept as deep as
+// the undo stack, in a fixed ring like LedgerStatsTracker's.
+class BalanceTimeline {
+private:
+    struct Bucket {
+        double minBalance;
+        double maxBalance;
+        double closeBalance;
+        Timestamp lastTimestamp;   // newest posting in the bucket decides the close
+        int lastID;
+        int count;
+    };
+
+    typedef std::map<int64_t, Bucket> Level;
+
+    struct JournalEntry {
+        Timestamp timestamp;
+        Bucket prev[TIMELINE_LEVELS];
+        bool existed[TIMELINE_LEVELS];
+    };
+
+    Level levels[TIMELINE_LEVELS];
+    Level::iterator recent[TIMELINE_LEVELS];   // last bucket touched; live postings hit it
+    std::vector<JournalEntry> journal;   // ring of maxJournal slots
+    size_t journalHead;                  // slot the next entry goes into
+    size_t journalCount;
+    size_t maxJournal;
+    double initialBalance;
+
+    static int64_t width(int level);
+    static int64_t keyOf(Timestamp timestamp, int level);
+    Level::iterator find(int level, int64_t key);
+
+public:
+    BalanceTimeline(double initialBalance, int undoDepth);
+
+    // Record a posting; undoable = whether it was pushed on the undo stack
+    void record(int id, Timestamp timestamp, double balanceAfter, bool undoable = true);
+
+    // Revert the most recent undoable posting
+    void revert();
+
+    // Forget undo information (undo history was cleared)
+    void clearJournal() { journalCount = 0; }
+
+    // Split [fromTs, toTs] into up to `points` equal slices and write one
+    // point per slice, oldest first. Empty slices carry the previous balance
+    // forward. Returns the number of points written.
+    int query(Timestamp fromTs, Timestamp toTs, int points, TimelinePoint* out) const;
+};
+
+#endif
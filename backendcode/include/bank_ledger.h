@@ -1,42 +1,15 @@
 #ifndef BANK_LEDGER_H
 #define BANK_LEDGER_H
 
-#include "transaction.h"
-#include "linked_list.h"
-#include "stack.h"
-#include <string>
-
-class BankLedger {
-private:
-    double balance;
-    int transactionID;
-    LinkedList* transactionList;
-    Stack* undoStack;
+#include "ledger_core.h"
 
+// The standard ledger: double money, 50-step undo, LinkedList history,
+// column store, running stats, audit chain and metrics, single-threaded.
+// Other trade-offs are other BasicLedger instantiations (ledger_policy.h).
+class BankLedger : public BasicLedger<DefaultLedgerPolicy> {
 public:
-    BankLedger(double initialBalance = 0.0);
-    ~BankLedger();
-
-    // Core functions
-    void deposit(double amount, std::string description);
-    void withdraw(double amount, std::string description);
-    void undo();
-    void showBalance();
-    void showHistory();
-
-    // Sorting
-    void sortByDate();
-    void sortByAmount();
-
-    // Searching
-    Transaction* searchByID(int id);
-
-    // ----------------------
-    // Getter functions
-    // ----------------------
-    double getBalance() const;
-    bool canUndo() const;
-    int getTransactionCount() const;
+    BankLedger(double initialBalance = 0.0, bool quiet = false)
+        : BasicLedger<DefaultLedgerPolicy>(initialBalance, quiet) {}
 };
 
 #endif
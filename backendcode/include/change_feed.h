@@ -0,0 +1,63 @@
+#ifndef CHANGE_FEED_H
+#define CHANGE_FEED_H
+
+#include "transaction.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Changes kept for pollers; anyone further behind re-reads a snapshot
+#define CHANGE_FEED_CAPACITY 4096
+
+// Returned by ChangeFeed::since when the requested changes are gone
+#define CHANGES_SNAPSHOT_REQUIRED (-1)
+
+enum ChangeKind : int {
+    CHANGE_APPEND = 0,         // a posting was added (live or imported)
+    CHANGE_UNDO = 1            // the posting transactionID was removed
+};
+
+// One change, plain C layout so a batch can be copied straight across FFI.
+// Every change carries the balance after it, so pollers never need a
+// separate balance read.
+struct ChangeRecord {
+    uint64_t seq;              // 1, 2, 3, ... per ledger
+    int kind;                  // ChangeKind
+    int transactionID;
+    int postingKind;           // KIND_DEPOSIT / KIND_WITHDRAWAL
+    double amount;
+    double balanceAfter;
+    int64_t timestamp;         // the posting's own timestamp (microseconds)
+};
+
+// Bounded, sequence-numbered change log for incremental consumers (UI
+// mirrors, caches). A consumer remembers the last seq it applied and asks
+// for everything after it: O(changes) work per refresh. If it fell more than
+// the ring's capacity behind, it re-reads the history instead (a snapshot)
+// and continues from the seq it read before the snapshot. Applying changes
+// by transaction ID makes the overlap harmless.
+class ChangeFeed {
+private:
+    std::vector<ChangeRecord> ring;
+    uint64_t latest;           // seq of the newest change (0 = none yet)
+
+    ChangeRecord& next();
+
+public:
+    explicit ChangeFeed(size_t capacity = CHANGE_FEED_CAPACITY);
+
+    void recordAppend(const Transaction& t, unsigned char postingKind);
+    void recordUndo(const Transaction& t, unsigned char postingKind, double balanceAfter);
+
+    uint64_t latestSeq() const { return latest; }
+
+    // Oldest seq still held (latestSeq() + 1 when empty)
+    uint64_t oldestSeq() const;
+
+    // Up to `capacity` changes after seq `after`, oldest first. Returns the
+    // count, or CHANGES_SNAPSHOT_REQUIRED if some of them were overwritten
+    // (or `after` is from a different ledger, beyond latestSeq()).
+    int since(uint64_t after, ChangeRecord* out, int capacity) const;
+};
+
+#endif
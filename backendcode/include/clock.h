@@ -0,0 +1,53 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <cstdint>
+
+// Posting timestamps: microseconds since the Unix epoch
+typedef int64_t Timestamp;
+
+#define MICROS_PER_SECOND 1000000LL
+#define MICROS_PER_DAY    (86400LL * MICROS_PER_SECOND)
+
+enum ClockKind {
+    CLOCK_COARSE = 0,    // cached OS time (a few ms resolution), cheapest to read
+    CLOCK_SYSTEM = 1,    // precise OS time
+    CLOCK_FAKE = 2       // deterministic: start, start + step, start + 2 * step, ...
+};
+
+// Wall clock used by a ledger to stamp live postings. A small value type
+// rather than an interface, so reading it is a switch and no allocation.
+//
+// The real clocks never return the same value twice: a reading at or
+// below the previous one is bumped to previous + 1us. Postings made
+// within one OS clock tick still get distinct, increasing stamps.
+class LedgerClock {
+private:
+    ClockKind kind;
+    Timestamp last;            // previous value returned
+    Timestamp step;            // CLOCK_FAKE increment
+
+public:
+    LedgerClock() : kind(CLOCK_COARSE), last(0), step(0) {}
+
+    static LedgerClock coarse() { return LedgerClock(); }
+    static LedgerClock system();
+    static LedgerClock fake(Timestamp start, Timestamp step = MICROS_PER_SECOND);
+
+    Timestamp now();
+
+    ClockKind getKind() const { return kind; }
+
+    // Raw OS readings, without the strictly-increasing adjustment
+    static Timestamp coarseNow();
+    static Timestamp systemNow();
+};
+
+// Seconds (time_t) to/from Timestamp, flooring toward -infinity
+inline Timestamp secondsToTimestamp(int64_t seconds) { return seconds * MICROS_PER_SECOND; }
+inline int64_t timestampToSeconds(Timestamp ts) {
+    int64_t s = ts / MICROS_PER_SECOND;
+    return (ts % MICROS_PER_SECOND < 0) ? s - 1 : s;
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef COLUMN_STORE_H
+#define COLUMN_STORE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Transaction type stored as a single byte in the columns
+enum TransactionKind : unsigned char {
+    KIND_DEPOSIT = 0,
+    KIND_WITHDRAWAL = 1
+};
+
+// Contiguous (struct-of-arrays) copy of the transaction history.
+// Rows are kept in posting order, independent of how the LinkedList is sorted,
+// so scans can run over plain arrays instead of chasing node pointers.
+class TransactionColumns {
+private:
+    std::vector<int> ids;
+    std::vector<unsigned char> kinds;
+    std::vector<double> amounts;
+    std::vector<int64_t> timestamps;
+    std::vector<double> balances;
+
+public:
+    // Append one posting
+    void append(int id, unsigned char kind, double amount, int64_t timestamp, double balanceAfter);
+
+    // Drop the most recent posting (used by undo)
+    void removeLast();
+
+    // Drop the n oldest postings (moved to the archive)
+    void dropFront(size_t n);
+
+    void clear();
+    void reserve(size_t n);
+
+    size_t size() const { return ids.size(); }
+    bool isEmpty() const { return ids.empty(); }
+
+    // Raw column access for scan kernels
+    const int* idData() const { return ids.data(); }
+    const unsigned char* kindData() const { return kinds.data(); }
+    const double* amountData() const { return amounts.data(); }
+    const int64_t* timestampData() const { return timestamps.data(); }
+    const double* balanceData() const { return balances.data(); }
+};
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include "transaction.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Ledger state is snapshotted every EVENT_CHECKPOINT_INTERVAL events, so a
+// point-in-time query replays at most that many events
+#define EVENT_CHECKPOINT_INTERVAL 1024
+
+enum LedgerEventKind : unsigned char {
+    EVENT_POST = 0,      // deposit, withdrawal or imported row
+    EVENT_UNDO = 1       // compensating event: reverts the newest live posting
+};
+
+struct LedgerEvent {
+    Timestamp recordedAt;      // when the event happened, microseconds (never decreases)
+    Timestamp postingTime;     // the posting's own timestamp
+    double amount;
+    double balanceAfter;       // ledger balance right after this event
+    int64_t link;              // POST: newest live posting below it (event index, -1 = none)
+                               // UNDO: event index of the reverted POST
+    int transactionID;         // posted, or reverted by the undo
+    uint32_t description;      // index into its block's descriptions
+    unsigned char kind;        // LedgerEventKind
+    unsigned char postingKind; // KIND_DEPOSIT / KIND_WITHDRAWAL
+};
+
+// Ledger as it was after some prefix of the event log. Plain C layout so
+// it can be filled directly across FFI.
+struct LedgerStateAt {
+    uint64_t events;           // log prefix length this state reflects
+    Timestamp asOf;            // recordedAt of the last event in the prefix (0 = none)
+    double balance;
+    int64_t newestLive;        // event index of the newest live posting (-1 = none)
+    int livePostings;
+    int undonePostings;
+    double depositTotal;       // live postings only
+    double withdrawalTotal;
+    int depositCount;
+    int withdrawalCount;
+    int lastTransactionID;     // highest ID issued so far
+};
+
+// A posting or undone posting as read back from the log. Copied out, with
+// its description, because spilled blocks only stay loaded briefly.
+struct LoggedPosting {
+    LedgerEvent event;
+    std::string description;
+};
+
+// Append-only log of everything that happened to a ledger, including
+// undos. Undo is always the newest live posting, so the live set at any
+// point is a stack: each POST links to the posting beneath it, and the
+// live postings at any point can be walked from the state alone.
+//
+// Events are kept in blocks of EVENT_CHECKPOINT_INTERVAL. Once spillTo()
+// names a directory, every full block is written there as one file (its
+// events, its descriptions and the state it starts from) and dropped from
+// memory; only the open block and a few bytes per sealed block stay. Block
+// files belong to the log and are removed when it is destroyed.
+class EventLog {
+private:
+    struct SpilledBlock {
+        Timestamp firstRecordedAt;
+        uint32_t undoCount;
+    };
+    struct LoadedBlock {
+        size_t index;
+        LedgerStateAt start;
+        std::vector<LedgerEvent> events;
+        std::vector<std::string> descriptions;
+    };
+
+    // Events [tailStart.events, current.events), still in memory
+    std::vector<LedgerEvent> events;
+    std::vector<LedgerStateAt> checkpoints;     // [k] = state after tailStart.events + (k+1) * interval
+    std::vector<uint64_t> undoEvents;           // indexes of UNDO events in memory, ascending
+    std::vector<std::string> descriptions;      // interned for the events in memory
+    std::unordered_map<std::string, uint32_t> descriptionIndex;
+    LedgerStateAt tailStart;                    // state after the spilled blocks
+    LedgerStateAt current;
+
+    std::string directory;
+    bool spilling;
+    std::vector<SpilledBlock> spilled;
+    mutable std::list<LoadedBlock> cache;       // front = most recently used
+    size_t cacheLimit;
+
+    bool apply(LedgerStateAt& state, uint64_t index) const;
+    void append(LedgerEvent& e);
+    uint32_t intern(const std::string& description);
+    bool spillSealed();
+    std::string blockPath(size_t index) const;
+    const LoadedBlock* load(size_t index) const;
+    bool event(uint64_t index, LedgerEvent& out, std::string* description = nullptr) const;
+
+public:
+    explicit EventLog(double initialBalance);
+    ~EventLog();
+
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    // Write sealed blocks (those already full, then each one as it fills)
+    // to `directory`, keeping up to cacheBlocks of them decoded for
+    // replays. False if spilling is already on or a block can't be
+    // written; the log then keeps the rest in memory.
+    bool spillTo(const std::string& directory, int cacheBlocks);
+
+    void recordPosting(const Transaction& t, unsigned char postingKind, Timestamp recordedAt);
+
+    // False (nothing logged) if transactionID is not the newest live posting
+    bool recordUndo(int transactionID, double balanceAfter, Timestamp recordedAt);
+
+    // State after every event recorded at or before asOf. Replays at most
+    // EVENT_CHECKPOINT_INTERVAL events from the preceding checkpoint, which
+    // for spilled history means reading one or two block files. False if
+    // one can't be read.
+    bool stateAt(Timestamp asOf, LedgerStateAt& out) const;
+    bool stateAfter(uint64_t eventCount, LedgerStateAt& out) const;
+    const LedgerStateAt& currentState() const { return current; }
+
+    // POST events live in `state`, oldest first. O(live postings).
+    bool livePostings(const LedgerStateAt& state, std::vector<LoggedPosting>& out) const;
+
+    // POST events undone within `state`'s prefix, in undo order. Spilled
+    // blocks without undos are skipped.
+    bool undonePostings(const LedgerStateAt& state, std::vector<LoggedPosting>& out) const;
+
+    uint64_t size() const { return current.events; }
+    uint64_t spilledEvents() const { return tailStart.events; }
+    size_t spilledBlocks() const { return spilled.size(); }
+};
+
+#endif
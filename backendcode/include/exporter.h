@@ -0,0 +1,79 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include "transaction.h"
+#include "linked_list.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Statement output formats
+enum ExportFormat {
+    EXPORT_CSV = 0,      // id,type,amount,description,timestamp,balanceAfter
+                         // (text timestamps: seconds with six decimals)
+    EXPORT_JSONL = 1,    // one JSON object per line
+    EXPORT_BINARY = 2    // fixed header + length-prefixed rows (little endian)
+};
+
+// Binary statement layout:
+//   header: "BLGX" | uint32 version | uint64 rowCount
+//   row:    int32 id | uint8 kind | double amount | int64 timestamp (us) |
+//           double balanceAfter | uint32 descLength | desc bytes
+// Version 1 stored whole seconds in the timestamp field.
+#define EXPORT_BINARY_MAGIC    "BLGX"
+#define EXPORT_BINARY_VERSION  2
+
+// Large-buffer writer over a file descriptor. Numbers are formatted with
+// std::to_chars straight into the buffer, no iostreams involved.
+class BufferedWriter {
+private:
+    int fd;
+    char* buffer;
+    size_t capacity;
+    size_t used;
+    bool failed;
+
+public:
+    BufferedWriter(int fd, size_t capacity = 1 << 20);
+    ~BufferedWriter();
+
+    void write(const char* data, size_t n);
+    void write(const std::string& s) { write(s.data(), s.size()); }
+    void put(char c);
+
+    void writeInt(int64_t value);
+    void writeMoney(double value);       // fixed, 2 decimals
+    void writeTimestamp(Timestamp ts);   // seconds, 6 decimals
+    void writeJsonString(const std::string& s);   // quoted + escaped
+    void writeCsvField(const std::string& s);     // quoted only if needed
+
+    template <typename T>
+    void writeRaw(const T& value) { write((const char*)&value, sizeof(T)); }
+
+    bool flush();
+    bool ok() const { return !failed; }
+};
+
+// Escape a string for inclusion inside JSON quotes
+std::string jsonEscape(const std::string& s);
+
+// Format a single transaction as a JSON object
+std::string transactionToJson(const Transaction& t);
+
+// Stream the history (in list order) to fd. Returns rows written, -1 on I/O error.
+long long exportTransactions(LinkedList& list, int fd, ExportFormat format);
+
+// Same over a copy of the rows, so the ledger needn't stay locked while
+// they are encoded and written
+long long exportTransactions(const std::vector<Transaction>& rows, int fd, ExportFormat format);
+
+// Create/truncate a file for a writer; -1 on failure. Close with closeOutputFile.
+int createOutputFile(const std::string& path);
+bool closeOutputFile(int fd);
+
+// Create/truncate path and export into it
+long long exportToFile(LinkedList& list, const std::string& path, ExportFormat format);
+long long exportToFile(const std::vector<Transaction>& rows, const std::string& path, ExportFormat format);
+
+#endif
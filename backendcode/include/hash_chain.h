@@ -0,0 +1,60 @@
+#ifndef HASH_CHAIN_H
+#define HASH_CHAIN_H
+
+#include "sha256.h"
+#include "transaction.h"
+#include <vector>
+#include <cstddef>
+
+// Tamper-evident hash chain over postings.
+//   chain[i]   = SHA256(chain[i-1] || canonical(transaction i)),  chain[-1] = 0
+//   checkpoint = chain value at the end of every CHECKPOINT_INTERVAL postings
+// Checkpoints are the leaves of an append-only Merkle tree (bagged peaks),
+// so one checkpoint can be proven against the root in O(log n).
+class HashChain {
+private:
+    Digest head;                                // chain value of the newest posting
+    size_t count;                               // postings hashed so far
+    std::vector<std::vector<Digest>> levels;    // levels[0] = checkpoints
+
+    void pushCheckpoint(const Digest& d);
+    void popCheckpoint();
+    bool checkpointIsProven(size_t index) const;
+
+public:
+    static const size_t CHECKPOINT_INTERVAL = 1024;
+
+    HashChain();
+
+    // Hash the next posting and store the result in t.chainHash. O(1) amortized.
+    void append(Transaction& t);
+
+    // Undo the newest posting. previous = chainHash of the posting before it
+    // (ignored when the chain becomes empty). O(log n) worst case.
+    void rollback(const Digest& previous);
+
+    // Re-verify postings[first..last] (posting positions, inclusive).
+    // Only the checkpoint blocks covering the range are rehashed; the
+    // checkpoints they end on are proven against the Merkle root.
+    // postings[0] is posting position `base` (earlier ones are archived).
+    bool verify(Transaction* const* postings, size_t total, size_t first, size_t last,
+                size_t base = 0) const;
+
+    // Rehash rows[0..n) starting at posting position firstPos, which must
+    // begin a checkpoint block. With compareStored the rows' own chainHash
+    // must match too; without it (rows decoded from the archive) a range
+    // has to end on a checkpoint or at the head to prove anything.
+    bool verifyBlocks(Transaction* const* rows, size_t firstPos, size_t n,
+                      bool compareStored) const;
+
+    // Merkle root over all checkpoints (what an auditor records)
+    Digest root() const;
+
+    const Digest& getHead() const { return head; }
+    size_t size() const { return count; }
+    size_t checkpointCount() const { return levels.empty() ? 0 : levels[0].size(); }
+
+    static Digest hashPosting(const Digest& previous, const Transaction& t);
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef HISTORY_CURSOR_H
+#define HISTORY_CURSOR_H
+
+#include "transaction.h"
+#include <cstddef>
+#include <cstdint>
+
+struct SegmentInfo;
+
+// Description bytes carried in a record (including the NUL)
+#define RECORD_DESCRIPTION_SIZE 64
+
+// One posting in plain C layout, so multi-get results and history chunks
+// are written straight into a caller-provided FFI buffer
+struct TransactionRecord {
+    int id;                      // 0 = not found (multi-get)
+    int kind;                    // KIND_DEPOSIT / KIND_WITHDRAWAL
+    double amount;
+    double balanceAfter;
+    int64_t timestamp;           // microseconds since the epoch
+    int descriptionLength;       // full length; longer descriptions are truncated
+    char description[RECORD_DESCRIPTION_SIZE];   // NUL-terminated
+};
+
+// Which postings a history cursor returns. Zero fields don't filter.
+struct HistoryFilter {
+    int typeMask;                // AGG_DEPOSITS | AGG_WITHDRAWALS (0 = both)
+    int fromID;                  // inclusive
+    int toID;                    // inclusive
+    int64_t fromTs;              // inclusive, microseconds
+    int64_t toTs;
+    double minAmount;            // inclusive
+    double maxAmount;
+};
+
+// Position in a history scan. Keyed by the next ID to look at, not by a
+// pointer, so postings and undos between chunks never invalidate it.
+struct HistoryCursor {
+    HistoryFilter filter;
+    int nextID;
+    int chunkSize;               // records per chunk
+    bool done;                   // no postings left in the filter's ID range
+};
+
+HistoryCursor makeHistoryCursor(const HistoryFilter& filter, int chunkSize);
+
+bool matchesFilter(const Transaction& t, const HistoryFilter& f);
+
+// False if the segment summary rules out every row (no decode needed)
+bool segmentMayMatch(const SegmentInfo& s, const HistoryFilter& f);
+
+void fillRecord(const Transaction& t, TransactionRecord& out);
+
+// Bytes of a description a record keeps
+size_t recordDescriptionLength(const char* description, size_t length);
+
+// Copy (and if needed truncate) a description into a record
+void fillDescription(const std::string& description, TransactionRecord& out);
+
+#endif
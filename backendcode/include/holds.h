@@ -0,0 +1,68 @@
+#ifndef HOLDS_H
+#define HOLDS_H
+
+#include "clock.h"
+#include "timer_wheel.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Expiry is checked at this granularity
+#define HOLD_TICK MICROS_PER_SECOND
+
+enum HoldState : int {
+    HOLD_ACTIVE = 0,
+    HOLD_SETTLED = 1,          // became a withdrawal
+    HOLD_RELEASED = 2,         // cancelled by the caller
+    HOLD_EXPIRED = 3           // nobody settled it in time
+};
+
+// One hold, plain C layout so it can be returned across FFI
+struct HoldRecord {
+    int id;
+    int state;                 // HoldState
+    double amount;
+    int64_t createdAt;         // microseconds
+    int64_t expiresAt;
+};
+
+// Outstanding authorization holds. A hold reserves part of the balance
+// (the ledger subtracts the held total from what can be withdrawn) until it
+// is settled, released or expires. Expiry runs on a TimerWheel, so a tick
+// costs O(1) plus the holds that actually expire, no matter how many are
+// outstanding. The book only tracks holds; the ledger owns the money.
+class HoldBook {
+private:
+    struct Hold {
+        double amount;
+        std::string description;
+        Timestamp createdAt;
+        Timestamp expiresAt;
+        int timer;             // TimerWheel handle
+    };
+
+    std::unordered_map<int, Hold> active;
+    TimerWheel wheel;
+    int nextID;
+    std::vector<int> fired;    // scratch for advance()
+
+public:
+    HoldBook();
+
+    // New active hold; returns its ID (IDs start at 1). `now` must not go
+    // backwards between calls while holds are outstanding.
+    int place(double amount, const std::string& description, Timestamp now, Timestamp expiresAt);
+
+    // Remove an active hold (settled or released). False if it isn't active.
+    bool take(int id, double& amount, std::string& description);
+
+    // Move time to `now`; every hold that came due is removed and appended
+    // to `expired` (state HOLD_EXPIRED)
+    void expire(Timestamp now, std::vector<HoldRecord>& expired);
+
+    bool get(int id, HoldRecord& out) const;
+    size_t size() const { return active.size(); }
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef IDEMPOTENCY_H
+#define IDEMPOTENCY_H
+
+#include "clock.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Keys are remembered for at least this long (and at most twice as long)
+#define IDEMPOTENCY_WINDOW (24LL * 3600 * MICROS_PER_SECOND)
+
+// Bloom filter size per generation (bits; a power of two) and probes per key.
+// 2^22 bits hold ~400K keys per window at a ~1% false positive rate.
+#define IDEMPOTENCY_BLOOM_BITS (1u << 22)
+#define IDEMPOTENCY_BLOOM_PROBES 4
+
+// Client idempotency keys -> the transaction ID they produced.
+//
+// Two generations, each a Bloom filter in front of an exact hash map. New
+// keys go into the current generation; once it is a window old, the older
+// generation is dropped and a fresh one started, so a key lives for one to
+// two windows and expiry is O(1) with no per-key timers. A lookup for a
+// new key (the common case) usually stops at the Bloom filters: a hash and
+// a few bit probes, no string compare or map probe. A false positive only
+// costs one exact lookup, so duplicates are never missed within the window.
+class IdempotencyIndex {
+private:
+    struct Generation {
+        std::vector<uint64_t> bloom;                 // allocated on first key
+        std::unordered_map<std::string, int> ids;
+        Timestamp startedAt;
+    };
+
+    Generation gens[2];
+    int current;
+    Timestamp window;
+
+    static uint64_t hash(const std::string& key);
+    static bool mayContain(const Generation& g, uint64_t h);
+    static void add(Generation& g, uint64_t h);
+    void rotate(Timestamp now);
+
+public:
+    explicit IdempotencyIndex(Timestamp window = IDEMPOTENCY_WINDOW);
+
+    // Transaction ID recorded for key, or 0 if the key is new (or expired)
+    int find(const std::string& key, Timestamp now);
+
+    void remember(const std::string& key, int transactionID, Timestamp now);
+
+    size_t size() const { return gens[0].ids.size() + gens[1].ids.size(); }
+};
+
+#endif
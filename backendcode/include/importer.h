@@ -0,0 +1,67 @@
+#ifndef IMPORTER_H
+#define IMPORTER_H
+
+#include "clock.h"
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class BankLedger;
+
+// Input formats for bulk import
+enum ImportFormat {
+    IMPORT_AUTO = 0,     // Guess from the first non-blank character
+    IMPORT_CSV = 1,      // type,amount,description[,timestamp] (Unix seconds, fraction allowed)
+    IMPORT_NDJSON = 2    // {"type":..,"amount":..,"description":..,"timestamp":..} per line
+};
+
+// One parsed posting, before it is applied to the ledger
+struct ImportRow {
+    unsigned char kind;          // KIND_DEPOSIT / KIND_WITHDRAWAL
+    double amount;
+    Timestamp timestamp;         // microseconds; 0 = not given, use the ledger clock
+    std::string description;
+};
+
+// Plain C layout so it can be returned across FFI
+struct ImportReport {
+    long long rowsRead;
+    long long rowsApplied;
+    long long rowsRejected;      // Parse errors + postings the ledger refused
+    double seconds;
+    double rowsPerSecond;
+};
+
+// Parse a single line; false if it is malformed (blank lines are not rows)
+bool parseCsvLine(const char* begin, const char* end, ImportRow& row);
+bool parseNdjsonLine(const char* begin, const char* end, ImportRow& row);
+
+// Receives parsed rows in file order, one slice at a time, on the calling
+// thread (the rows may be moved from)
+typedef std::function<void(std::vector<ImportRow>& rows)> ImportRowSink;
+
+// Stream-parse a buffer in batches on `threads` workers (0 = hardware
+// threads) and hand the rows to sink in file order; the next batch is
+// parsed while the sink works. Counts non-blank lines and parse errors.
+void streamRows(const char* data, size_t length, ImportFormat format, int threads,
+                const ImportRowSink& sink, long long& lines, long long& rejected);
+
+// Memory-map a file read-only and call fn with its bytes. False if it
+// can't be opened.
+bool withFileContents(const std::string& path, const std::function<void(const char*, size_t)>& fn);
+
+// Stream-parse a buffer in batches on `threads` workers (0 = hardware threads)
+// and apply the rows to the ledger in file order. applyLock, if given, is
+// held only while a parsed batch is applied, so other users of the ledger
+// get in between batches (their postings then land between imported ones).
+ImportReport importBuffer(BankLedger& ledger, const char* data, size_t length,
+                          ImportFormat format, int threads = 0, std::mutex* applyLock = nullptr);
+
+// Memory-map a file and import it. Returns false if the file can't be opened.
+bool importFile(BankLedger& ledger, const std::string& path, ImportFormat format,
+                int threads, ImportReport& report, std::mutex* applyLock = nullptr);
+
+#endif
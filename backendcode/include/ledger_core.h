@@ -0,0 +1,1519 @@
+#ifndef LEDGER_CORE_H
+#define LEDGER_CORE_H
+
+#include "ledger_policy.h"
+#include "transaction.h"
+#include "stack.h"
+#include "column_store.h"
+#include "aggregation.h"
+#include "ledger_stats.h"
+#include "hash_chain.h"
+#include "archive.h"
+#include "event_log.h"
+#include "change_feed.h"
+#include "balance_timeline.h"
+#include "holds.h"
+#include "idempotency.h"
+#include "velocity_limits.h"
+#include "history_cursor.h"
+#include "query.h"
+#include "metrics.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One posting of a batch (BasicLedger::postBatch)
+struct PostingRequest {
+    unsigned char kind;          // KIND_DEPOSIT / KIND_WITHDRAWAL
+    double amount;
+    std::string description;
+};
+
+struct PostingResult {
+    int id;                      // 0 = rejected
+    double balance;              // after the posting (unchanged if rejected)
+};
+
+// Ledger core, configured at compile time by a policy struct (see
+// ledger_policy.h). BankLedger is the DefaultLedgerPolicy instantiation.
+//
+// With a locking policy every public member runs under the ledger mutex.
+// Pointers and references handed out (searchByID, getStats, getColumns,
+// getTransactionList) are only stable while no other thread mutates.
+template <typename Policy>
+class BasicLedger {
+public:
+    typedef typename Policy::Money Money;
+    typedef typename Money::Value MoneyValue;
+    typedef typename Policy::History History;
+
+private:
+    typedef std::lock_guard<typename Policy::Mutex> Guard;
+
+    static const bool metricsEnabled = Policy::metrics && BANK_LEDGER_METRICS;
+    typedef ConditionalOpTimer<metricsEnabled> OpTimer;
+
+    // Posting order is needed by the chain and by archival
+    static const bool keepPostings = Policy::auditChain || Policy::archive;
+
+    MoneyValue balance;
+    int transactionID;
+    bool quiet;                    // Suppress console output (benchmarks, tools, FFI)
+    LedgerClock clock;             // Stamps live postings and events
+    mutable typename Policy::Mutex mutex;
+    History* transactionList;
+    Stack* undoStack;              // nullptr when undoDepth == 0
+    TransactionColumns* columns;   // Contiguous copy for scans (policy: columns)
+    LedgerStatsTracker* stats;     // Incremental summary counters (policy: stats)
+    HashChain* chain;              // Tamper-evident chain over postings (policy: auditChain)
+    std::vector<Transaction*> postings;   // Hot posting order (not owned, list owns them)
+    LedgerMetrics* metrics;        // Latency histograms per operation (policy: metrics)
+    EventLog* events;              // Every posting and undo, never rewritten (policy: eventLog)
+    ChangeFeed* changes;           // Recent appends/undos for pollers (policy: changeFeed)
+    BalanceTimeline* timeline;     // Min/max balance pyramid for charts (policy: timeline)
+    HoldBook* holds;               // Outstanding authorization holds (policy: holds)
+    MoneyValue held;               // Sum of active holds; available = balance - held
+    IdempotencyIndex* idempotencyKeys;   // Client retry keys -> transaction ID (policy: idempotency)
+    VelocityLimits* velocity;      // Withdrawal caps per time window (policy: velocityLimits)
+    int lastVelocityBreach;        // Rule that rejected the latest withdrawal, -1 if none
+
+    // Cold tier (policy: archive, off until enableArchive)
+    HistoryArchive* archive;
+    bool archiving;                // false after a failed write: everything stays hot
+    size_t hotLimit;               // postings kept in memory after a compaction
+    uint64_t archivedRows;         // postings[0] is posting position archivedRows
+    Digest archivedTailHash;       // chainHash of the newest archived posting
+
+    // Live postings; caller holds the lock. Stamped `at`, or by the clock when
+    // at is 0. Return the new ID, or 0 if rejected.
+    int depositLocked(double amount, const std::string& description, Timestamp at = 0);
+    int withdrawLocked(double amount, const std::string& description, Timestamp at = 0);
+
+    // Release every hold due by `now`; caller holds the lock. Returns the count.
+    int expireHoldsAt(Timestamp now);
+
+    // Shared bookkeeping for a new posting; caller holds the lock
+    void recordPosting(Transaction* t, unsigned char kind, bool undoable);
+
+    // Drop the undo stack and the stats/timeline journals; caller holds the lock
+    void clearUndoLocked();
+
+    // Move the oldest ARCHIVE_SEGMENT_ROWS postings into a segment; caller holds the lock
+    void compactOldest();
+
+    // Hot postings in ID order: the postings vector when it is kept, else a
+    // sorted copy of the list in `scratch`. Caller holds the lock.
+    Transaction* const* hotByID(std::vector<Transaction*>& scratch, size_t& n) const;
+
+public:
+    BasicLedger(double initialBalance = 0.0, bool quiet = false);
+    ~BasicLedger();
+
+    // Core functions
+    void deposit(double amount, std::string description);
+    void withdraw(double amount, std::string description);
+
+    // Take back the newest undoable posting. Destructive for the live view:
+    // the row leaves the history, columns and stats, and the audit chain
+    // steps back to the previous posting, so verifyHistory covers only what
+    // is still live. No reversal row is posted. What was undone, and when,
+    // survives only in the event log (policy: eventLog; see getStateAt).
+    void undo();
+    void showBalance();
+    void showHistory();
+
+    // Deposit or withdrawal with a client idempotency key: a key seen within
+    // IDEMPOTENCY_WINDOW posts nothing and returns the original transaction
+    // ID, with duplicate = true (an undo in between doesn't forget the key).
+    // An empty key, or a policy without idempotency, posts unconditionally.
+    // Returns the transaction ID, 0 if the posting was rejected.
+    int postWithKey(unsigned char kind, double amount, const std::string& description,
+                    const std::string& key, bool& duplicate);
+
+    // Live deposits and withdrawals applied in order under one lock, each
+    // exactly as deposit/withdraw would; out[i] is the outcome of
+    // requests[i]. Returns how many were applied.
+    int postBatch(const PostingRequest* requests, int n, PostingResult* out);
+
+    // Live deposit or withdrawal stamped `at` (microseconds) instead of the
+    // clock, for postings that were due earlier, e.g. scheduled ones caught
+    // up late. Every deposit/withdraw check applies (available balance,
+    // holds, velocity limits) and it can be undone. Returns the new ID, or 0
+    // if the posting was rejected.
+    int postAt(unsigned char kind, double amount, const std::string& description, Timestamp at);
+
+    // Bulk import: silent, not undoable, and it clears the undo history (undo
+    // only takes back the newest posting). Returns false if the posting is rejected;
+    // a withdrawal must fit the available balance (balance minus holds).
+    // timestamp (microseconds) is kept as given; 0 stamps it with the ledger
+    // clock, and such a withdrawal is also checked against velocity limits.
+    bool postImported(unsigned char kind, double amount, const std::string& description,
+                      Timestamp timestamp);
+    void clearUndoHistory();
+
+    // Sorting
+    void sortByDate();
+    void sortByAmount();
+
+    // Searching
+    Transaction* searchByID(int id);
+
+    // Multi-get: out[i] = posting ids[i], or id 0 if there is none. The IDs
+    // are visited in sorted order, so the whole batch costs one pass and each
+    // archived segment is loaded once. Returns how many were found.
+    int getByIDs(const int* ids, int n, TransactionRecord* out);
+
+    // Next chunk of a history scan, in ID order across archive and memory:
+    // fills up to cursor.chunkSize records into out and advances the cursor.
+    // Postings made while the scan runs are included if it hasn't reached
+    // them yet. Returns the count, or -1 if an archived segment can't be read.
+    int readHistory(HistoryCursor& cursor, TransactionRecord* out);
+
+    // Aggregation over timestamps in [fromTs, toTs] (microseconds; vectorized
+    // column scan, or a list walk without columns) into out. False if an
+    // archived segment can't be read.
+    bool aggregate(int typeMask, Timestamp fromTs, Timestamp toTs, AggregateResult& out) const;
+
+    // Filter query (query.h) over the whole history, archived segments first.
+    // Writes up to `capacity` matching rows, oldest first, with the projected
+    // fields filled, and totals (all matches, rows scanned, time) in report.
+    // Returns the rows written, or -1 if an archived segment can't be read.
+    int runQuery(const CompiledQuery& query, TransactionRecord* out, int capacity, QueryReport& report);
+
+    void setQuiet(bool q) { quiet = q; }
+
+    // Clock for live postings and log events (default: coarse OS time).
+    // A fake clock makes runs reproducible, audit root included.
+    void setClock(const LedgerClock& c);
+
+    // Running statistics (O(1), maintained on every posting; zero without stats)
+    const LedgerStats& getStats() const;
+    bool getBucketStats(StatsBucket bucket, Timestamp timestamp, LedgerStats& out) const;
+
+    // Balance chart: up to `points` min/max/close points over [fromTs, toTs]
+    // (microseconds), from the timeline pyramid in O(points). Returns the
+    // count; 0 without the timeline policy.
+    int getBalanceTimeline(Timestamp fromTs, Timestamp toTs, int points, TimelinePoint* out) const;
+
+    // Audit: re-verify the hash chain for IDs in [fromID, toID]
+    bool verifyHistory(int fromID, int toID) const;
+    std::string getAuditRoot() const;
+
+    // Latency metrics (false / empty when the policy or build disables them)
+    bool getMetrics(LedgerMetricsSnapshot& out) const;
+    void showMetrics() const;
+
+    // Archival: once more than hotLimit + ARCHIVE_SEGMENT_ROWS postings are
+    // in memory, the oldest segment's worth is written to `directory` and
+    // dropped from the list and columns. Balance, counts, search, aggregation
+    // and verification still cover archived postings; sort, display and
+    // export see the hot tier only. hotLimit is raised to the undo depth.
+    // Sealed event-log blocks are written to the same directory.
+    // False if the policy has no archive, it is already on, or the
+    // directory is unusable.
+    bool enableArchive(const std::string& directory, int hotLimit, int cacheSegments = 2);
+    uint64_t getArchivedCount() const;
+
+    // Point in time: the ledger as it was after every event recorded at or
+    // before asOf (microseconds), including which postings had been undone.
+    // Bounded work from the nearest checkpoint. False without an event log,
+    // or if a spilled block of it can't be read.
+    bool getStateAt(Timestamp asOf, LedgerStateAt& out) const;
+    void showLedgerAt(Timestamp asOf) const;
+    const EventLog* getEventLog() const { return events; }
+
+    // Change feed: up to `capacity` changes after seq `after`, oldest first,
+    // and the newest seq in `latest`. CHANGES_SNAPSHOT_REQUIRED if they are
+    // no longer held (or the policy keeps no feed): re-read the history and
+    // continue from the `latest` returned alongside.
+    int getChangesSince(uint64_t after, ChangeRecord* out, int capacity, uint64_t& latest) const;
+    uint64_t getChangeSeq() const;
+
+    // Authorization holds: a hold reserves `amount` of the balance until it
+    // is settled into a withdrawal, released, or reaches expiresAt
+    // (microseconds). Withdrawals and new holds only see the available
+    // balance. Holds aren't postings: they never enter the history, undo or
+    // audit chain; settling one posts an ordinary (undoable) withdrawal.
+    // Returns the hold ID, or 0 if the amount isn't available or the policy
+    // has no holds.
+    int placeHold(double amount, const std::string& description, Timestamp expiresAt);
+
+    // Withdraw `amount` (0 = all of it, at most the held amount) against an
+    // active hold and release the rest. False if the hold isn't active or
+    // the balance can't cover the amount.
+    bool settleHold(int holdID, double amount = 0.0);
+    bool releaseHold(int holdID);
+
+    // Expire the holds that are due by the ledger clock. Holding operations
+    // do this first themselves; call it to release money without one.
+    int expireHolds();
+
+    bool getHold(int holdID, HoldRecord& out) const;   // active holds only
+    int getActiveHoldCount() const;
+    double getHeldBalance() const;
+    double getAvailableBalance() const;
+
+    // Velocity limits: caps on withdrawals within a sliding window, e.g.
+    // $5,000 per 24h or 20 withdrawals per hour. A withdrawal that would
+    // break a rule is rejected before the balance check; settling a hold is
+    // not checked (the hold already authorized it) but counts. Imported rows
+    // with a historic timestamp count but aren't checked. Replaces the
+    // rules; withdrawals still inside the new windows count against them,
+    // archived ones included (an archived segment that can't be read is
+    // left out of the count).
+    // Returns how many rules are active (0 if the policy has no limits).
+    int setVelocityLimits(const VelocityRule* rules, int n);
+    int getVelocityLimits(VelocityRule* out) const;   // up to VELOCITY_MAX_RULES
+    int getLastVelocityBreach() const;
+
+    // ----------------------
+    // Getter functions
+    // ----------------------
+    double getBalance() const;
+    bool canUndo() const;
+    int getTransactionCount() const;
+    const TransactionColumns& getColumns() const;
+    History* getTransactionList() const { return transactionList; }
+};
+
+// ===== Implementation =====
+
+template <typename Policy>
+BasicLedger<Policy>::BasicLedger(double initialBalance, bool quiet) {
+    this->quiet = quiet;
+    balance = Money::fromDouble(initialBalance);
+    transactionID = 0;
+    transactionList = new History();
+    undoStack = nullptr;
+    columns = nullptr;
+    stats = nullptr;
+    chain = nullptr;
+    metrics = nullptr;
+    events = nullptr;
+    changes = nullptr;
+    timeline = nullptr;
+    holds = nullptr;
+    held = 0;
+    idempotencyKeys = nullptr;
+    velocity = nullptr;
+    lastVelocityBreach = -1;
+    archive = nullptr;
+    archiving = false;
+    hotLimit = 0;
+    archivedRows = 0;
+    archivedTailHash = Digest::zero();
+
+    if constexpr (Policy::undoDepth > 0) undoStack = new Stack(Policy::undoDepth);
+    if constexpr (Policy::columns) columns = new TransactionColumns();
+    if constexpr (Policy::stats) {
+        stats = new LedgerStatsTracker(Money::toDouble(balance), Policy::undoDepth);
+    }
+    if constexpr (Policy::auditChain) chain = new HashChain();
+    if constexpr (metricsEnabled) metrics = new LedgerMetrics();
+    if constexpr (Policy::eventLog) events = new EventLog(Money::toDouble(balance));
+    if constexpr (Policy::changeFeed) changes = new ChangeFeed();
+    if constexpr (Policy::timeline) {
+        timeline = new BalanceTimeline(Money::toDouble(balance), Policy::undoDepth);
+    }
+    if constexpr (Policy::holds) holds = new HoldBook();
+    if constexpr (Policy::idempotency) idempotencyKeys = new IdempotencyIndex();
+    if constexpr (Policy::velocityLimits) velocity = new VelocityLimits();
+
+    if (!quiet) {
+        std::cout << "Bank Ledger initialized with balance: $"
+                  << std::fixed << std::setprecision(2) << Money::toDouble(balance) << std::endl;
+    }
+}
+
+template <typename Policy>
+BasicLedger<Policy>::~BasicLedger() {
+    delete transactionList;
+    delete undoStack;
+    delete columns;
+    delete stats;
+    delete chain;
+    delete metrics;
+    delete events;
+    delete changes;
+    delete timeline;
+    delete holds;
+    delete idempotencyKeys;
+    delete velocity;
+    delete archive;
+}
+
+template <typename Policy>
+void BasicLedger<Policy>::recordPosting(Transaction* t, unsigned char kind, bool undoable) {
+    TRACE_SPAN("BankLedger::recordPosting");
+
+    Timestamp ts = t->timestamp;
+
+    if constexpr (Policy::auditChain) chain->append(*t);
+    if constexpr (keepPostings) postings.push_back(t);
+    transactionList->insert(t);
+    if constexpr (Policy::columns) {
+        columns->append(t->id, kind, t->amount, ts, t->balanceAfter);
+    }
+    if constexpr (Policy::stats) {
+        stats->record(t->id, kind == KIND_WITHDRAWAL, t->amount, ts, t->balanceAfter, undoable);
+    }
+    // Live postings were just stamped by the clock; imported ones carry historic time
+    if constexpr (Policy::eventLog) events->recordPosting(*t, kind, undoable ? ts : clock.now());
+    if constexpr (Policy::changeFeed) changes->recordAppend(*t, kind);
+    if constexpr (Policy::timeline) timeline->record(t->id, ts, t->balanceAfter, undoable);
+    if constexpr (Policy::velocityLimits) {
+        if (kind == KIND_WITHDRAWAL && velocity->active()) velocity->record(ts, t->amount);
+    }
+
+    // Undo only ever takes back the newest posting, so one that can't be
+    // undone seals everything before it too
+    if (undoable) {
+        if constexpr (Policy::undoDepth > 0) undoStack->push(new Transaction(*t));  // Push copy
+    } else {
+        clearUndoLocked();
+    }
+
+    if constexpr (Policy::archive) {
+        if (archiving && postings.size() >= hotLimit + ARCHIVE_SEGMENT_ROWS) compactOldest();
+    }
+}
+
+template <typename Policy>
+void BasicLedger<Policy>::compactOldest() {
+    TRACE_SPAN("BankLedger::compactOldest");
+
+    const size_t n = ARCHIVE_SEGMENT_ROWS;
+    if (!archive->append(postings.data(), n, archivedRows)) {
+        // Keep everything in memory rather than lose postings
+        archiving = false;
+        if (!quiet) std::cout << "Warning: archive write failed, archival disabled." << std::endl;
+        return;
+    }
+
+    // IDs increase in posting order, so the segment is everything below the boundary
+    int boundary = postings[n - 1]->id + 1;
+    archivedTailHash = postings[n - 1]->chainHash;
+    postings.erase(postings.begin(), postings.begin() + n);
+    transactionList->discardBefore(boundary);
+    if constexpr (Policy::columns) columns->dropFront(n);
+    archivedRows += n;
+}
+
+template <typename Policy>
+Transaction* const* BasicLedger<Policy>::hotByID(std::vector<Transaction*>& scratch, size_t& n) const {
+    if constexpr (keepPostings) {
+        // IDs increase in posting order and undo pops the back: already sorted
+        n = postings.size();
+        return postings.data();
+    } else {
+        Transaction** arr;
+        {
+            TRACE_SPAN("History::toArray");
+            arr = transactionList->toArray();
+        }
+        n = (size_t)transactionList->size();
+        scratch.assign(arr, arr + n);
+        delete[] arr;
+
+        TRACE_SPAN("std::sort");
+        std::sort(scratch.begin(), scratch.end(),
+                  [](Transaction* a, Transaction* b) { return a->id < b->id; });
+        return scratch.data();
+    }
+}
+
+template <typename Policy>
+void BasicLedger<Policy>::deposit(double amount, std::string description) {
+    OpTimer timer(metrics, OP_DEPOSIT);
+    TRACE_SPAN("BankLedger::deposit");
+    Guard lock(mutex);
+    depositLocked(amount, description);
+}
+
+template <typename Policy>
+void BasicLedger<Policy>::withdraw(double amount, std::string description) {
+    OpTimer timer(metrics, OP_WITHDRAW);
+    TRACE_SPAN("BankLedger::withdraw");
+    Guard lock(mutex);
+    withdrawLocked(amount, description);
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::postBatch(const PostingRequest* requests, int n, PostingResult* out) {
+    TRACE_SPAN("BankLedger::postBatch");
+    Guard lock(mutex);
+
+    int applied = 0;
+    for (int i = 0; i < n; i++) {
+        const PostingRequest& r = requests[i];
+        bool withdrawal = (r.kind == KIND_WITHDRAWAL);
+        OpTimer timer(metrics, withdrawal ? OP_WITHDRAW : OP_DEPOSIT);
+        out[i].id = withdrawal ? withdrawLocked(r.amount, r.description)
+                               : depositLocked(r.amount, r.description);
+        out[i].balance = Money::toDouble(balance);
+        if (out[i].id != 0) applied++;
+    }
+    return applied;
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::depositLocked(double amount, const std::string& description, Timestamp at) {
+    // NaN and infinity would compare their way past every check below
+    MoneyValue value = std::isfinite(amount) ? Money::fromDouble(amount) : 0;
+    if (value <= 0) {
+        if (!quiet) std::cout << "Error: Amount must be positive!" << std::endl;
+        return 0;
+    }
+
+    balance += value;
+    transactionID++;
+
+    Transaction* t = new Transaction(transactionID, "DEPOSIT", Money::toDouble(value),
+                                     description, Money::toDouble(balance),
+                                     at != 0 ? at : clock.now());
+    recordPosting(t, KIND_DEPOSIT, true);
+
+    if (!quiet) {
+        std::cout << "Deposit successful! New balance: $"
+                  << std::fixed << std::setprecision(2) << Money::toDouble(balance) << std::endl;
+    }
+    return t->id;
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::withdrawLocked(double amount, const std::string& description, Timestamp at) {
+    // NaN and infinity would compare their way past every check below
+    MoneyValue value = std::isfinite(amount) ? Money::fromDouble(amount) : 0;
+    if (value <= 0) {
+        if (!quiet) std::cout << "Error: Amount must be positive!" << std::endl;
+        return 0;
+    }
+
+    // Only read the clock early if something is held or limited; the posting reuses it
+    Timestamp now = at;
+    if constexpr (Policy::holds) {
+        if (holds->size() > 0) {
+            if (now == 0) now = clock.now();
+            expireHoldsAt(now);
+        }
+    }
+    if constexpr (Policy::velocityLimits) {
+        lastVelocityBreach = -1;
+        if (velocity->active()) {
+            if (now == 0) now = clock.now();
+            lastVelocityBreach = velocity->check(now, Money::toDouble(value));
+            if (lastVelocityBreach >= 0) {
+                if (!quiet) {
+                    std::cout << "Error: Velocity limit exceeded (rule "
+                              << lastVelocityBreach + 1 << ")!" << std::endl;
+                }
+                return 0;
+            }
+        }
+    }
+
+    if (value > balance - held) {
+        if (!quiet) {
+            std::cout << "Error: Insufficient balance!" << std::endl;
+            std::cout << "Current balance: $" << std::fixed << std::setprecision(2)
+                      << Money::toDouble(balance) << std::endl;
+            if (held > 0) {
+                std::cout << "On hold: $" << std::fixed << std::setprecision(2)
+                          << Money::toDouble(held) << std::endl;
+            }
+        }
+        return 0;
+    }
+
+    balance -= value;
+    transactionID++;
+
+    Transaction* t = new Transaction(transactionID, "WITHDRAWAL", Money::toDouble(value),
+                                     description, Money::toDouble(balance),
+                                     now != 0 ? now : clock.now());
+    recordPosting(t, KIND_WITHDRAWAL, true);
+
+    if (!quiet) {
+        std::cout << "Withdrawal successful! New balance: $"
+                  << std::fixed << std::setprecision(2) << Money::toDouble(balance) << std::endl;
+    }
+    return t->id;
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::postWithKey(unsigned char kind, double amount, const std::string& description,
+                                     const std::string& key, bool& duplicate) {
+    OpTimer timer(metrics, kind == KIND_WITHDRAWAL ? OP_WITHDRAW : OP_DEPOSIT);
+    TRACE_SPAN("BankLedger::postWithKey");
+    Guard lock(mutex);
+
+    duplicate = false;
+    if constexpr (Policy::idempotency) {
+        if (!key.empty()) {
+            Timestamp now = clock.now();
+            int original = idempotencyKeys->find(key, now);
+            if (original != 0) {
+                duplicate = true;
+                return original;
+            }
+
+            // The posting carries the same time the key is remembered at
+            int id = (kind == KIND_WITHDRAWAL) ? withdrawLocked(amount, description, now)
+                                               : depositLocked(amount, description, now);
+            // Only successful postings are remembered: a rejected request may be retried
+            if (id != 0) idempotencyKeys->remember(key, id, now);
+            return id;
+        }
+    }
+    return (kind == KIND_WITHDRAWAL) ? withdrawLocked(amount, description)
+                                     : depositLocked(amount, description);
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::postAt(unsigned char kind, double amount, const std::string& description,
+                                Timestamp at) {
+    OpTimer timer(metrics, kind == KIND_WITHDRAWAL ? OP_WITHDRAW : OP_DEPOSIT);
+    TRACE_SPAN("BankLedger::postAt");
+    Guard lock(mutex);
+    return (kind == KIND_WITHDRAWAL) ? withdrawLocked(amount, description, at)
+                                     : depositLocked(amount, description, at);
+}
+
+template <typename Policy>
+void BasicLedger<Policy>::undo() {
+    OpTimer timer(metrics, OP_UNDO);
+    TRACE_SPAN("BankLedger::undo");
+    Guard lock(mutex);
+
+    if (undoStack == nullptr || undoStack->isEmpty()) {
+        if (!quiet) std::cout << "Error: No transactions to undo!" << std::endl;
+        return;
+    }
+
+    // Taking back a deposit must not leave held money uncovered
+    if constexpr (Policy::holds) {
+        Transaction* newest = undoStack->peek();
+        if (newest && newest->type == "DEPOSIT" && held > 0 &&
+            balance - Money::fromDouble(newest->amount) < held) {
+            if (!quiet) std::cout << "Error: Cannot undo, that deposit covers money on hold!" << std::endl;
+            return;
+        }
+    }
+
+    Transaction* lastTrans = undoStack->pop();
+    if (!lastTrans) return;
+
+    if (lastTrans->type == "DEPOSIT") {
+        balance -= Money::fromDouble(lastTrans->amount);
+    } else {
+        balance += Money::fromDouble(lastTrans->amount);
+    }
+
+    // Remove by ID: the list may have been re-sorted since the posting
+    Transaction* removed = transactionList->removeByID(lastTrans->id);
+    if (removed) delete removed;
+    if constexpr (Policy::columns) columns->removeLast();
+    if constexpr (Policy::stats) stats->revert();
+    if constexpr (Policy::timeline) timeline->revert();
+    if constexpr (Policy::velocityLimits) {
+        if (lastTrans->type == "WITHDRAWAL") velocity->revert(lastTrans->timestamp, lastTrans->amount);
+    }
+
+    // The posting leaves the live view but the log keeps it, plus the undo
+    if constexpr (Policy::eventLog) {
+        events->recordUndo(lastTrans->id, Money::toDouble(balance), clock.now());
+    }
+    if constexpr (Policy::changeFeed) {
+        unsigned char kind = (lastTrans->type == "WITHDRAWAL") ? KIND_WITHDRAWAL : KIND_DEPOSIT;
+        changes->recordUndo(*lastTrans, kind, Money::toDouble(balance));
+    }
+
+    // Undo always reverts the newest posting, so the chain just steps back
+    if constexpr (keepPostings) postings.pop_back();
+    if constexpr (Policy::auditChain) {
+        chain->rollback(postings.empty() ? archivedTailHash : postings.back()->chainHash);
+    }
+
+    delete lastTrans;
+
+    if (!quiet) {
+        std::cout << "Transaction undone successfully!" << std::endl;
+        std::cout << "New balance: $" << std::fixed << std::setprecision(2)
+                  << Money::toDouble(balance) << std::endl;
+    }
+}
+
+template <typename Policy>
+bool BasicLedger<Policy>::postImported(unsigned char kind, double amount,
+                                       const std::string& description, Timestamp timestamp) {
+    OpTimer timer(metrics, OP_IMPORT_ROW);
+    TRACE_SPAN("BankLedger::postImported");
+    Guard lock(mutex);
+
+    MoneyValue value = std::isfinite(amount) ? Money::fromDouble(amount) : 0;
+    if (value <= 0) return false;
+
+    // Historic rows keep their own time; the clock is only read when none was given
+    bool live = (timestamp == 0);
+    if (live) timestamp = clock.now();
+
+    bool isWithdrawal = (kind == KIND_WITHDRAWAL);
+    if (isWithdrawal) {
+        // Held money is spoken for, whatever the posting's source
+        if constexpr (Policy::holds) {
+            if (holds->size() > 0) expireHoldsAt(live ? timestamp : clock.now());
+        }
+        // A row without a time of its own is money moving now: limited like
+        // any withdrawal. Historic rows only count toward the windows.
+        if constexpr (Policy::velocityLimits) {
+            lastVelocityBreach = -1;
+            if (live && velocity->active()) {
+                lastVelocityBreach = velocity->check(timestamp, Money::toDouble(value));
+                if (lastVelocityBreach >= 0) return false;
+            }
+        }
+        if (value > balance - held) return false;
+    }
+
+    if (isWithdrawal) balance -= value;
+    else balance += value;
+    transactionID++;
+
+    Transaction* t = new Transaction(transactionID, isWithdrawal ? "WITHDRAWAL" : "DEPOSIT",
+                                     Money::toDouble(value), description, Money::toDouble(balance),
+                                     timestamp);
+
+    recordPosting(t, kind, false);
+    return true;
+}
+
+template <typename Policy>
+void BasicLedger<Policy>::setClock(const LedgerClock& c) {
+    Guard lock(mutex);
+    clock = c;
+}
+
+template <typename Policy>
+void BasicLedger<Policy>::clearUndoHistory() {
+    Guard lock(mutex);
+    clearUndoLocked();
+}
+
+template <typename Policy>
+void BasicLedger<Policy>::clearUndoLocked() {
+    if constexpr (Policy::undoDepth > 0) {
+        while (!undoStack->isEmpty()) {
+            delete undoStack->pop();
+        }
+    }
+    if constexpr (Policy::stats) stats->clearJournal();
+    if constexpr (Policy::timeline) timeline->clearJournal();
+}
+
+template <typename Policy>
+void BasicLedger<Policy>::showBalance() {
+    Guard lock(mutex);
+
+    std::cout << "\n=== Account Balance ===" << std::endl;
+    std::cout << "Current Balance: $" << std::fixed << std::setprecision(2)
+              << Money::toDouble(balance) << std::endl;
+    std::cout << "Total Transactions: " << transactionList->size() << std::endl;
+    std::cout << "Available Undos: " << (undoStack ? undoStack->size() : 0) << std::endl;
+    if (held > 0) {
+        std::cout << "On Hold: $" << std::fixed << std::setprecision(2) << Money::toDouble(held)
+                  << " (" << holds->size() << " holds), Available: $"
+                  << Money::toDouble(balance - held) << std::endl;
+    }
+
+    if constexpr (Policy::stats) {
+        const LedgerStats& s = stats->getTotal();
+        std::cout << "Total Deposits: $" << s.depositTotal << " (" << s.depositCount << ")" << std::endl;
+        std::cout << "Total Withdrawals: $" << s.withdrawalTotal << " (" << s.withdrawalCount << ")" << std::endl;
+        std::cout << "Largest Transaction: $" << s.largestTransaction
+                  << " (ID " << s.largestTransactionID << ")" << std::endl;
+        std::cout << "Balance Range: $" << s.minBalance << " - $" << s.maxBalance << std::endl;
+    }
+}
+
+template <typename Policy>
+void BasicLedger<Policy>::showHistory() {
+    TRACE_SPAN("BankLedger::showHistory");
+    Guard lock(mutex);
+
+    transactionList->display();
+    if (archivedRows > 0) {
+        std::cout << "(" << archivedRows << " older transactions archived in "
+                  << archive->segmentCount() << " segments)" << std::endl;
+    }
+}
+
+template <typename Policy>
+void BasicLedger<Policy>::sortByDate() {
+    OpTimer timer(metrics, OP_SORT_BY_DATE);
+    TRACE_SPAN("BankLedger::sortByDate");
+    Guard lock(mutex);
+
+    {
+        TRACE_SPAN("History::sortByDate");
+        transactionList->sortByDate();
+    }
+    if (!quiet) std::cout << "Transactions sorted by date." << std::endl;
+}
+
+template <typename Policy>
+void BasicLedger<Policy>::sortByAmount() {
+    OpTimer timer(metrics, OP_SORT_BY_AMOUNT);
+    TRACE_SPAN("BankLedger::sortByAmount");
+    Guard lock(mutex);
+
+    {
+        TRACE_SPAN("History::sortByAmount");
+        transactionList->sortByAmount();
+    }
+    if (!quiet) std::cout << "Transactions sorted by amount." << std::endl;
+}
+
+template <typename Policy>
+Transaction* BasicLedger<Policy>::searchByID(int id) {
+    OpTimer timer(metrics, OP_SEARCH);
+    TRACE_SPAN("BankLedger::searchByID");
+    Guard lock(mutex);
+
+    int n = transactionList->size();
+    if (n == 0 && archivedRows == 0) {
+        if (!quiet) std::cout << "No transactions available." << std::endl;
+        return nullptr;
+    }
+
+    // Binary search over the postings in ID order
+    std::vector<Transaction*> scratch;
+    size_t count;
+    Transaction* const* arr = hotByID(scratch, count);
+
+    int low = 0, high = (int)count - 1;
+    Transaction* result = nullptr;
+
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        if (arr[mid]->id == id) {
+            result = arr[mid];
+            break;
+        }
+        if (arr[mid]->id < id) low = mid + 1;
+        else high = mid - 1;
+    }
+
+    // Older IDs may have been archived (the row lives in the archive cache)
+    if (!result && archive != nullptr) result = archive->find(id);
+
+    if (!result) {
+        if (!quiet) std::cout << "Transaction with ID " << id << " not found." << std::endl;
+        return nullptr;
+    }
+
+    if (!quiet) {
+        TRACE_SPAN("console output");
+        std::cout << "\n=== Transaction Found ===" << std::endl;
+        result->display();
+        std::cout << "=========================\n";
+    }
+
+    return result;
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::getByIDs(const int* ids, int n, TransactionRecord* out) {
+    OpTimer timer(metrics, OP_MULTI_GET);
+    TRACE_SPAN("BankLedger::getByIDs");
+    Guard lock(mutex);
+
+    std::vector<int> order((size_t)n);
+    for (int i = 0; i < n; i++) order[(size_t)i] = i;
+    std::sort(order.begin(), order.end(), [ids](int a, int b) { return ids[a] < ids[b]; });
+
+    std::vector<Transaction*> scratch;
+    size_t hotCount;
+    Transaction* const* hot = hotByID(scratch, hotCount);
+    Transaction* const* hotEnd = hot + hotCount;
+    Transaction* const* pos = hot;
+    auto byID = [](const Transaction* t, int v) { return t->id < v; };
+
+    size_t loaded = (size_t)-1;
+    const std::vector<Transaction*>* rows = nullptr;
+    int found = 0;
+
+    for (int k : order) {
+        int id = ids[k];
+        const Transaction* t = nullptr;
+
+        if (hotCount > 0 && id >= hot[0]->id) {
+            // Requests are ascending, so the search only moves forward
+            pos = std::lower_bound(pos, hotEnd, id, byID);
+            if (pos != hotEnd && (*pos)->id == id) t = *pos;
+        } else if (archive != nullptr) {
+            size_t s = archive->segmentFor(id);
+            if (s < archive->segmentCount() && archive->segment(s).firstID <= id) {
+                if (s != loaded) {
+                    rows = archive->load(s);
+                    loaded = s;
+                }
+                if (rows) {
+                    auto it = std::lower_bound(rows->begin(), rows->end(), id, byID);
+                    if (it != rows->end() && (*it)->id == id) t = *it;
+                }
+            }
+        }
+
+        // Copy out now: archived rows only live until the next segment load
+        if (t) {
+            fillRecord(*t, out[k]);
+            found++;
+        } else {
+            memset(&out[k], 0, sizeof(TransactionRecord));
+        }
+    }
+
+    return found;
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::readHistory(HistoryCursor& cursor, TransactionRecord* out) {
+    OpTimer timer(metrics, OP_READ_HISTORY);
+    TRACE_SPAN("BankLedger::readHistory");
+    Guard lock(mutex);
+
+    if (cursor.done) return 0;
+
+    const HistoryFilter& f = cursor.filter;
+    const int lastID = (f.toID > 0 && f.toID < transactionID) ? f.toID : transactionID;
+    const int capacity = cursor.chunkSize;
+    auto byID = [](const Transaction* t, int v) { return t->id < v; };
+    int filled = 0;
+
+    // Archived segments first: they hold every ID below the hot tier
+    if (archive != nullptr) {
+        for (size_t s = archive->segmentFor(cursor.nextID);
+             s < archive->segmentCount() && filled < capacity; s++) {
+            const SegmentInfo& info = archive->segment(s);
+            if (info.firstID > lastID) break;
+            if (!segmentMayMatch(info, f)) {
+                cursor.nextID = info.lastID + 1;
+                continue;
+            }
+
+            const std::vector<Transaction*>* rows = archive->load(s);
+            if (!rows) return -1;     // cursor stays put, the caller may retry
+
+            auto it = std::lower_bound(rows->begin(), rows->end(), cursor.nextID, byID);
+            for (; it != rows->end() && filled < capacity; ++it) {
+                const Transaction* t = *it;
+                if (t->id > lastID) break;
+                cursor.nextID = t->id + 1;
+                if (matchesFilter(*t, f)) fillRecord(*t, out[filled++]);
+            }
+        }
+    }
+    if (filled == capacity) return filled;
+
+    std::vector<Transaction*> scratch;
+    size_t hotCount;
+    Transaction* const* hot = hotByID(scratch, hotCount);
+    Transaction* const* it = std::lower_bound(hot, hot + hotCount, cursor.nextID, byID);
+    for (; it != hot + hotCount && filled < capacity; ++it) {
+        const Transaction* t = *it;
+        if (t->id > lastID) break;
+        cursor.nextID = t->id + 1;
+        if (matchesFilter(*t, f)) fillRecord(*t, out[filled++]);
+    }
+
+    if (it == hot + hotCount || (*it)->id > lastID) cursor.done = true;
+    return filled;
+}
+
+template <typename Policy>
+bool BasicLedger<Policy>::aggregate(int typeMask, Timestamp fromTs, Timestamp toTs, AggregateResult& out) const {
+    OpTimer timer(metrics, OP_AGGREGATE);
+    TRACE_SPAN("BankLedger::aggregate");
+    Guard lock(mutex);
+
+    if constexpr (Policy::columns) {
+        out = aggregateTransactions(*columns, typeMask, fromTs, toTs);
+    } else {
+        int n = transactionList->size();
+        Transaction** arr = transactionList->toArray();
+        out = aggregateArrayScalar(arr, n, typeMask, fromTs, toTs);
+        delete[] arr;
+    }
+
+    if (archive != nullptr && archivedRows > 0) {
+        TRACE_SPAN("HistoryArchive::aggregate");
+        AggregateResult archived;
+        if (!archive->aggregate(typeMask, fromTs, toTs, archived)) return false;
+        out = combineAggregates(archived, out);
+    }
+    return true;
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::runQuery(const CompiledQuery& query, TransactionRecord* out, int capacity,
+                                  QueryReport& report) {
+    OpTimer timer(metrics, OP_QUERY);
+    TRACE_SPAN("BankLedger::runQuery");
+    Guard lock(mutex);
+
+    auto started = std::chrono::steady_clock::now();
+    memset(&report, 0, sizeof(QueryReport));
+    uint32_t sel[QUERY_BATCH];
+    int filled = 0;
+
+    auto drain = [&](QueryScan& scan) {
+        size_t n;
+        while ((n = scan.nextBatch(sel)) > 0) {
+            report.rowsMatched += (long long)n;
+            for (size_t k = 0; k < n && filled < capacity; k++) scan.fill(sel[k], out[filled++]);
+        }
+        report.rowsScanned += (long long)scan.rowsScanned();
+    };
+
+    // Archived segments decode only the columns the query reads or returns
+    if (archive != nullptr) {
+        TRACE_SPAN("HistoryArchive::query");
+        SegmentColumns cols;
+        for (size_t s = 0; s < archive->segmentCount(); s++) {
+            if (!querySegmentMayMatch(query, archive->segment(s))) {
+                report.segmentsSkipped++;
+                continue;
+            }
+            if (!archive->decodeColumns(s, querySegmentColumns(query), cols)) return -1;
+            QuerySource src = segmentQuerySource(cols);
+            QueryScan scan(query, src);
+            drain(scan);
+        }
+    }
+
+    // Hot tier: the columns, with descriptions read through the postings
+    std::vector<Transaction*> scratch;
+    size_t hotCount;
+    Transaction* const* hot = hotByID(scratch, hotCount);
+    TransactionColumns gathered;
+    const TransactionColumns* cols;
+    if constexpr (Policy::columns) {
+        cols = columns;
+    } else {
+        gathered.reserve(hotCount);
+        for (size_t i = 0; i < hotCount; i++) {
+            const Transaction* t = hot[i];
+            gathered.append(t->id, t->type == "WITHDRAWAL" ? KIND_WITHDRAWAL : KIND_DEPOSIT,
+                            t->amount, t->timestamp, t->balanceAfter);
+        }
+        cols = &gathered;
+    }
+
+    QuerySource src;
+    src.rows = std::min(cols->size(), hotCount);
+    src.ids = cols->idData();
+    src.kinds = cols->kindData();
+    src.amounts = cols->amountData();
+    src.timestamps = cols->timestampData();
+    src.balances = cols->balanceData();
+    src.postings = hot;
+    src.descriptionIndex = nullptr;
+    src.dictionary = nullptr;
+    QueryScan scan(query, src);
+    drain(scan);
+
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    report.rowsPerSecond = report.seconds > 0.0 ? (double)report.rowsScanned / report.seconds : 0.0;
+    return filled;
+}
+
+template <typename Policy>
+const LedgerStats& BasicLedger<Policy>::getStats() const {
+    Guard lock(mutex);
+
+    if constexpr (Policy::stats) {
+        return stats->getTotal();
+    } else {
+        static const LedgerStats none = LedgerStats();
+        return none;
+    }
+}
+
+template <typename Policy>
+bool BasicLedger<Policy>::getBucketStats(StatsBucket bucket, Timestamp timestamp,
+                                         LedgerStats& out) const {
+    Guard lock(mutex);
+
+    if constexpr (Policy::stats) {
+        return stats->getBucket(bucket, timestamp, out);
+    } else {
+        (void)bucket;
+        (void)timestamp;
+        (void)out;
+        return false;
+    }
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::getBalanceTimeline(Timestamp fromTs, Timestamp toTs, int points,
+                                            TimelinePoint* out) const {
+    Guard lock(mutex);
+
+    if constexpr (Policy::timeline) {
+        return timeline->query(fromTs, toTs, points, out);
+    } else {
+        (void)fromTs;
+        (void)toTs;
+        (void)points;
+        (void)out;
+        return 0;
+    }
+}
+
+template <typename Policy>
+bool BasicLedger<Policy>::verifyHistory(int fromID, int toID) const {
+    OpTimer timer(metrics, OP_VERIFY);
+    TRACE_SPAN("BankLedger::verifyHistory");
+    Guard lock(mutex);
+
+    if constexpr (Policy::auditChain) {
+        if (fromID > toID) return false;
+        bool covered = false;
+
+        // Archived segments overlapping the range are decoded and rehashed
+        // whole; they end on checkpoints, which anchor them to the root
+        if (archive != nullptr) {
+            for (size_t i = 0; i < archive->segmentCount(); i++) {
+                const SegmentInfo& s = archive->segment(i);
+                if (s.lastID < fromID || s.firstID > toID) continue;
+
+                const std::vector<Transaction*>* rows = archive->load(i);
+                if (rows == nullptr ||
+                    !chain->verifyBlocks(rows->data(), s.firstPosition, rows->size(), false)) {
+                    return false;
+                }
+                covered = true;
+            }
+        }
+
+        // IDs increase in posting order, so positions can be found by binary search
+        auto byID = [](const Transaction* t, int id) { return t->id < id; };
+        auto first = std::lower_bound(postings.begin(), postings.end(), fromID, byID);
+        auto last = std::lower_bound(postings.begin(), postings.end(), toID + 1, byID);
+        if (first == last) return covered;
+
+        size_t firstPos = (size_t)(first - postings.begin()) + archivedRows;
+        size_t lastPos = (size_t)(last - postings.begin()) - 1 + archivedRows;
+        return chain->verify(postings.data(), archivedRows + postings.size(), firstPos, lastPos,
+                             archivedRows);
+    } else {
+        (void)fromID;
+        (void)toID;
+        return false;
+    }
+}
+
+template <typename Policy>
+std::string BasicLedger<Policy>::getAuditRoot() const {
+    Guard lock(mutex);
+
+    if constexpr (Policy::auditChain) {
+        // Checkpoint Merkle root plus the live head covering the partial last block
+        return chain->root().toHex() + ":" + chain->getHead().toHex();
+    } else {
+        return "";
+    }
+}
+
+template <typename Policy>
+bool BasicLedger<Policy>::getMetrics(LedgerMetricsSnapshot& out) const {
+    if constexpr (metricsEnabled) {
+        metrics->snapshot(out);
+        return true;
+    } else {
+        (void)out;
+        return false;
+    }
+}
+
+template <typename Policy>
+void BasicLedger<Policy>::showMetrics() const {
+    if constexpr (metricsEnabled) {
+        std::cout << "\n=== Operation Latency ===" << std::endl;
+        std::cout << metrics->dump();
+    } else {
+        std::cout << "Metrics are disabled in this build." << std::endl;
+    }
+}
+
+template <typename Policy>
+bool BasicLedger<Policy>::enableArchive(const std::string& directory, int hotLimit,
+                                        int cacheSegments) {
+    Guard lock(mutex);
+
+    if constexpr (Policy::archive) {
+        if (archive != nullptr) return false;
+
+        HistoryArchive* a = new HistoryArchive(directory, cacheSegments);
+        if (!a->isUsable()) {
+            delete a;
+            return false;
+        }
+
+        // Undo must always find its posting in the hot tier
+        archive = a;
+        archiving = true;
+        this->hotLimit = (size_t)(hotLimit < Policy::undoDepth ? Policy::undoDepth : hotLimit);
+
+        while (archiving && postings.size() >= this->hotLimit + ARCHIVE_SEGMENT_ROWS) {
+            compactOldest();
+        }
+        if constexpr (Policy::eventLog) events->spillTo(directory, cacheSegments);
+        return true;
+    } else {
+        (void)directory;
+        (void)hotLimit;
+        (void)cacheSegments;
+        return false;
+    }
+}
+
+template <typename Policy>
+uint64_t BasicLedger<Policy>::getArchivedCount() const {
+    Guard lock(mutex);
+    return archivedRows;
+}
+
+template <typename Policy>
+bool BasicLedger<Policy>::getStateAt(Timestamp asOf, LedgerStateAt& out) const {
+    OpTimer timer(metrics, OP_STATE_AT);
+    TRACE_SPAN("BankLedger::getStateAt");
+    Guard lock(mutex);
+
+    if constexpr (Policy::eventLog) {
+        return events->stateAt(asOf, out);
+    } else {
+        (void)asOf;
+        (void)out;
+        return false;
+    }
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::getChangesSince(uint64_t after, ChangeRecord* out, int capacity,
+                                         uint64_t& latest) const {
+    Guard lock(mutex);
+
+    if constexpr (Policy::changeFeed) {
+        latest = changes->latestSeq();
+        return changes->since(after, out, capacity);
+    } else {
+        (void)after;
+        (void)out;
+        (void)capacity;
+        latest = 0;
+        return CHANGES_SNAPSHOT_REQUIRED;
+    }
+}
+
+template <typename Policy>
+uint64_t BasicLedger<Policy>::getChangeSeq() const {
+    Guard lock(mutex);
+    if constexpr (Policy::changeFeed) return changes->latestSeq();
+    else return 0;
+}
+
+template <typename Policy>
+void BasicLedger<Policy>::showLedgerAt(Timestamp asOf) const {
+    TRACE_SPAN("BankLedger::showLedgerAt");
+    Guard lock(mutex);
+
+    if constexpr (Policy::eventLog) {
+        LedgerStateAt s;
+        std::vector<LoggedPosting> live, undone;
+        if (!events->stateAt(asOf, s) || !events->livePostings(s, live) ||
+            !events->undonePostings(s, undone)) {
+            std::cout << "Error: Cannot read archived history." << std::endl;
+            return;
+        }
+
+        auto print = [](const LoggedPosting& p) {
+            std::cout << "ID: " << p.event.transactionID << " | "
+                      << (p.event.postingKind == KIND_WITHDRAWAL ? "WITHDRAWAL" : "DEPOSIT") << " | "
+                      << "Amount: $" << p.event.amount << " | "
+                      << "Description: " << p.description << " | "
+                      << "Balance: $" << p.event.balanceAfter << "\n";
+        };
+
+        time_t when = (time_t)timestampToSeconds(asOf);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", std::localtime(&when));
+        std::cout << "\n=== Ledger as of " << stamp << " ===" << std::endl;
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "Events applied: " << s.events << " of " << events->size() << std::endl;
+        std::cout << "Balance: $" << s.balance << std::endl;
+        std::cout << "Deposits: $" << s.depositTotal << " (" << s.depositCount << ")" << std::endl;
+        std::cout << "Withdrawals: $" << s.withdrawalTotal << " (" << s.withdrawalCount << ")" << std::endl;
+
+        std::cout << "\nLive postings (" << live.size() << "):" << std::endl;
+        for (const LoggedPosting& p : live) print(p);
+
+        std::cout << "\nUndone by then (" << undone.size() << "):" << std::endl;
+        for (const LoggedPosting& p : undone) print(p);
+    } else {
+        (void)asOf;
+        std::cout << "Point-in-time history is not kept by this ledger." << std::endl;
+    }
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::expireHoldsAt(Timestamp now) {
+    if constexpr (Policy::holds) {
+        std::vector<HoldRecord> expired;
+        holds->expire(now, expired);
+        for (const HoldRecord& h : expired) held -= Money::fromDouble(h.amount);
+        return (int)expired.size();
+    } else {
+        (void)now;
+        return 0;
+    }
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::placeHold(double amount, const std::string& description,
+                                   Timestamp expiresAt) {
+    OpTimer timer(metrics, OP_PLACE_HOLD);
+    TRACE_SPAN("BankLedger::placeHold");
+    Guard lock(mutex);
+
+    if constexpr (Policy::holds) {
+        MoneyValue value = std::isfinite(amount) ? Money::fromDouble(amount) : 0;
+        if (value <= 0) return 0;
+
+        Timestamp now = clock.now();
+        expireHoldsAt(now);
+        if (value > balance - held) return 0;
+
+        held += value;
+        return holds->place(Money::toDouble(value), description, now, expiresAt);
+    } else {
+        (void)amount;
+        (void)description;
+        (void)expiresAt;
+        return 0;
+    }
+}
+
+template <typename Policy>
+bool BasicLedger<Policy>::settleHold(int holdID, double amount) {
+    OpTimer timer(metrics, OP_SETTLE_HOLD);
+    TRACE_SPAN("BankLedger::settleHold");
+    Guard lock(mutex);
+
+    if constexpr (Policy::holds) {
+        Timestamp now = clock.now();
+        expireHoldsAt(now);
+
+        HoldRecord h;
+        if (!holds->get(holdID, h)) return false;
+        MoneyValue reserved = Money::fromDouble(h.amount);
+        MoneyValue value = (amount == 0.0) ? reserved
+                         : std::isfinite(amount) ? Money::fromDouble(amount) : 0;
+        if (value <= 0 || value > reserved) return false;
+        // The reservation should guarantee the money; never overdraw if it doesn't
+        if (value > balance) return false;
+
+        double heldAmount;
+        std::string description;
+        holds->take(holdID, heldAmount, description);
+        held -= reserved;
+
+        balance -= value;
+        transactionID++;
+        Transaction* t = new Transaction(transactionID, "WITHDRAWAL", Money::toDouble(value),
+                                         description, Money::toDouble(balance), now);
+        recordPosting(t, KIND_WITHDRAWAL, true);
+        return true;
+    } else {
+        (void)holdID;
+        (void)amount;
+        return false;
+    }
+}
+
+template <typename Policy>
+bool BasicLedger<Policy>::releaseHold(int holdID) {
+    TRACE_SPAN("BankLedger::releaseHold");
+    Guard lock(mutex);
+
+    if constexpr (Policy::holds) {
+        double amount;
+        std::string description;
+        if (!holds->take(holdID, amount, description)) return false;
+        held -= Money::fromDouble(amount);
+        return true;
+    } else {
+        (void)holdID;
+        return false;
+    }
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::expireHolds() {
+    TRACE_SPAN("BankLedger::expireHolds");
+    Guard lock(mutex);
+
+    if constexpr (Policy::holds) {
+        if (holds->size() == 0) return 0;
+        return expireHoldsAt(clock.now());
+    } else {
+        return 0;
+    }
+}
+
+template <typename Policy>
+bool BasicLedger<Policy>::getHold(int holdID, HoldRecord& out) const {
+    Guard lock(mutex);
+
+    if constexpr (Policy::holds) {
+        return holds->get(holdID, out);
+    } else {
+        (void)holdID;
+        (void)out;
+        return false;
+    }
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::getActiveHoldCount() const {
+    Guard lock(mutex);
+    return holds ? (int)holds->size() : 0;
+}
+
+template <typename Policy>
+double BasicLedger<Policy>::getHeldBalance() const {
+    Guard lock(mutex);
+    return Money::toDouble(held);
+}
+
+template <typename Policy>
+double BasicLedger<Policy>::getAvailableBalance() const {
+    Guard lock(mutex);
+    return Money::toDouble(balance - held);
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::setVelocityLimits(const VelocityRule* rules, int n) {
+    TRACE_SPAN("BankLedger::setVelocityLimits");
+    Guard lock(mutex);
+
+    if constexpr (Policy::velocityLimits) {
+        int active = velocity->setRules(rules, rules ? n : 0);
+        if (active == 0) return 0;
+
+        // Recount recent withdrawals; anything older than the longest window is skipped
+        VelocityRule set[VELOCITY_MAX_RULES];
+        velocity->getRules(set);
+        int64_t longest = 0;
+        for (int i = 0; i < active; i++) longest = std::max(longest, set[i].window);
+        Timestamp cutoff = clock.now() - longest;
+
+        // Archived segments first (posting order); their footers say which
+        // can hold a recent withdrawal, and only those columns are decoded
+        if constexpr (Policy::archive) {
+            for (size_t i = 0; archive != nullptr && i < archive->segmentCount(); i++) {
+                const SegmentInfo& s = archive->segment(i);
+                if (s.maxTimestamp < cutoff || s.withdrawalCount == 0) continue;
+
+                SegmentColumns cols;
+                if (!archive->decodeColumns(i, SEG_SCAN_COLUMNS, cols)) continue;
+                for (size_t r = 0; r < cols.timestamps.size(); r++) {
+                    if (cols.timestamps[r] >= cutoff && cols.kinds[r] == KIND_WITHDRAWAL) {
+                        velocity->record(cols.timestamps[r], cols.amounts[r]);
+                    }
+                }
+            }
+        }
+
+        std::vector<Transaction*> scratch;
+        size_t count;
+        Transaction* const* hot = hotByID(scratch, count);
+        for (size_t i = 0; i < count; i++) {
+            const Transaction* t = hot[i];
+            if (t->timestamp >= cutoff && t->type == "WITHDRAWAL") {
+                velocity->record(t->timestamp, t->amount);
+            }
+        }
+        return active;
+    } else {
+        (void)rules;
+        (void)n;
+        return 0;
+    }
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::getVelocityLimits(VelocityRule* out) const {
+    Guard lock(mutex);
+    if constexpr (Policy::velocityLimits) {
+        return velocity->getRules(out);
+    } else {
+        (void)out;
+        return 0;
+    }
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::getLastVelocityBreach() const {
+    Guard lock(mutex);
+    return lastVelocityBreach;
+}
+
+// ----------------------
+// Getter implementations
+// ----------------------
+template <typename Policy>
+double BasicLedger<Policy>::getBalance() const {
+    Guard lock(mutex);
+    return Money::toDouble(balance);
+}
+
+template <typename Policy>
+bool BasicLedger<Policy>::canUndo() const {
+    Guard lock(mutex);
+    return undoStack != nullptr && !undoStack->isEmpty();
+}
+
+template <typename Policy>
+int BasicLedger<Policy>::getTransactionCount() const {
+    Guard lock(mutex);
+    return (transactionList ? transactionList->size() : 0) + (int)archivedRows;
+}
+
+template <typename Policy>
+const TransactionColumns& BasicLedger<Policy>::getColumns() const {
+    if constexpr (Policy::columns) {
+        return *columns;
+    } else {
+        static const TransactionColumns none;
+        return none;
+    }
+}
+
+// Stock instantiations, compiled once in src/ledger_core.cpp
+typedef BasicLedger<EmbeddedLedgerPolicy> EmbeddedLedger;
+typedef BasicLedger<ConcurrentLedgerPolicy> ConcurrentLedger;
+
+extern template class BasicLedger<DefaultLedgerPolicy>;
+extern template class BasicLedger<EmbeddedLedgerPolicy>;
+extern template class BasicLedger<ConcurrentLedgerPolicy>;
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef LEDGER_POLICY_H
+#define LEDGER_POLICY_H
+
+#include "linked_list.h"
+#include "vector_history.h"
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+
+// Number of most recent transactions that can be undone (default policy)
+#define UNDO_LIMIT 50
+
+// A ledger policy is a struct with these members:
+//
+//   typedef ... Money;      // DoubleMoney or FixedPointMoney
+//   typedef ... Mutex;      // NullMutex (single-threaded) or std::mutex
+//   typedef ... History;    // LinkedList or VectorHistory
+//   static const int  undoDepth;    // 0 disables undo
+//   static const bool metrics;      // latency histograms
+//   static const bool columns;      // column store for vectorized aggregation
+//   static const bool stats;        // incremental running statistics
+//   static const bool auditChain;   // SHA-256 hash chain over postings
+//   static const bool archive;      // cold history can move to disk segments
+//   static const bool eventLog;     // append-only log for point-in-time queries
+//   static const bool changeFeed;   // bounded change ring for incremental pollers
+//   static const bool timeline;     // balance-over-time pyramid for charts
+//   static const bool holds;        // authorization holds with timed expiry
+//   static const bool idempotency;  // client retry keys detect duplicate postings
+//   static const bool velocityLimits;   // sliding-window caps on withdrawals
+//
+// Disabled features are removed at compile time (if constexpr), so an
+// embedded build pays nothing for them.
+
+// ===== Money representations =====
+
+// Balance kept as a binary double (today's behaviour)
+struct DoubleMoney {
+    typedef double Value;
+
+    static Value fromDouble(double v) { return v; }
+    static double toDouble(Value v) { return v; }
+};
+
+// Balance kept as integer cents: no drift over millions of postings.
+// Amounts are rounded to the nearest cent on entry.
+struct FixedPointMoney {
+    typedef int64_t Value;
+
+    static Value fromDouble(double v) { return (Value)std::llround(v * 100.0); }
+    static double toDouble(Value v) { return (double)v / 100.0; }
+};
+
+// ===== Locking =====
+
+// Satisfies Lockable with no cost, for single-threaded builds
+struct NullMutex {
+    void lock() {}
+    void unlock() {}
+};
+
+// ===== Stock policies =====
+
+// Everything on, single-threaded: what BankLedger has always been
+struct DefaultLedgerPolicy {
+    typedef DoubleMoney Money;
+    typedef NullMutex Mutex;
+    typedef LinkedList History;
+    static const int undoDepth = UNDO_LIMIT;
+    static const bool metrics = true;
+    static const bool columns = true;
+    static const bool stats = true;
+    static const bool auditChain = true;
+    static const bool archive = true;
+    static const bool eventLog = true;
+    static const bool changeFeed = true;
+    static const bool timeline = true;
+    static const bool holds = true;
+    static const bool idempotency = true;
+    static const bool velocityLimits = true;
+};
+
+// Minimal footprint: fixed-point money, a short undo window, no side indexes
+struct EmbeddedLedgerPolicy {
+    typedef FixedPointMoney Money;
+    typedef NullMutex Mutex;
+    typedef VectorHistory History;
+    static const int undoDepth = 8;
+    static const bool metrics = false;
+    static const bool columns = false;
+    static const bool stats = false;
+    static const bool auditChain = false;
+    static const bool archive = false;
+    static const bool eventLog = false;
+    static const bool changeFeed = false;
+    static const bool timeline = false;
+    static const bool holds = false;
+    static const bool idempotency = false;
+    static const bool velocityLimits = false;
+};
+
+// Full feature set, every public operation serialized by a mutex so the
+// ledger can be shared between threads (e.g. FFI worker pools)
+struct ConcurrentLedgerPolicy {
+    typedef DoubleMoney Money;
+    typedef std::mutex Mutex;
+    typedef LinkedList History;
+    static const int undoDepth = UNDO_LIMIT;
+    static const bool metrics = true;
+    static const bool columns = true;
+    static const bool stats = true;
+    static const bool auditChain = true;
+    static const bool archive = true;
+    static const bool eventLog = true;
+    static const bool changeFeed = true;
+    static const bool timeline = true;
+    static const bool holds = true;
+    static const bool idempotency = true;
+    static const bool velocityLimits = true;
+};
+
+#endif
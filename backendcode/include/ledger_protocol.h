@@ -0,0 +1,55 @@
+#ifndef LEDGER_PROTOCOL_H
+#define LEDGER_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Binary protocol of the ledger daemon (little endian, no padding):
+//
+//   frame: uint32 length | uint8 opcode | uint8 status | uint16 reserved |
+//          uint32 tag | payload[length]
+//
+// Requests send status 0. Responses echo opcode and tag and come back in
+// request order on each connection, so a client may pipeline any number
+// of requests before reading.
+#define PROTOCOL_HEADER_SIZE     12
+#define PROTOCOL_MAX_PAYLOAD     4096
+#define PROTOCOL_DEFAULT_SOCKET  "/tmp/bank_ledger.sock"
+
+// Request payloads (responses in brackets). Times are microseconds since the epoch.
+enum RequestOpcode : unsigned char {
+    REQ_DEPOSIT = 1,       // double amount | uint16 length | description   [double balance]
+    REQ_WITHDRAW = 2,      // same as deposit                               [double balance]
+    REQ_UNDO = 3,          // -                                             [double balance]
+    REQ_BALANCE = 4,       // -                                             [double balance]
+    REQ_COUNT = 5,         // -                                             [int64 count]
+    REQ_AGGREGATE = 6,     // int32 typeMask | int64 fromUs | int64 toUs    [AggregateResult]
+    REQ_VERIFY = 7         // int32 fromID | int32 toID                     [-]
+};
+
+enum ResponseStatus : unsigned char {
+    RESP_OK = 0,
+    RESP_REJECTED = 1,     // valid request the ledger refused (e.g. insufficient balance)
+    RESP_BAD_REQUEST = 2   // malformed; the server closes the connection after it
+};
+
+struct FrameHeader {
+    uint32_t length;
+    unsigned char opcode;
+    unsigned char status;
+    uint32_t tag;
+};
+
+// Append one frame to out
+void appendFrame(std::string& out, unsigned char opcode, unsigned char status, uint32_t tag,
+                 const void* payload, uint32_t length);
+
+// Deposit / withdrawal request
+void appendPostingRequest(std::string& out, unsigned char opcode, uint32_t tag,
+                          double amount, const std::string& description);
+
+// False if fewer than PROTOCOL_HEADER_SIZE bytes are available
+bool readFrameHeader(const char* data, size_t size, FrameHeader& out);
+
+#endif
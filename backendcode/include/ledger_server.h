@@ -0,0 +1,87 @@
+#ifndef LEDGER_SERVER_H
+#define LEDGER_SERVER_H
+
+#include "bank_ledger.h"
+#include "ledger_protocol.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Bytes read from one connection per event-loop round, so a flooding
+// client can't starve the others
+#define SERVER_READ_BUDGET (1 << 20)
+
+// Unsent response bytes per connection before the server stops reading and
+// applying its requests, so a client that doesn't read can't grow memory
+#define SERVER_OUTPUT_LIMIT (4 << 20)
+
+struct ServerStats {
+    uint64_t connections;      // accepted so far
+    uint64_t requests;
+    uint64_t rounds;           // event-loop rounds that applied requests
+    uint64_t bytesIn;
+    uint64_t bytesOut;
+};
+
+// Serves one ledger to local clients over a Unix domain socket, from a
+// single-threaded epoll loop (Linux only). Each round drains every ready
+// socket, applies all complete requests back to back (consecutive postings
+// as one ledger batch), then answers each connection with one write.
+class LedgerServer {
+private:
+    struct Connection {
+        int fd;
+        std::string in;        // unparsed request bytes
+        std::string out;       // responses not yet written
+        size_t flushed;        // bytes of out already written
+        bool wantRead;         // EPOLLIN registered (off while out is over the limit)
+        bool wantWrite;        // EPOLLOUT registered
+        bool closing;
+        bool active;           // queued for this round
+        bool deferred;         // requests left unapplied at the output limit
+    };
+
+    BankLedger& ledger;
+    int listenFd;
+    int epollFd;
+    std::string socketPath;
+    std::vector<Connection*> connections;
+    std::atomic<bool> stopping;
+    ServerStats stats;
+
+    // Postings collected from one connection, reused across rounds
+    std::vector<FrameHeader> batchFrames;
+    std::vector<PostingRequest> batch;
+    std::vector<PostingResult> batchResults;
+    size_t batchSize;
+
+    void acceptClients();
+    void readAvailable(Connection* c);
+    void applyRequests(Connection* c);
+    void applyBatch(std::string& out);
+    bool handle(const FrameHeader& h, const char* payload, std::string& out);
+    void flush(Connection* c);
+    void watch(Connection* c);
+    void closeConnection(Connection* c);
+
+public:
+    explicit LedgerServer(BankLedger& ledger);
+    ~LedgerServer();
+
+    LedgerServer(const LedgerServer&) = delete;
+    LedgerServer& operator=(const LedgerServer&) = delete;
+
+    // Bind and listen (replaces a stale socket file). False on failure.
+    bool listen(const std::string& path);
+
+    // Serve until stop() is called
+    void run();
+
+    // Safe from a signal handler
+    void stop() { stopping.store(true, std::memory_order_relaxed); }
+
+    const ServerStats& getStats() const { return stats; }
+};
+
+#endif
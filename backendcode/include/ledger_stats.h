@@ -0,0 +1,77 @@
+#ifndef LEDGER_STATS_H
+#define LEDGER_STATS_H
+
+#include "clock.h"
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Summary counters, plain C layout so it can be returned across FFI
+struct LedgerStats {
+    double depositTotal;
+    double withdrawalTotal;
+    int depositCount;
+    int withdrawalCount;
+    double largestTransaction;
+    int largestTransactionID;      // 0 if no postings yet
+    double minBalance;             // running min/max of balanceAfter
+    double maxBalance;
+};
+
+// Calendar bucket granularity (UTC)
+enum StatsBucket {
+    BUCKET_DAY = 0,
+    BUCKET_MONTH = 1
+};
+
+// Maintains LedgerStats for the whole ledger and per day/month bucket.
+// Every posting is O(1); undo restores the exact previous values from a
+// journal that is kept as deep as the undo stack (a fixed ring, so
+// dropping the oldest entry is O(1) too).
+class LedgerStatsTracker {
+private:
+    struct JournalEntry {
+        LedgerStats prevTotal;
+        int dayKey;
+        int monthKey;
+        LedgerStats prevDay;
+        LedgerStats prevMonth;
+        bool dayExisted;
+        bool monthExisted;
+    };
+
+    LedgerStats total;
+    std::unordered_map<int, LedgerStats> days;
+    std::unordered_map<int, LedgerStats> months;
+    std::vector<JournalEntry> journal;   // ring of maxJournal slots
+    size_t journalHead;                  // slot the next entry goes into
+    size_t journalCount;
+    size_t maxJournal;
+
+    static void apply(LedgerStats& s, int id, bool isWithdrawal, double amount, double balanceAfter);
+
+public:
+    LedgerStatsTracker(double initialBalance, int undoDepth);
+
+    // Record a posting; undoable = whether it was pushed on the undo stack
+    void record(int id, bool isWithdrawal, double amount, Timestamp timestamp,
+                double balanceAfter, bool undoable = true);
+
+    // Revert the most recent undoable posting
+    void revert();
+
+    // Forget undo information (undo history was cleared)
+    void clearJournal() { journalCount = 0; }
+
+    const LedgerStats& getTotal() const { return total; }
+
+    // Stats for the bucket containing timestamp (UTC); false if no postings there
+    bool getBucket(StatsBucket bucket, Timestamp timestamp, LedgerStats& out) const;
+
+    // Bucket keys: days since epoch / months since year 0
+    static int dayKey(Timestamp timestamp);
+    static int monthKey(Timestamp timestamp);
+};
+
+#endif
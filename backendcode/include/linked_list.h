@@ -33,6 +33,13 @@ public:
     // Remove last node, return Transaction* without deleting it
     Transaction* removeLast();
 
+    // Remove node holding the given transaction ID, return Transaction* without deleting it
+    Transaction* removeByID(int id);
+
+    // Delete every transaction with an ID below `id` (archived postings).
+    // Works in any sort order; returns how many were removed.
+    int discardBefore(int id);
+
     // Display list
     void display();
 
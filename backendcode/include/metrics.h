@@ -0,0 +1,137 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+// Compile-time switch: build with BANK_LEDGER_METRICS=0 to strip all timing
+#ifndef BANK_LEDGER_METRICS
+#define BANK_LEDGER_METRICS 1
+#endif
+
+// Ledger operations that are timed
+enum LedgerOp {
+    OP_DEPOSIT = 0,
+    OP_WITHDRAW,
+    OP_UNDO,
+    OP_SORT_BY_DATE,
+    OP_SORT_BY_AMOUNT,
+    OP_SEARCH,
+    OP_AGGREGATE,
+    OP_IMPORT_ROW,
+    OP_VERIFY,
+    OP_STATE_AT,
+    OP_MULTI_GET,
+    OP_READ_HISTORY,
+    OP_PLACE_HOLD,
+    OP_SETTLE_HOLD,
+    OP_QUERY,
+    OP_COUNT
+};
+
+// Per-operation summary, plain C layout for FFI
+struct OpMetrics {
+    unsigned long long count;
+    unsigned long long totalNs;
+    unsigned long long minNs;
+    unsigned long long maxNs;
+    double p50Ns;
+    double p90Ns;
+    double p99Ns;
+    double p999Ns;
+};
+
+struct LedgerMetricsSnapshot {
+    OpMetrics ops[OP_COUNT];
+};
+
+const char* ledgerOpName(int op);
+
+// HDR-style log-linear histogram layout: values below 32 ns get exact
+// buckets, above that each power of two is split into 16 sub-buckets
+// (~6% relative error). Values are clamped at 2^40 ns (~18 minutes).
+#define HIST_SUB_BITS     4
+#define HIST_LINEAR       32
+#define HIST_MAX_SHIFT    36
+#define HIST_BUCKETS      (HIST_LINEAR + HIST_MAX_SHIFT * 16)
+
+int histogramBucket(uint64_t ns);
+uint64_t histogramBucketLow(int bucket);
+
+// Collects latency histograms for one ledger. Each thread writes to its own
+// shard (single writer, no atomic read-modify-write on the hot path); a
+// snapshot merges all shards with relaxed loads and never takes a lock.
+class LedgerMetrics {
+private:
+    struct Shard {
+        std::atomic<uint64_t> counts[OP_COUNT][HIST_BUCKETS];
+        std::atomic<uint64_t> total[OP_COUNT];
+        std::atomic<uint64_t> minNs[OP_COUNT];
+        std::atomic<uint64_t> maxNs[OP_COUNT];
+        Shard* next;
+        std::thread::id owner;     // the one thread that writes it
+
+        Shard();
+    };
+
+    std::atomic<Shard*> shards;    // lock-free push-only list
+    uint64_t instanceID;           // never reused, keys the thread-local cache
+
+    Shard* localShard();
+
+public:
+    LedgerMetrics();
+    ~LedgerMetrics();
+
+    void record(LedgerOp op, uint64_t ns);
+    void snapshot(LedgerMetricsSnapshot& out) const;
+
+    // Threads that have recorded into this ledger (one shard each)
+    int shardCount() const;
+
+    // Text table of every operation that has been recorded
+    std::string dump() const;
+};
+
+// Times the enclosing scope into a LedgerMetrics
+class ScopedOpTimer {
+private:
+    LedgerMetrics* metrics;
+    LedgerOp op;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    ScopedOpTimer(LedgerMetrics* m, LedgerOp o)
+        : metrics(m), op(o), start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedOpTimer() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        metrics->record(op, (uint64_t)ns);
+    }
+};
+
+// Compile-time selectable timer for templated ledgers: the disabled
+// specialization is empty and generates no code
+template <bool Enabled>
+class ConditionalOpTimer {
+public:
+    ConditionalOpTimer(LedgerMetrics*, LedgerOp) {}
+};
+
+template <>
+class ConditionalOpTimer<true> : public ScopedOpTimer {
+public:
+    ConditionalOpTimer(LedgerMetrics* m, LedgerOp o) : ScopedOpTimer(m, o) {}
+};
+
+#if BANK_LEDGER_METRICS
+#define LEDGER_TIMED(metrics, op) ScopedOpTimer ledgerOpTimer_((metrics), (op))
+#else
+#define LEDGER_TIMED(metrics, op) ((void)0)
+#endif
+
+#endif
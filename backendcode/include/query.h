@@ -0,0 +1,131 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include "transaction.h"
+#include "history_cursor.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct SegmentInfo;
+struct SegmentColumns;
+
+// Rows filtered per pipeline step
+#define QUERY_BATCH 1024
+
+// ===== Filter language =====
+//
+//   [SELECT field, ... WHERE] predicate AND predicate ...
+//
+//   type = DEPOSIT | WITHDRAWAL        (also !=)
+//   id | amount | balance | ts  op value          op: = != < <= > >=
+//   id | amount | balance | ts  BETWEEN a AND b   (inclusive)
+//   desc ~ "text"                      case-insensitive substring
+//   desc = "text"                      exact match (also !=)
+//
+// ts values are Unix seconds or UTC dates ("2024-01-31", "2024-01-31T09:30:00").
+// Keywords and field names are case-insensitive; SELECT * (or no SELECT)
+// returns every field. An empty query matches everything.
+
+enum QueryField : int {
+    QF_ID = 0,
+    QF_TYPE,
+    QF_AMOUNT,
+    QF_BALANCE,
+    QF_TS,
+    QF_DESC,
+    QF_COUNT
+};
+
+#define QUERY_WANT(field)   (1u << (field))
+#define QUERY_ALL_FIELDS    ((1u << QF_COUNT) - 1)
+
+// One comparison, normalized to a closed range (negate = outside it).
+// Integer fields (id, type, ts) use lo/hi; amount and balance loD/hiD.
+struct QueryPredicate {
+    QueryField field;
+    bool negate;
+    int64_t lo, hi;
+    double loD, hiD;
+    bool contains;               // desc: substring (lower-cased) vs exact
+    std::string text;
+};
+
+// A parsed query: predicates in evaluation order (cheap columns first,
+// descriptions last), the fields to return, and the id/ts bounds every
+// match must lie in, used to skip rows and segments without reading them.
+struct CompiledQuery {
+    std::vector<QueryPredicate> predicates;
+    unsigned projection;         // QUERY_WANT bits (id is always returned)
+    unsigned touched;            // fields the predicates read
+    int64_t idLo, idHi;
+    int64_t tsLo, tsHi;
+    int typeMask;                // AGG_DEPOSITS | AGG_WITHDRAWALS
+    double amountLo, amountHi;
+    bool empty;                  // contradictory bounds: nothing can match
+};
+
+// Parse text; false (and a message naming the position) on a syntax error
+bool compileQuery(const std::string& text, CompiledQuery& out, std::string& error);
+
+// Plain C layout for FFI
+struct QueryReport {
+    long long rowsScanned;       // rows the pipeline evaluated
+    long long rowsMatched;       // all matches, also those past the output capacity
+    long long segmentsSkipped;   // archived segments ruled out by their summary
+    double seconds;
+    double rowsPerSecond;        // rowsScanned / seconds
+};
+
+// Columns a scan runs over, in ID order. Columns the query doesn't touch
+// (or project) may be null. Descriptions come from the postings (hot tier)
+// or dictionary-coded (archived segments).
+struct QuerySource {
+    size_t rows;
+    const int* ids;
+    const unsigned char* kinds;
+    const double* amounts;
+    const int64_t* timestamps;
+    const double* balances;
+    Transaction* const* postings;
+    const uint32_t* descriptionIndex;
+    const std::vector<std::string>* dictionary;
+};
+
+// Batch-at-a-time execution over one source. The ID bounds narrow the row
+// range by binary search first; each batch then runs the first predicate
+// densely into a selection vector and the rest over the surviving rows only.
+class QueryScan {
+private:
+    const CompiledQuery& query;
+    const QuerySource& src;
+    size_t next;
+    size_t end;
+    size_t scanned;
+    std::vector<unsigned char> dictionaryMatch;   // per dictionary entry
+
+    size_t filter(size_t begin, size_t stop, uint32_t* sel) const;
+
+public:
+    QueryScan(const CompiledQuery& q, const QuerySource& source);
+
+    // Up to QUERY_BATCH matching row indices into sel; 0 when the scan is done
+    size_t nextBatch(uint32_t* sel);
+
+    // Copy a matching row's projected fields (the rest are zeroed)
+    void fill(uint32_t row, TransactionRecord& out) const;
+
+    size_t rowsScanned() const { return scanned; }
+};
+
+// False if the segment summary rules out every row
+bool querySegmentMayMatch(const CompiledQuery& q, const SegmentInfo& s);
+
+// SEG_WANT bits a scan of an archived segment needs to decode
+unsigned querySegmentColumns(const CompiledQuery& q);
+
+// View over decoded segment columns (those not decoded stay null)
+QuerySource segmentQuerySource(const SegmentColumns& cols);
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef RECONCILE_H
+#define RECONCILE_H
+
+#include "clock.h"
+#include "importer.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class BankLedger;
+
+// How far a statement date may be from the posting's timestamp
+#define RECONCILE_DEFAULT_WINDOW (3 * MICROS_PER_DAY)
+
+// ===== Statement reconciliation =====
+//
+// A statement row matches a ledger posting with the same type, the same
+// amount (to the cent) and the same normalized description, posted within
+// the date window either side of the statement date. Each posting matches
+// at most one row; among candidates the earliest posting wins, which pairs
+// the most rows possible when a key repeats.
+//
+// Statements use the import formats (importer.h). Rows must carry a
+// timestamp; rows without one are counted as rejected.
+
+// Plain C layout for FFI
+struct ReconcileReport {
+    long long statementRows;     // rows parsed from the statement
+    long long ledgerRows;        // postings compared against, archive included
+    long long matched;
+    long long missing;           // on the statement, not in the ledger
+    long long extra;             // in the ledger, not on the statement
+    long long rejected;          // malformed lines and rows without a date
+    double seconds;
+    double rowsPerSecond;        // (statementRows + ledgerRows) / seconds
+};
+
+// A row on one side without a partner on the other
+struct ReconcileItem {
+    long long statementRow;      // 1-based among parsed rows; 0 for ledger postings
+    int ledgerID;                // 0 for statement rows
+    unsigned char kind;
+    double amount;
+    Timestamp timestamp;
+    std::string description;     // as compared (normalized)
+};
+
+struct ReconcileResult {
+    ReconcileReport report;
+    std::vector<ReconcileItem> missing;   // by statement row
+    std::vector<ReconcileItem> extra;     // by ledger ID
+};
+
+// Lower-case ASCII letters, keep digits and non-ASCII bytes, and fold
+// every run of anything else into one space (trimmed): "ACME Corp. #42"
+// and "acme corp 42" compare equal.
+std::string normalizeDescription(const char* begin, const char* end);
+
+// Reconcile a statement held in memory on `threads` workers (0 = hardware
+// threads). The ledger isn't changed.
+void reconcileBuffer(BankLedger& ledger, const char* data, size_t length, ImportFormat format,
+                     Timestamp window, int threads, ReconcileResult& out);
+
+// Memory-map a statement file and reconcile it. False if it can't be opened.
+bool reconcileFile(BankLedger& ledger, const std::string& path, ImportFormat format,
+                   Timestamp window, int threads, ReconcileResult& out);
+
+// Write the discrepancies as CSV (status,statement_row,ledger_id,type,
+// amount,timestamp,description). False if the file can't be written.
+bool writeReconcileCsv(const std::string& path, const ReconcileResult& result);
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "clock.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Occurrences handed out per collectDue call by runDueSchedules
+#define SCHEDULE_BATCH 1024
+
+enum ScheduleRepeat : int {
+    REPEAT_ONCE = 0,           // a single future-dated posting
+    REPEAT_INTERVAL = 1,       // every `every` microseconds (e.g. 14 days)
+    REPEAT_MONTHLY = 2         // every `every` calendar months, same day (clamped to month end)
+};
+
+// What to post and when, plain C layout so it can be passed across FFI
+struct ScheduleSpec {
+    int account;               // caller's account index, handed back with each occurrence
+    int kind;                  // KIND_DEPOSIT / KIND_WITHDRAWAL
+    double amount;
+    int64_t firstDue;          // microseconds
+    int repeat;                // ScheduleRepeat
+    int64_t every;             // interval in microseconds, or months for REPEAT_MONTHLY
+    int count;                 // total occurrences, 0 = until cancelled
+};
+
+// One occurrence that came due
+struct ScheduledPosting {
+    int scheduleID;
+    int account;
+    unsigned char kind;
+    double amount;
+    Timestamp due;             // post with this timestamp, even when caught up late
+    int occurrence;            // 1 for the first
+    std::string description;
+};
+
+struct ScheduleRunReport {
+    int posted;
+    int rejected;              // the post callback refused it (e.g. insufficient funds)
+};
+
+// Future-dated and recurring postings. Pending schedules sit in a binary
+// min-heap keyed by (next due time, schedule ID): finding the next due one
+// is O(1) and advancing it O(log n), so hundreds of thousands of schedules
+// cost nothing between due times. Cancelled schedules are dropped lazily
+// when they reach the top.
+//
+// Occurrences come out in (due, schedule ID) order, so a catch-up after the
+// app was closed replays exactly what would have happened live, and runs
+// are reproducible under a fake clock.
+class PostingScheduler {
+private:
+    struct Schedule {
+        ScheduleSpec spec;
+        std::string description;
+        Timestamp nextDue;
+        int done;              // occurrences handed out
+        bool active;
+    };
+
+    struct HeapEntry {
+        Timestamp due;
+        int id;
+    };
+
+    std::vector<Schedule> schedules;   // schedule ID = index + 1
+    std::vector<HeapEntry> heap;
+    size_t activeCount;
+    LedgerClock clock;
+
+    static bool later(const HeapEntry& a, const HeapEntry& b);
+
+    // Due time of the occurrence after `done` occurrences, from the first due time
+    static Timestamp occurrenceTime(const ScheduleSpec& spec, int done);
+
+public:
+    PostingScheduler();
+
+    // Returns the schedule ID, or 0 if the spec is invalid
+    int add(const ScheduleSpec& spec, const std::string& description);
+    bool cancel(int id);
+
+    // Hand out up to `limit` occurrences due at or before `now`, oldest
+    // first, advancing their schedules. Returns how many were appended.
+    size_t collectDue(Timestamp now, std::vector<ScheduledPosting>& out, size_t limit);
+
+    // Earliest pending due time (INT64_MAX when nothing is scheduled)
+    Timestamp nextDue();
+
+    size_t size() const { return activeCount; }
+
+    // Clock used when the caller doesn't pass a time (default: coarse OS time)
+    void setClock(const LedgerClock& c) { clock = c; }
+    Timestamp now() { return clock.now(); }
+};
+
+// Post everything due by `now` through post(const ScheduledPosting&) -> bool,
+// SCHEDULE_BATCH occurrences at a time. For a BasicLedger, post live at the
+// due time, so holds, velocity limits and undo apply as for any posting:
+//
+//   runDueSchedules(scheduler, now, [&](const ScheduledPosting& p) {
+//       return ledger.postAt(p.kind, p.amount, p.description, p.due) != 0;
+//   });
+template <typename PostFn>
+ScheduleRunReport runDueSchedules(PostingScheduler& scheduler, Timestamp now, PostFn post) {
+    ScheduleRunReport report = { 0, 0 };
+    std::vector<ScheduledPosting> batch;
+    batch.reserve(SCHEDULE_BATCH);
+
+    while (scheduler.collectDue(now, batch, SCHEDULE_BATCH) > 0) {
+        for (const ScheduledPosting& p : batch) {
+            if (post(p)) report.posted++;
+            else report.rejected++;
+        }
+        batch.clear();
+    }
+    return report;
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef SEGMENT_CODEC_H
+#define SEGMENT_CODEC_H
+
+#include "transaction.h"
+#include "aggregation.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Columnar segment format for immutable runs of postings (archive, snapshots).
+//
+//   header:  "BLGS" | uint32 version | uint32 rows | uint64 firstPosition
+//   columns, in SegmentColumn order, each self-describing:
+//     ids, timestamps:   zigzag varint of the delta to the previous row
+//     kinds:             bitmap, 1 bit per row (1 = withdrawal)
+//     amounts, balances: uint8 encoding, then
+//                          RAW:     doubles
+//                          CENTS:   frame of reference (int64 base cents,
+//                                   uint8 width) + bit-packed offsets
+//                          DERIVED: first value, then balance[i] is
+//                                   balance[i-1] +/- amount[i] except for
+//                                   listed (varint row, double) exceptions
+//     descriptions:      dictionary (varint count, varint length + bytes
+//                        per entry), uint8 width, bit-packed indexes
+//   footer:  uint32 column offsets | min/max id, timestamp, amount
+//   trailer: uint32 footer offset
+//
+// Every encoding round-trips the doubles bit for bit, so decoded rows hash
+// exactly like the originals. Bit-packed runs carry 8 bytes of slack so the
+// decoder can always load a whole word.
+#define SEGMENT_MAGIC    "BLGS"
+#define SEGMENT_VERSION  2
+
+enum SegmentColumn {
+    SEG_COL_IDS = 0,
+    SEG_COL_TIMESTAMPS,
+    SEG_COL_KINDS,
+    SEG_COL_AMOUNTS,
+    SEG_COL_BALANCES,
+    SEG_COL_DESCRIPTIONS,
+    SEGMENT_COLUMN_COUNT
+};
+
+// Column selection for partial decodes
+#define SEG_WANT(col)        (1u << (col))
+#define SEG_ALL_COLUMNS      ((1u << SEGMENT_COLUMN_COUNT) - 1)
+#define SEG_SCAN_COLUMNS     (SEG_WANT(SEG_COL_TIMESTAMPS) | SEG_WANT(SEG_COL_KINDS) | \
+                              SEG_WANT(SEG_COL_AMOUNTS))
+
+// Readable without decoding any column, so whole segments can be skipped
+struct SegmentFooter {
+    uint32_t rows;
+    uint64_t firstPosition;
+    uint32_t columnOffset[SEGMENT_COLUMN_COUNT];
+    uint32_t footerOffset;                   // end of the last column
+    int minID;
+    int maxID;
+    int64_t minTimestamp;
+    int64_t maxTimestamp;
+    double minAmount;
+    double maxAmount;
+};
+
+// Decoded columns; only the requested ones are filled (balances are derived
+// from amounts and kinds, so asking for them fills those too)
+struct SegmentColumns {
+    std::vector<int> ids;
+    std::vector<int64_t> timestamps;
+    std::vector<unsigned char> kinds;
+    std::vector<double> amounts;
+    std::vector<double> balances;
+    std::vector<uint32_t> descriptions;      // index into dictionary
+    std::vector<std::string> dictionary;
+};
+
+// Encode rows [0, n) (posting order)
+std::string encodeSegment(Transaction* const* rows, size_t n, uint64_t firstPosition);
+
+// Header and footer only. False if the buffer is not a valid segment.
+bool readSegmentFooter(const char* data, size_t size, SegmentFooter& out);
+
+// Decode the columns selected by `columns` (SEG_WANT bits)
+bool decodeSegmentColumns(const char* data, size_t size, SegmentColumns& out,
+                          unsigned columns = SEG_ALL_COLUMNS);
+
+// Decode into newly allocated transactions (caller owns them)
+bool decodeSegment(const std::string& data, std::vector<Transaction*>& rows,
+                   uint64_t& firstPosition);
+
+// Aggregate straight off decoded columns (needs SEG_SCAN_COLUMNS)
+AggregateResult aggregateSegment(const SegmentColumns& cols, int typeMask,
+                                 int64_t fromTs, int64_t toTs);
+
+#endif
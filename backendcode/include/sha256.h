@@ -0,0 +1,38 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// 32-byte SHA-256 digest
+struct Digest {
+    unsigned char bytes[32];
+
+    bool operator==(const Digest& other) const;
+    bool operator!=(const Digest& other) const { return !(*this == other); }
+
+    std::string toHex() const;
+    static Digest zero();
+};
+
+// Streaming SHA-256 (FIPS 180-4)
+class Sha256 {
+private:
+    uint32_t state[8];
+    unsigned char block[64];
+    size_t blockUsed;
+    uint64_t totalBytes;
+
+    void compress(const unsigned char* chunk);
+
+public:
+    Sha256();
+
+    void update(const void* data, size_t n);
+    Digest finish();
+
+    static Digest hash(const void* data, size_t n);
+};
+
+#endif
@@ -3,20 +3,12 @@
 
 #include "transaction.h"
 
-class StackNode {
-public:
-    Transaction* data;
-    StackNode* next;
-
-    StackNode(Transaction* t) {
-        data = t;
-        next = nullptr;
-    }
-};
-
+// Bounded undo stack: a fixed ring of maxSize slots allocated up front.
+// Push, pop and discarding the oldest entry when full are all O(1).
 class Stack {
 private:
-    StackNode* top;
+    Transaction** slots;
+    int head;       // slot the next push goes into
     int count;
     int maxSize;
 
@@ -24,11 +16,22 @@ public:
     Stack(int max = 50);
     ~Stack();
 
+    // Not copyable: owns the transactions it holds
+    Stack(const Stack&) = delete;
+    Stack& operator=(const Stack&) = delete;
+
+    // Push; when full the oldest entry is discarded so the
+    // stack always holds the most recent maxSize transactions
     bool push(Transaction* t);
     Transaction* pop();
 
+    // Newest entry without removing it (nullptr when empty)
+    Transaction* peek() const {
+        return count > 0 ? slots[(head + maxSize - 1) % maxSize] : nullptr;
+    }
+
     bool isEmpty() const {
-        return top == nullptr;
+        return count == 0;
     }
 
     bool isFull() const {
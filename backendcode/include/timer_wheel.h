@@ -0,0 +1,64 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "clock.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 4 levels of 256 slots: 2^32 ticks of range (136 years at one second)
+#define WHEEL_LEVELS 4
+#define WHEEL_SLOT_BITS 8
+#define WHEEL_SLOTS (1 << WHEEL_SLOT_BITS)
+
+// Hierarchical timer wheel. Level 0 has one slot per tick; each slot of a
+// higher level covers a whole turn of the level below and is cascaded
+// (re-filed one level down) when that level wraps. Schedule and cancel are
+// O(1); advancing is O(1) per tick plus O(1) amortized per timer, however
+// many timers are pending. Timers live in a node pool linked by index, so
+// there is no allocation per timer once the pool has grown.
+class TimerWheel {
+private:
+    struct Node {
+        int64_t expiryTick;
+        int payload;
+        int prev;                  // -1 = slot head
+        int next;                  // -1 = end of slot
+        int slot;                  // level * WHEEL_SLOTS + index, -1 = free
+    };
+
+    std::vector<Node> nodes;
+    int heads[WHEEL_LEVELS * WHEEL_SLOTS];
+    int freeList;                  // chained through Node::next
+    Timestamp tickWidth;
+    int64_t currentTick;           // every timer at or before it has fired
+    size_t pending;
+
+    int64_t tickOf(Timestamp t) const;
+    void file(int n);              // put node n in the slot for its expiry
+    void unlink(int n);
+
+public:
+    // Ticks are tickWidth microseconds wide, counted from 0; nothing fires
+    // before `start`
+    explicit TimerWheel(Timestamp start, Timestamp tickWidth = MICROS_PER_SECOND);
+
+    // Fire `payload` at the first advance past expiresAt (rounded up to a
+    // tick; times already past fire on the next tick). Returns a handle.
+    int schedule(Timestamp expiresAt, int payload);
+
+    // Drop a timer that hasn't fired; the handle may be reused afterwards
+    void cancel(int handle);
+
+    // Move time forward to `now`, appending the payload of every timer that
+    // came due to `fired` (in expiry order, by tick)
+    void advance(Timestamp now, std::vector<int>& fired);
+
+    // Set the wheel's time to `start` without firing anything; only when
+    // nothing is pending (e.g. after the ledger clock was replaced)
+    void restart(Timestamp start);
+
+    size_t size() const { return pending; }
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Compile-time switch: build with BANK_LEDGER_TRACING=0 to strip all spans.
+// When compiled in, tracing is still off until setTracingEnabled(true); a
+// disabled span costs one relaxed load.
+#ifndef BANK_LEDGER_TRACING
+#define BANK_LEDGER_TRACING 1
+#endif
+
+// Events kept per thread; older spans are overwritten when a ring wraps
+#define TRACE_RING_CAPACITY (1 << 16)
+
+// One completed span. `name` must be a string literal (never copied).
+struct TraceEvent {
+    const char* name;
+    int64_t startNs;
+    int64_t durationNs;
+};
+
+extern std::atomic<bool> tracingActive;
+
+void setTracingEnabled(bool enabled);
+bool isTracingEnabled();
+
+// Drop every recorded span (rings stay allocated)
+void clearTraceBuffers();
+
+// Write all rings as Chrome trace_event JSON (open in Perfetto or
+// chrome://tracing). Call after tracing is disabled: spans recorded while
+// the file is written may be torn. Returns false if the file can't be written.
+bool writeChromeTrace(const std::string& path);
+
+// Label the calling thread in the trace (string literal)
+void setTraceThreadName(const char* name);
+
+// Times the enclosing scope into the calling thread's ring
+class TraceSpan {
+private:
+    const char* name;
+    int64_t start;
+
+public:
+    explicit TraceSpan(const char* spanName) : name(nullptr), start(0) {
+        if (tracingActive.load(std::memory_order_relaxed)) begin(spanName);
+    }
+
+    ~TraceSpan() {
+        if (name != nullptr) end();
+    }
+
+private:
+    void begin(const char* spanName);
+    void end();
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if BANK_LEDGER_TRACING
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(name)
+#else
+#define TRACE_SPAN(name) ((void)0)
+#endif
+
+#endif
@@ -1,8 +1,9 @@
 #ifndef TRANSACTION_H
 #define TRANSACTION_H
 
+#include "sha256.h"
+#include "clock.h"
 #include <string>
-#include <ctime>
 
 class Transaction {
 public:
@@ -10,11 +11,12 @@ public:
     std::string type;          // "DEPOSIT" or "WITHDRAWAL"
     double amount;
     std::string description;
-    time_t timestamp;
+    Timestamp timestamp;       // microseconds since the Unix epoch
     double balanceAfter;
+    Digest chainHash;          // Hash chained to the previous posting
 
     Transaction(int id, const std::string& type, double amount,
-                const std::string& desc, double balanceAfter);
+                const std::string& desc, double balanceAfter, Timestamp timestamp);
 
     void display() const;
 };
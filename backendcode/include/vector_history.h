@@ -0,0 +1,45 @@
+#ifndef VECTOR_HISTORY_H
+#define VECTOR_HISTORY_H
+
+#include "transaction.h"
+#include <vector>
+
+// Contiguous alternative to LinkedList with the same interface, for ledger
+// policies that favour cache locality over O(1) middle removal. Owns the
+// transactions it holds.
+class VectorHistory {
+private:
+    std::vector<Transaction*> items;
+
+public:
+    VectorHistory() {}
+    ~VectorHistory();
+
+    VectorHistory(const VectorHistory&) = delete;
+    VectorHistory& operator=(const VectorHistory&) = delete;
+
+    void insert(Transaction* t) { items.push_back(t); }
+
+    // Remove and return without deleting (nullptr if absent)
+    Transaction* removeLast();
+    Transaction* removeByID(int id);
+
+    // Delete every transaction with an ID below `id`; returns how many
+    int discardBefore(int id);
+
+    void display();
+
+    int size() const { return (int)items.size(); }
+    bool isEmpty() const { return items.empty(); }
+
+    // Stable, like the list's merge sort
+    void sortByDate();
+    void sortByAmount();
+
+    // Caller frees with delete[] (nullptr when empty)
+    Transaction** toArray();
+
+    Transaction* getAt(int index);
+};
+
+#endif
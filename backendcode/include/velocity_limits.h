@@ -0,0 +1,71 @@
+#ifndef VELOCITY_LIMITS_H
+#define VELOCITY_LIMITS_H
+
+#include "clock.h"
+#include <cstdint>
+
+#define VELOCITY_MAX_RULES 8
+
+// Buckets per window (a power of two): a window is tracked at
+// window / VELOCITY_BUCKETS resolution
+#define VELOCITY_BUCKETS 64
+
+enum VelocityMetric : int {
+    VELOCITY_AMOUNT = 0,       // sum withdrawn within the window
+    VELOCITY_COUNT = 1         // number of withdrawals within the window
+};
+
+// "at most `limit` (amount or count) of withdrawals per `window`",
+// plain C layout so rules can be passed across FFI
+struct VelocityRule {
+    int metric;                // VelocityMetric
+    double limit;
+    int64_t window;            // microseconds
+};
+
+// Sliding-window withdrawal limits. Each rule keeps a ring of time buckets
+// and a running total of the live ones, so checking and recording a
+// withdrawal is O(1) per rule; buckets that slid out of the window are
+// subtracted as time moves on. The window is tracked at bucket resolution
+// and errs on the strict side: a withdrawal counts for up to one bucket
+// width longer than the window. Amounts are kept in integer cents, so
+// adding and reverting never drifts.
+class VelocityLimits {
+private:
+    struct Window {
+        VelocityRule rule;
+        int64_t limitUnits;
+        int64_t bucketWidth;
+        int64_t epochs[VELOCITY_BUCKETS];   // which bucket index each slot holds
+        int64_t units[VELOCITY_BUCKETS];
+        int64_t total;
+        int64_t newestEpoch;                // slots older than this - BUCKETS are stale
+        Timestamp newestStart;              // where bucket newestEpoch begins
+    };
+
+    Window windows[VELOCITY_MAX_RULES];
+    int ruleCount;
+
+    static int64_t cents(double amount);
+    static int64_t epochOf(const Window& w, Timestamp t);
+    static void slide(Window& w, int64_t epoch);
+
+public:
+    VelocityLimits();
+
+    // Replace the rules (at most VELOCITY_MAX_RULES; invalid ones are
+    // skipped) and forget all counts. Returns how many rules are active.
+    int setRules(const VelocityRule* rules, int n);
+    int getRules(VelocityRule* out) const;
+    bool active() const { return ruleCount > 0; }
+
+    // Index of the first rule a withdrawal of `amount` at `now` would
+    // break, or -1 if it fits every rule
+    int check(Timestamp now, double amount);
+
+    // Count a withdrawal (after it was posted); revert takes it back (undo)
+    void record(Timestamp t, double amount);
+    void revert(Timestamp t, double amount);
+};
+
+#endif
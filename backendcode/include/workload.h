@@ -0,0 +1,109 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class BankLedger;
+
+// Operations a trace can contain (stored as these letters in trace files)
+enum TraceOpKind : char {
+    TRACE_DEPOSIT = 'D',
+    TRACE_WITHDRAW = 'W',
+    TRACE_UNDO = 'U',
+    TRACE_SEARCH = 'S',       // arg = transaction ID
+    TRACE_AGGREGATE = 'A',    // arg = AGG_* type mask
+    TRACE_BALANCE = 'B'
+};
+
+// One recorded operation. arrivalNs is relative to the start of the trace.
+struct TraceOp {
+    int64_t arrivalNs;
+    char kind;
+    double amount;
+    int arg;
+    std::string description;
+};
+
+// Knobs for the synthetic workload. The same config + seed always produces
+// the same trace, on every platform (no std:: distributions are used).
+struct WorkloadConfig {
+    uint64_t seed;
+    long long operations;
+
+    // Relative weights of the operation mix
+    double depositWeight;
+    double withdrawWeight;
+    double undoWeight;
+    double queryWeight;       // split between balance, aggregate and search
+
+    // Amounts are log-normal: exp(N(amountMu, amountSigma)), rounded to cents
+    double amountMu;
+    double amountSigma;
+
+    // Fraction of withdrawals deliberately larger than the balance
+    double overdraftRate;
+
+    // Descriptions are drawn from `vocabularySize` strings with Zipf(zipfExponent)
+    int vocabularySize;
+    double zipfExponent;
+
+    // Arrivals: Poisson at ratePerSecond, switching to a burst state in which
+    // the rate is multiplied by burstFactor (mean burst length in operations)
+    double ratePerSecond;
+    double burstFactor;
+    double burstProbability;  // chance per operation of entering a burst
+    double meanBurstLength;
+
+    double initialBalance;
+
+    WorkloadConfig();
+};
+
+// Header line of a trace file; replays need the same starting balance
+struct TraceHeader {
+    uint64_t seed;
+    double initialBalance;
+};
+
+// Plain C layout, like ImportReport
+struct ReplayReport {
+    long long operations;
+    long long postings;       // Deposits + withdrawals that were applied
+    long long rejected;       // Withdrawals refused (insufficient funds) and empty undos
+    long long undos;
+    long long queries;
+    double seconds;
+    double opsPerSecond;
+    double finalBalance;
+};
+
+// Small deterministic PRNG (xoshiro256**, seeded with splitmix64)
+class WorkloadRandom {
+private:
+    uint64_t s[4];
+
+public:
+    explicit WorkloadRandom(uint64_t seed);
+
+    uint64_t next();
+    double uniform();                     // [0, 1)
+    double exponential(double mean);
+    double normal();                      // N(0, 1)
+};
+
+// Generate a trace from the config
+void generateWorkload(const WorkloadConfig& config, std::vector<TraceOp>& ops);
+
+// Text trace files: "# bank_ledger trace v1 seed=.. balance=.." then one
+// "<arrivalNs> <kind> <amount> <arg> <description>" line per operation
+bool writeTrace(const std::string& path, const TraceHeader& header,
+                const std::vector<TraceOp>& ops);
+bool readTrace(const std::string& path, TraceHeader& header, std::vector<TraceOp>& ops);
+
+// Run a trace against a ledger. With `paced`, each operation waits for its
+// arrival time; otherwise operations run back to back.
+ReplayReport replayTrace(BankLedger& ledger, const std::vector<TraceOp>& ops, bool paced);
+
+#endif
@@ -1,18 +1,19 @@
 #include "include/bank_ledger.h"
+#include "include/exporter.h"
 #include <iostream>
 #include <iomanip>
 #include <limits>
-#include <chrono>
-#include <vector>
+#include <ctime>
 
 using namespace std;
-using namespace std::chrono;
+
+// Query results printed by the console (the count covers all matches)
+#define QUERY_SHOWN 20
 
 // -------------------- Function Prototypes --------------------
 void displayMenu();
 void pause();
 void runCorrectnessTests();
-void runPerformanceAnalysis();
 
 // -------------------- MAIN --------------------
 int main() {
@@ -23,7 +24,7 @@ int main() {
 
     cout << "1. Run Interactive Bank Ledger\n";
     cout << "2. Run Correctness Test Cases\n";
-    cout << "3. Run Performance Analysis (Big-O)\n";
+    cout << "3. Performance Analysis (see bank_ledger_bench)\n";
     cout << "Enter choice: ";
 
     int mode;
@@ -35,7 +36,8 @@ int main() {
     }
 
     if (mode == 3) {
-        runPerformanceAnalysis();
+        cout << "\nPerformance analysis moved to the bank_ledger_bench tool:\n";
+        cout << "  bank_ledger_bench --max-n 1e6 --json results.json\n";
         return 0;
     }
 
@@ -50,10 +52,19 @@ int main() {
     double amount;
     string description;
     int searchID;
+    int holdID;
+    long long minutes;
+    int format;
+    string path;
+    string queryText;
+    CompiledQuery query;
+    QueryReport report;
+    TransactionRecord rows[QUERY_SHOWN];
+    int shown;
 
     while (true) {
         displayMenu();
-        cout << "\nEnter your choice (1-9): ";
+        cout << "\nEnter your choice (1-16): ";
         cin >> choice;
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
 
@@ -108,6 +119,90 @@ int main() {
                 cout << "Exiting...\n";
                 return 0;
 
+            case 10: {
+                cout << "Format (0 = CSV, 1 = JSON lines, 2 = binary): ";
+                cin >> format;
+                cin.ignore();
+                cout << "Output file: ";
+                getline(cin, path);
+                long long rows = exportToFile(*ledger.getTransactionList(), path, (ExportFormat)format);
+                if (rows < 0) cout << "Error: Export failed.\n";
+                else cout << "Exported " << rows << " transactions to " << path << "\n";
+                break;
+            }
+
+            case 11:
+                ledger.showMetrics();
+                break;
+
+            case 12: {
+                long long when;
+                cout << "Unix time (or -N for N seconds ago): ";
+                cin >> when;
+                cin.ignore();
+                if (when <= 0) when += (long long)time(nullptr);
+                // Everything up to the end of that second
+                ledger.showLedgerAt(secondsToTimestamp(when + 1) - 1);
+                break;
+            }
+
+            case 13:
+                cout << "Enter amount to hold: $";
+                cin >> amount;
+                cout << "Valid for how many minutes: ";
+                cin >> minutes;
+                cin.ignore();
+                cout << "Enter description: ";
+                getline(cin, description);
+                holdID = ledger.placeHold(amount, description,
+                                          LedgerClock::coarseNow() + minutes * 60 * MICROS_PER_SECOND);
+                if (holdID == 0) cout << "Error: Insufficient available balance!\n";
+                else cout << "Hold #" << holdID << " placed.\n";
+                break;
+
+            case 14:
+                cout << "Enter hold ID: ";
+                cin >> holdID;
+                cout << "Amount to withdraw (0 = full hold): $";
+                cin >> amount;
+                cin.ignore();
+                if (ledger.settleHold(holdID, amount)) cout << "Hold settled.\n";
+                else cout << "Error: Hold is not active or amount exceeds it.\n";
+                break;
+
+            case 15:
+                cout << "Enter hold ID: ";
+                cin >> holdID;
+                cin.ignore();
+                if (ledger.releaseHold(holdID)) cout << "Hold released.\n";
+                else cout << "Error: Hold is not active.\n";
+                break;
+
+            case 16:
+                cout << "Query (e.g. type = WITHDRAWAL AND amount > 100 AND desc ~ \"rent\"):\n> ";
+                getline(cin, queryText);
+                if (!compileQuery(queryText, query, description)) {
+                    cout << "Error: " << description << "\n";
+                    break;
+                }
+                shown = ledger.runQuery(query, rows, QUERY_SHOWN, report);
+                if (shown < 0) {
+                    cout << "Error: Cannot read archived history.\n";
+                    break;
+                }
+                for (int i = 0; i < shown; i++) {
+                    cout << "ID: " << rows[i].id << " | "
+                         << (rows[i].kind == KIND_WITHDRAWAL ? "WITHDRAWAL" : "DEPOSIT") << " | $"
+                         << fixed << setprecision(2) << rows[i].amount << " | Balance: $"
+                         << rows[i].balanceAfter << " | " << rows[i].description << "\n";
+                }
+                cout << report.rowsMatched << " matches";
+                if (report.rowsMatched > shown) cout << " (first " << shown << " shown)";
+                cout << " | " << report.rowsScanned << " rows scanned in " << setprecision(3)
+                     << report.seconds * 1000.0 << " ms (" << setprecision(0) << report.rowsPerSecond
+                     << " rows/sec)\n";
+                break;
+
             default:
                 cout << "Invalid choice!\n";
         }
@@ -139,61 +234,13 @@ void runCorrectnessTests() {
     cout << "\nAll test cases executed successfully.\n";
 }
 
-// -------------------- PERFORMANCE ANALYSIS --------------------
-void runPerformanceAnalysis() {
-    cout << "\n===== PERFORMANCE ANALYSIS =====\n";
-    vector<int> sizes = {1000, 10000, 100000};
-
-    cout << left << setw(10) << "N"
-         << setw(20) << "Insert (ms)"
-         << setw(20) << "Sort (ms)"
-         << setw(20) << "Search (ms)" << endl;
-
-    for (int N : sizes) {
-        double insertTime = 0, sortTime = 0, searchTime = 0;
-
-        for (int run = 0; run < 3; run++) {
-            BankLedger ledger(0);
-
-            // -------- Insert --------
-            auto start = high_resolution_clock::now();
-            for (int i = 1; i <= N; i++) {
-                ledger.deposit(i * 10, "Auto");
-            }
-            auto end = high_resolution_clock::now();
-            insertTime += duration<double, milli>(end - start).count();
-
-            // -------- Sort --------
-            start = high_resolution_clock::now();
-            ledger.sortByAmount();   // Merge Sort
-            end = high_resolution_clock::now();
-            sortTime += duration<double, milli>(end - start).count();
-
-            // -------- Search --------
-            start = high_resolution_clock::now();
-            ledger.searchByID(N / 2); // Binary Search
-            end = high_resolution_clock::now();
-            searchTime += duration<double, milli>(end - start).count();
-        }
-
-        cout << setw(10) << N
-             << setw(20) << insertTime / 3
-             << setw(20) << sortTime / 3
-             << setw(20) << searchTime / 3 << endl;
-    }
-
-    cout << "\nBig-O Summary:\n";
-    cout << "Insertion (Linked List): O(1)\n";
-    cout << "Undo (Stack): O(1)\n";
-    cout << "Sorting (Merge Sort): O(n log n)\n";
-    cout << "Searching (Binary Search): O(log n)\n";
-}
-
 // -------------------- UTILITIES --------------------
 void displayMenu() {
     cout << "\n1. Add Deposit\n2. Add Withdrawal\n3. View History\n4. Balance\n";
     cout << "5. Undo\n6. Sort by Date\n7. Sort by Amount\n";
-    cout << "8. Search by ID\n9. Exit\n";
+    cout << "8. Search by ID\n9. Exit\n10. Export Statement\n11. Show Metrics\n";
+    cout << "12. Ledger As Of Time\n13. Place Hold\n14. Settle Hold\n15. Release Hold\n";
+    cout << "16. Query History\n";
 }
 
 void pause() {
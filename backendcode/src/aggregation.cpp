@@ -0,0 +1,349 @@
+#include "../include/aggregation.h"
+#include <limits>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AGG_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#define TARGET_SSE42
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+#endif
+
+// Running totals shared by all kernels
+struct Partial {
+    double sumDeposits;
+    double sumWithdrawals;
+    int64_t depositCount;
+    int64_t withdrawalCount;
+    double minAmount;
+    double maxAmount;
+};
+
+static Partial emptyPartial() {
+    Partial p;
+    p.sumDeposits = 0.0;
+    p.sumWithdrawals = 0.0;
+    p.depositCount = 0;
+    p.withdrawalCount = 0;
+    p.minAmount = std::numeric_limits<double>::infinity();
+    p.maxAmount = -std::numeric_limits<double>::infinity();
+    return p;
+}
+
+static AggregateResult finish(const Partial& p) {
+    AggregateResult r;
+    r.totalDeposits = p.sumDeposits;
+    r.totalWithdrawals = p.sumWithdrawals;
+    r.depositCount = (int)p.depositCount;
+    r.withdrawalCount = (int)p.withdrawalCount;
+
+    int64_t n = p.depositCount + p.withdrawalCount;
+    if (n == 0) {
+        r.minAmount = r.maxAmount = r.avgAmount = 0.0;
+    } else {
+        r.minAmount = p.minAmount;
+        r.maxAmount = p.maxAmount;
+        r.avgAmount = (p.sumDeposits + p.sumWithdrawals) / (double)n;
+    }
+    return r;
+}
+
+// ===== Scalar kernel =====
+
+static void scalarRange(const TransactionColumns& cols, size_t begin, size_t end,
+                        int typeMask, int64_t fromTs, int64_t toTs, Partial& p) {
+    const unsigned char* kinds = cols.kindData();
+    const double* amounts = cols.amountData();
+    const int64_t* ts = cols.timestampData();
+
+    bool wantDeposits = (typeMask & AGG_DEPOSITS) != 0;
+    bool wantWithdrawals = (typeMask & AGG_WITHDRAWALS) != 0;
+
+    for (size_t i = begin; i < end; i++) {
+        if (ts[i] < fromTs || ts[i] > toTs) continue;
+
+        double a = amounts[i];
+        if (kinds[i] == KIND_WITHDRAWAL) {
+            if (!wantWithdrawals) continue;
+            p.sumWithdrawals += a;
+            p.withdrawalCount++;
+        } else {
+            if (!wantDeposits) continue;
+            p.sumDeposits += a;
+            p.depositCount++;
+        }
+        if (a < p.minAmount) p.minAmount = a;
+        if (a > p.maxAmount) p.maxAmount = a;
+    }
+}
+
+#ifdef AGG_X86
+
+// ===== AVX2 kernel: 4 rows per iteration =====
+
+TARGET_AVX2
+static void avx2Range(const TransactionColumns& cols, int typeMask,
+                      int64_t fromTs, int64_t toTs, Partial& p) {
+    const unsigned char* kinds = cols.kindData();
+    const double* amounts = cols.amountData();
+    const int64_t* ts = cols.timestampData();
+    size_t n = cols.size();
+    size_t vecEnd = n - (n % 4);
+
+    const __m256i from = _mm256_set1_epi64x(fromTs);
+    const __m256i to = _mm256_set1_epi64x(toTs);
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    const __m256i withdrawalKind = _mm256_set1_epi64x(KIND_WITHDRAWAL);
+    const __m256i depAllowed = (typeMask & AGG_DEPOSITS) ? ones : _mm256_setzero_si256();
+    const __m256i wdAllowed = (typeMask & AGG_WITHDRAWALS) ? ones : _mm256_setzero_si256();
+    const __m256d posInf = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    const __m256d negInf = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+
+    __m256d sumDep = _mm256_setzero_pd();
+    __m256d sumWd = _mm256_setzero_pd();
+    __m256i cntDep = _mm256_setzero_si256();
+    __m256i cntWd = _mm256_setzero_si256();
+    __m256d vmin = posInf;
+    __m256d vmax = negInf;
+
+    for (size_t i = 0; i < vecEnd; i += 4) {
+        __m256i t = _mm256_loadu_si256((const __m256i*)(ts + i));
+        __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi64(from, t), _mm256_cmpgt_epi64(t, to));
+
+        int packedKinds;
+        std::memcpy(&packedKinds, kinds + i, sizeof(int));
+        __m256i k = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(packedKinds));
+        __m256i isWd = _mm256_cmpeq_epi64(k, withdrawalKind);
+
+        __m256i dep = _mm256_andnot_si256(outside, _mm256_andnot_si256(isWd, depAllowed));
+        __m256i wd = _mm256_andnot_si256(outside, _mm256_and_si256(isWd, wdAllowed));
+        __m256d depMask = _mm256_castsi256_pd(dep);
+        __m256d wdMask = _mm256_castsi256_pd(wd);
+        __m256d anyMask = _mm256_or_pd(depMask, wdMask);
+
+        __m256d a = _mm256_loadu_pd(amounts + i);
+        sumDep = _mm256_add_pd(sumDep, _mm256_and_pd(a, depMask));
+        sumWd = _mm256_add_pd(sumWd, _mm256_and_pd(a, wdMask));
+        cntDep = _mm256_sub_epi64(cntDep, dep);   // mask lanes are -1
+        cntWd = _mm256_sub_epi64(cntWd, wd);
+        vmin = _mm256_min_pd(vmin, _mm256_blendv_pd(posInf, a, anyMask));
+        vmax = _mm256_max_pd(vmax, _mm256_blendv_pd(negInf, a, anyMask));
+    }
+
+    alignas(32) double d[4];
+    alignas(32) int64_t c[4];
+
+    _mm256_store_pd(d, sumDep);
+    p.sumDeposits += d[0] + d[1] + d[2] + d[3];
+    _mm256_store_pd(d, sumWd);
+    p.sumWithdrawals += d[0] + d[1] + d[2] + d[3];
+    _mm256_store_si256((__m256i*)c, cntDep);
+    p.depositCount += c[0] + c[1] + c[2] + c[3];
+    _mm256_store_si256((__m256i*)c, cntWd);
+    p.withdrawalCount += c[0] + c[1] + c[2] + c[3];
+    _mm256_store_pd(d, vmin);
+    p.minAmount = std::min(p.minAmount, std::min(std::min(d[0], d[1]), std::min(d[2], d[3])));
+    _mm256_store_pd(d, vmax);
+    p.maxAmount = std::max(p.maxAmount, std::max(std::max(d[0], d[1]), std::max(d[2], d[3])));
+
+    scalarRange(cols, vecEnd, n, typeMask, fromTs, toTs, p);
+}
+
+// ===== SSE4.2 kernel: 2 rows per iteration =====
+
+TARGET_SSE42
+static void sse42Range(const TransactionColumns& cols, int typeMask,
+                       int64_t fromTs, int64_t toTs, Partial& p) {
+    const unsigned char* kinds = cols.kindData();
+    const double* amounts = cols.amountData();
+    const int64_t* ts = cols.timestampData();
+    size_t n = cols.size();
+    size_t vecEnd = n - (n % 2);
+
+    const __m128i from = _mm_set1_epi64x(fromTs);
+    const __m128i to = _mm_set1_epi64x(toTs);
+    const __m128i ones = _mm_set1_epi64x(-1);
+    const __m128i withdrawalKind = _mm_set1_epi64x(KIND_WITHDRAWAL);
+    const __m128i depAllowed = (typeMask & AGG_DEPOSITS) ? ones : _mm_setzero_si128();
+    const __m128i wdAllowed = (typeMask & AGG_WITHDRAWALS) ? ones : _mm_setzero_si128();
+    const __m128d posInf = _mm_set1_pd(std::numeric_limits<double>::infinity());
+    const __m128d negInf = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+
+    __m128d sumDep = _mm_setzero_pd();
+    __m128d sumWd = _mm_setzero_pd();
+    __m128i cntDep = _mm_setzero_si128();
+    __m128i cntWd = _mm_setzero_si128();
+    __m128d vmin = posInf;
+    __m128d vmax = negInf;
+
+    for (size_t i = 0; i < vecEnd; i += 2) {
+        __m128i t = _mm_loadu_si128((const __m128i*)(ts + i));
+        __m128i outside = _mm_or_si128(_mm_cmpgt_epi64(from, t), _mm_cmpgt_epi64(t, to));
+
+        short packedKinds;
+        std::memcpy(&packedKinds, kinds + i, sizeof(short));
+        __m128i k = _mm_cvtepu8_epi64(_mm_cvtsi32_si128((unsigned short)packedKinds));
+        __m128i isWd = _mm_cmpeq_epi64(k, withdrawalKind);
+
+        __m128i dep = _mm_andnot_si128(outside, _mm_andnot_si128(isWd, depAllowed));
+        __m128i wd = _mm_andnot_si128(outside, _mm_and_si128(isWd, wdAllowed));
+        __m128d depMask = _mm_castsi128_pd(dep);
+        __m128d wdMask = _mm_castsi128_pd(wd);
+        __m128d anyMask = _mm_or_pd(depMask, wdMask);
+
+        __m128d a = _mm_loadu_pd(amounts + i);
+        sumDep = _mm_add_pd(sumDep, _mm_and_pd(a, depMask));
+        sumWd = _mm_add_pd(sumWd, _mm_and_pd(a, wdMask));
+        cntDep = _mm_sub_epi64(cntDep, dep);
+        cntWd = _mm_sub_epi64(cntWd, wd);
+        vmin = _mm_min_pd(vmin, _mm_blendv_pd(posInf, a, anyMask));
+        vmax = _mm_max_pd(vmax, _mm_blendv_pd(negInf, a, anyMask));
+    }
+
+    alignas(16) double d[2];
+    alignas(16) int64_t c[2];
+
+    _mm_store_pd(d, sumDep);
+    p.sumDeposits += d[0] + d[1];
+    _mm_store_pd(d, sumWd);
+    p.sumWithdrawals += d[0] + d[1];
+    _mm_store_si128((__m128i*)c, cntDep);
+    p.depositCount += c[0] + c[1];
+    _mm_store_si128((__m128i*)c, cntWd);
+    p.withdrawalCount += c[0] + c[1];
+    _mm_store_pd(d, vmin);
+    p.minAmount = std::min(p.minAmount, std::min(d[0], d[1]));
+    _mm_store_pd(d, vmax);
+    p.maxAmount = std::max(p.maxAmount, std::max(d[0], d[1]));
+
+    scalarRange(cols, vecEnd, n, typeMask, fromTs, toTs, p);
+}
+
+#endif
+
+// ===== Runtime dispatch =====
+
+AggregationKernel detectAggregationKernel() {
+#ifdef AGG_X86
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    bool sse42 = (info[2] & (1 << 20)) != 0;
+
+    if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+        __cpuidex(info, 7, 0);
+        if (info[1] & (1 << 5)) return KERNEL_AVX2;
+    }
+    if (sse42) return KERNEL_SSE42;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return KERNEL_AVX2;
+    if (__builtin_cpu_supports("sse4.2")) return KERNEL_SSE42;
+#endif
+#endif
+    return KERNEL_SCALAR;
+}
+
+const char* aggregationKernelName(AggregationKernel kernel) {
+    switch (kernel) {
+        case KERNEL_AVX2: return "AVX2";
+        case KERNEL_SSE42: return "SSE4.2";
+        default: return "Scalar";
+    }
+}
+
+AggregateResult aggregateWithKernel(const TransactionColumns& cols, int typeMask,
+                                    int64_t fromTs, int64_t toTs, AggregationKernel kernel) {
+    Partial p = emptyPartial();
+
+    // CPU features don't change at runtime, detect once
+    static const AggregationKernel supported = detectAggregationKernel();
+    if (kernel > supported) kernel = supported;
+
+#ifdef AGG_X86
+    if (kernel == KERNEL_AVX2) {
+        avx2Range(cols, typeMask, fromTs, toTs, p);
+        return finish(p);
+    }
+    if (kernel == KERNEL_SSE42) {
+        sse42Range(cols, typeMask, fromTs, toTs, p);
+        return finish(p);
+    }
+#endif
+
+    scalarRange(cols, 0, cols.size(), typeMask, fromTs, toTs, p);
+    return finish(p);
+}
+
+AggregateResult aggregateTransactions(const TransactionColumns& cols, int typeMask,
+                                      int64_t fromTs, int64_t toTs) {
+    return aggregateWithKernel(cols, typeMask, fromTs, toTs, KERNEL_AVX2);
+}
+
+static inline void accumulatePosting(Partial& p, const Transaction* t, int typeMask,
+                                     int64_t fromTs, int64_t toTs) {
+    if ((int64_t)t->timestamp < fromTs || (int64_t)t->timestamp > toTs) return;
+
+    bool isWithdrawal = (t->type == "WITHDRAWAL");
+    if (isWithdrawal) {
+        if (!(typeMask & AGG_WITHDRAWALS)) return;
+        p.sumWithdrawals += t->amount;
+        p.withdrawalCount++;
+    } else {
+        if (!(typeMask & AGG_DEPOSITS)) return;
+        p.sumDeposits += t->amount;
+        p.depositCount++;
+    }
+    if (t->amount < p.minAmount) p.minAmount = t->amount;
+    if (t->amount > p.maxAmount) p.maxAmount = t->amount;
+}
+
+AggregateResult aggregateListScalar(LinkedList& list, int typeMask,
+                                    int64_t fromTs, int64_t toTs) {
+    Partial p = emptyPartial();
+
+    for (Node* current = list.getHead(); current != nullptr; current = current->next) {
+        accumulatePosting(p, current->data, typeMask, fromTs, toTs);
+    }
+
+    return finish(p);
+}
+
+AggregateResult aggregateArrayScalar(Transaction* const* items, int n, int typeMask,
+                                     int64_t fromTs, int64_t toTs) {
+    Partial p = emptyPartial();
+
+    for (int i = 0; i < n; i++) {
+        accumulatePosting(p, items[i], typeMask, fromTs, toTs);
+    }
+
+    return finish(p);
+}
+
+AggregateResult combineAggregates(const AggregateResult& a, const AggregateResult& b) {
+    int na = a.depositCount + a.withdrawalCount;
+    int nb = b.depositCount + b.withdrawalCount;
+    if (na == 0) return b;
+    if (nb == 0) return a;
+
+    Partial p;
+    p.sumDeposits = a.totalDeposits + b.totalDeposits;
+    p.sumWithdrawals = a.totalWithdrawals + b.totalWithdrawals;
+    p.depositCount = (int64_t)a.depositCount + b.depositCount;
+    p.withdrawalCount = (int64_t)a.withdrawalCount + b.withdrawalCount;
+    p.minAmount = std::min(a.minAmount, b.minAmount);
+    p.maxAmount = std::max(a.maxAmount, b.maxAmount);
+    return finish(p);
+}
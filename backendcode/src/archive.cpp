@@ -0,0 +1,196 @@
+#include "../include/archive.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+// ===== Archive =====
+
+HistoryArchive::HistoryArchive(const std::string& directory, int cacheSegments) {
+    this->directory = directory;
+    cacheLimit = cacheSegments < 1 ? 1 : (size_t)cacheSegments;
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    usable = std::filesystem::is_directory(directory, ec);
+}
+
+HistoryArchive::~HistoryArchive() {
+    while (!cache.empty()) evict(cache.begin());
+
+    for (const SegmentInfo& s : segments) {
+        std::remove(s.path.c_str());
+    }
+}
+
+void HistoryArchive::evict(std::list<LoadedSegment>::iterator it) {
+    for (Transaction* t : it->rows) delete t;
+    cache.erase(it);
+}
+
+bool HistoryArchive::append(Transaction* const* rows, size_t n, uint64_t firstPosition) {
+    if (!usable || n == 0) return false;
+
+    char name[32];
+    snprintf(name, sizeof(name), "segment_%06zu.blgs", segments.size());
+    std::string path = (std::filesystem::path(directory) / name).string();
+
+    std::string data = encodeSegment(rows, n, firstPosition);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), (std::streamsize)data.size());
+    out.close();
+    if (!out) {
+        std::remove(path.c_str());
+        return false;
+    }
+
+    SegmentInfo info;
+    info.path = path;
+    info.firstPosition = firstPosition;
+    info.rows = (uint32_t)n;
+    info.bytes = data.size();
+    info.firstID = rows[0]->id;
+    info.lastID = rows[n - 1]->id;
+    info.minTimestamp = std::numeric_limits<int64_t>::max();
+    info.maxTimestamp = std::numeric_limits<int64_t>::min();
+    info.depositTotal = info.withdrawalTotal = 0.0;
+    info.depositCount = info.withdrawalCount = 0;
+    info.minDeposit = info.minWithdrawal = std::numeric_limits<double>::infinity();
+    info.maxDeposit = info.maxWithdrawal = -std::numeric_limits<double>::infinity();
+
+    for (size_t i = 0; i < n; i++) {
+        const Transaction* t = rows[i];
+        int64_t ts = (int64_t)t->timestamp;
+        info.minTimestamp = std::min(info.minTimestamp, ts);
+        info.maxTimestamp = std::max(info.maxTimestamp, ts);
+
+        if (t->type == "WITHDRAWAL") {
+            info.withdrawalTotal += t->amount;
+            info.withdrawalCount++;
+            info.minWithdrawal = std::min(info.minWithdrawal, t->amount);
+            info.maxWithdrawal = std::max(info.maxWithdrawal, t->amount);
+        } else {
+            info.depositTotal += t->amount;
+            info.depositCount++;
+            info.minDeposit = std::min(info.minDeposit, t->amount);
+            info.maxDeposit = std::max(info.maxDeposit, t->amount);
+        }
+    }
+
+    segments.push_back(info);
+    return true;
+}
+
+const std::vector<Transaction*>* HistoryArchive::load(size_t index) {
+    if (index >= segments.size()) return nullptr;
+
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+        if (it->index == index) {
+            cache.splice(cache.begin(), cache, it);
+            return &cache.front().rows;
+        }
+    }
+
+    std::string data;
+    if (!readFile(index, data)) return nullptr;
+
+    LoadedSegment loaded;
+    loaded.index = index;
+    uint64_t firstPosition;
+    if (!decodeSegment(data, loaded.rows, firstPosition) ||
+        firstPosition != segments[index].firstPosition) {
+        for (Transaction* t : loaded.rows) delete t;
+        return nullptr;
+    }
+
+    while (cache.size() >= cacheLimit) evict(std::prev(cache.end()));
+    cache.push_front(std::move(loaded));
+    return &cache.front().rows;
+}
+
+bool HistoryArchive::readFile(size_t index, std::string& data) const {
+    std::ifstream in(segments[index].path, std::ios::binary);
+    if (!in) return false;
+
+    data.assign((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return in.good() || in.eof();
+}
+
+size_t HistoryArchive::segmentFor(int id) const {
+    // Segments hold ascending, disjoint ID ranges
+    auto seg = std::lower_bound(segments.begin(), segments.end(), id,
+                                [](const SegmentInfo& s, int v) { return s.lastID < v; });
+    return (size_t)(seg - segments.begin());
+}
+
+Transaction* HistoryArchive::find(int id) {
+    size_t index = segmentFor(id);
+    if (index == segments.size() || segments[index].firstID > id) return nullptr;
+
+    const std::vector<Transaction*>* rows = load(index);
+    if (!rows) return nullptr;
+
+    auto it = std::lower_bound(rows->begin(), rows->end(), id,
+                               [](const Transaction* t, int v) { return t->id < v; });
+    return (it != rows->end() && (*it)->id == id) ? *it : nullptr;
+}
+
+static AggregateResult summaryResult(const SegmentInfo& s, int typeMask) {
+    AggregateResult r;
+    bool deposits = (typeMask & AGG_DEPOSITS) && s.depositCount > 0;
+    bool withdrawals = (typeMask & AGG_WITHDRAWALS) && s.withdrawalCount > 0;
+
+    r.totalDeposits = deposits ? s.depositTotal : 0.0;
+    r.totalWithdrawals = withdrawals ? s.withdrawalTotal : 0.0;
+    r.depositCount = deposits ? (int)s.depositCount : 0;
+    r.withdrawalCount = withdrawals ? (int)s.withdrawalCount : 0;
+
+    int n = r.depositCount + r.withdrawalCount;
+    if (n == 0) {
+        r.minAmount = r.maxAmount = r.avgAmount = 0.0;
+        return r;
+    }
+    r.minAmount = std::min(deposits ? s.minDeposit : s.minWithdrawal,
+                           withdrawals ? s.minWithdrawal : s.minDeposit);
+    r.maxAmount = std::max(deposits ? s.maxDeposit : s.maxWithdrawal,
+                           withdrawals ? s.maxWithdrawal : s.maxDeposit);
+    r.avgAmount = (r.totalDeposits + r.totalWithdrawals) / n;
+    return r;
+}
+
+bool HistoryArchive::aggregate(int typeMask, int64_t fromTs, int64_t toTs, AggregateResult& out) const {
+    out = aggregateArrayScalar(nullptr, 0, typeMask, fromTs, toTs);
+
+    for (size_t i = 0; i < segments.size(); i++) {
+        const SegmentInfo& s = segments[i];
+        if (s.maxTimestamp < fromTs || s.minTimestamp > toTs) continue;
+
+        if (s.minTimestamp >= fromTs && s.maxTimestamp <= toTs) {
+            out = combineAggregates(out, summaryResult(s, typeMask));
+            continue;
+        }
+
+        SegmentColumns cols;
+        if (!decodeColumns(i, SEG_SCAN_COLUMNS, cols)) return false;
+        out = combineAggregates(out, aggregateSegment(cols, typeMask, fromTs, toTs));
+    }
+    return true;
+}
+
+bool HistoryArchive::decodeColumns(size_t index, unsigned columns, SegmentColumns& out) const {
+    std::string data;
+    return readFile(index, data) && decodeSegmentColumns(data.data(), data.size(), out, columns);
+}
+
+uint64_t HistoryArchive::rowCount() const {
+    uint64_t n = 0;
+    for (const SegmentInfo& s : segments) n += s.rows;
+    return n;
+}
+
+uint64_t HistoryArchive::byteCount() const {
+    uint64_t n = 0;
+    for (const SegmentInfo& s : segments) n += s.bytes;
+    return n;
+}
@@ -0,0 +1,124 @@
+#include "../include/async_executor.h"
+#include <chrono>
+#include <cstring>
+
+AsyncExecutor::AsyncExecutor(int threads) {
+    nextRequestId = 1;
+    stopping = false;
+    postFn = nullptr;
+    port = 0;
+
+    if (threads < 1) threads = 1;
+    for (int i = 0; i < threads; i++) {
+        workers.emplace_back(&AsyncExecutor::workerLoop, this);
+    }
+}
+
+AsyncExecutor::~AsyncExecutor() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    jobReady.notify_all();
+
+    // Workers finish the queue before exiting
+    for (std::thread& w : workers) w.join();
+}
+
+long long AsyncExecutor::submit(void* owner, std::function<AsyncResult()> work) {
+    long long id;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        id = nextRequestId++;
+        jobs.push_back(Job{ id, owner, std::move(work) });
+        pending[owner]++;
+        inFlight.insert(id);
+    }
+    jobReady.notify_one();
+    return id;
+}
+
+void AsyncExecutor::setCompletionPort(int64_t port, PostCObjectFn postFn) {
+    std::lock_guard<std::mutex> guard(lock);
+    this->port = port;
+    this->postFn = postFn;
+}
+
+void AsyncExecutor::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            jobReady.wait(guard, [this]() { return stopping || !jobs.empty(); });
+            if (jobs.empty()) return;   // stopping and drained
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        AsyncResult result = job.work();
+
+        AsyncCompletion c;
+        c.requestId = job.requestId;
+        c.status = result.status;
+        c.value = result.value;
+        strncpy(c.message, result.message.c_str(), ASYNC_MESSAGE_SIZE - 1);
+        c.message[ASYNC_MESSAGE_SIZE - 1] = '\0';
+
+        PostCObjectFn post;
+        int64_t target;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            completions.push_back(c);
+            inFlight.erase(job.requestId);
+            if (--pending[job.owner] == 0) pending.erase(job.owner);
+            post = postFn;
+            target = port;
+        }
+        jobDone.notify_all();
+
+        // Posting happens outside the lock; the receiver collects with take()
+        if (post != nullptr) {
+            PortMessage msg;
+            msg.type = PORT_MESSAGE_INT64;
+            msg.asInt64 = job.requestId;
+            post(target, &msg);
+        }
+    }
+}
+
+bool AsyncExecutor::poll(AsyncCompletion& out) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (completions.empty()) return false;
+
+    out = completions.front();
+    completions.pop_front();
+    return true;
+}
+
+bool AsyncExecutor::take(long long requestId, int timeoutMs, AsyncCompletion& out) {
+    std::unique_lock<std::mutex> guard(lock);
+
+    bool found = false;
+    auto find = [&]() {
+        for (auto it = completions.begin(); it != completions.end(); ++it) {
+            if (it->requestId == requestId) {
+                out = *it;
+                completions.erase(it);
+                found = true;
+                return true;
+            }
+        }
+        // Not queued or running either: nothing will ever complete it
+        return inFlight.count(requestId) == 0;
+    };
+
+    if (timeoutMs < 0) jobDone.wait(guard, find);
+    else jobDone.wait_for(guard, std::chrono::milliseconds(timeoutMs), find);
+    return found;
+}
+
+void AsyncExecutor::drain(void* owner) {
+    std::unique_lock<std::mutex> guard(lock);
+    jobDone.wait(guard, [&]() { return pending.find(owner) == pending.end(); });
+}
@@ -0,0 +1,149 @@
+#include "../include/balance_timeline.h"
+#include <iterator>
+
+BalanceTimeline::BalanceTimeline(double initialBalance, int undoDepth) {
+    this->initialBalance = initialBalance;
+    maxJournal = undoDepth > 0 ? (size_t)undoDepth : 0;
+    journal.resize(maxJournal);
+    journalHead = 0;
+    journalCount = 0;
+    for (int k = 0; k < TIMELINE_LEVELS; k++) recent[k] = levels[k].end();
+}
+
+int64_t BalanceTimeline::width(int level) {
+    int64_t w = TIMELINE_BASE_WIDTH;
+    for (int k = 0; k < level; k++) w *= TIMELINE_FANOUT;
+    return w;
+}
+
+int64_t BalanceTimeline::keyOf(Timestamp timestamp, int level) {
+    int64_t w = width(level);
+    int64_t q = timestamp / w;
+    return (timestamp % w < 0) ? q - 1 : q;    // floor, also before 1970
+}
+
+BalanceTimeline::Level::iterator BalanceTimeline::find(int level, int64_t key) {
+    if (recent[level] != levels[level].end() && recent[level]->first == key) return recent[level];
+    return levels[level].find(key);
+}
+
+void BalanceTimeline::record(int id, Timestamp timestamp, double balanceAfter, bool undoable) {
+    JournalEntry* e = nullptr;
+    if (undoable && maxJournal > 0) {
+        // Keep the journal exactly as deep as the undo stack: when full the
+        // oldest entry sits in the head slot and is overwritten
+        e = &journal[journalHead];
+        journalHead = (journalHead + 1) % maxJournal;
+        if (journalCount < maxJournal) journalCount++;
+        e->timestamp = timestamp;
+    }
+
+    for (int k = 0; k < TIMELINE_LEVELS; k++) {
+        int64_t key = keyOf(timestamp, k);
+        Level::iterator it = find(k, key);
+
+        if (it == levels[k].end()) {
+            if (e) e->existed[k] = false;
+            Bucket b;
+            b.minBalance = balanceAfter;
+            b.maxBalance = balanceAfter;
+            b.closeBalance = balanceAfter;
+            b.lastTimestamp = timestamp;
+            b.lastID = id;
+            b.count = 1;
+            it = levels[k].emplace_hint(levels[k].lower_bound(key), key, b);
+        } else {
+            if (e) {
+                e->existed[k] = true;
+                e->prev[k] = it->second;
+            }
+            Bucket& b = it->second;
+            if (balanceAfter < b.minBalance) b.minBalance = balanceAfter;
+            if (balanceAfter > b.maxBalance) b.maxBalance = balanceAfter;
+            // Imported rows can arrive out of time order
+            if (timestamp > b.lastTimestamp || (timestamp == b.lastTimestamp && id > b.lastID)) {
+                b.closeBalance = balanceAfter;
+                b.lastTimestamp = timestamp;
+                b.lastID = id;
+            }
+            b.count++;
+        }
+        recent[k] = it;
+    }
+}
+
+void BalanceTimeline::revert() {
+    if (journalCount == 0) return;
+
+    journalHead = (journalHead + maxJournal - 1) % maxJournal;
+    journalCount--;
+    const JournalEntry& e = journal[journalHead];
+    for (int k = 0; k < TIMELINE_LEVELS; k++) {
+        Level::iterator it = find(k, keyOf(e.timestamp, k));
+        if (it == levels[k].end()) continue;
+
+        if (e.existed[k]) {
+            it->second = e.prev[k];
+            recent[k] = it;
+        } else {
+            levels[k].erase(it);
+            recent[k] = levels[k].end();
+        }
+    }
+}
+
+int BalanceTimeline::query(Timestamp fromTs, Timestamp toTs, int points, TimelinePoint* out) const {
+    if (points <= 0 || toTs < fromTs) return 0;
+    if (points > TIMELINE_MAX_POINTS) points = TIMELINE_MAX_POINTS;
+
+    int64_t span = toTs - fromTs + 1;
+    int64_t slice = (span + points - 1) / points;
+    int n = (int)((span + slice - 1) / slice);
+
+    // Coarsest level whose buckets still fit in a slice
+    int level = 0;
+    while (level + 1 < TIMELINE_LEVELS && width(level + 1) <= slice) level++;
+    const Level& lv = levels[level];
+    int64_t w = width(level);
+
+    for (int i = 0; i < n; i++) {
+        out[i].timestamp = fromTs + (int64_t)i * slice;
+        out[i].count = 0;
+    }
+
+    Level::const_iterator it = lv.lower_bound(keyOf(fromTs, level));
+    double carry = (it == lv.begin()) ? initialBalance : std::prev(it)->second.closeBalance;
+    int64_t lastKey = keyOf(toTs, level);
+
+    // Fold buckets into slices; a bucket straddling a slice edge goes to the
+    // slice holding its start (clamped into range)
+    for (; it != lv.end() && it->first <= lastKey; ++it) {
+        int64_t start = it->first * w;
+        int i = (start <= fromTs) ? 0 : (int)((start - fromTs) / slice);
+        if (i >= n) i = n - 1;
+
+        const Bucket& b = it->second;
+        TimelinePoint& p = out[i];
+        if (p.count == 0) {
+            p.minBalance = b.minBalance;
+            p.maxBalance = b.maxBalance;
+        } else {
+            if (b.minBalance < p.minBalance) p.minBalance = b.minBalance;
+            if (b.maxBalance > p.maxBalance) p.maxBalance = b.maxBalance;
+        }
+        p.closeBalance = b.closeBalance;   // buckets come in time order
+        p.count += b.count;
+    }
+
+    // Empty slices: the balance didn't move
+    for (int i = 0; i < n; i++) {
+        if (out[i].count == 0) {
+            out[i].minBalance = carry;
+            out[i].maxBalance = carry;
+            out[i].closeBalance = carry;
+        } else {
+            carry = out[i].closeBalance;
+        }
+    }
+    return n;
+}
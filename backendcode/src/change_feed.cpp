@@ -0,0 +1,47 @@
+#include "../include/change_feed.h"
+
+ChangeFeed::ChangeFeed(size_t capacity) : ring(capacity > 0 ? capacity : 1) {
+    latest = 0;
+}
+
+ChangeRecord& ChangeFeed::next() {
+    latest++;
+    ChangeRecord& c = ring[(size_t)((latest - 1) % ring.size())];
+    c.seq = latest;
+    return c;
+}
+
+void ChangeFeed::recordAppend(const Transaction& t, unsigned char postingKind) {
+    ChangeRecord& c = next();
+    c.kind = CHANGE_APPEND;
+    c.transactionID = t.id;
+    c.postingKind = postingKind;
+    c.amount = t.amount;
+    c.balanceAfter = t.balanceAfter;
+    c.timestamp = t.timestamp;
+}
+
+void ChangeFeed::recordUndo(const Transaction& t, unsigned char postingKind, double balanceAfter) {
+    ChangeRecord& c = next();
+    c.kind = CHANGE_UNDO;
+    c.transactionID = t.id;
+    c.postingKind = postingKind;
+    c.amount = t.amount;
+    c.balanceAfter = balanceAfter;
+    c.timestamp = t.timestamp;
+}
+
+uint64_t ChangeFeed::oldestSeq() const {
+    return latest >= ring.size() ? latest - ring.size() + 1 : 1;
+}
+
+int ChangeFeed::since(uint64_t after, ChangeRecord* out, int capacity) const {
+    if (after > latest || after + 1 < oldestSeq()) return CHANGES_SNAPSHOT_REQUIRED;
+
+    uint64_t available = latest - after;
+    int n = (capacity < 0) ? 0 : (available < (uint64_t)capacity ? (int)available : capacity);
+    for (int i = 0; i < n; i++) {
+        out[i] = ring[(size_t)((after + (uint64_t)i) % ring.size())];
+    }
+    return n;
+}
@@ -0,0 +1,70 @@
+#include "../include/clock.h"
+#include <chrono>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// ===== OS readings =====
+
+Timestamp LedgerClock::coarseNow() {
+#if defined(_WIN32)
+    // Updated by the kernel once per tick; no syscall
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    int64_t ticks = ((int64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;   // 100ns since 1601
+    return ticks / 10 - 11644473600LL * MICROS_PER_SECOND;
+#elif defined(CLOCK_REALTIME_COARSE)
+    // Last tick's time, read from the vDSO without touching the clock source
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return (Timestamp)ts.tv_sec * MICROS_PER_SECOND + ts.tv_nsec / 1000;
+#else
+    return systemNow();
+#endif
+}
+
+Timestamp LedgerClock::systemNow() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+// ===== LedgerClock =====
+
+LedgerClock LedgerClock::system() {
+    LedgerClock c;
+    c.kind = CLOCK_SYSTEM;
+    return c;
+}
+
+LedgerClock LedgerClock::fake(Timestamp start, Timestamp step) {
+    LedgerClock c;
+    c.kind = CLOCK_FAKE;
+    c.step = step;
+    c.last = start - step;
+    return c;
+}
+
+Timestamp LedgerClock::now() {
+    Timestamp t;
+    switch (kind) {
+        case CLOCK_FAKE:
+            last += step;
+            return last;
+        case CLOCK_SYSTEM:
+            t = systemNow();
+            break;
+        default:
+            t = coarseNow();
+            break;
+    }
+
+    if (t <= last) t = last + 1;
+    last = t;
+    return t;
+}
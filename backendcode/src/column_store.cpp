@@ -0,0 +1,49 @@
+#include "../include/column_store.h"
+
+void TransactionColumns::append(int id, unsigned char kind, double amount,
+                                int64_t timestamp, double balanceAfter) {
+    ids.push_back(id);
+    kinds.push_back(kind);
+    amounts.push_back(amount);
+    timestamps.push_back(timestamp);
+    balances.push_back(balanceAfter);
+}
+
+void TransactionColumns::removeLast() {
+    if (ids.empty()) return;
+
+    ids.pop_back();
+    kinds.pop_back();
+    amounts.pop_back();
+    timestamps.pop_back();
+    balances.pop_back();
+}
+
+void TransactionColumns::dropFront(size_t n) {
+    if (n >= ids.size()) {
+        clear();
+        return;
+    }
+
+    ids.erase(ids.begin(), ids.begin() + n);
+    kinds.erase(kinds.begin(), kinds.begin() + n);
+    amounts.erase(amounts.begin(), amounts.begin() + n);
+    timestamps.erase(timestamps.begin(), timestamps.begin() + n);
+    balances.erase(balances.begin(), balances.begin() + n);
+}
+
+void TransactionColumns::clear() {
+    ids.clear();
+    kinds.clear();
+    amounts.clear();
+    timestamps.clear();
+    balances.clear();
+}
+
+void TransactionColumns::reserve(size_t n) {
+    ids.reserve(n);
+    kinds.reserve(n);
+    amounts.reserve(n);
+    timestamps.reserve(n);
+    balances.reserve(n);
+}
@@ -0,0 +1,380 @@
+#include "../include/event_log.h"
+#include "../include/column_store.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+// Block file:
+//   "BLGE" | uint32 version | uint32 events | uint64 index of the first event
+//   LedgerStateAt the block starts from | LedgerEvent per event
+//   uint32 descriptions | uint32 length + bytes per description
+// Structs are written as they are in memory: block files never outlive the
+// log that wrote them.
+#define EVENT_BLOCK_MAGIC    "BLGE"
+#define EVENT_BLOCK_VERSION  1
+
+template <typename T>
+static void put(std::string& out, const T& value) {
+    out.append((const char*)&value, sizeof(T));
+}
+
+template <typename T>
+static bool get(const std::string& in, size_t& pos, T& value) {
+    if (in.size() - pos < sizeof(T)) return false;
+    memcpy(&value, in.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+EventLog::EventLog(double initialBalance) {
+    tailStart.events = 0;
+    tailStart.asOf = 0;
+    tailStart.balance = initialBalance;
+    tailStart.newestLive = -1;
+    tailStart.livePostings = 0;
+    tailStart.undonePostings = 0;
+    tailStart.depositTotal = 0.0;
+    tailStart.withdrawalTotal = 0.0;
+    tailStart.depositCount = 0;
+    tailStart.withdrawalCount = 0;
+    tailStart.lastTransactionID = 0;
+    current = tailStart;
+    spilling = false;
+    cacheLimit = 2;
+}
+
+EventLog::~EventLog() {
+    for (size_t i = 0; i < spilled.size(); i++) {
+        std::remove(blockPath(i).c_str());
+    }
+}
+
+bool EventLog::apply(LedgerStateAt& state, uint64_t index) const {
+    LedgerEvent e;
+    if (!event(index, e)) return false;
+
+    // An undo carries the amount and kind of the posting it takes back;
+    // the posting itself is only needed for what lies beneath it
+    int64_t beneath = (int64_t)index;
+    if (e.kind == EVENT_UNDO) {
+        LedgerEvent p;
+        if (!event((uint64_t)e.link, p)) return false;
+        beneath = p.link;
+    }
+
+    state.events = index + 1;
+    state.asOf = e.recordedAt;
+    state.balance = e.balanceAfter;
+
+    bool isWithdrawal = (e.postingKind == KIND_WITHDRAWAL);
+    int sign = (e.kind == EVENT_POST) ? 1 : -1;
+
+    if (isWithdrawal) {
+        state.withdrawalTotal += sign * e.amount;
+        state.withdrawalCount += sign;
+    } else {
+        state.depositTotal += sign * e.amount;
+        state.depositCount += sign;
+    }
+    state.livePostings += sign;
+    state.newestLive = beneath;
+
+    if (e.kind == EVENT_POST) {
+        state.lastTransactionID = std::max(state.lastTransactionID, e.transactionID);
+    } else {
+        state.undonePostings++;
+    }
+    return true;
+}
+
+void EventLog::append(LedgerEvent& e) {
+    // Keep recordedAt monotonic so stateAt can binary search
+    if (current.events > 0 && e.recordedAt < current.asOf) {
+        e.recordedAt = current.asOf;
+    }
+
+    uint64_t index = current.events;
+    events.push_back(e);
+    if (e.kind == EVENT_UNDO) undoEvents.push_back(index);
+    apply(current, index);
+
+    if (current.events % EVENT_CHECKPOINT_INTERVAL == 0) {
+        checkpoints.push_back(current);
+        if (spilling) spillSealed();
+    }
+}
+
+uint32_t EventLog::intern(const std::string& description) {
+    auto it = descriptionIndex.find(description);
+    if (it == descriptionIndex.end()) {
+        it = descriptionIndex.emplace(description, (uint32_t)descriptions.size()).first;
+        descriptions.push_back(description);
+    }
+    return it->second;
+}
+
+void EventLog::recordPosting(const Transaction& t, unsigned char postingKind, Timestamp recordedAt) {
+    LedgerEvent e;
+    e.recordedAt = recordedAt;
+    e.postingTime = t.timestamp;
+    e.amount = t.amount;
+    e.balanceAfter = t.balanceAfter;
+    e.link = current.newestLive;
+    e.transactionID = t.id;
+    e.description = intern(t.description);
+    e.kind = EVENT_POST;
+    e.postingKind = postingKind;
+    append(e);
+}
+
+bool EventLog::recordUndo(int transactionID, double balanceAfter, Timestamp recordedAt) {
+    if (current.newestLive < 0) return false;
+
+    // The posting may already sit in a spilled block
+    LedgerEvent p;
+    std::string description;
+    if (!event((uint64_t)current.newestLive, p, &description)) return false;
+    if (p.transactionID != transactionID) return false;
+
+    LedgerEvent e;
+    e.recordedAt = recordedAt;
+    e.postingTime = p.postingTime;
+    e.amount = p.amount;
+    e.balanceAfter = balanceAfter;
+    e.link = current.newestLive;
+    e.transactionID = transactionID;
+    e.description = intern(description);
+    e.kind = EVENT_UNDO;
+    e.postingKind = p.postingKind;
+    append(e);
+    return true;
+}
+
+// ===== Spilled blocks =====
+
+bool EventLog::spillTo(const std::string& directory, int cacheBlocks) {
+    if (spilling) return false;
+
+    this->directory = directory;
+    spilling = true;
+    // Two at least: replaying one block can reach back into another
+    cacheLimit = cacheBlocks < 2 ? 2 : (size_t)cacheBlocks;
+    return spillSealed();
+}
+
+std::string EventLog::blockPath(size_t index) const {
+    char name[32];
+    snprintf(name, sizeof(name), "events_%06zu.blge", index);
+    return (std::filesystem::path(directory) / name).string();
+}
+
+bool EventLog::spillSealed() {
+    size_t full = events.size() / EVENT_CHECKPOINT_INTERVAL;
+    size_t written = 0;
+
+    for (; written < full; written++) {
+        const LedgerEvent* block = events.data() + written * EVENT_CHECKPOINT_INTERVAL;
+        uint64_t first = tailStart.events + written * EVENT_CHECKPOINT_INTERVAL;
+        const LedgerStateAt& start = (written == 0) ? tailStart : checkpoints[written - 1];
+
+        // Each block carries only the descriptions its own events use
+        std::unordered_map<uint32_t, uint32_t> remap;
+        std::vector<uint32_t> used;
+        uint32_t undoCount = 0;
+
+        std::string data(EVENT_BLOCK_MAGIC, 4);
+        put(data, (uint32_t)EVENT_BLOCK_VERSION);
+        put(data, (uint32_t)EVENT_CHECKPOINT_INTERVAL);
+        put(data, first);
+        put(data, start);
+        for (size_t i = 0; i < EVENT_CHECKPOINT_INTERVAL; i++) {
+            LedgerEvent e = block[i];
+            auto it = remap.emplace(e.description, (uint32_t)used.size()).first;
+            if (it->second == used.size()) used.push_back(e.description);
+            e.description = it->second;
+            if (e.kind == EVENT_UNDO) undoCount++;
+            put(data, e);
+        }
+        put(data, (uint32_t)used.size());
+        for (uint32_t d : used) {
+            put(data, (uint32_t)descriptions[d].size());
+            data += descriptions[d];
+        }
+
+        std::string path = blockPath(spilled.size());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), (std::streamsize)data.size());
+        out.close();
+        if (!out) {
+            std::remove(path.c_str());
+            spilling = false;
+            break;
+        }
+        spilled.push_back(SpilledBlock{ block[0].recordedAt, undoCount });
+    }
+    if (written == 0) return spilling;
+
+    tailStart = checkpoints[written - 1];
+    checkpoints.erase(checkpoints.begin(), checkpoints.begin() + (std::ptrdiff_t)written);
+    events.erase(events.begin(), events.begin() + (std::ptrdiff_t)(written * EVENT_CHECKPOINT_INTERVAL));
+    undoEvents.erase(undoEvents.begin(),
+                     std::lower_bound(undoEvents.begin(), undoEvents.end(), tailStart.events));
+
+    // Re-intern what is left, so the table only covers events in memory
+    std::vector<std::string> old;
+    old.swap(descriptions);
+    descriptionIndex.clear();
+    for (LedgerEvent& e : events) e.description = intern(old[e.description]);
+    return spilling;
+}
+
+const EventLog::LoadedBlock* EventLog::load(size_t index) const {
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+        if (it->index == index) {
+            cache.splice(cache.begin(), cache, it);
+            return &cache.front();
+        }
+    }
+
+    std::ifstream in(blockPath(index), std::ios::binary);
+    if (!in) return nullptr;
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    LoadedBlock block;
+    block.index = index;
+    size_t pos = 4;
+    uint32_t version = 0, count = 0, descriptionCount = 0;
+    uint64_t first = 0;
+    if (data.size() < pos || memcmp(data.data(), EVENT_BLOCK_MAGIC, 4) != 0 ||
+        !get(data, pos, version) || version != EVENT_BLOCK_VERSION ||
+        !get(data, pos, count) || count != EVENT_CHECKPOINT_INTERVAL ||
+        !get(data, pos, first) || first != (uint64_t)index * EVENT_CHECKPOINT_INTERVAL ||
+        !get(data, pos, block.start)) {
+        return nullptr;
+    }
+
+    block.events.resize(count);
+    for (LedgerEvent& e : block.events) {
+        if (!get(data, pos, e)) return nullptr;
+    }
+    if (!get(data, pos, descriptionCount)) return nullptr;
+    for (uint32_t i = 0; i < descriptionCount; i++) {
+        uint32_t length = 0;
+        if (!get(data, pos, length) || data.size() - pos < length) return nullptr;
+        block.descriptions.emplace_back(data, pos, length);
+        pos += length;
+    }
+    for (const LedgerEvent& e : block.events) {
+        if (e.description >= descriptionCount) return nullptr;
+    }
+
+    while (cache.size() >= cacheLimit) cache.pop_back();
+    cache.push_front(std::move(block));
+    return &cache.front();
+}
+
+bool EventLog::event(uint64_t index, LedgerEvent& out, std::string* description) const {
+    if (index >= tailStart.events) {
+        if (index - tailStart.events >= events.size()) return false;
+        out = events[(size_t)(index - tailStart.events)];
+        if (description) *description = descriptions[out.description];
+        return true;
+    }
+
+    const LoadedBlock* block = load((size_t)(index / EVENT_CHECKPOINT_INTERVAL));
+    if (!block) return false;
+    out = block->events[(size_t)(index % EVENT_CHECKPOINT_INTERVAL)];
+    if (description) *description = block->descriptions[out.description];
+    return true;
+}
+
+// ===== Queries =====
+
+bool EventLog::stateAfter(uint64_t eventCount, LedgerStateAt& out) const {
+    if (eventCount >= current.events) {
+        out = current;
+        return true;
+    }
+
+    // Nearest checkpoint at or before the prefix, then replay the rest
+    if (eventCount >= tailStart.events) {
+        uint64_t k = (eventCount - tailStart.events) / EVENT_CHECKPOINT_INTERVAL;
+        out = (k == 0) ? tailStart : checkpoints[(size_t)k - 1];
+    } else {
+        const LoadedBlock* block = load((size_t)(eventCount / EVENT_CHECKPOINT_INTERVAL));
+        if (!block) return false;
+        out = block->start;
+    }
+    for (uint64_t i = out.events; i < eventCount; i++) {
+        if (!apply(out, i)) return false;
+    }
+    return true;
+}
+
+bool EventLog::stateAt(Timestamp asOf, LedgerStateAt& out) const {
+    auto after = [](Timestamp t, const LedgerEvent& e) { return t < e.recordedAt; };
+    uint64_t count;
+
+    if (spilled.empty() || (!events.empty() && events.front().recordedAt <= asOf)) {
+        auto end = std::upper_bound(events.begin(), events.end(), asOf, after);
+        count = tailStart.events + (uint64_t)(end - events.begin());
+    } else {
+        // Last spilled block starting at or before asOf, then within it
+        auto next = std::upper_bound(spilled.begin(), spilled.end(), asOf,
+                                     [](Timestamp t, const SpilledBlock& b) { return t < b.firstRecordedAt; });
+        if (next == spilled.begin()) {
+            count = 0;
+        } else {
+            size_t index = (size_t)(next - spilled.begin()) - 1;
+            const LoadedBlock* block = load(index);
+            if (!block) return false;
+            auto end = std::upper_bound(block->events.begin(), block->events.end(), asOf, after);
+            count = (uint64_t)index * EVENT_CHECKPOINT_INTERVAL + (uint64_t)(end - block->events.begin());
+        }
+    }
+    return stateAfter(count, out);
+}
+
+bool EventLog::livePostings(const LedgerStateAt& state, std::vector<LoggedPosting>& out) const {
+    size_t first = out.size();
+    for (int64_t i = state.newestLive; i >= 0;) {
+        LoggedPosting p;
+        if (!event((uint64_t)i, p.event, &p.description)) {
+            out.resize(first);
+            return false;
+        }
+        i = p.event.link;
+        out.push_back(std::move(p));
+    }
+    std::reverse(out.begin() + (std::ptrdiff_t)first, out.end());
+    return true;
+}
+
+bool EventLog::undonePostings(const LedgerStateAt& state, std::vector<LoggedPosting>& out) const {
+    // Indexes first: loading a posting can evict the block being read
+    std::vector<uint64_t> reverted;
+    for (size_t b = 0; b < spilled.size() && (uint64_t)b * EVENT_CHECKPOINT_INTERVAL < state.events; b++) {
+        if (spilled[b].undoCount == 0) continue;
+
+        const LoadedBlock* block = load(b);
+        if (!block) return false;
+        uint64_t first = (uint64_t)b * EVENT_CHECKPOINT_INTERVAL;
+        for (size_t i = 0; i < block->events.size() && first + i < state.events; i++) {
+            if (block->events[i].kind == EVENT_UNDO) reverted.push_back((uint64_t)block->events[i].link);
+        }
+    }
+
+    auto end = std::lower_bound(undoEvents.begin(), undoEvents.end(), state.events);
+    for (auto it = undoEvents.begin(); it != end; ++it) {
+        reverted.push_back((uint64_t)events[(size_t)(*it - tailStart.events)].link);
+    }
+
+    for (uint64_t index : reverted) {
+        LoggedPosting p;
+        if (!event(index, p.event, &p.description)) return false;
+        out.push_back(std::move(p));
+    }
+    return true;
+}
@@ -0,0 +1,360 @@
+#include "../include/exporter.h"
+#include "../include/column_store.h"
+#include <charconv>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#define WRITE_FD(fd, p, n) _write(fd, p, (unsigned int)(n))
+#define CLOSE_FD(fd) _close(fd)
+#define OPEN_FLAGS (_O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY)
+#define OPEN_FILE(path) _open(path, OPEN_FLAGS, _S_IREAD | _S_IWRITE)
+#else
+#include <unistd.h>
+#define WRITE_FD(fd, p, n) ::write(fd, p, n)
+#define CLOSE_FD(fd) ::close(fd)
+#define OPEN_FILE(path) ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644)
+#endif
+
+// ===== BufferedWriter =====
+
+BufferedWriter::BufferedWriter(int fd, size_t capacity) {
+    this->fd = fd;
+    this->capacity = capacity < 256 ? 256 : capacity;
+    buffer = new char[this->capacity];
+    used = 0;
+    failed = false;
+}
+
+BufferedWriter::~BufferedWriter() {
+    flush();
+    delete[] buffer;
+}
+
+bool BufferedWriter::flush() {
+    size_t off = 0;
+    while (off < used && !failed) {
+        auto n = WRITE_FD(fd, buffer + off, used - off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            failed = true;
+            break;
+        }
+        off += (size_t)n;
+    }
+    used = 0;
+    return !failed;
+}
+
+void BufferedWriter::write(const char* data, size_t n) {
+    if (used + n > capacity) {
+        flush();
+        // Larger than the whole buffer: write straight through
+        if (n > capacity) {
+            size_t off = 0;
+            while (off < n && !failed) {
+                auto w = WRITE_FD(fd, data + off, n - off);
+                if (w < 0) {
+                    if (errno == EINTR) continue;
+                    failed = true;
+                    break;
+                }
+                off += (size_t)w;
+            }
+            return;
+        }
+    }
+    memcpy(buffer + used, data, n);
+    used += n;
+}
+
+void BufferedWriter::put(char c) {
+    if (used == capacity) flush();
+    buffer[used++] = c;
+}
+
+void BufferedWriter::writeInt(int64_t value) {
+    if (capacity - used < 24) flush();
+    std::to_chars_result r = std::to_chars(buffer + used, buffer + capacity, value);
+    used = (size_t)(r.ptr - buffer);
+}
+
+void BufferedWriter::writeMoney(double value) {
+    if (capacity - used < 64) flush();
+    std::to_chars_result r = std::to_chars(buffer + used, buffer + capacity, value,
+                                           std::chars_format::fixed, 2);
+    if (r.ec != std::errc()) {
+        write("0.00", 4);   // only for absurd magnitudes beyond the buffer
+        return;
+    }
+    used = (size_t)(r.ptr - buffer);
+}
+
+// Timestamps are written as seconds with six decimals ("1700000000.250000"),
+// which older readers still take as a number of seconds. Returns the length.
+static size_t formatTimestamp(char* buf, Timestamp ts) {
+    char* p = buf;
+    uint64_t magnitude = (uint64_t)ts;
+    if (ts < 0) {
+        *p++ = '-';
+        magnitude = 0 - magnitude;
+    }
+    p = std::to_chars(p, buf + 24, magnitude / MICROS_PER_SECOND).ptr;
+    *p++ = '.';
+
+    uint64_t fraction = magnitude % MICROS_PER_SECOND;
+    for (int i = 5; i >= 0; i--) {
+        p[i] = (char)('0' + fraction % 10);
+        fraction /= 10;
+    }
+    return (size_t)(p + 6 - buf);
+}
+
+void BufferedWriter::writeTimestamp(Timestamp ts) {
+    if (capacity - used < 32) flush();
+    used += formatTimestamp(buffer + used, ts);
+}
+
+static const char HEX[] = "0123456789abcdef";
+
+// Length of the prefix that can be copied without escaping
+static size_t safeJsonRun(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n) {
+        unsigned char c = (unsigned char)p[i];
+        if (c < 0x20 || c == '"' || c == '\\') break;
+        i++;
+    }
+    return i;
+}
+
+void BufferedWriter::writeJsonString(const std::string& s) {
+    put('"');
+
+    const char* p = s.data();
+    size_t n = s.size();
+    while (n > 0) {
+        size_t run = safeJsonRun(p, n);
+        write(p, run);
+        p += run;
+        n -= run;
+        if (n == 0) break;
+
+        unsigned char c = (unsigned char)*p++;
+        n--;
+        switch (c) {
+            case '"': write("\\\"", 2); break;
+            case '\\': write("\\\\", 2); break;
+            case '\n': write("\\n", 2); break;
+            case '\r': write("\\r", 2); break;
+            case '\t': write("\\t", 2); break;
+            case '\b': write("\\b", 2); break;
+            case '\f': write("\\f", 2); break;
+            default: {
+                char esc[6] = { '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF] };
+                write(esc, 6);
+            }
+        }
+    }
+
+    put('"');
+}
+
+void BufferedWriter::writeCsvField(const std::string& s) {
+    if (s.find_first_of(",\"\r\n") == std::string::npos) {
+        write(s);
+        return;
+    }
+
+    put('"');
+    for (char c : s) {
+        if (c == '"') put('"');
+        put(c);
+    }
+    put('"');
+}
+
+// ===== String helpers =====
+
+std::string jsonEscape(const std::string& s) {
+    std::string out;
+    out.reserve(s.size() + 8);
+
+    for (char ch : s) {
+        unsigned char c = (unsigned char)ch;
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                if (c < 0x20) {
+                    out += "\\u00";
+                    out += HEX[c >> 4];
+                    out += HEX[c & 0xF];
+                } else {
+                    out += ch;
+                }
+        }
+    }
+    return out;
+}
+
+static void appendMoney(std::string& out, double value) {
+    char buf[64];
+    std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, 2);
+    out.append(buf, r.ec == std::errc() ? (size_t)(r.ptr - buf) : 0);
+}
+
+static void appendTimestamp(std::string& out, Timestamp ts) {
+    char buf[32];
+    out.append(buf, formatTimestamp(buf, ts));
+}
+
+static void appendInt(std::string& out, int64_t value) {
+    char buf[24];
+    std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, (size_t)(r.ptr - buf));
+}
+
+std::string transactionToJson(const Transaction& t) {
+    std::string out;
+    out.reserve(128 + t.description.size());
+
+    out += "{\"id\":";
+    appendInt(out, t.id);
+    out += ",\"type\":\"";
+    out += jsonEscape(t.type);
+    out += "\",\"amount\":";
+    appendMoney(out, t.amount);
+    out += ",\"description\":\"";
+    out += jsonEscape(t.description);
+    out += "\",\"timestamp\":";
+    appendTimestamp(out, t.timestamp);
+    out += ",\"balanceAfter\":";
+    appendMoney(out, t.balanceAfter);
+    out += "}";
+    return out;
+}
+
+// ===== Row writers =====
+
+static void writeCsvRow(BufferedWriter& w, const Transaction& t) {
+    w.writeInt(t.id);
+    w.put(',');
+    w.write(t.type);
+    w.put(',');
+    w.writeMoney(t.amount);
+    w.put(',');
+    w.writeCsvField(t.description);
+    w.put(',');
+    w.writeTimestamp(t.timestamp);
+    w.put(',');
+    w.writeMoney(t.balanceAfter);
+    w.put('\n');
+}
+
+static void writeJsonRow(BufferedWriter& w, const Transaction& t) {
+    w.write("{\"id\":", 6);
+    w.writeInt(t.id);
+    w.write(",\"type\":", 8);
+    w.writeJsonString(t.type);
+    w.write(",\"amount\":", 10);
+    w.writeMoney(t.amount);
+    w.write(",\"description\":", 15);
+    w.writeJsonString(t.description);
+    w.write(",\"timestamp\":", 13);
+    w.writeTimestamp(t.timestamp);
+    w.write(",\"balanceAfter\":", 16);
+    w.writeMoney(t.balanceAfter);
+    w.write("}\n", 2);
+}
+
+static void writeBinaryRow(BufferedWriter& w, const Transaction& t) {
+    int32_t id = t.id;
+    uint8_t kind = (t.type == "WITHDRAWAL") ? KIND_WITHDRAWAL : KIND_DEPOSIT;
+    int64_t ts = t.timestamp;
+    uint32_t len = (uint32_t)t.description.size();
+
+    w.writeRaw(id);
+    w.writeRaw(kind);
+    w.writeRaw(t.amount);
+    w.writeRaw(ts);
+    w.writeRaw(t.balanceAfter);
+    w.writeRaw(len);
+    w.write(t.description.data(), len);
+}
+
+// Header, then every row forEach hands over
+template <typename ForEach>
+static long long writeRows(int fd, ExportFormat format, uint64_t count, ForEach forEach) {
+    BufferedWriter w(fd);
+    long long rows = 0;
+
+    if (format == EXPORT_CSV) {
+        w.write("id,type,amount,description,timestamp,balanceAfter\n");
+    } else if (format == EXPORT_BINARY) {
+        uint32_t version = EXPORT_BINARY_VERSION;
+        w.write(EXPORT_BINARY_MAGIC, 4);
+        w.writeRaw(version);
+        w.writeRaw(count);
+    }
+
+    forEach([&](const Transaction& t) {
+        switch (format) {
+            case EXPORT_JSONL: writeJsonRow(w, t); break;
+            case EXPORT_BINARY: writeBinaryRow(w, t); break;
+            default: writeCsvRow(w, t); break;
+        }
+        rows++;
+    });
+
+    if (!w.flush()) return -1;
+    return rows;
+}
+
+long long exportTransactions(LinkedList& list, int fd, ExportFormat format) {
+    return writeRows(fd, format, (uint64_t)list.size(), [&](auto&& emit) {
+        for (Node* current = list.getHead(); current != nullptr; current = current->next) {
+            emit(*current->data);
+        }
+    });
+}
+
+long long exportTransactions(const std::vector<Transaction>& rows, int fd, ExportFormat format) {
+    return writeRows(fd, format, (uint64_t)rows.size(), [&](auto&& emit) {
+        for (const Transaction& t : rows) emit(t);
+    });
+}
+
+int createOutputFile(const std::string& path) {
+    return OPEN_FILE(path.c_str());
+}
+
+bool closeOutputFile(int fd) {
+    return CLOSE_FD(fd) == 0;
+}
+
+long long exportToFile(LinkedList& list, const std::string& path, ExportFormat format) {
+    int fd = createOutputFile(path);
+    if (fd < 0) return -1;
+
+    long long rows = exportTransactions(list, fd, format);
+    if (!closeOutputFile(fd)) return -1;
+    return rows;
+}
+
+long long exportToFile(const std::vector<Transaction>& rows, const std::string& path, ExportFormat format) {
+    int fd = createOutputFile(path);
+    if (fd < 0) return -1;
+
+    long long written = exportTransactions(rows, fd, format);
+    if (!closeOutputFile(fd)) return -1;
+    return written;
+}
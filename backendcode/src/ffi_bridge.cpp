@@ -1,7 +1,14 @@
 #include "../include/bank_ledger.h"
+#include "../include/importer.h"
+#include "../include/reconcile.h"
+#include "../include/exporter.h"
+#include "../include/async_executor.h"
+#include "../include/scheduler.h"
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <mutex>
 #include <string>
-#include <sstream>
-#include <iomanip>
 
 #ifdef _WIN32
 #define DLL_EXPORT __declspec(dllexport)
@@ -17,25 +24,142 @@ void setMessage(const std::string& msg) {
     lastMessage = msg;
 }
 
+// ===== Per-ledger locking =====
+// Async jobs run on worker threads, so every call that touches a ledger
+// holds that ledger's mutex for its duration.
+//
+// Each ledger also gets a serial number that is never reused. Anything that
+// keeps a ledger pointer across calls (cursors, schedules) keeps the serial
+// too: the allocator may hand a deleted ledger's address to a new one.
+
+struct LedgerEntry {
+    std::mutex* lock;
+    unsigned long long serial;
+};
+
+static std::mutex registryLock;
+static std::map<void*, LedgerEntry> ledgerLocks;
+static unsigned long long nextLedgerSerial = 0;
+
+static std::mutex* ledgerMutex(void* ledger) {
+    std::lock_guard<std::mutex> guard(registryLock);
+    auto it = ledgerLocks.find(ledger);
+    return it == ledgerLocks.end() ? nullptr : it->second.lock;
+}
+
+// 0 if the ledger isn't (or is no longer) registered
+static unsigned long long ledgerSerial(void* ledger) {
+    std::lock_guard<std::mutex> guard(registryLock);
+    auto it = ledgerLocks.find(ledger);
+    return it == ledgerLocks.end() ? 0 : it->second.serial;
+}
+
+class LedgerGuard {
+private:
+    std::mutex* m;
+
+public:
+    explicit LedgerGuard(void* ledger) : m(ledgerMutex(ledger)) {
+        if (m) m->lock();
+    }
+    ~LedgerGuard() {
+        if (m) m->unlock();
+    }
+};
+
+// Copy of the in-memory history in list order, taken under the ledger's
+// guard so it can be encoded and written without it
+static std::vector<Transaction> snapshotHistory(void* ledger) {
+    LedgerGuard guard(ledger);
+    std::vector<Transaction> rows;
+    LinkedList* list = ((BankLedger*)ledger)->getTransactionList();
+    rows.reserve((size_t)list->size());
+    for (Node* n = list->getHead(); n != nullptr; n = n->next) rows.push_back(*n->data);
+    return rows;
+}
+
+// ===== History cursors =====
+
+struct FfiCursor {
+    void* ledger;
+    unsigned long long serial;
+    HistoryCursor position;
+};
+
+// ===== Scheduled postings =====
+
+// One scheduler can drive many ledgers: each ledger gets an account index
+struct FfiAccount {
+    void* ledger;
+    unsigned long long serial;
+};
+
+struct FfiScheduler {
+    std::mutex lock;
+    PostingScheduler schedules;
+    std::vector<FfiAccount> ledgers;
+    std::map<unsigned long long, int> accounts;   // by ledger serial
+};
+
+// 0 = coarse OS time, 1 = precise OS time, 2 = fake (start, start + step, ...)
+static LedgerClock makeClock(int kind, long long start, long long step) {
+    if (kind == CLOCK_FAKE) return LedgerClock::fake(start, step);
+    if (kind == CLOCK_SYSTEM) return LedgerClock::system();
+    return LedgerClock::coarse();
+}
+
+// ===== Async worker pool =====
+
+#define ASYNC_WORKERS 2
+
+static std::once_flag executorOnce;
+static std::atomic<AsyncExecutor*> executor(nullptr);
+
+// Created on first use and never destroyed: joining workers during static
+// destruction / library unload is not safe
+static AsyncExecutor* asyncExecutor() {
+    std::call_once(executorOnce, []() { executor.store(new AsyncExecutor(ASYNC_WORKERS)); });
+    return executor.load();
+}
+
 extern "C" {
 
     // Create BankLedger
     DLL_EXPORT void* createBankLedger(double initialBalance) {
+        TRACE_SPAN("ffi.createBankLedger");
         BankLedger* ledger = new BankLedger(initialBalance);
+        {
+            std::lock_guard<std::mutex> guard(registryLock);
+            ledgerLocks[ledger] = LedgerEntry{new std::mutex(), ++nextLedgerSerial};
+        }
         setMessage("Bank ledger created successfully.");
         return ledger;
     }
 
     // Delete BankLedger
     DLL_EXPORT void deleteBankLedger(void* ledger) {
+        TRACE_SPAN("ffi.deleteBankLedger");
         if (ledger) {
+            // Let queued async work for this ledger finish first
+            AsyncExecutor* ex = executor.load();
+            if (ex) ex->drain(ledger);
+
+            std::mutex* m;
+            {
+                std::lock_guard<std::mutex> guard(registryLock);
+                m = ledgerLocks[ledger].lock;
+                ledgerLocks.erase(ledger);
+            }
             delete (BankLedger*)ledger;
+            delete m;
             setMessage("Bank ledger deleted.");
         }
     }
 
     // Deposit
     DLL_EXPORT int addDeposit(void* ledger, double amount, const char* description) {
+        TRACE_SPAN("ffi.addDeposit");
+        LedgerGuard guard(ledger);
         if (!ledger || !description) {
             setMessage("Error: Invalid deposit parameters.");
             return 0;
@@ -50,6 +174,8 @@ extern "C" {
 
     // Withdrawal
     DLL_EXPORT int addWithdrawal(void* ledger, double amount, const char* description) {
+        TRACE_SPAN("ffi.addWithdrawal");
+        LedgerGuard guard(ledger);
         if (!ledger || !description) {
             setMessage("Error: Invalid withdrawal parameters.");
             return 0;
@@ -61,7 +187,8 @@ extern "C" {
         double newBalance = bank->getBalance();
 
         if (newBalance == oldBalance) {
-            setMessage("Withdrawal failed: Insufficient balance.");
+            setMessage(bank->getLastVelocityBreach() >= 0 ? "Withdrawal failed: Velocity limit exceeded."
+                                                          : "Withdrawal failed: Insufficient balance.");
             return 0;
         }
 
@@ -69,8 +196,50 @@ extern "C" {
         return 1;
     }
 
+    // Deposit/withdrawal that is safe to retry: a key already used within the
+    // retention window (24h) posts nothing and returns the original transaction
+    // ID. Returns the transaction ID, 0 if rejected; *duplicate (optional) is
+    // set to 1 for a repeat. An empty key behaves like addDeposit/addWithdrawal.
+    static int postWithKey(void* ledger, unsigned char kind, double amount, const char* description,
+                           const char* key, int* duplicate) {
+        LedgerGuard guard(ledger);
+        if (!ledger || !description || !key) {
+            setMessage("Error: Invalid posting parameters.");
+            return 0;
+        }
+
+        bool repeat;
+        int id = ((BankLedger*)ledger)->postWithKey(kind, amount, std::string(description),
+                                                    std::string(key), repeat);
+        if (duplicate) *duplicate = repeat ? 1 : 0;
+
+        if (id == 0 && kind == KIND_WITHDRAWAL) {
+            setMessage(((BankLedger*)ledger)->getLastVelocityBreach() >= 0
+                           ? "Withdrawal failed: Velocity limit exceeded."
+                           : "Withdrawal failed: Insufficient balance.");
+        }
+        else if (id == 0) setMessage("Deposit failed: Amount must be positive.");
+        else if (repeat) setMessage("Duplicate request: transaction " + std::to_string(id) + " already posted.");
+        else setMessage("Transaction " + std::to_string(id) + " posted.");
+        return id;
+    }
+
+    DLL_EXPORT int addDepositWithKey(void* ledger, double amount, const char* description,
+                                     const char* key, int* duplicate) {
+        TRACE_SPAN("ffi.addDepositWithKey");
+        return postWithKey(ledger, KIND_DEPOSIT, amount, description, key, duplicate);
+    }
+
+    DLL_EXPORT int addWithdrawalWithKey(void* ledger, double amount, const char* description,
+                                        const char* key, int* duplicate) {
+        TRACE_SPAN("ffi.addWithdrawalWithKey");
+        return postWithKey(ledger, KIND_WITHDRAWAL, amount, description, key, duplicate);
+    }
+
     // Undo last transaction
     DLL_EXPORT int undoLastTransaction(void* ledger) {
+        TRACE_SPAN("ffi.undoLastTransaction");
+        LedgerGuard guard(ledger);
         if (!ledger) {
             setMessage("Error: Ledger does not exist.");
             return 0;
@@ -82,13 +251,21 @@ extern "C" {
             return 0;
         }
 
+        int before = bank->getTransactionCount();
         bank->undo();
+        if (bank->getTransactionCount() == before) {
+            setMessage("Error: Cannot undo, that deposit covers money on hold.");
+            return 0;
+        }
+
         setMessage("Undo successful. New Balance: $" + std::to_string(bank->getBalance()));
         return 1;
     }
 
     // Get current balance
     DLL_EXPORT double getCurrentBalance(void* ledger) {
+        TRACE_SPAN("ffi.getCurrentBalance");
+        LedgerGuard guard(ledger);
         if (!ledger) {
             setMessage("Error: Ledger not found.");
             return 0.0;
@@ -99,6 +276,8 @@ extern "C" {
 
     // Check if undo is available
     DLL_EXPORT int canUndo(void* ledger) {
+        TRACE_SPAN("ffi.canUndo");
+        LedgerGuard guard(ledger);
         if (!ledger) return 0;
         BankLedger* bank = (BankLedger*)ledger;
         return bank->canUndo() ? 1 : 0;
@@ -106,6 +285,8 @@ extern "C" {
 
     // Get transaction count
     DLL_EXPORT int getTransactionCount(void* ledger) {
+        TRACE_SPAN("ffi.getTransactionCount");
+        LedgerGuard guard(ledger);
         if (!ledger) return 0;
         BankLedger* bank = (BankLedger*)ledger;
         return bank->getTransactionCount();
@@ -113,6 +294,8 @@ extern "C" {
 
     // Sort transactions by date
     DLL_EXPORT int sortTransactionsByDate(void* ledger) {
+        TRACE_SPAN("ffi.sortTransactionsByDate");
+        LedgerGuard guard(ledger);
         if (!ledger) return 0;
         BankLedger* bank = (BankLedger*)ledger;
         bank->sortByDate();
@@ -122,6 +305,8 @@ extern "C" {
 
     // Sort transactions by amount
     DLL_EXPORT int sortTransactionsByAmount(void* ledger) {
+        TRACE_SPAN("ffi.sortTransactionsByAmount");
+        LedgerGuard guard(ledger);
         if (!ledger) return 0;
         BankLedger* bank = (BankLedger*)ledger;
         bank->sortByAmount();
@@ -131,6 +316,8 @@ extern "C" {
 
     // Search transaction by ID
     DLL_EXPORT const char* searchTransactionByID(void* ledger, int transactionID) {
+        TRACE_SPAN("ffi.searchTransactionByID");
+        LedgerGuard guard(ledger);
         static std::string resultBuffer;
 
         if (!ledger) {
@@ -148,25 +335,689 @@ extern "C" {
             return resultBuffer.c_str();
         }
 
-        // Format transaction as JSON-like string
-        std::ostringstream oss;
-        oss << std::fixed << std::setprecision(2);
-        oss << "{"
-            << "\"id\":" << found->id << ","
-            << "\"type\":\"" << found->type << "\","
-            << "\"amount\":" << found->amount << ","
-            << "\"description\":\"" << found->description << "\","
-            << "\"timestamp\":" << found->timestamp << ","
-            << "\"balanceAfter\":" << found->balanceAfter
-            << "}";
-
-        resultBuffer = oss.str();
+        // Format transaction as JSON (description is escaped)
+        {
+            TRACE_SPAN("transactionToJson");
+            resultBuffer = transactionToJson(*found);
+        }
         setMessage("Transaction found successfully (Binary Search).");
         return resultBuffer.c_str();
     }
 
+    // Look up n transactions in one call. out must hold n records; missing
+    // IDs come back with id 0. Returns how many were found (-1 on bad input).
+    DLL_EXPORT int getTransactionsByIDs(void* ledger, const int* ids, int n, TransactionRecord* out) {
+        TRACE_SPAN("ffi.getTransactionsByIDs");
+        LedgerGuard guard(ledger);
+        if (!ledger || n < 0 || (n > 0 && (!ids || !out))) {
+            setMessage("Error: Invalid lookup parameters.");
+            return -1;
+        }
+        return ((BankLedger*)ledger)->getByIDs(ids, n, out);
+    }
+
+    // Stream history in chunks of chunkSize records (filter may be null = everything).
+    // Returns an opaque cursor for nextChunk, or null on bad input.
+    DLL_EXPORT void* openHistoryCursor(void* ledger, const HistoryFilter* filter, int chunkSize) {
+        TRACE_SPAN("ffi.openHistoryCursor");
+        unsigned long long serial = ledger ? ledgerSerial(ledger) : 0;
+        if (!ledger || chunkSize <= 0 || serial == 0) {
+            setMessage("Error: Invalid cursor parameters.");
+            return nullptr;
+        }
+
+        HistoryFilter all;
+        memset(&all, 0, sizeof(all));
+
+        FfiCursor* c = new FfiCursor();
+        c->ledger = ledger;
+        c->serial = serial;
+        c->position = makeHistoryCursor(filter ? *filter : all, chunkSize);
+        return c;
+    }
+
+    // Fill out (room for chunkSize records) with the next matching postings.
+    // Returns the count, 0 once history is exhausted, -1 on error.
+    DLL_EXPORT int nextChunk(void* cursor, TransactionRecord* out) {
+        TRACE_SPAN("ffi.nextChunk");
+        FfiCursor* c = (FfiCursor*)cursor;
+        if (!c || !out) return -1;
+
+        LedgerGuard guard(c->ledger);
+        if (ledgerSerial(c->ledger) != c->serial) {
+            setMessage("Error: Ledger was deleted while the cursor was open.");
+            return -1;
+        }
+
+        int n = ((BankLedger*)c->ledger)->readHistory(c->position, out);
+        if (n < 0) setMessage("Error: Archived history could not be read.");
+        return n;
+    }
+
+    DLL_EXPORT void closeCursor(void* cursor) {
+        delete (FfiCursor*)cursor;
+    }
+
+    // Change feed: up to capacity changes after seq `after` into out, and the
+    // newest seq into *latest. Returns the count, -1 when those changes are no
+    // longer held (re-read the history, then continue from *latest), -2 on bad input.
+    DLL_EXPORT int getChangesSince(void* ledger, unsigned long long after, ChangeRecord* out,
+                                   int capacity, unsigned long long* latest) {
+        TRACE_SPAN("ffi.getChangesSince");
+        LedgerGuard guard(ledger);
+        if (!ledger || !latest || capacity < 0 || (capacity > 0 && !out)) {
+            setMessage("Error: Invalid change feed parameters.");
+            return -2;
+        }
+
+        uint64_t newest;
+        int n = ((BankLedger*)ledger)->getChangesSince(after, out, capacity, newest);
+        *latest = newest;
+        return n;
+    }
+
+    // Newest change seq; read it before a snapshot to resume the feed from there
+    DLL_EXPORT unsigned long long getChangeSeq(void* ledger) {
+        TRACE_SPAN("ffi.getChangeSeq");
+        LedgerGuard guard(ledger);
+        if (!ledger) return 0;
+        return ((BankLedger*)ledger)->getChangeSeq();
+    }
+
+    // Aggregate totals over a time window in microseconds since the epoch
+    // (typeMask: 1 = deposits, 2 = withdrawals, 3 = both). Returns 0 if the
+    // parameters are invalid or an archived segment can't be read.
+    DLL_EXPORT int getAggregates(void* ledger, int typeMask, long long fromTs, long long toTs,
+                                 AggregateResult* out) {
+        TRACE_SPAN("ffi.getAggregates");
+        LedgerGuard guard(ledger);
+        if (!ledger || !out) {
+            setMessage("Error: Invalid aggregate parameters.");
+            return 0;
+        }
+
+        BankLedger* bank = (BankLedger*)ledger;
+        if (!bank->aggregate(typeMask, fromTs, toTs, *out)) {
+            setMessage("Error: Cannot read archived history.");
+            return 0;
+        }
+        return 1;
+    }
+
+    // Filter query, e.g. `type = WITHDRAWAL AND amount > 100 AND desc ~ "rent"`
+    // (grammar in query.h). Writes up to capacity matching rows, oldest first,
+    // and the totals and throughput into report. Returns the rows written, or
+    // -1 on a syntax error (the message says where) or an unreadable archive.
+    DLL_EXPORT int runQuery(void* ledger, const char* text, TransactionRecord* out, int capacity,
+                            QueryReport* report) {
+        TRACE_SPAN("ffi.runQuery");
+        LedgerGuard guard(ledger);
+        if (!ledger || !text || !report || capacity < 0 || (capacity > 0 && !out)) {
+            setMessage("Error: Invalid query parameters.");
+            return -1;
+        }
+
+        CompiledQuery query;
+        std::string error;
+        if (!compileQuery(text, query, error)) {
+            setMessage("Query error: " + error);
+            return -1;
+        }
+
+        int n = ((BankLedger*)ledger)->runQuery(query, out, capacity, *report);
+        if (n < 0) {
+            setMessage("Error: Cannot read archived history.");
+            return -1;
+        }
+        setMessage(std::to_string(report->rowsMatched) + " matches, "
+                   + std::to_string((long long)report->rowsPerSecond) + " rows/sec.");
+        return n;
+    }
+
+    // Running ledger statistics in one call
+    DLL_EXPORT int getLedgerStats(void* ledger, LedgerStats* out) {
+        TRACE_SPAN("ffi.getLedgerStats");
+        LedgerGuard guard(ledger);
+        if (!ledger || !out) {
+            setMessage("Error: Invalid stats parameters.");
+            return 0;
+        }
+
+        BankLedger* bank = (BankLedger*)ledger;
+        *out = bank->getStats();
+        return 1;
+    }
+
+    // Statistics for the UTC day (bucket = 0) or month (bucket = 1) containing timestamp (microseconds)
+    DLL_EXPORT int getBucketStats(void* ledger, int bucket, long long timestamp, LedgerStats* out) {
+        TRACE_SPAN("ffi.getBucketStats");
+        LedgerGuard guard(ledger);
+        if (!ledger || !out) {
+            setMessage("Error: Invalid stats parameters.");
+            return 0;
+        }
+
+        BankLedger* bank = (BankLedger*)ledger;
+        StatsBucket kind = (bucket == 1) ? BUCKET_MONTH : BUCKET_DAY;
+        if (!bank->getBucketStats(kind, timestamp, *out)) {
+            setMessage("No transactions in the requested period.");
+            return 0;
+        }
+        return 1;
+    }
+
+    // Balance chart over [fromUs, toUs]: up to `points` min/max/close points
+    // into out (room for `points`). Returns the count, -1 on bad input.
+    DLL_EXPORT int getBalanceTimeline(void* ledger, long long fromUs, long long toUs, int points,
+                                      TimelinePoint* out) {
+        TRACE_SPAN("ffi.getBalanceTimeline");
+        LedgerGuard guard(ledger);
+        if (!ledger || !out || points <= 0 || toUs < fromUs) {
+            setMessage("Error: Invalid timeline parameters.");
+            return -1;
+        }
+
+        return ((BankLedger*)ledger)->getBalanceTimeline(fromUs, toUs, points, out);
+    }
+
+    // Reserve amount until expiresAtUs; returns the hold ID, 0 if not available
+    DLL_EXPORT int placeHold(void* ledger, double amount, const char* description, long long expiresAtUs) {
+        TRACE_SPAN("ffi.placeHold");
+        LedgerGuard guard(ledger);
+        if (!ledger || !description) {
+            setMessage("Error: Invalid hold parameters.");
+            return 0;
+        }
+
+        int id = ((BankLedger*)ledger)->placeHold(amount, std::string(description), expiresAtUs);
+        if (id == 0) {
+            setMessage("Hold failed: Insufficient available balance.");
+            return 0;
+        }
+        setMessage("Hold placed.");
+        return id;
+    }
+
+    // Turn a hold into a withdrawal of amount (0 = the full hold); the rest is released
+    DLL_EXPORT int settleHold(void* ledger, int holdID, double amount) {
+        TRACE_SPAN("ffi.settleHold");
+        LedgerGuard guard(ledger);
+        if (!ledger) {
+            setMessage("Error: Ledger does not exist.");
+            return 0;
+        }
+
+        if (!((BankLedger*)ledger)->settleHold(holdID, amount)) {
+            setMessage("Settle failed: Hold is not active or amount exceeds it.");
+            return 0;
+        }
+        setMessage("Hold settled.");
+        return 1;
+    }
+
+    DLL_EXPORT int releaseHold(void* ledger, int holdID) {
+        TRACE_SPAN("ffi.releaseHold");
+        LedgerGuard guard(ledger);
+        if (!ledger) {
+            setMessage("Error: Ledger does not exist.");
+            return 0;
+        }
+
+        if (!((BankLedger*)ledger)->releaseHold(holdID)) {
+            setMessage("Release failed: Hold is not active.");
+            return 0;
+        }
+        setMessage("Hold released.");
+        return 1;
+    }
+
+    // Expire due holds now; returns how many expired
+    DLL_EXPORT int expireHolds(void* ledger) {
+        TRACE_SPAN("ffi.expireHolds");
+        LedgerGuard guard(ledger);
+        if (!ledger) return 0;
+        return ((BankLedger*)ledger)->expireHolds();
+    }
+
+    // Active hold by ID; 0 once it was settled, released or expired
+    DLL_EXPORT int getHold(void* ledger, int holdID, HoldRecord* out) {
+        TRACE_SPAN("ffi.getHold");
+        LedgerGuard guard(ledger);
+        if (!ledger || !out) {
+            setMessage("Error: Invalid hold parameters.");
+            return 0;
+        }
+        return ((BankLedger*)ledger)->getHold(holdID, *out) ? 1 : 0;
+    }
+
+    // Balance minus active holds: what can be withdrawn or held right now
+    DLL_EXPORT double getAvailableBalance(void* ledger) {
+        TRACE_SPAN("ffi.getAvailableBalance");
+        LedgerGuard guard(ledger);
+        if (!ledger) return 0.0;
+        BankLedger* bank = (BankLedger*)ledger;
+        bank->expireHolds();
+        return bank->getAvailableBalance();
+    }
+
+    // Replace the withdrawal velocity limits (count = 0 clears them).
+    // Returns the number of rules in effect.
+    DLL_EXPORT int setVelocityLimits(void* ledger, const VelocityRule* rules, int count) {
+        TRACE_SPAN("ffi.setVelocityLimits");
+        LedgerGuard guard(ledger);
+        if (!ledger || count < 0 || (count > 0 && !rules)) {
+            setMessage("Error: Invalid velocity limit parameters.");
+            return 0;
+        }
+
+        int active = ((BankLedger*)ledger)->setVelocityLimits(rules, count);
+        setMessage(std::to_string(active) + " velocity limit(s) in effect.");
+        return active;
+    }
+
+    // Copies up to VELOCITY_MAX_RULES rules into out; returns how many
+    DLL_EXPORT int getVelocityLimits(void* ledger, VelocityRule* out) {
+        TRACE_SPAN("ffi.getVelocityLimits");
+        LedgerGuard guard(ledger);
+        if (!ledger || !out) return 0;
+        return ((BankLedger*)ledger)->getVelocityLimits(out);
+    }
+
+    // Bulk import from a CSV (format = 1) or NDJSON (format = 2) file; 0 = detect
+    DLL_EXPORT int importTransactionsFromFile(void* ledger, const char* path, int format,
+                                              int threads, ImportReport* out) {
+        TRACE_SPAN("ffi.importTransactionsFromFile");
+        LedgerGuard guard(ledger);
+        if (!ledger || !path || !out) {
+            setMessage("Error: Invalid import parameters.");
+            return 0;
+        }
+
+        BankLedger* bank = (BankLedger*)ledger;
+        if (!importFile(*bank, path, (ImportFormat)format, threads, *out)) {
+            setMessage("Error: Cannot open import file.");
+            return 0;
+        }
+
+        setMessage("Imported " + std::to_string(out->rowsApplied) + " transactions, "
+                   + std::to_string(out->rowsRejected) + " rejected.");
+        return 1;
+    }
+
+    // Reconcile against a bank statement file (import formats, 0 = detect).
+    // windowSeconds <= 0 uses the default; reportPath (optional) receives the
+    // missing and extra rows as CSV.
+    DLL_EXPORT int reconcileStatement(void* ledger, const char* path, int format, long long windowSeconds,
+                                      int threads, const char* reportPath, ReconcileReport* out) {
+        TRACE_SPAN("ffi.reconcileStatement");
+        LedgerGuard guard(ledger);
+        if (!ledger || !path || !out) {
+            setMessage("Error: Invalid reconcile parameters.");
+            return 0;
+        }
+
+        Timestamp window = windowSeconds > 0 ? secondsToTimestamp(windowSeconds) : RECONCILE_DEFAULT_WINDOW;
+        ReconcileResult result;
+        if (!reconcileFile(*(BankLedger*)ledger, path, (ImportFormat)format, window, threads, result)) {
+            setMessage("Error: Cannot open statement file.");
+            return 0;
+        }
+        *out = result.report;
+
+        if (reportPath && *reportPath && !writeReconcileCsv(reportPath, result)) {
+            setMessage("Error: Cannot write reconciliation report.");
+            return 0;
+        }
+
+        setMessage(std::to_string(out->matched) + " matched, " + std::to_string(out->missing)
+                   + " missing from the ledger, " + std::to_string(out->extra) + " not on the statement.");
+        return 1;
+    }
+
+    // Export the statement to a file: format 0 = CSV, 1 = JSON lines, 2 = binary
+    DLL_EXPORT long long exportStatement(void* ledger, const char* path, int format) {
+        TRACE_SPAN("ffi.exportStatement");
+        LedgerGuard guard(ledger);
+        if (!ledger || !path) {
+            setMessage("Error: Invalid export parameters.");
+            return -1;
+        }
+
+        BankLedger* bank = (BankLedger*)ledger;
+        long long rows = exportToFile(*bank->getTransactionList(), path, (ExportFormat)format);
+        if (rows < 0) {
+            setMessage("Error: Export failed.");
+            return -1;
+        }
+
+        setMessage("Exported " + std::to_string(rows) + " transactions.");
+        return rows;
+    }
+
+    // Audit: re-verify the hash chain over transaction IDs [fromID, toID]
+    DLL_EXPORT int verifyTransactionRange(void* ledger, int fromID, int toID) {
+        TRACE_SPAN("ffi.verifyTransactionRange");
+        LedgerGuard guard(ledger);
+        if (!ledger) {
+            setMessage("Error: Ledger not found.");
+            return 0;
+        }
+
+        BankLedger* bank = (BankLedger*)ledger;
+        if (!bank->verifyHistory(fromID, toID)) {
+            setMessage("Verification FAILED or range is empty.");
+            return 0;
+        }
+
+        setMessage("History verified: hash chain intact.");
+        return 1;
+    }
+
+    // Audit root ("merkleRoot:head" in hex) for auditors to record
+    DLL_EXPORT const char* getAuditRoot(void* ledger) {
+        TRACE_SPAN("ffi.getAuditRoot");
+        LedgerGuard guard(ledger);
+        static std::string rootBuffer;
+        rootBuffer = ledger ? ((BankLedger*)ledger)->getAuditRoot() : "";
+        return rootBuffer.c_str();
+    }
+
+    // Ledger summary as of a time in microseconds since the epoch (disputes). Returns 1 on success.
+    DLL_EXPORT int getLedgerStateAt(void* ledger, long long asOf, LedgerStateAt* out) {
+        TRACE_SPAN("ffi.getLedgerStateAt");
+        LedgerGuard guard(ledger);
+        if (!ledger || !out) {
+            setMessage("Error: Ledger not found.");
+            return 0;
+        }
+
+        BankLedger* l = (BankLedger*)ledger;
+        if (!l->getStateAt(asOf, *out)) {
+            setMessage(l->getEventLog() ? "Error: Cannot read archived history."
+                                        : "Point-in-time history is not kept by this ledger.");
+            return 0;
+        }
+        return 1;
+    }
+
+    // Move cold history into segment files under `directory`, keeping at
+    // least hotLimit postings in memory. Returns 1 on success.
+    DLL_EXPORT int enableHistoryArchive(void* ledger, const char* directory, int hotLimit) {
+        TRACE_SPAN("ffi.enableHistoryArchive");
+        LedgerGuard guard(ledger);
+        if (!ledger || !directory) {
+            setMessage("Error: Ledger not found.");
+            return 0;
+        }
+
+        BankLedger* bank = (BankLedger*)ledger;
+        if (!bank->enableArchive(directory, hotLimit)) {
+            setMessage("Error: Could not enable archive in " + std::string(directory));
+            return 0;
+        }
+
+        setMessage("History archive enabled (" + std::to_string(bank->getArchivedCount()) +
+                   " transactions archived).");
+        return 1;
+    }
+
+    // Clock for new postings: 0 = coarse OS time, 1 = precise OS time,
+    // 2 = fake (start, start + step, ...; microseconds) for reproducible tests
+    DLL_EXPORT int setLedgerClock(void* ledger, int kind, long long start, long long step) {
+        TRACE_SPAN("ffi.setLedgerClock");
+        LedgerGuard guard(ledger);
+        if (!ledger) {
+            setMessage("Error: Ledger not found.");
+            return 0;
+        }
+
+        ((BankLedger*)ledger)->setClock(makeClock(kind, start, step));
+        return 1;
+    }
+
+    // Scheduler for future-dated and recurring postings into any number of ledgers
+    DLL_EXPORT void* createScheduler() {
+        return new FfiScheduler();
+    }
+
+    DLL_EXPORT void deleteScheduler(void* scheduler) {
+        delete (FfiScheduler*)scheduler;
+    }
+
+    // Clock read by runDueSchedules(scheduler, 0); same kinds as setLedgerClock
+    DLL_EXPORT int setSchedulerClock(void* scheduler, int kind, long long start, long long step) {
+        FfiScheduler* s = (FfiScheduler*)scheduler;
+        if (!s) return 0;
+        std::lock_guard<std::mutex> guard(s->lock);
+        s->schedules.setClock(makeClock(kind, start, step));
+        return 1;
+    }
+
+    // Post `amount` into ledger at firstDueUs, then per `repeat` (0 = once,
+    // 1 = every `every` microseconds, 2 = every `every` months), `count`
+    // times in total (0 = until cancelled). Returns the schedule ID, 0 on error.
+    DLL_EXPORT int addSchedule(void* scheduler, void* ledger, int kind, double amount,
+                               const char* description, long long firstDueUs, int repeat,
+                               long long every, int count) {
+        TRACE_SPAN("ffi.addSchedule");
+        FfiScheduler* s = (FfiScheduler*)scheduler;
+        unsigned long long serial = ledger ? ledgerSerial(ledger) : 0;
+        if (!s || !ledger || !description || serial == 0) {
+            setMessage("Error: Invalid schedule parameters.");
+            return 0;
+        }
+
+        std::lock_guard<std::mutex> guard(s->lock);
+        auto it = s->accounts.find(serial);
+        if (it == s->accounts.end()) {
+            it = s->accounts.emplace(serial, (int)s->ledgers.size()).first;
+            s->ledgers.push_back(FfiAccount{ledger, serial});
+        }
+
+        ScheduleSpec spec;
+        spec.account = it->second;
+        spec.kind = kind;
+        spec.amount = amount;
+        spec.firstDue = firstDueUs;
+        spec.repeat = repeat;
+        spec.every = every;
+        spec.count = count;
+        int id = s->schedules.add(spec, std::string(description));
+        if (id == 0) setMessage("Error: Invalid schedule parameters.");
+        return id;
+    }
+
+    DLL_EXPORT int cancelSchedule(void* scheduler, int scheduleID) {
+        FfiScheduler* s = (FfiScheduler*)scheduler;
+        if (!s) return 0;
+        std::lock_guard<std::mutex> guard(s->lock);
+        return s->schedules.cancel(scheduleID) ? 1 : 0;
+    }
+
+    // Post every occurrence due by nowUs (0 = the scheduler clock), catching
+    // up missed ones in due order with their due timestamps. Each is a live,
+    // undoable posting, checked like addWithdrawal (holds, velocity limits).
+    // Returns how many were posted; *rejected (optional) gets those refused,
+    // e.g. withdrawals beyond the available balance. Schedules into ledgers
+    // deleted since are cancelled.
+    DLL_EXPORT int runDueSchedules(void* scheduler, long long nowUs, int* rejected) {
+        TRACE_SPAN("ffi.runDueSchedules");
+        FfiScheduler* s = (FfiScheduler*)scheduler;
+        if (!s) return 0;
+
+        std::lock_guard<std::mutex> guard(s->lock);
+        Timestamp now = nowUs != 0 ? nowUs : s->schedules.now();
+        std::vector<int> orphaned;
+
+        ScheduleRunReport report = runDueSchedules(s->schedules, now, [&](const ScheduledPosting& p) {
+            const FfiAccount& account = s->ledgers[p.account];
+            LedgerGuard lock(account.ledger);
+            if (ledgerSerial(account.ledger) != account.serial) {
+                orphaned.push_back(p.scheduleID);
+                return false;
+            }
+            BankLedger* bank = (BankLedger*)account.ledger;
+            return bank->postAt(p.kind, p.amount, p.description, p.due) != 0;
+        });
+        for (int id : orphaned) s->schedules.cancel(id);
+
+        if (rejected) *rejected = report.rejected;
+        return report.posted;
+    }
+
+    // Earliest pending due time in microseconds, 0 when nothing is scheduled
+    DLL_EXPORT long long nextScheduledDue(void* scheduler) {
+        FfiScheduler* s = (FfiScheduler*)scheduler;
+        if (!s) return 0;
+        std::lock_guard<std::mutex> guard(s->lock);
+        Timestamp due = s->schedules.nextDue();
+        return due == INT64_MAX ? 0 : due;
+    }
+
+    // Latency histograms: fills OP_COUNT entries, returns how many (0 = disabled)
+    DLL_EXPORT int getLedgerMetrics(void* ledger, LedgerMetricsSnapshot* out) {
+        TRACE_SPAN("ffi.getLedgerMetrics");
+        LedgerGuard guard(ledger);
+        if (!ledger || !out) {
+            setMessage("Error: Ledger not found.");
+            return 0;
+        }
+
+        if (!((BankLedger*)ledger)->getMetrics(*out)) {
+            setMessage("Metrics are disabled in this build.");
+            return 0;
+        }
+        return OP_COUNT;
+    }
+
+    // Tracing: spans are only recorded while enabled (1) and the build has
+    // BANK_LEDGER_TRACING on
+    DLL_EXPORT int enableTracing(int enabled) {
+#if BANK_LEDGER_TRACING
+        setTracingEnabled(enabled != 0);
+        setMessage(enabled ? "Tracing enabled." : "Tracing disabled.");
+        return 1;
+#else
+        (void)enabled;
+        setMessage("Tracing is disabled in this build.");
+        return 0;
+#endif
+    }
+
+    DLL_EXPORT void clearTrace() {
+        clearTraceBuffers();
+    }
+
+    // Write recorded spans as Chrome trace_event JSON (disables tracing first)
+    DLL_EXPORT int exportChromeTrace(const char* path) {
+        if (!path) {
+            setMessage("Error: No output path.");
+            return 0;
+        }
+
+        setTracingEnabled(false);
+        if (!writeChromeTrace(path)) {
+            setMessage("Error: Cannot write trace file.");
+            return 0;
+        }
+
+        setMessage("Trace written.");
+        return 1;
+    }
+
+    // ===== Async API =====
+    // Each call queues the work on the native pool and returns a request id
+    // (0 = rejected). Completions are collected with pollCompletion /
+    // waitCompletion, and the request id is also posted to the completion
+    // port when one is registered. Async jobs never touch getLastMessage.
+    //
+    // Import parses and export encodes and writes without the ledger's guard;
+    // they hold it only to apply a parsed batch or to copy the history.
+    // Sort and verify work on the ledger's own rows and hold it throughout,
+    // so other calls on that ledger wait for them.
+
+    // Register a Dart NativePort: pass port.sendPort.nativePort and
+    // NativeApi.postCObject. port = 0 or a null function detaches.
+    DLL_EXPORT int setCompletionPort(long long port, void* postCObject) {
+        TRACE_SPAN("ffi.setCompletionPort");
+        PostCObjectFn fn = (port != 0) ? (PostCObjectFn)postCObject : nullptr;
+        asyncExecutor()->setCompletionPort(port, fn);
+        return 1;
+    }
+
+    DLL_EXPORT long long asyncSortTransactions(void* ledger, int byAmount) {
+        TRACE_SPAN("ffi.asyncSortTransactions");
+        if (!ledgerMutex(ledger)) return 0;
+
+        return asyncExecutor()->submit(ledger, [ledger, byAmount]() {
+            LedgerGuard guard(ledger);
+            BankLedger* bank = (BankLedger*)ledger;
+            if (byAmount) bank->sortByAmount();
+            else bank->sortByDate();
+            return AsyncResult{ 1, bank->getTransactionCount(),
+                                byAmount ? "Transactions sorted by amount." : "Transactions sorted by date." };
+        });
+    }
+
+    DLL_EXPORT long long asyncImportTransactionsFromFile(void* ledger, const char* path,
+                                                         int format, int threads) {
+        TRACE_SPAN("ffi.asyncImportTransactionsFromFile");
+        if (!ledgerMutex(ledger) || !path) return 0;
+
+        std::string file = path;
+        return asyncExecutor()->submit(ledger, [ledger, file, format, threads]() {
+            ImportReport report;
+            if (!importFile(*(BankLedger*)ledger, file, (ImportFormat)format, threads, report,
+                            ledgerMutex(ledger))) {
+                return AsyncResult{ 0, 0, "Error: Cannot open import file." };
+            }
+            return AsyncResult{ 1, report.rowsApplied,
+                                "Imported " + std::to_string(report.rowsApplied) + " transactions, "
+                                + std::to_string(report.rowsRejected) + " rejected." };
+        });
+    }
+
+    DLL_EXPORT long long asyncExportStatement(void* ledger, const char* path, int format) {
+        TRACE_SPAN("ffi.asyncExportStatement");
+        if (!ledgerMutex(ledger) || !path) return 0;
+
+        std::string file = path;
+        return asyncExecutor()->submit(ledger, [ledger, file, format]() {
+            long long rows = exportToFile(snapshotHistory(ledger), file, (ExportFormat)format);
+            if (rows < 0) return AsyncResult{ 0, -1, "Error: Export failed." };
+            return AsyncResult{ 1, rows, "Exported " + std::to_string(rows) + " transactions." };
+        });
+    }
+
+    DLL_EXPORT long long asyncVerifyTransactionRange(void* ledger, int fromID, int toID) {
+        TRACE_SPAN("ffi.asyncVerifyTransactionRange");
+        if (!ledgerMutex(ledger)) return 0;
+
+        return asyncExecutor()->submit(ledger, [ledger, fromID, toID]() {
+            LedgerGuard guard(ledger);
+            if (!((BankLedger*)ledger)->verifyHistory(fromID, toID)) {
+                return AsyncResult{ 0, 0, "Verification FAILED or range is empty." };
+            }
+            return AsyncResult{ 1, 1, "History verified: hash chain intact." };
+        });
+    }
+
+    // Oldest finished request, if any (1 = filled in, 0 = nothing ready)
+    DLL_EXPORT int pollCompletion(AsyncCompletion* out) {
+        if (!out) return 0;
+        return asyncExecutor()->poll(*out) ? 1 : 0;
+    }
+
+    // Completion of one request; timeoutMs -1 waits forever, 0 only checks
+    DLL_EXPORT int waitCompletion(long long requestId, int timeoutMs, AsyncCompletion* out) {
+        TRACE_SPAN("ffi.waitCompletion");
+        if (!out || requestId <= 0) return 0;
+        return asyncExecutor()->take(requestId, timeoutMs, *out) ? 1 : 0;
+    }
+
     // Get last message
     DLL_EXPORT const char* getLastMessage() {
+        TRACE_SPAN("ffi.getLastMessage");
         return lastMessage.c_str();
     }
 
@@ -0,0 +1,177 @@
+#include "../include/hash_chain.h"
+#include <cstring>
+
+// Internal Merkle node: H(0x01 || left || right)
+static Digest hashNode(const Digest& left, const Digest& right) {
+    static const unsigned char tag = 0x01;
+    Sha256 h;
+    h.update(&tag, 1);
+    h.update(left.bytes, 32);
+    h.update(right.bytes, 32);
+    return h.finish();
+}
+
+HashChain::HashChain() {
+    head = Digest::zero();
+    count = 0;
+    levels.resize(1);
+}
+
+Digest HashChain::hashPosting(const Digest& previous, const Transaction& t) {
+    // Canonical little-endian encoding of the posting
+    unsigned char fixed[4 + 1 + 8 + 8 + 8 + 4];
+    int32_t id = t.id;
+    unsigned char kind = (t.type == "WITHDRAWAL") ? 1 : 0;
+    int64_t ts = (int64_t)t.timestamp;
+    uint32_t len = (uint32_t)t.description.size();
+
+    unsigned char* p = fixed;
+    memcpy(p, &id, 4);             p += 4;
+    *p++ = kind;
+    memcpy(p, &t.amount, 8);       p += 8;
+    memcpy(p, &ts, 8);             p += 8;
+    memcpy(p, &t.balanceAfter, 8); p += 8;
+    memcpy(p, &len, 4);
+
+    Sha256 h;
+    h.update(previous.bytes, 32);
+    h.update(fixed, sizeof(fixed));
+    h.update(t.description.data(), len);
+    return h.finish();
+}
+
+void HashChain::append(Transaction& t) {
+    head = hashPosting(head, t);
+    t.chainHash = head;
+    count++;
+
+    if (count % CHECKPOINT_INTERVAL == 0) {
+        pushCheckpoint(head);
+    }
+}
+
+void HashChain::rollback(const Digest& previous) {
+    if (count == 0) return;
+
+    if (count % CHECKPOINT_INTERVAL == 0) {
+        popCheckpoint();
+    }
+
+    count--;
+    head = (count == 0) ? Digest::zero() : previous;
+}
+
+// ===== Merkle tree over checkpoints =====
+
+void HashChain::pushCheckpoint(const Digest& d) {
+    levels[0].push_back(d);
+
+    // Every completed pair produces a parent one level up
+    size_t j = 0;
+    while (levels[j].size() % 2 == 0) {
+        size_t n = levels[j].size();
+        Digest parent = hashNode(levels[j][n - 2], levels[j][n - 1]);
+        if (levels.size() <= j + 1) levels.resize(j + 2);
+        levels[j + 1].push_back(parent);
+        j++;
+    }
+}
+
+void HashChain::popCheckpoint() {
+    if (levels[0].empty()) return;
+
+    size_t idx = levels[0].size() - 1;
+    levels[0].pop_back();
+
+    // A right child's parent was created with it; remove the parents too
+    size_t j = 0;
+    while (idx % 2 == 1) {
+        levels[j + 1].pop_back();
+        idx /= 2;
+        j++;
+    }
+}
+
+Digest HashChain::root() const {
+    size_t n = levels[0].size();
+    if (n == 0) return Digest::zero();
+
+    // Bag the peaks, right (small) to left (large)
+    bool first = true;
+    Digest acc = Digest::zero();
+    for (size_t j = 0; (n >> j) != 0; j++) {
+        if (((n >> j) & 1) == 0) continue;
+        const Digest& peak = levels[j][(n >> j) - 1];
+        acc = first ? peak : hashNode(peak, acc);
+        first = false;
+    }
+    return acc;
+}
+
+bool HashChain::checkpointIsProven(size_t index) const {
+    if (index >= levels[0].size()) return false;
+
+    // Climb the audit path until the node has no complete sibling (its peak)
+    Digest node = levels[0][index];
+    size_t idx = index;
+    size_t j = 0;
+    while (j + 1 < levels.size() && idx / 2 < levels[j + 1].size()) {
+        size_t sibling = idx ^ 1;
+        node = (idx % 2 == 0) ? hashNode(node, levels[j][sibling])
+                              : hashNode(levels[j][sibling], node);
+        idx /= 2;
+        j++;
+    }
+
+    // The peaks determine root(), so matching the stored peak proves inclusion
+    return node == levels[j][idx];
+}
+
+// ===== Range verification =====
+
+bool HashChain::verify(Transaction* const* postings, size_t total, size_t first, size_t last,
+                       size_t base) const {
+    if (total != count || first > last || last >= total) return false;
+
+    size_t pos = (first / CHECKPOINT_INTERVAL) * CHECKPOINT_INTERVAL;
+    size_t endPos = (last / CHECKPOINT_INTERVAL + 1) * CHECKPOINT_INTERVAL - 1;
+    if (endPos >= total) endPos = total - 1;
+    if (pos < base) return false;
+
+    return verifyBlocks(postings + (pos - base), pos, endPos - pos + 1, true);
+}
+
+bool HashChain::verifyBlocks(Transaction* const* rows, size_t firstPos, size_t n,
+                             bool compareStored) const {
+    if (n == 0 || firstPos % CHECKPOINT_INTERVAL != 0 || firstPos + n > count) return false;
+
+    // Start from the (proven) checkpoint preceding the range
+    size_t startBlock = firstPos / CHECKPOINT_INTERVAL;
+    Digest prev = Digest::zero();
+    if (startBlock > 0) {
+        if (!checkpointIsProven(startBlock - 1)) return false;
+        prev = levels[0][startBlock - 1];
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        size_t pos = firstPos + i;
+        Digest c = hashPosting(prev, *rows[i]);
+        if (compareStored && c != rows[i]->chainHash) return false;
+
+        if ((pos + 1) % CHECKPOINT_INTERVAL == 0) {
+            size_t cp = pos / CHECKPOINT_INTERVAL;
+            if (levels[0][cp] != c || !checkpointIsProven(cp)) return false;
+        }
+        prev = c;
+    }
+
+    size_t end = firstPos + n;
+    if (end == count) {
+        // Range reaches the newest posting: must match the live head
+        if (prev != head) return false;
+    } else if (!compareStored && end % CHECKPOINT_INTERVAL != 0) {
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,65 @@
+#include "../include/history_cursor.h"
+#include "../include/aggregation.h"
+#include "../include/archive.h"
+#include <cstring>
+
+HistoryCursor makeHistoryCursor(const HistoryFilter& filter, int chunkSize) {
+    HistoryCursor c;
+    c.filter = filter;
+    if (c.filter.typeMask == 0) c.filter.typeMask = AGG_ALL;
+    c.nextID = filter.fromID > 0 ? filter.fromID : 1;
+    c.chunkSize = chunkSize > 0 ? chunkSize : 1;
+    c.done = false;
+    return c;
+}
+
+bool matchesFilter(const Transaction& t, const HistoryFilter& f) {
+    int mask = (t.type == "WITHDRAWAL") ? AGG_WITHDRAWALS : AGG_DEPOSITS;
+    if (!(f.typeMask & mask)) return false;
+    if (f.fromTs != 0 && t.timestamp < f.fromTs) return false;
+    if (f.toTs != 0 && t.timestamp > f.toTs) return false;
+    if (f.minAmount != 0.0 && t.amount < f.minAmount) return false;
+    if (f.maxAmount != 0.0 && t.amount > f.maxAmount) return false;
+    return true;
+}
+
+bool segmentMayMatch(const SegmentInfo& s, const HistoryFilter& f) {
+    if (f.fromTs != 0 && s.maxTimestamp < f.fromTs) return false;
+    if (f.toTs != 0 && s.minTimestamp > f.toTs) return false;
+
+    // Amount bounds per type, from the summary
+    bool deposits = (f.typeMask & AGG_DEPOSITS) && s.depositCount > 0 &&
+                    (f.minAmount == 0.0 || s.maxDeposit >= f.minAmount) &&
+                    (f.maxAmount == 0.0 || s.minDeposit <= f.maxAmount);
+    bool withdrawals = (f.typeMask & AGG_WITHDRAWALS) && s.withdrawalCount > 0 &&
+                       (f.minAmount == 0.0 || s.maxWithdrawal >= f.minAmount) &&
+                       (f.maxAmount == 0.0 || s.minWithdrawal <= f.maxAmount);
+    return deposits || withdrawals;
+}
+
+void fillRecord(const Transaction& t, TransactionRecord& out) {
+    out.id = t.id;
+    out.kind = (t.type == "WITHDRAWAL") ? KIND_WITHDRAWAL : KIND_DEPOSIT;
+    out.amount = t.amount;
+    out.balanceAfter = t.balanceAfter;
+    out.timestamp = t.timestamp;
+    fillDescription(t.description, out);
+}
+
+size_t recordDescriptionLength(const char* description, size_t length) {
+    size_t n = length;
+    if (n > RECORD_DESCRIPTION_SIZE - 1) {
+        n = RECORD_DESCRIPTION_SIZE - 1;
+        // Don't cut a UTF-8 sequence in half
+        while (n > 0 && ((unsigned char)description[n] & 0xC0) == 0x80) n--;
+    }
+    return n;
+}
+
+void fillDescription(const std::string& description, TransactionRecord& out) {
+    out.descriptionLength = (int)description.size();
+
+    size_t n = recordDescriptionLength(description.data(), description.size());
+    memcpy(out.description, description.data(), n);
+    out.description[n] = '\0';
+}
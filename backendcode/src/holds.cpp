@@ -0,0 +1,61 @@
+#include "../include/holds.h"
+
+HoldBook::HoldBook() : wheel(0, HOLD_TICK) {
+    nextID = 1;
+}
+
+int HoldBook::place(double amount, const std::string& description, Timestamp now, Timestamp expiresAt) {
+    // An empty wheel follows the caller's clock, wherever it starts
+    if (active.empty()) wheel.restart(now);
+
+    int id = nextID++;
+    Hold& h = active[id];
+    h.amount = amount;
+    h.description = description;
+    h.createdAt = now;
+    h.expiresAt = expiresAt;
+    h.timer = wheel.schedule(expiresAt, id);
+    return id;
+}
+
+bool HoldBook::take(int id, double& amount, std::string& description) {
+    auto it = active.find(id);
+    if (it == active.end()) return false;
+
+    wheel.cancel(it->second.timer);
+    amount = it->second.amount;
+    description = it->second.description;
+    active.erase(it);
+    return true;
+}
+
+void HoldBook::expire(Timestamp now, std::vector<HoldRecord>& expired) {
+    fired.clear();
+    wheel.advance(now, fired);
+
+    for (int id : fired) {
+        auto it = active.find(id);
+        if (it == active.end()) continue;
+
+        HoldRecord r;
+        r.id = id;
+        r.state = HOLD_EXPIRED;
+        r.amount = it->second.amount;
+        r.createdAt = it->second.createdAt;
+        r.expiresAt = it->second.expiresAt;
+        expired.push_back(r);
+        active.erase(it);
+    }
+}
+
+bool HoldBook::get(int id, HoldRecord& out) const {
+    auto it = active.find(id);
+    if (it == active.end()) return false;
+
+    out.id = id;
+    out.state = HOLD_ACTIVE;
+    out.amount = it->second.amount;
+    out.createdAt = it->second.createdAt;
+    out.expiresAt = it->second.expiresAt;
+    return true;
+}
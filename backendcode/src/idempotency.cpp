@@ -0,0 +1,94 @@
+#include "../include/idempotency.h"
+#include <algorithm>
+#include <climits>
+
+#define UNSTARTED INT64_MIN
+
+IdempotencyIndex::IdempotencyIndex(Timestamp window) {
+    this->window = window > 0 ? window : IDEMPOTENCY_WINDOW;
+    current = 0;
+    gens[0].startedAt = UNSTARTED;
+    gens[1].startedAt = UNSTARTED;
+}
+
+uint64_t IdempotencyIndex::hash(const std::string& key) {
+    // FNV-1a, then a splitmix64 finalizer so every bit depends on every byte
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+// Probe i is h1 + i * h2 (double hashing)
+bool IdempotencyIndex::mayContain(const Generation& g, uint64_t h) {
+    if (g.bloom.empty()) return false;
+    uint32_t h1 = (uint32_t)h;
+    uint32_t h2 = (uint32_t)(h >> 32) | 1;
+    for (int i = 0; i < IDEMPOTENCY_BLOOM_PROBES; i++) {
+        uint32_t bit = (h1 + (uint32_t)i * h2) & (IDEMPOTENCY_BLOOM_BITS - 1);
+        if (!(g.bloom[bit >> 6] & (1ULL << (bit & 63)))) return false;
+    }
+    return true;
+}
+
+void IdempotencyIndex::add(Generation& g, uint64_t h) {
+    if (g.bloom.empty()) g.bloom.assign(IDEMPOTENCY_BLOOM_BITS / 64, 0);
+    uint32_t h1 = (uint32_t)h;
+    uint32_t h2 = (uint32_t)(h >> 32) | 1;
+    for (int i = 0; i < IDEMPOTENCY_BLOOM_PROBES; i++) {
+        uint32_t bit = (h1 + (uint32_t)i * h2) & (IDEMPOTENCY_BLOOM_BITS - 1);
+        g.bloom[bit >> 6] |= 1ULL << (bit & 63);
+    }
+}
+
+static void clearGeneration(std::vector<uint64_t>& bloom, std::unordered_map<std::string, int>& ids) {
+    std::fill(bloom.begin(), bloom.end(), 0);
+    ids.clear();
+}
+
+void IdempotencyIndex::rotate(Timestamp now) {
+    Generation& cur = gens[current];
+    if (cur.startedAt == UNSTARTED) {
+        cur.startedAt = now;
+        return;
+    }
+    if (now - cur.startedAt < window) return;
+
+    Generation& older = gens[1 - current];
+    clearGeneration(older.bloom, older.ids);
+    if (now - cur.startedAt >= 2 * window) {
+        // Idle for two windows: everything has expired
+        clearGeneration(cur.bloom, cur.ids);
+        older.startedAt = now;
+    } else {
+        older.startedAt = cur.startedAt + window;
+    }
+    current = 1 - current;
+}
+
+int IdempotencyIndex::find(const std::string& key, Timestamp now) {
+    rotate(now);
+    uint64_t h = hash(key);
+
+    for (int i = 0; i < 2; i++) {
+        const Generation& g = gens[(current + i) & 1];
+        if (!mayContain(g, h)) continue;
+        auto it = g.ids.find(key);
+        if (it != g.ids.end()) return it->second;
+    }
+    return 0;
+}
+
+void IdempotencyIndex::remember(const std::string& key, int transactionID, Timestamp now) {
+    rotate(now);
+    Generation& g = gens[current];
+    add(g, hash(key));
+    g.ids[key] = transactionID;
+}
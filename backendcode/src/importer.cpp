@@ -0,0 +1,531 @@
+#include "../include/importer.h"
+#include "../include/bank_ledger.h"
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Bytes parsed per batch; bounds the memory held in parsed rows
+static const size_t BATCH_BYTES = 16u << 20;
+
+// ===== Field helpers =====
+
+static const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    return p;
+}
+
+static const char* trimRight(const char* begin, const char* end) {
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) end--;
+    return end;
+}
+
+static bool equalsIgnoreCase(const char* begin, const char* end, const char* word) {
+    size_t n = strlen(word);
+    if ((size_t)(end - begin) != n) return false;
+    for (size_t i = 0; i < n; i++) {
+        char c = begin[i];
+        if (c >= 'a' && c <= 'z') c = (char)(c - 'a' + 'A');
+        if (c != word[i]) return false;
+    }
+    return true;
+}
+
+static bool parseKind(const char* begin, const char* end, unsigned char& kind) {
+    if (equalsIgnoreCase(begin, end, "DEPOSIT") || equalsIgnoreCase(begin, end, "D")) {
+        kind = KIND_DEPOSIT;
+        return true;
+    }
+    if (equalsIgnoreCase(begin, end, "WITHDRAWAL") || equalsIgnoreCase(begin, end, "W")) {
+        kind = KIND_WITHDRAWAL;
+        return true;
+    }
+    return false;
+}
+
+static bool parseDouble(const char* begin, const char* end, double& value) {
+    begin = skipSpaces(begin, end);
+    end = trimRight(begin, end);
+    if (begin == end) return false;
+    std::from_chars_result r = std::from_chars(begin, end, value);
+    // from_chars also takes "nan" and "inf", which are no amount
+    return r.ec == std::errc() && r.ptr == end && std::isfinite(value);
+}
+
+// Unix seconds with an optional fraction ("1700000000" or "1700000000.25"),
+// to microseconds. Digits past the sixth decimal are dropped.
+static bool parseTimestamp(const char* begin, const char* end, Timestamp& value) {
+    begin = skipSpaces(begin, end);
+    end = trimRight(begin, end);
+    if (begin == end) return false;
+
+    bool negative = (*begin == '-');
+    const char* p = negative ? begin + 1 : begin;
+    uint64_t seconds;
+    std::from_chars_result r = std::from_chars(p, end, seconds);
+    if (r.ec != std::errc()) return false;
+    p = r.ptr;
+
+    uint64_t micros = 0;
+    if (p < end && *p == '.') {
+        p++;
+        uint64_t scale = MICROS_PER_SECOND;
+        while (p < end && *p >= '0' && *p <= '9') {
+            scale /= 10;
+            micros += (uint64_t)(*p - '0') * scale;
+            p++;
+        }
+    }
+    if (p != end || seconds > (uint64_t)(INT64_MAX / MICROS_PER_SECOND) - 1) return false;
+
+    int64_t magnitude = (int64_t)(seconds * MICROS_PER_SECOND + micros);
+    value = negative ? -magnitude : magnitude;
+    return true;
+}
+
+// ===== CSV =====
+
+// Read one CSV field starting at p. Unquoted fields are returned as a view into
+// the line; "quoted ""fields""" are unescaped into scratch. Returns the delimiter position.
+static const char* readCsvField(const char* p, const char* end, std::string& scratch,
+                                const char*& fieldBegin, const char*& fieldEnd) {
+    p = skipSpaces(p, end);
+
+    if (p < end && *p == '"') {
+        p++;
+        scratch.clear();
+        while (p < end) {
+            if (*p == '"') {
+                if (p + 1 < end && p[1] == '"') {
+                    scratch.push_back('"');
+                    p += 2;
+                    continue;
+                }
+                p++;
+                break;
+            }
+            scratch.push_back(*p++);
+        }
+        fieldBegin = scratch.data();
+        fieldEnd = scratch.data() + scratch.size();
+        while (p < end && *p != ',') p++;
+        return p;
+    }
+
+    const char* start = p;
+    while (p < end && *p != ',') p++;
+    fieldBegin = start;
+    fieldEnd = trimRight(start, p);
+    return p;
+}
+
+bool parseCsvLine(const char* begin, const char* end, ImportRow& row) {
+    end = trimRight(begin, end);
+    thread_local std::string scratch;
+    const char* fb;
+    const char* fe;
+
+    // type
+    const char* p = readCsvField(begin, end, scratch, fb, fe);
+    if (!parseKind(fb, fe, row.kind) || p >= end) return false;
+
+    // amount
+    p = readCsvField(p + 1, end, scratch, fb, fe);
+    if (!parseDouble(fb, fe, row.amount) || p >= end) return false;
+
+    // description
+    p = readCsvField(p + 1, end, scratch, fb, fe);
+    row.description.assign(fb, fe);
+
+    // optional timestamp
+    row.timestamp = 0;
+    if (p < end) {
+        p = readCsvField(p + 1, end, scratch, fb, fe);
+        if (!parseTimestamp(fb, fe, row.timestamp) || p < end) return false;
+    }
+
+    return true;
+}
+
+// ===== NDJSON =====
+
+static void appendUtf8(std::string& out, unsigned cp) {
+    if (cp < 0x80) {
+        out.push_back((char)cp);
+    } else if (cp < 0x800) {
+        out.push_back((char)(0xC0 | (cp >> 6)));
+        out.push_back((char)(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back((char)(0xE0 | (cp >> 12)));
+        out.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back((char)(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back((char)(0xF0 | (cp >> 18)));
+        out.push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back((char)(0x80 | (cp & 0x3F)));
+    }
+}
+
+static bool readHex4(const char* p, const char* end, unsigned& cp) {
+    if (end - p < 4) return false;
+    cp = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        cp <<= 4;
+        if (c >= '0' && c <= '9') cp |= (unsigned)(c - '0');
+        else if (c >= 'a' && c <= 'f') cp |= (unsigned)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') cp |= (unsigned)(c - 'A' + 10);
+        else return false;
+    }
+    return true;
+}
+
+// p points at the opening quote; returns pointer past the closing quote or nullptr
+static const char* readJsonString(const char* p, const char* end, std::string& out) {
+    out.clear();
+    p++;
+    while (p < end) {
+        char c = *p++;
+        if (c == '"') return p;
+        if (c != '\\') {
+            out.push_back(c);
+            continue;
+        }
+        if (p >= end) return nullptr;
+        char e = *p++;
+        switch (e) {
+            case '"': out.push_back('"'); break;
+            case '\\': out.push_back('\\'); break;
+            case '/': out.push_back('/'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                unsigned cp;
+                if (!readHex4(p, end, cp)) return nullptr;
+                p += 4;
+                // Surrogate pair
+                if (cp >= 0xD800 && cp <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                    unsigned lo;
+                    if (readHex4(p + 2, end, lo) && lo >= 0xDC00 && lo <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                        p += 6;
+                    }
+                }
+                appendUtf8(out, cp);
+                break;
+            }
+            default:
+                return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+static const char* skipWs(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    return p;
+}
+
+bool parseNdjsonLine(const char* begin, const char* end, ImportRow& row) {
+    const char* p = skipWs(begin, end);
+    if (p >= end || *p != '{') return false;
+    p++;
+
+    bool haveType = false, haveAmount = false;
+    row.timestamp = 0;
+    row.description.clear();
+    thread_local std::string key;
+    thread_local std::string text;
+
+    p = skipWs(p, end);
+    if (p < end && *p == '}') return false;
+
+    while (p < end) {
+        p = skipWs(p, end);
+        if (p >= end || *p != '"') return false;
+        p = readJsonString(p, end, key);
+        if (!p) return false;
+
+        p = skipWs(p, end);
+        if (p >= end || *p != ':') return false;
+        p = skipWs(p + 1, end);
+        if (p >= end) return false;
+
+        if (*p == '"') {
+            p = readJsonString(p, end, text);
+            if (!p) return false;
+
+            if (key == "type") {
+                if (!parseKind(text.data(), text.data() + text.size(), row.kind)) return false;
+                haveType = true;
+            } else if (key == "description") {
+                row.description.swap(text);
+            }
+        } else {
+            // Number or literal: runs until the next delimiter
+            const char* v = p;
+            while (p < end && *p != ',' && *p != '}') p++;
+            const char* ve = trimRight(v, p);
+
+            if (key == "amount") {
+                if (!parseDouble(v, ve, row.amount)) return false;
+                haveAmount = true;
+            } else if (key == "timestamp") {
+                if (!parseTimestamp(v, ve, row.timestamp)) return false;
+            } else if (*v == '{' || *v == '[') {
+                return false;   // nested values are not part of the format
+            }
+        }
+
+        p = skipWs(p, end);
+        if (p >= end) return false;
+        if (*p == '}') break;
+        if (*p != ',') return false;
+        p++;
+    }
+
+    return haveType && haveAmount;
+}
+
+// ===== Parallel batch parsing =====
+
+struct ParsedSlice {
+    std::vector<ImportRow> rows;
+    long long lines;
+    long long rejected;
+};
+
+static bool isBlank(const char* begin, const char* end) {
+    for (const char* p = begin; p < end; p++) {
+        if (*p != ' ' && *p != '\t' && *p != '\r') return false;
+    }
+    return true;
+}
+
+static void parseSlice(const char* begin, const char* end, ImportFormat format, ParsedSlice& out) {
+    TRACE_SPAN("import.parseSlice");
+
+    out.rows.clear();
+    out.lines = 0;
+    out.rejected = 0;
+
+    // Rough row estimate keeps vector growth off the hot path
+    out.rows.reserve((size_t)(end - begin) / 32 + 1);
+
+    const char* p = begin;
+    ImportRow row;
+    while (p < end) {
+        const char* nl = (const char*)memchr(p, '\n', (size_t)(end - p));
+        const char* lineEnd = nl ? nl : end;
+
+        if (!isBlank(p, lineEnd)) {
+            out.lines++;
+            bool ok = (format == IMPORT_NDJSON) ? parseNdjsonLine(p, lineEnd, row)
+                                                : parseCsvLine(p, lineEnd, row);
+            if (ok) out.rows.push_back(std::move(row));
+            else out.rejected++;
+        }
+
+        p = nl ? nl + 1 : end;
+    }
+}
+
+// Move `pos` forward to just past the next newline (or to `end`)
+static size_t alignToLine(const char* data, size_t pos, size_t end) {
+    if (pos >= end) return end;
+    const char* nl = (const char*)memchr(data + pos, '\n', end - pos);
+    return nl ? (size_t)(nl - data) + 1 : end;
+}
+
+// Split one batch into per-thread slices and parse them concurrently
+static void parseBatch(const char* data, size_t begin, size_t end, ImportFormat format,
+                       std::vector<ParsedSlice>& slices) {
+    TRACE_SPAN("import.parseBatch");
+    size_t threads = slices.size();
+    size_t span = (end - begin) / threads + 1;
+    std::vector<std::thread> workers;
+
+    size_t start = begin;
+    for (size_t i = 0; i < threads; i++) {
+        size_t stop = (i + 1 == threads) ? end : alignToLine(data, std::min(start + span, end), end);
+
+        // Last slice runs on the calling thread
+        if (i + 1 == threads) parseSlice(data + start, data + stop, format, slices[i]);
+        else workers.emplace_back(parseSlice, data + start, data + stop, format, std::ref(slices[i]));
+
+        start = stop;
+    }
+
+    for (std::thread& w : workers) w.join();
+}
+
+void streamRows(const char* data, size_t length, ImportFormat format, int threads,
+                const ImportRowSink& sink, long long& lines, long long& rejected) {
+    lines = rejected = 0;
+
+    size_t pos = 0;
+    const char* first = skipWs(data, data + length);
+    if (format == IMPORT_AUTO) {
+        format = (first < data + length && *first == '{') ? IMPORT_NDJSON : IMPORT_CSV;
+    }
+
+    // Skip a CSV header row ("type,amount,...")
+    if (format == IMPORT_CSV && first + 4 <= data + length && equalsIgnoreCase(first, first + 4, "TYPE")) {
+        pos = alignToLine(data, (size_t)(first - data), length);
+    }
+
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+
+    // Double-buffered: parse batch k+1 on the workers while the sink takes batch k
+    std::vector<ParsedSlice> current(threads), next(threads);
+    size_t batchEnd = alignToLine(data, std::min(pos + BATCH_BYTES, length), length);
+    parseBatch(data, pos, batchEnd, format, current);
+    pos = batchEnd;
+
+    while (true) {
+        std::thread prefetch;
+        bool more = pos < length;
+        if (more) {
+            batchEnd = alignToLine(data, std::min(pos + BATCH_BYTES, length), length);
+            prefetch = std::thread(parseBatch, data, pos, batchEnd, format, std::ref(next));
+            pos = batchEnd;
+        }
+
+        {
+            TRACE_SPAN("import.sinkBatch");
+            for (ParsedSlice& slice : current) {
+                lines += slice.lines;
+                rejected += slice.rejected;
+                sink(slice.rows);
+            }
+        }
+
+        if (!more) break;
+        {
+            TRACE_SPAN("import.waitPrefetch");
+            prefetch.join();
+        }
+        current.swap(next);
+    }
+}
+
+ImportReport importBuffer(BankLedger& ledger, const char* data, size_t length,
+                          ImportFormat format, int threads, std::mutex* applyLock) {
+    ImportReport report;
+    report.rowsRead = report.rowsApplied = report.rowsRejected = 0;
+    report.seconds = report.rowsPerSecond = 0.0;
+
+    auto started = std::chrono::steady_clock::now();
+
+    // A lock that may be absent
+    auto hold = [applyLock]() {
+        return applyLock ? std::unique_lock<std::mutex>(*applyLock) : std::unique_lock<std::mutex>();
+    };
+
+    // Imported history replaces what can be undone
+    {
+        auto guard = hold();
+        ledger.clearUndoHistory();
+    }
+
+    long long applied = 0, failed = 0;
+    streamRows(data, length, format, threads, [&](std::vector<ImportRow>& rows) {
+        TRACE_SPAN("import.applyBatch");
+        auto guard = hold();
+        for (const ImportRow& row : rows) {
+            if (ledger.postImported(row.kind, row.amount, row.description, row.timestamp)) applied++;
+            else failed++;
+        }
+    }, report.rowsRead, report.rowsRejected);
+    report.rowsApplied = applied;
+    report.rowsRejected += failed;
+
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    report.rowsPerSecond = report.seconds > 0 ? report.rowsRead / report.seconds : 0.0;
+    return report;
+}
+
+// ===== File mapping =====
+
+bool withFileContents(const std::string& path, const std::function<void(const char*, size_t)>& fn) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        fn("", 0);
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const char* data = mapping ? (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!data) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fn(data, (size_t)size.QuadPart);
+
+    UnmapViewOfFile(data);
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return true;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        fn("", 0);
+        return true;
+    }
+
+    void* map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+    fn((const char*)map, (size_t)st.st_size);
+
+    munmap(map, (size_t)st.st_size);
+    return true;
+#endif
+}
+
+bool importFile(BankLedger& ledger, const std::string& path, ImportFormat format,
+                int threads, ImportReport& report, std::mutex* applyLock) {
+    return withFileContents(path, [&](const char* data, size_t length) {
+        report = importBuffer(ledger, data, length, format, threads, applyLock);
+    });
+}
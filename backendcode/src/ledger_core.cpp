@@ -0,0 +1,5 @@
+#include "../include/ledger_core.h"
+
+// Alternative stock policies, compiled once so every build checks them
+template class BasicLedger<EmbeddedLedgerPolicy>;
+template class BasicLedger<ConcurrentLedgerPolicy>;
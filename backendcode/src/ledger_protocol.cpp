@@ -0,0 +1,40 @@
+#include "../include/ledger_protocol.h"
+#include <cstring>
+
+void appendFrame(std::string& out, unsigned char opcode, unsigned char status, uint32_t tag,
+                 const void* payload, uint32_t length) {
+    char header[PROTOCOL_HEADER_SIZE];
+    uint16_t reserved = 0;
+    memcpy(header, &length, 4);
+    header[4] = (char)opcode;
+    header[5] = (char)status;
+    memcpy(header + 6, &reserved, 2);
+    memcpy(header + 8, &tag, 4);
+
+    out.append(header, PROTOCOL_HEADER_SIZE);
+    if (length > 0) out.append((const char*)payload, length);
+}
+
+void appendPostingRequest(std::string& out, unsigned char opcode, uint32_t tag,
+                          double amount, const std::string& description) {
+    char payload[PROTOCOL_MAX_PAYLOAD];
+    size_t len = description.size();
+    if (len > PROTOCOL_MAX_PAYLOAD - 10) len = PROTOCOL_MAX_PAYLOAD - 10;
+
+    uint16_t descLength = (uint16_t)len;
+    memcpy(payload, &amount, 8);
+    memcpy(payload + 8, &descLength, 2);
+    memcpy(payload + 10, description.data(), len);
+
+    appendFrame(out, opcode, 0, tag, payload, (uint32_t)(10 + len));
+}
+
+bool readFrameHeader(const char* data, size_t size, FrameHeader& out) {
+    if (size < PROTOCOL_HEADER_SIZE) return false;
+
+    memcpy(&out.length, data, 4);
+    out.opcode = (unsigned char)data[4];
+    out.status = (unsigned char)data[5];
+    memcpy(&out.tag, data + 8, 4);
+    return true;
+}
@@ -0,0 +1,357 @@
+#include "../include/ledger_server.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define MAX_EVENTS 256
+#define READ_CHUNK 65536
+
+static bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static size_t backlog(const std::string& out, size_t flushed) {
+    return out.size() - flushed;
+}
+
+// Payload of a deposit/withdrawal; false if malformed
+static bool parsePosting(const FrameHeader& h, const char* payload, PostingRequest& r) {
+    uint16_t descLength;
+    if (h.length < 10) return false;
+    memcpy(&r.amount, payload, 8);
+    memcpy(&descLength, payload + 8, 2);
+    if (10u + descLength != h.length) return false;
+
+    r.kind = (h.opcode == REQ_DEPOSIT) ? KIND_DEPOSIT : KIND_WITHDRAWAL;
+    r.description.assign(payload + 10, descLength);
+    return true;
+}
+
+LedgerServer::LedgerServer(BankLedger& ledger) : ledger(ledger) {
+    listenFd = -1;
+    epollFd = -1;
+    stopping = false;
+    memset(&stats, 0, sizeof(stats));
+    batchSize = 0;
+}
+
+LedgerServer::~LedgerServer() {
+    for (Connection* c : connections) {
+        ::close(c->fd);
+        delete c;
+    }
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        unlink(socketPath.c_str());
+    }
+    if (epollFd >= 0) ::close(epollFd);
+}
+
+bool LedgerServer::listen(const std::string& path) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) return false;
+
+    unlink(path.c_str());
+    if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+        ::listen(listenFd, SOMAXCONN) != 0 || !setNonBlocking(listenFd)) {
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    socketPath = path;
+
+    epollFd = epoll_create1(0);
+    if (epollFd < 0) return false;
+
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;     // nullptr = the listening socket
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev) == 0;
+}
+
+void LedgerServer::acceptClients() {
+    while (true) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) return;    // EAGAIN: no more pending
+        if (!setNonBlocking(fd)) {
+            ::close(fd);
+            continue;
+        }
+
+        Connection* c = new Connection();
+        c->fd = fd;
+        c->flushed = 0;
+        c->wantRead = true;
+        c->wantWrite = false;
+        c->closing = false;
+        c->active = false;
+        c->deferred = false;
+
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = c;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            ::close(fd);
+            delete c;
+            continue;
+        }
+        connections.push_back(c);
+        stats.connections++;
+    }
+}
+
+void LedgerServer::readAvailable(Connection* c) {
+    size_t budget = SERVER_READ_BUDGET;
+    while (budget > 0) {
+        size_t start = c->in.size();
+        size_t want = std::min((size_t)READ_CHUNK, budget);
+        c->in.resize(start + want);
+
+        ssize_t n = recv(c->fd, &c->in[start], want, 0);
+        if (n <= 0) {
+            c->in.resize(start);
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                c->closing = true;
+            }
+            return;
+        }
+
+        c->in.resize(start + (size_t)n);
+        stats.bytesIn += (uint64_t)n;
+        budget -= (size_t)n;
+        if ((size_t)n < want) return;
+    }
+}
+
+void LedgerServer::applyRequests(Connection* c) {
+    size_t pos = 0;
+    FrameHeader h;
+    const size_t postingResponse = PROTOCOL_HEADER_SIZE + 8;
+
+    c->deferred = false;
+    while (readFrameHeader(c->in.data() + pos, c->in.size() - pos, h)) {
+        if (h.length > PROTOCOL_MAX_PAYLOAD) {
+            // Can't resynchronize the stream: answer once, then hang up
+            applyBatch(c->out);
+            appendFrame(c->out, h.opcode, RESP_BAD_REQUEST, h.tag, nullptr, 0);
+            c->closing = true;
+            pos = c->in.size();
+            break;
+        }
+        if (c->in.size() - pos < PROTOCOL_HEADER_SIZE + h.length) break;
+
+        // Leave the rest until the client has read some of its answers
+        if (backlog(c->out, c->flushed) + batchSize * postingResponse >= SERVER_OUTPUT_LIMIT) {
+            c->deferred = true;
+            break;
+        }
+
+        const char* payload = c->in.data() + pos + PROTOCOL_HEADER_SIZE;
+        bool ok;
+        if (h.opcode == REQ_DEPOSIT || h.opcode == REQ_WITHDRAW) {
+            // Collected, and applied together once something else comes up
+            if (batch.size() == batchSize) batch.emplace_back();
+            ok = parsePosting(h, payload, batch[batchSize]);
+            if (ok) {
+                batchFrames.resize(batchSize + 1);
+                batchFrames[batchSize++] = h;
+            }
+        } else {
+            applyBatch(c->out);
+            ok = handle(h, payload, c->out);
+        }
+        pos += PROTOCOL_HEADER_SIZE + h.length;
+        stats.requests++;
+
+        if (!ok) {
+            // Malformed: answer, then hang up without reading further
+            applyBatch(c->out);
+            appendFrame(c->out, h.opcode, RESP_BAD_REQUEST, h.tag, nullptr, 0);
+            c->closing = true;
+            pos = c->in.size();
+            break;
+        }
+    }
+    applyBatch(c->out);
+
+    c->in.erase(0, pos);
+}
+
+void LedgerServer::applyBatch(std::string& out) {
+    if (batchSize == 0) return;
+
+    batchResults.resize(batchSize);
+    ledger.postBatch(batch.data(), (int)batchSize, batchResults.data());
+    for (size_t i = 0; i < batchSize; i++) {
+        const FrameHeader& h = batchFrames[i];
+        unsigned char status = batchResults[i].id != 0 ? RESP_OK : RESP_REJECTED;
+        appendFrame(out, h.opcode, status, h.tag, &batchResults[i].balance, 8);
+    }
+    batchSize = 0;
+}
+
+// Everything but postings (applyBatch). False if the request is malformed;
+// nothing is appended then.
+bool LedgerServer::handle(const FrameHeader& h, const char* payload, std::string& out) {
+    unsigned char status = RESP_OK;
+    double balance;
+
+    switch (h.opcode) {
+        case REQ_UNDO:
+            if (!ledger.canUndo()) status = RESP_REJECTED;
+            else ledger.undo();
+            balance = ledger.getBalance();
+            appendFrame(out, h.opcode, status, h.tag, &balance, 8);
+            return true;
+
+        case REQ_BALANCE:
+            balance = ledger.getBalance();
+            appendFrame(out, h.opcode, status, h.tag, &balance, 8);
+            return true;
+
+        case REQ_COUNT: {
+            int64_t count = ledger.getTransactionCount();
+            appendFrame(out, h.opcode, status, h.tag, &count, 8);
+            return true;
+        }
+
+        case REQ_AGGREGATE: {
+            int32_t typeMask;
+            int64_t fromTs, toTs;
+            if (h.length != 20) return false;
+            memcpy(&typeMask, payload, 4);
+            memcpy(&fromTs, payload + 4, 8);
+            memcpy(&toTs, payload + 12, 8);
+
+            AggregateResult r;
+            if (!ledger.aggregate(typeMask, fromTs, toTs, r)) status = RESP_REJECTED;
+            appendFrame(out, h.opcode, status, h.tag, &r, sizeof(r));
+            return true;
+        }
+
+        case REQ_VERIFY: {
+            int32_t fromID, toID;
+            if (h.length != 8) return false;
+            memcpy(&fromID, payload, 4);
+            memcpy(&toID, payload + 4, 4);
+
+            if (!ledger.verifyHistory(fromID, toID)) status = RESP_REJECTED;
+            appendFrame(out, h.opcode, status, h.tag, nullptr, 0);
+            return true;
+        }
+    }
+    return false;
+}
+
+void LedgerServer::flush(Connection* c) {
+    while (c->flushed < c->out.size()) {
+        ssize_t n = send(c->fd, c->out.data() + c->flushed, c->out.size() - c->flushed, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) c->closing = true;
+            break;
+        }
+        c->flushed += (size_t)n;
+        stats.bytesOut += (uint64_t)n;
+    }
+
+    if (c->flushed == c->out.size()) {
+        c->out.clear();
+        c->flushed = 0;
+    }
+}
+
+// Ask for input only while the output backlog is under the limit, and for
+// EPOLLOUT only while the socket buffer is full
+void LedgerServer::watch(Connection* c) {
+    if (c->closing) return;
+
+    bool reading = backlog(c->out, c->flushed) < SERVER_OUTPUT_LIMIT;
+    bool writing = c->flushed < c->out.size();
+    if (reading == c->wantRead && writing == c->wantWrite) return;
+
+    epoll_event ev;
+    ev.events = (reading ? (uint32_t)EPOLLIN : 0u) | (writing ? (uint32_t)EPOLLOUT : 0u);
+    ev.data.ptr = c;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, c->fd, &ev);
+    c->wantRead = reading;
+    c->wantWrite = writing;
+}
+
+void LedgerServer::closeConnection(Connection* c) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, c->fd, nullptr);
+    ::close(c->fd);
+    connections.erase(std::find(connections.begin(), connections.end(), c));
+    delete c;
+}
+
+void LedgerServer::run() {
+    epoll_event events[MAX_EVENTS];
+    std::vector<Connection*> round, carried;
+
+    while (!stopping.load(std::memory_order_relaxed)) {
+        // Short timeout so stop() from a signal handler is noticed promptly;
+        // none if deferred requests can go ahead now
+        int n = epoll_wait(epollFd, events, MAX_EVENTS, carried.empty() ? 200 : 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        // 1. Drain every ready socket, plus connections whose deferred
+        // requests fit under the output limit again
+        round.swap(carried);
+        carried.clear();
+        for (Connection* c : round) c->active = true;
+        for (int i = 0; i < n; i++) {
+            Connection* c = (Connection*)events[i].data.ptr;
+            if (c == nullptr) {
+                acceptClients();
+                continue;
+            }
+
+            if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) &&
+                backlog(c->out, c->flushed) < SERVER_OUTPUT_LIMIT) {
+                readAvailable(c);
+            }
+            if (!c->active) {
+                c->active = true;
+                round.push_back(c);
+            }
+        }
+
+        // 2. Apply all complete requests of this round back to back
+        bool applied = false;
+        for (Connection* c : round) {
+            if (!c->in.empty()) {
+                applyRequests(c);
+                applied = true;
+            }
+        }
+        if (applied) stats.rounds++;
+
+        // 3. One write per connection, then retire closed ones
+        for (Connection* c : round) {
+            c->active = false;
+            if (!c->out.empty()) flush(c);
+            if (c->closing) {
+                closeConnection(c);
+                continue;
+            }
+            watch(c);
+            if (c->deferred && backlog(c->out, c->flushed) < SERVER_OUTPUT_LIMIT) carried.push_back(c);
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#include "../include/ledger_stats.h"
+
+static LedgerStats emptyStats(double balance) {
+    LedgerStats s;
+    s.depositTotal = 0.0;
+    s.withdrawalTotal = 0.0;
+    s.depositCount = 0;
+    s.withdrawalCount = 0;
+    s.largestTransaction = 0.0;
+    s.largestTransactionID = 0;
+    s.minBalance = balance;
+    s.maxBalance = balance;
+    return s;
+}
+
+LedgerStatsTracker::LedgerStatsTracker(double initialBalance, int undoDepth) {
+    total = emptyStats(initialBalance);
+    maxJournal = undoDepth > 0 ? (size_t)undoDepth : 0;
+    journal.resize(maxJournal);
+    journalHead = 0;
+    journalCount = 0;
+}
+
+void LedgerStatsTracker::apply(LedgerStats& s, int id, bool isWithdrawal,
+                               double amount, double balanceAfter) {
+    if (isWithdrawal) {
+        s.withdrawalTotal += amount;
+        s.withdrawalCount++;
+    } else {
+        s.depositTotal += amount;
+        s.depositCount++;
+    }
+
+    if (amount > s.largestTransaction) {
+        s.largestTransaction = amount;
+        s.largestTransactionID = id;
+    }
+    if (balanceAfter < s.minBalance) s.minBalance = balanceAfter;
+    if (balanceAfter > s.maxBalance) s.maxBalance = balanceAfter;
+}
+
+void LedgerStatsTracker::record(int id, bool isWithdrawal, double amount,
+                                Timestamp timestamp, double balanceAfter, bool undoable) {
+    int dk = dayKey(timestamp);
+    int mk = monthKey(timestamp);
+
+    if (undoable && maxJournal > 0) {
+        // Keep the journal exactly as deep as the undo stack: when full the
+        // oldest entry sits in the head slot and is overwritten
+        JournalEntry& e = journal[journalHead];
+        journalHead = (journalHead + 1) % maxJournal;
+        if (journalCount < maxJournal) journalCount++;
+
+        e.prevTotal = total;
+        e.dayKey = dk;
+        e.monthKey = mk;
+
+        auto d = days.find(dk);
+        e.dayExisted = (d != days.end());
+        if (e.dayExisted) e.prevDay = d->second;
+
+        auto m = months.find(mk);
+        e.monthExisted = (m != months.end());
+        if (e.monthExisted) e.prevMonth = m->second;
+    }
+
+    apply(total, id, isWithdrawal, amount, balanceAfter);
+
+    // A new bucket starts its balance range at the first posting in it
+    auto d = days.emplace(dk, emptyStats(balanceAfter)).first;
+    apply(d->second, id, isWithdrawal, amount, balanceAfter);
+
+    auto m = months.emplace(mk, emptyStats(balanceAfter)).first;
+    apply(m->second, id, isWithdrawal, amount, balanceAfter);
+}
+
+void LedgerStatsTracker::revert() {
+    if (journalCount == 0) return;
+
+    journalHead = (journalHead + maxJournal - 1) % maxJournal;
+    journalCount--;
+    const JournalEntry& e = journal[journalHead];
+
+    total = e.prevTotal;
+
+    if (e.dayExisted) days[e.dayKey] = e.prevDay;
+    else days.erase(e.dayKey);
+
+    if (e.monthExisted) months[e.monthKey] = e.prevMonth;
+    else months.erase(e.monthKey);
+}
+
+bool LedgerStatsTracker::getBucket(StatsBucket bucket, Timestamp timestamp, LedgerStats& out) const {
+    const std::unordered_map<int, LedgerStats>& map = (bucket == BUCKET_DAY) ? days : months;
+    int key = (bucket == BUCKET_DAY) ? dayKey(timestamp) : monthKey(timestamp);
+
+    auto it = map.find(key);
+    if (it == map.end()) return false;
+
+    out = it->second;
+    return true;
+}
+
+// ===== Calendar keys =====
+
+int LedgerStatsTracker::dayKey(Timestamp timestamp) {
+    // Floor division so pre-1970 timestamps land in the right day
+    int64_t d = timestamp / MICROS_PER_DAY;
+    if (timestamp % MICROS_PER_DAY < 0) d--;
+    return (int)d;
+}
+
+int LedgerStatsTracker::monthKey(Timestamp timestamp) {
+    // Civil-from-days conversion (proleptic Gregorian), no gmtime() call
+    int64_t z = dayKey(timestamp) + 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t y = yoe + era * 400;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    int64_t m = mp < 10 ? mp + 3 : mp - 9;
+    if (m <= 2) y++;
+
+    return (int)(y * 12 + (m - 1));
+}
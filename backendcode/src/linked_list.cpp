@@ -55,6 +55,63 @@ Transaction* LinkedList::removeLast() {
     return t;
 }
 
+Transaction* LinkedList::removeByID(int id) {
+    if (head == nullptr) {
+        return nullptr;
+    }
+
+    // Fast path: newest posting is still at the tail (list not re-sorted)
+    if (tail->data->id == id) {
+        return removeLast();
+    }
+
+    Node* prev = nullptr;
+    Node* current = head;
+    while (current != nullptr && current->data->id != id) {
+        prev = current;
+        current = current->next;
+    }
+
+    if (current == nullptr) {
+        return nullptr;
+    }
+
+    Transaction* t = current->data;
+    if (prev == nullptr) {
+        head = current->next;
+    } else {
+        prev->next = current->next;
+    }
+
+    delete current;   // Delete node ONLY
+    count--;
+    return t;
+}
+
+int LinkedList::discardBefore(int id) {
+    int removed = 0;
+    Node* prev = nullptr;
+    Node* current = head;
+
+    while (current != nullptr) {
+        Node* next = current->next;
+        if (current->data->id < id) {
+            if (prev == nullptr) head = next;
+            else prev->next = next;
+            delete current->data;
+            delete current;
+            removed++;
+        } else {
+            prev = current;
+        }
+        current = next;
+    }
+
+    tail = prev;
+    count -= removed;
+    return removed;
+}
+
 void LinkedList::display() {
     if (head == nullptr) {
         std::cout << "No transactions found.\n";
@@ -92,20 +149,23 @@ Node* LinkedList::getMiddle(Node* h) {
 }
 
 Node* LinkedList::merge(Node* left, Node* right, bool (*compare)(Transaction*, Transaction*)) {
-    if (left == nullptr) return right;
-    if (right == nullptr) return left;
-
-    Node* result = nullptr;
-
-    if (compare(left->data, right->data)) {
-        result = left;
-        result->next = merge(left->next, right, compare);
-    } else {
-        result = right;
-        result->next = merge(left, right->next, compare);
+    // Iterative merge: recursion depth would grow with list length
+    Node dummy(nullptr);
+    Node* tailNode = &dummy;
+
+    while (left != nullptr && right != nullptr) {
+        if (compare(left->data, right->data)) {
+            tailNode->next = left;
+            left = left->next;
+        } else {
+            tailNode->next = right;
+            right = right->next;
+        }
+        tailNode = tailNode->next;
     }
 
-    return result;
+    tailNode->next = (left != nullptr) ? left : right;
+    return dummy.next;
 }
 
 Node* LinkedList::mergeSort(Node* h, bool (*compare)(Transaction*, Transaction*)) {
@@ -137,8 +197,6 @@ void LinkedList::sortByDate() {
 
     head = mergeSort(head, compareByDate);
     updateTail();
-
-    std::cout << "Transactions sorted by date.\n";
 }
 
 void LinkedList::sortByAmount() {
@@ -146,8 +204,6 @@ void LinkedList::sortByAmount() {
 
     head = mergeSort(head, compareByAmount);
     updateTail();
-
-    std::cout << "Transactions sorted by amount.\n";
 }
 
 // ===== Array Conversion =====
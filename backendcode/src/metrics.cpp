@@ -0,0 +1,230 @@
+#include "../include/metrics.h"
+#include <sstream>
+#include <iomanip>
+#include <limits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static const char* OP_NAMES[OP_COUNT] = {
+    "deposit", "withdraw", "undo", "sortByDate", "sortByAmount",
+    "searchByID", "aggregate", "importRow", "verifyHistory",
+    "stateAt", "multiGet", "readHistory",
+    "placeHold", "settleHold", "query"
+};
+
+const char* ledgerOpName(int op) {
+    if (op < 0 || op >= OP_COUNT) return "unknown";
+    return OP_NAMES[op];
+}
+
+// ===== Histogram layout =====
+
+static int highestBit(uint64_t v) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return (int)index;
+#else
+    return 63 - __builtin_clzll(v);
+#endif
+}
+
+int histogramBucket(uint64_t ns) {
+    if (ns < HIST_LINEAR) return (int)ns;
+
+    int shift = highestBit(ns) - HIST_SUB_BITS;
+    if (shift > HIST_MAX_SHIFT) return HIST_BUCKETS - 1;
+
+    int mantissa = (int)(ns >> shift);    // 16..31
+    return HIST_LINEAR + (shift - 1) * 16 + (mantissa - 16);
+}
+
+uint64_t histogramBucketLow(int bucket) {
+    if (bucket < HIST_LINEAR) return (uint64_t)bucket;
+
+    int shift = (bucket - HIST_LINEAR) / 16 + 1;
+    uint64_t mantissa = (uint64_t)((bucket - HIST_LINEAR) % 16 + 16);
+    return mantissa << shift;
+}
+
+static double bucketMidpoint(int bucket) {
+    if (bucket < HIST_LINEAR) return (double)bucket;
+    int shift = (bucket - HIST_LINEAR) / 16 + 1;
+    return (double)histogramBucketLow(bucket) + (double)(1ULL << shift) / 2.0;
+}
+
+// ===== Shards =====
+
+LedgerMetrics::Shard::Shard() {
+    for (int op = 0; op < OP_COUNT; op++) {
+        for (int b = 0; b < HIST_BUCKETS; b++) {
+            counts[op][b].store(0, std::memory_order_relaxed);
+        }
+        total[op].store(0, std::memory_order_relaxed);
+        minNs[op].store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+        maxNs[op].store(0, std::memory_order_relaxed);
+    }
+    next = nullptr;
+    owner = std::this_thread::get_id();
+}
+
+static std::atomic<uint64_t> nextInstanceID(1);
+
+LedgerMetrics::LedgerMetrics() : shards(nullptr) {
+    instanceID = nextInstanceID.fetch_add(1, std::memory_order_relaxed);
+}
+
+LedgerMetrics::~LedgerMetrics() {
+    Shard* s = shards.load(std::memory_order_acquire);
+    while (s != nullptr) {
+        Shard* next = s->next;
+        delete s;
+        s = next;
+    }
+}
+
+LedgerMetrics::Shard* LedgerMetrics::localShard() {
+    // Small per-thread cache: ledger instance -> this thread's shard
+    struct CacheEntry {
+        uint64_t id;
+        Shard* shard;
+    };
+    static const int CACHE_SIZE = 8;
+    thread_local CacheEntry cache[CACHE_SIZE] = {};
+    thread_local int nextSlot = 0;
+
+    for (int i = 0; i < CACHE_SIZE; i++) {
+        if (cache[i].id == instanceID) return cache[i].shard;
+    }
+
+    // Evicted from the cache (the thread rotates through many ledgers):
+    // find its shard on the list rather than starting another one
+    std::thread::id self = std::this_thread::get_id();
+    Shard* shard = nullptr;
+    for (Shard* s = shards.load(std::memory_order_acquire); s != nullptr; s = s->next) {
+        if (s->owner == self) {
+            shard = s;
+            break;
+        }
+    }
+
+    // First use on this thread: publish a new shard with a CAS push
+    if (shard == nullptr) {
+        shard = new Shard();
+        Shard* head = shards.load(std::memory_order_relaxed);
+        do {
+            shard->next = head;
+        } while (!shards.compare_exchange_weak(head, shard, std::memory_order_release,
+                                               std::memory_order_relaxed));
+    }
+
+    cache[nextSlot].id = instanceID;
+    cache[nextSlot].shard = shard;
+    nextSlot = (nextSlot + 1) % CACHE_SIZE;
+    return shard;
+}
+
+void LedgerMetrics::record(LedgerOp op, uint64_t ns) {
+    Shard* s = localShard();
+    int b = histogramBucket(ns);
+
+    // Single writer per shard: plain load + store, no locked instructions
+    s->counts[op][b].store(s->counts[op][b].load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+    s->total[op].store(s->total[op].load(std::memory_order_relaxed) + ns,
+                       std::memory_order_relaxed);
+    if (ns < s->minNs[op].load(std::memory_order_relaxed)) {
+        s->minNs[op].store(ns, std::memory_order_relaxed);
+    }
+    if (ns > s->maxNs[op].load(std::memory_order_relaxed)) {
+        s->maxNs[op].store(ns, std::memory_order_relaxed);
+    }
+}
+
+int LedgerMetrics::shardCount() const {
+    int n = 0;
+    for (Shard* s = shards.load(std::memory_order_acquire); s != nullptr; s = s->next) n++;
+    return n;
+}
+
+// ===== Merging =====
+
+void LedgerMetrics::snapshot(LedgerMetricsSnapshot& out) const {
+    const double quantiles[4] = { 0.50, 0.90, 0.99, 0.999 };
+
+    for (int op = 0; op < OP_COUNT; op++) {
+        OpMetrics& m = out.ops[op];
+        uint64_t count = 0, total = 0;
+        uint64_t minNs = std::numeric_limits<uint64_t>::max(), maxNs = 0;
+        uint64_t local[HIST_BUCKETS] = {};
+
+        for (Shard* s = shards.load(std::memory_order_acquire); s != nullptr; s = s->next) {
+            for (int b = 0; b < HIST_BUCKETS; b++) {
+                uint64_t c = s->counts[op][b].load(std::memory_order_relaxed);
+                local[b] += c;
+                count += c;
+            }
+            total += s->total[op].load(std::memory_order_relaxed);
+            uint64_t lo = s->minNs[op].load(std::memory_order_relaxed);
+            uint64_t hi = s->maxNs[op].load(std::memory_order_relaxed);
+            if (lo < minNs) minNs = lo;
+            if (hi > maxNs) maxNs = hi;
+        }
+
+        m.count = count;
+        m.totalNs = total;
+        m.minNs = count ? minNs : 0;
+        m.maxNs = maxNs;
+
+        double* targets[4] = { &m.p50Ns, &m.p90Ns, &m.p99Ns, &m.p999Ns };
+        for (int q = 0; q < 4; q++) {
+            *targets[q] = 0.0;
+            if (count == 0) continue;
+
+            uint64_t rank = (uint64_t)(quantiles[q] * (double)(count - 1)) + 1;
+            uint64_t seen = 0;
+            for (int b = 0; b < HIST_BUCKETS; b++) {
+                seen += local[b];
+                if (seen >= rank) {
+                    double v = bucketMidpoint(b);
+                    // Never report outside the observed range
+                    if (v > (double)maxNs) v = (double)maxNs;
+                    if (v < (double)m.minNs) v = (double)m.minNs;
+                    *targets[q] = v;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+std::string LedgerMetrics::dump() const {
+    LedgerMetricsSnapshot snap;
+    snapshot(snap);
+
+    std::ostringstream out;
+    out << std::left << std::setw(16) << "Operation" << std::right
+        << std::setw(10) << "Count"
+        << std::setw(12) << "Mean (us)"
+        << std::setw(12) << "p50 (us)"
+        << std::setw(12) << "p99 (us)"
+        << std::setw(12) << "p99.9 (us)"
+        << std::setw(12) << "Max (us)" << "\n";
+    out << std::fixed << std::setprecision(2);
+
+    for (int op = 0; op < OP_COUNT; op++) {
+        const OpMetrics& m = snap.ops[op];
+        if (m.count == 0) continue;
+
+        out << std::left << std::setw(16) << ledgerOpName(op) << std::right
+            << std::setw(10) << m.count
+            << std::setw(12) << (double)m.totalNs / m.count / 1000.0
+            << std::setw(12) << m.p50Ns / 1000.0
+            << std::setw(12) << m.p99Ns / 1000.0
+            << std::setw(12) << m.p999Ns / 1000.0
+            << std::setw(12) << m.maxNs / 1000.0 << "\n";
+    }
+    return out.str();
+}
@@ -0,0 +1,598 @@
+#include "../include/query.h"
+#include "../include/aggregation.h"
+#include "../include/archive.h"
+#include "../include/column_store.h"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// ===== Tokenizer =====
+
+enum TokenKind {
+    TOK_END,
+    TOK_WORD,        // keyword, field, number or unquoted date
+    TOK_STRING,      // quoted
+    TOK_OP,          // = != <> < <= > >= ~
+    TOK_COMMA,
+    TOK_STAR
+};
+
+struct Token {
+    TokenKind kind;
+    std::string text;
+    size_t pos;
+};
+
+static bool isWordChar(char c) {
+    return std::isalnum((unsigned char)c) || c == '_' || c == '.' || c == ':' || c == '-' || c == '$';
+}
+
+static bool tokenize(const std::string& s, std::vector<Token>& out, std::string& error) {
+    size_t i = 0;
+    while (i < s.size()) {
+        char c = s[i];
+        if (std::isspace((unsigned char)c)) {
+            i++;
+            continue;
+        }
+
+        Token t;
+        t.pos = i;
+        if (c == '"' || c == '\'') {
+            t.kind = TOK_STRING;
+            size_t j = i + 1;
+            while (j < s.size() && s[j] != c) {
+                if (s[j] == '\\' && j + 1 < s.size()) j++;
+                t.text += s[j++];
+            }
+            if (j >= s.size()) {
+                error = "unterminated string at position " + std::to_string(i + 1);
+                return false;
+            }
+            i = j + 1;
+        } else if (c == ',' || c == '*') {
+            t.kind = (c == ',') ? TOK_COMMA : TOK_STAR;
+            t.text = std::string(1, c);
+            i++;
+        } else if (c == '=' || c == '~') {
+            t.kind = TOK_OP;
+            t.text = std::string(1, c);
+            i++;
+        } else if (c == '<' || c == '>' || c == '!') {
+            t.kind = TOK_OP;
+            t.text = std::string(1, c);
+            i++;
+            if (i < s.size() && (s[i] == '=' || (c == '<' && s[i] == '>'))) t.text += s[i++];
+            if (t.text == "!") {
+                error = "expected != at position " + std::to_string(t.pos + 1);
+                return false;
+            }
+            if (t.text == "<>") t.text = "!=";
+        } else if (isWordChar(c)) {
+            t.kind = TOK_WORD;
+            while (i < s.size() && isWordChar(s[i])) t.text += s[i++];
+        } else {
+            error = std::string("unexpected '") + c + "' at position " + std::to_string(i + 1);
+            return false;
+        }
+        out.push_back(t);
+    }
+
+    Token end;
+    end.kind = TOK_END;
+    end.pos = s.size();
+    out.push_back(end);
+    return true;
+}
+
+// ASCII case folding inline: the locale-aware tolower is a call per byte
+static inline char foldCase(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+static std::string lower(const std::string& s) {
+    std::string out = s;
+    for (char& c : out) c = foldCase(c);
+    return out;
+}
+
+// ===== Literals =====
+
+static bool parseNumber(const std::string& text, double& value) {
+    std::string digits;
+    for (char c : text) {
+        if (c != '$' && c != ',') digits += c;
+    }
+    if (digits.empty()) return false;
+    char* end;
+    value = std::strtod(digits.c_str(), &end);
+    return *end == '\0' && std::isfinite(value);
+}
+
+static int64_t daysFromCivil(int64_t y, int64_t m, int64_t d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// Unix seconds, or YYYY-MM-DD with an optional Thh:mm[:ss] (UTC)
+static bool parseTime(const std::string& text, int64_t& value) {
+    int y, m, d, hh = 0, mm = 0, ss = 0;
+    char tail;
+    if (std::sscanf(text.c_str(), "%4d-%2d-%2d%c", &y, &m, &d, &tail) >= 3 && text.size() >= 10 &&
+        text[4] == '-') {
+        if (text.size() > 10) {
+            int n = std::sscanf(text.c_str() + 10, "T%2d:%2d:%2d", &hh, &mm, &ss);
+            if (n < 2 || hh > 23 || mm > 59 || ss > 60) return false;
+        }
+        if (m < 1 || m > 12 || d < 1 || d > 31) return false;
+        int64_t seconds = daysFromCivil(y, m, d) * 86400 + hh * 3600 + mm * 60 + ss;
+        value = seconds * MICROS_PER_SECOND;
+        return true;
+    }
+
+    double seconds;
+    if (!parseNumber(text, seconds) || std::fabs(seconds) > 9.0e12) return false;
+    value = (int64_t)std::llround(seconds * MICROS_PER_SECOND);
+    return true;
+}
+
+// ===== Parser =====
+
+struct Parser {
+    std::vector<Token> tokens;
+    size_t at;
+    std::string error;
+
+    const Token& peek() const { return tokens[at]; }
+
+    bool isWord(const char* word) const {
+        return peek().kind == TOK_WORD && lower(peek().text) == word;
+    }
+
+    bool fail(const std::string& what) {
+        error = what + " at position " + std::to_string(peek().pos + 1);
+        return false;
+    }
+};
+
+static bool fieldNamed(const std::string& name, QueryField& field) {
+    std::string n = lower(name);
+    if (n == "id") field = QF_ID;
+    else if (n == "type" || n == "kind") field = QF_TYPE;
+    else if (n == "amount") field = QF_AMOUNT;
+    else if (n == "balance") field = QF_BALANCE;
+    else if (n == "ts" || n == "time" || n == "timestamp" || n == "date") field = QF_TS;
+    else if (n == "desc" || n == "description") field = QF_DESC;
+    else return false;
+    return true;
+}
+
+static bool parseValue(Parser& p, QueryField field, QueryPredicate& pred, bool upper) {
+    const Token& t = p.peek();
+    if (t.kind != TOK_WORD && t.kind != TOK_STRING) return p.fail("expected a value");
+
+    int64_t i = 0;
+    double d = 0.0;
+    switch (field) {
+    case QF_TYPE: {
+        std::string n = lower(t.text);
+        if (n == "deposit") i = KIND_DEPOSIT;
+        else if (n == "withdrawal") i = KIND_WITHDRAWAL;
+        else return p.fail("expected DEPOSIT or WITHDRAWAL");
+        break;
+    }
+    case QF_TS:
+        if (!parseTime(t.text, i)) return p.fail("expected a date or Unix seconds");
+        break;
+    case QF_ID:
+        if (!parseNumber(t.text, d) || d != std::floor(d)) return p.fail("expected an integer");
+        i = (int64_t)d;
+        break;
+    case QF_DESC:
+        pred.text = t.text;
+        break;
+    default:
+        if (!parseNumber(t.text, d)) return p.fail("expected a number");
+        break;
+    }
+
+    if (upper) {
+        pred.hi = i;
+        pred.hiD = d;
+    } else {
+        pred.lo = pred.hi = i;
+        pred.loD = pred.hiD = d;
+    }
+    p.at++;
+    return true;
+}
+
+static bool isIntegerField(QueryField f) {
+    return f == QF_ID || f == QF_TYPE || f == QF_TS;
+}
+
+static bool parsePredicate(Parser& p, QueryPredicate& pred) {
+    if (p.peek().kind != TOK_WORD || !fieldNamed(p.peek().text, pred.field)) {
+        return p.fail("expected id, type, amount, balance, ts or desc");
+    }
+    p.at++;
+    pred.negate = false;
+    pred.contains = false;
+
+    if (p.isWord("between")) {
+        if (pred.field == QF_DESC || pred.field == QF_TYPE) return p.fail("BETWEEN needs a numeric field");
+        p.at++;
+        if (!parseValue(p, pred.field, pred, false)) return false;
+        if (!p.isWord("and")) return p.fail("expected AND");
+        p.at++;
+        return parseValue(p, pred.field, pred, true);
+    }
+
+    if (p.peek().kind != TOK_OP) return p.fail("expected a comparison");
+    std::string op = p.peek().text;
+    p.at++;
+
+    if (pred.field == QF_DESC) {
+        if (op != "~" && op != "=" && op != "!=") return p.fail("desc supports ~, = and !=");
+        if (!parseValue(p, pred.field, pred, false)) return false;
+        pred.contains = (op == "~");
+        pred.negate = (op == "!=");
+        if (pred.contains) pred.text = lower(pred.text);
+        return true;
+    }
+    if (op == "~") return p.fail("~ only applies to desc");
+    if (pred.field == QF_TYPE && op != "=" && op != "!=") return p.fail("type supports = and !=");
+    if (!parseValue(p, pred.field, pred, false)) return false;
+
+    // Every comparison becomes a closed range
+    int64_t v = pred.lo;
+    double dv = pred.loD;
+    if (op == "!=") {
+        pred.negate = true;
+    } else if (op == "<" || op == "<=") {
+        pred.lo = INT64_MIN;
+        pred.loD = -INFINITY;
+        if (op == "<") {
+            pred.hi = (v == INT64_MIN) ? v : v - 1;
+            pred.hiD = std::nextafter(dv, -INFINITY);
+        }
+    } else if (op == ">" || op == ">=") {
+        pred.hi = INT64_MAX;
+        pred.hiD = INFINITY;
+        if (op == ">") {
+            pred.lo = (v == INT64_MAX) ? v : v + 1;
+            pred.loD = std::nextafter(dv, INFINITY);
+        }
+    }
+    return true;
+}
+
+static bool parseQuery(Parser& p, CompiledQuery& out) {
+    out.predicates.clear();
+    out.projection = QUERY_ALL_FIELDS;
+    out.touched = 0;
+    out.idLo = out.tsLo = INT64_MIN;
+    out.idHi = out.tsHi = INT64_MAX;
+    out.typeMask = AGG_ALL;
+    out.amountLo = -INFINITY;
+    out.amountHi = INFINITY;
+    out.empty = false;
+
+    if (p.isWord("select")) {
+        p.at++;
+        if (p.peek().kind == TOK_STAR) {
+            p.at++;
+        } else {
+            out.projection = QUERY_WANT(QF_ID);
+            for (;;) {
+                QueryField f;
+                if (p.peek().kind != TOK_WORD || !fieldNamed(p.peek().text, f)) {
+                    return p.fail("expected a field name");
+                }
+                out.projection |= QUERY_WANT(f);
+                p.at++;
+                if (p.peek().kind != TOK_COMMA) break;
+                p.at++;
+            }
+        }
+        if (p.peek().kind != TOK_END) {
+            if (!p.isWord("where")) return p.fail("expected WHERE");
+            p.at++;
+        }
+    } else if (p.isWord("where")) {
+        p.at++;
+    }
+
+    // Non-negated ranges on the same column merge into one predicate
+    QueryPredicate merged[QF_COUNT];
+    bool hasMerged[QF_COUNT] = {};
+    std::vector<QueryPredicate> rest;
+
+    for (bool first = true; p.peek().kind != TOK_END; first = false) {
+        if (!first) {
+            if (!p.isWord("and")) return p.fail("expected AND");
+            p.at++;
+        }
+
+        QueryPredicate pred;
+        if (!parsePredicate(p, pred)) return false;
+
+        if (pred.negate || pred.field == QF_DESC) {
+            rest.push_back(pred);
+            continue;
+        }
+        QueryPredicate& m = merged[pred.field];
+        if (!hasMerged[pred.field]) {
+            m = pred;
+            hasMerged[pred.field] = true;
+        } else {
+            m.lo = std::max(m.lo, pred.lo);
+            m.hi = std::min(m.hi, pred.hi);
+            m.loD = std::max(m.loD, pred.loD);
+            m.hiD = std::min(m.hiD, pred.hiD);
+        }
+    }
+
+    for (int f = 0; f < QF_COUNT; f++) {
+        if (!hasMerged[f]) continue;
+        const QueryPredicate& m = merged[f];
+        if (isIntegerField((QueryField)f) ? m.lo > m.hi : !(m.loD <= m.hiD)) out.empty = true;
+    }
+    if (hasMerged[QF_ID]) {
+        out.idLo = merged[QF_ID].lo;
+        out.idHi = merged[QF_ID].hi;
+    }
+    if (hasMerged[QF_TS]) {
+        out.tsLo = merged[QF_TS].lo;
+        out.tsHi = merged[QF_TS].hi;
+    }
+    if (hasMerged[QF_TYPE]) {
+        out.typeMask = (merged[QF_TYPE].lo == KIND_WITHDRAWAL) ? AGG_WITHDRAWALS : AGG_DEPOSITS;
+    }
+    if (hasMerged[QF_AMOUNT]) {
+        out.amountLo = merged[QF_AMOUNT].loD;
+        out.amountHi = merged[QF_AMOUNT].hiD;
+    }
+
+    // Evaluation order: the ID range is applied by binary search, so it
+    // needs no predicate. Then type, time and amounts; descriptions last,
+    // since they are the only per-row string work.
+    static const QueryField order[] = { QF_TYPE, QF_TS, QF_AMOUNT, QF_BALANCE };
+    for (QueryField f : order) {
+        if (hasMerged[f]) out.predicates.push_back(merged[f]);
+    }
+    for (const QueryPredicate& r : rest) {
+        if (r.field != QF_DESC) out.predicates.push_back(r);
+    }
+    for (const QueryPredicate& r : rest) {
+        if (r.field == QF_DESC) out.predicates.push_back(r);
+    }
+    for (const QueryPredicate& q : out.predicates) out.touched |= QUERY_WANT(q.field);
+    return true;
+}
+
+bool compileQuery(const std::string& text, CompiledQuery& out, std::string& error) {
+    Parser p;
+    p.at = 0;
+    if (!tokenize(text, p.tokens, error)) return false;
+    if (!parseQuery(p, out)) {
+        error = p.error;
+        return false;
+    }
+    return true;
+}
+
+// ===== Execution =====
+
+static bool containsIgnoreCase(const std::string& haystack, const std::string& lowerNeedle) {
+    size_t m = lowerNeedle.size();
+    if (m == 0) return true;
+    if (haystack.size() < m) return false;
+
+    const char* h = haystack.data();
+    const char* n = lowerNeedle.data();
+    char first = n[0];
+    for (size_t i = 0, last = haystack.size() - m; i <= last; i++) {
+        if (foldCase(h[i]) != first) continue;
+        size_t k = 1;
+        while (k < m && foldCase(h[i + k]) == n[k]) k++;
+        if (k == m) return true;
+    }
+    return false;
+}
+
+static bool descriptionMatches(const std::string& d, const QueryPredicate& p) {
+    bool hit = p.contains ? containsIgnoreCase(d, p.text) : d == p.text;
+    return hit != p.negate;
+}
+
+// The first predicate of a batch scans it densely; later ones only revisit
+// the rows still selected. Both write branch-free: every row is stored and
+// the cursor only advances on a match.
+template <typename Test>
+static size_t selectDense(size_t begin, size_t stop, uint32_t* sel, Test test) {
+    size_t n = 0;
+    for (size_t i = begin; i < stop; i++) {
+        sel[n] = (uint32_t)i;
+        n += test(i) ? 1 : 0;
+    }
+    return n;
+}
+
+template <typename Test>
+static size_t selectRefine(uint32_t* sel, size_t n, Test test) {
+    size_t m = 0;
+    for (size_t k = 0; k < n; k++) {
+        uint32_t i = sel[k];
+        sel[m] = i;
+        m += test(i) ? 1 : 0;
+    }
+    return m;
+}
+
+template <typename Test>
+static size_t selectRows(bool dense, size_t begin, size_t stop, uint32_t* sel, size_t n, Test test) {
+    return dense ? selectDense(begin, stop, sel, test) : selectRefine(sel, n, test);
+}
+
+template <typename T>
+static size_t selectRange(const T* col, T lo, T hi, bool negate, bool dense, size_t begin, size_t stop,
+                          uint32_t* sel, size_t n) {
+    if (negate) {
+        return selectRows(dense, begin, stop, sel, n, [=](size_t i) { return (col[i] < lo) | (col[i] > hi); });
+    }
+    return selectRows(dense, begin, stop, sel, n, [=](size_t i) { return (col[i] >= lo) & (col[i] <= hi); });
+}
+
+QueryScan::QueryScan(const CompiledQuery& q, const QuerySource& source) : query(q), src(source) {
+    next = 0;
+    end = q.empty ? 0 : src.rows;
+    scanned = 0;
+
+    // IDs ascend, so the ID range is a slice found by binary search
+    if (end > 0 && src.ids && (q.idLo != INT64_MIN || q.idHi != INT64_MAX)) {
+        int lo = (int)std::max<int64_t>(q.idLo, INT_MIN);
+        int hi = (int)std::min<int64_t>(q.idHi, INT_MAX);
+        next = std::lower_bound(src.ids, src.ids + end, lo) - src.ids;
+        end = std::upper_bound(src.ids, src.ids + end, hi) - src.ids;
+        if (end < next) end = next;
+    }
+
+    // Dictionary-coded descriptions: decide each distinct string once
+    if (src.dictionary && (q.touched & QUERY_WANT(QF_DESC))) {
+        dictionaryMatch.resize(src.dictionary->size());
+        for (size_t e = 0; e < dictionaryMatch.size(); e++) {
+            bool ok = true;
+            for (const QueryPredicate& p : q.predicates) {
+                if (p.field == QF_DESC && !descriptionMatches((*src.dictionary)[e], p)) ok = false;
+            }
+            dictionaryMatch[e] = ok ? 1 : 0;
+        }
+    }
+}
+
+size_t QueryScan::filter(size_t begin, size_t stop, uint32_t* sel) const {
+    size_t n = 0;
+    bool dense = true;
+    bool dictionaryDone = false;
+
+    for (const QueryPredicate& p : query.predicates) {
+        switch (p.field) {
+        case QF_TYPE:
+            n = selectRange(src.kinds, (unsigned char)p.lo, (unsigned char)p.hi, p.negate, dense,
+                            begin, stop, sel, n);
+            break;
+        case QF_ID:
+            n = selectRange(src.ids, (int)std::max<int64_t>(p.lo, INT_MIN),
+                            (int)std::min<int64_t>(p.hi, INT_MAX), p.negate, dense, begin, stop, sel, n);
+            break;
+        case QF_TS:
+            n = selectRange(src.timestamps, p.lo, p.hi, p.negate, dense, begin, stop, sel, n);
+            break;
+        case QF_AMOUNT:
+            n = selectRange(src.amounts, p.loD, p.hiD, p.negate, dense, begin, stop, sel, n);
+            break;
+        case QF_BALANCE:
+            n = selectRange(src.balances, p.loD, p.hiD, p.negate, dense, begin, stop, sel, n);
+            break;
+        case QF_DESC:
+            if (src.dictionary) {
+                // Every desc predicate was folded into dictionaryMatch
+                if (dictionaryDone) continue;
+                dictionaryDone = true;
+                const unsigned char* match = dictionaryMatch.data();
+                const uint32_t* codes = src.descriptionIndex;
+                n = selectRows(dense, begin, stop, sel, n, [=](size_t i) { return match[codes[i]] != 0; });
+            } else {
+                Transaction* const* rows = src.postings;
+                n = selectRows(dense, begin, stop, sel, n,
+                           [&](size_t i) { return descriptionMatches(rows[i]->description, p); });
+            }
+            break;
+        default:
+            break;
+        }
+        dense = false;
+        if (n == 0) return 0;
+    }
+
+    if (dense) {
+        for (size_t i = begin; i < stop; i++) sel[n++] = (uint32_t)i;
+    }
+    return n;
+}
+
+size_t QueryScan::nextBatch(uint32_t* sel) {
+    while (next < end) {
+        size_t begin = next;
+        size_t stop = std::min(end, begin + QUERY_BATCH);
+        next = stop;
+        scanned += stop - begin;
+
+        size_t n = filter(begin, stop, sel);
+        if (n > 0) return n;
+    }
+    return 0;
+}
+
+void QueryScan::fill(uint32_t row, TransactionRecord& out) const {
+    memset(&out, 0, sizeof(TransactionRecord));
+    unsigned want = query.projection;
+
+    if (src.ids) out.id = src.ids[row];
+    if ((want & QUERY_WANT(QF_TYPE)) && src.kinds) out.kind = src.kinds[row];
+    if ((want & QUERY_WANT(QF_AMOUNT)) && src.amounts) out.amount = src.amounts[row];
+    if ((want & QUERY_WANT(QF_BALANCE)) && src.balances) out.balanceAfter = src.balances[row];
+    if ((want & QUERY_WANT(QF_TS)) && src.timestamps) out.timestamp = src.timestamps[row];
+    if (want & QUERY_WANT(QF_DESC)) {
+        if (src.dictionary) fillDescription((*src.dictionary)[src.descriptionIndex[row]], out);
+        else if (src.postings) fillDescription(src.postings[row]->description, out);
+    }
+}
+
+// ===== Archived segments =====
+
+bool querySegmentMayMatch(const CompiledQuery& q, const SegmentInfo& s) {
+    if (q.empty) return false;
+    if (s.lastID < q.idLo || s.firstID > q.idHi) return false;
+    if (s.maxTimestamp < q.tsLo || s.minTimestamp > q.tsHi) return false;
+
+    bool deposits = (q.typeMask & AGG_DEPOSITS) && s.depositCount > 0 &&
+                    s.maxDeposit >= q.amountLo && s.minDeposit <= q.amountHi;
+    bool withdrawals = (q.typeMask & AGG_WITHDRAWALS) && s.withdrawalCount > 0 &&
+                       s.maxWithdrawal >= q.amountLo && s.minWithdrawal <= q.amountHi;
+    return deposits || withdrawals;
+}
+
+unsigned querySegmentColumns(const CompiledQuery& q) {
+    static const int column[QF_COUNT] = { SEG_COL_IDS, SEG_COL_KINDS, SEG_COL_AMOUNTS,
+                                          SEG_COL_BALANCES, SEG_COL_TIMESTAMPS, SEG_COL_DESCRIPTIONS };
+    unsigned need = q.touched | q.projection;
+    unsigned bits = SEG_WANT(SEG_COL_IDS);
+    for (int f = 0; f < QF_COUNT; f++) {
+        if (need & QUERY_WANT(f)) bits |= SEG_WANT(column[f]);
+    }
+    return bits;
+}
+
+QuerySource segmentQuerySource(const SegmentColumns& cols) {
+    QuerySource src;
+    src.rows = cols.ids.size();
+    src.ids = cols.ids.empty() ? nullptr : cols.ids.data();
+    src.kinds = cols.kinds.empty() ? nullptr : cols.kinds.data();
+    src.amounts = cols.amounts.empty() ? nullptr : cols.amounts.data();
+    src.timestamps = cols.timestamps.empty() ? nullptr : cols.timestamps.data();
+    src.balances = cols.balances.empty() ? nullptr : cols.balances.data();
+    src.postings = nullptr;
+    src.descriptionIndex = cols.descriptions.empty() ? nullptr : cols.descriptions.data();
+    src.dictionary = cols.descriptions.empty() ? nullptr : &cols.dictionary;
+    return src;
+}
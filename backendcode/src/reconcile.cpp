@@ -0,0 +1,423 @@
+#include "../include/reconcile.h"
+#include "../include/bank_ledger.h"
+#include "../include/exporter.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+// Records per history chunk when reading the ledger side
+static const int LEDGER_CHUNK = 4096;
+
+// Entries per partition the partition count aims for (keeps a
+// partition's hash table and sort in cache)
+static const size_t PARTITION_TARGET = 1 << 15;
+
+// Parsed rows below which a slice is keyed on the calling thread
+static const size_t KEY_PARALLEL_MIN = 4096;
+
+// ===== Keys =====
+
+// One row on either side. The description lives in the side's text arena.
+struct ReconcileEntry {
+    uint64_t hash;               // kind, cents and description
+    int64_t cents;
+    Timestamp ts;
+    uint64_t text;               // offset into the arena
+    uint32_t length;
+    uint32_t row;                // statement row (0-based) or ledger ID
+    unsigned char kind;
+};
+
+struct ReconcileSide {
+    std::vector<ReconcileEntry> entries;
+    std::string arena;
+};
+
+static size_t normalizeInto(const char* begin, const char* end, std::string& arena) {
+    size_t start = arena.size();
+    arena.resize(start + (size_t)(end - begin));   // never grows
+    char* first = &arena[start];
+    char* o = first;
+    bool gap = false;
+    for (const char* p = begin; p < end; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 'A' && c <= 'Z') c = (unsigned char)(c - 'A' + 'a');
+        else if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80)) {
+            gap = true;
+            continue;
+        }
+        if (gap && o > first) *o++ = ' ';
+        gap = false;
+        *o++ = (char)c;
+    }
+    arena.resize(start + (size_t)(o - first));
+    return (size_t)(o - first);
+}
+
+std::string normalizeDescription(const char* begin, const char* end) {
+    std::string out;
+    normalizeInto(begin, end, out);
+    return out;
+}
+
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+static int64_t toCents(double amount) {
+    return (int64_t)std::llround(amount * 100.0);
+}
+
+// Normalize the description into the arena and key the entry
+static void addEntry(ReconcileSide& side, unsigned char kind, double amount, Timestamp ts,
+                     const char* desc, size_t length, uint32_t row) {
+    ReconcileEntry e;
+    e.text = side.arena.size();
+    e.length = (uint32_t)normalizeInto(desc, desc + length, side.arena);
+    e.cents = toCents(amount);
+    e.ts = ts;
+    e.row = row;
+    e.kind = kind;
+
+    uint64_t h = 0xcbf29ce484222325ULL;   // FNV-1a over the text
+    const unsigned char* p = (const unsigned char*)side.arena.data() + e.text;
+    for (uint32_t i = 0; i < e.length; i++) h = (h ^ p[i]) * 0x100000001b3ULL;
+    e.hash = mix64(h ^ mix64((uint64_t)e.cents * 4 + kind));
+    side.entries.push_back(e);
+}
+
+static bool sameKey(const ReconcileEntry& a, const std::string& arenaA,
+                    const ReconcileEntry& b, const std::string& arenaB) {
+    return a.hash == b.hash && a.kind == b.kind && a.cents == b.cents && a.length == b.length &&
+           memcmp(arenaA.data() + a.text, arenaB.data() + b.text, a.length) == 0;
+}
+
+// ===== Partitioning =====
+
+// Run fn(begin, end, worker) over `threads` contiguous ranges of [0, n)
+template <typename Fn>
+static void parallelRanges(size_t n, int threads, Fn fn) {
+    std::vector<std::thread> workers;
+    size_t span = n / threads + 1;
+    for (int t = 0; t < threads; t++) {
+        size_t begin = std::min(n, t * span), end = std::min(n, begin + span);
+        if (t + 1 == threads) fn(begin, end, t);
+        else workers.emplace_back(fn, begin, end, t);
+    }
+    for (std::thread& w : workers) w.join();
+}
+
+// Scatter entries by the top hash bits into partition-major order, each
+// worker writing its own precomputed ranges (input order is kept within
+// a partition). bounds gets partitions + 1 offsets.
+static void scatter(const std::vector<ReconcileEntry>& in, int bits, int threads,
+                    std::vector<ReconcileEntry>& out, std::vector<size_t>& bounds) {
+    TRACE_SPAN("reconcile.scatter");
+    const size_t parts = (size_t)1 << bits;
+    std::vector<size_t> counts((size_t)threads * parts, 0);
+
+    parallelRanges(in.size(), threads, [&](size_t begin, size_t end, int t) {
+        size_t* c = &counts[(size_t)t * parts];
+        for (size_t i = begin; i < end; i++) c[in[i].hash >> (64 - bits)]++;
+    });
+
+    // Worker t's slice of partition p starts after every earlier partition
+    // and after workers 0..t-1's share of p
+    bounds.assign(parts + 1, 0);
+    size_t offset = 0;
+    for (size_t p = 0; p < parts; p++) {
+        bounds[p] = offset;
+        for (int t = 0; t < threads; t++) {
+            size_t n = counts[(size_t)t * parts + p];
+            counts[(size_t)t * parts + p] = offset;
+            offset += n;
+        }
+    }
+    bounds[parts] = offset;
+
+    out.resize(in.size());
+    parallelRanges(in.size(), threads, [&](size_t begin, size_t end, int t) {
+        size_t* c = &counts[(size_t)t * parts];
+        for (size_t i = begin; i < end; i++) out[c[in[i].hash >> (64 - bits)]++] = in[i];
+    });
+}
+
+// ===== Join =====
+
+// Per-worker output: indices into the partitioned arrays
+struct JoinOutput {
+    long long matched = 0;
+    std::vector<size_t> missing;   // statement entries
+    std::vector<size_t> extra;     // ledger entries
+};
+
+struct KeyGroup {
+    size_t begin, end;             // ledger entries, sorted by timestamp
+    size_t cursor;                 // first one not yet matched or given up on
+};
+
+// Match one partition: group the ledger entries by key into an open-
+// addressed table, then walk the statement rows in date order. Within a
+// key, postings older than the window are extra for good (later rows are
+// only later); otherwise the earliest posting within the window matches.
+static void joinPartition(std::vector<ReconcileEntry>& ledger, const std::string& ledgerText,
+                          size_t lb, size_t le,
+                          std::vector<ReconcileEntry>& statement, const std::string& statementText,
+                          size_t sb, size_t se, Timestamp window, JoinOutput& out) {
+    std::sort(ledger.begin() + lb, ledger.begin() + le,
+              [&](const ReconcileEntry& a, const ReconcileEntry& b) {
+        if (a.hash != b.hash) return a.hash < b.hash;
+        if (a.kind != b.kind) return a.kind < b.kind;
+        if (a.cents != b.cents) return a.cents < b.cents;
+        if (a.length != b.length) return a.length < b.length;
+        int c = memcmp(ledgerText.data() + a.text, ledgerText.data() + b.text, a.length);
+        if (c != 0) return c < 0;
+        if (a.ts != b.ts) return a.ts < b.ts;
+        return a.row < b.row;
+    });
+    std::sort(statement.begin() + sb, statement.begin() + se,
+              [](const ReconcileEntry& a, const ReconcileEntry& b) {
+        return a.ts != b.ts ? a.ts < b.ts : a.row < b.row;
+    });
+
+    std::vector<KeyGroup> groups;
+    for (size_t i = lb; i < le; i++) {
+        if (i == lb || !sameKey(ledger[i], ledgerText, ledger[i - 1], ledgerText)) {
+            if (!groups.empty()) groups.back().end = i;
+            groups.push_back({ i, le, i });
+        }
+    }
+
+    size_t slots = 16;
+    while (slots < groups.size() * 2) slots <<= 1;
+    std::vector<uint32_t> table(slots, 0);     // group index + 1
+    for (size_t g = 0; g < groups.size(); g++) {
+        size_t s = ledger[groups[g].begin].hash & (slots - 1);
+        while (table[s] != 0) s = (s + 1) & (slots - 1);
+        table[s] = (uint32_t)(g + 1);
+    }
+
+    for (size_t i = sb; i < se; i++) {
+        const ReconcileEntry& row = statement[i];
+        KeyGroup* group = nullptr;
+        for (size_t s = row.hash & (slots - 1); table[s] != 0; s = (s + 1) & (slots - 1)) {
+            KeyGroup& g = groups[table[s] - 1];
+            if (sameKey(ledger[g.begin], ledgerText, row, statementText)) {
+                group = &g;
+                break;
+            }
+        }
+        if (!group) {
+            out.missing.push_back(i);
+            continue;
+        }
+
+        while (group->cursor < group->end && ledger[group->cursor].ts < row.ts - window) {
+            out.extra.push_back(group->cursor++);
+        }
+        if (group->cursor < group->end && ledger[group->cursor].ts <= row.ts + window) {
+            group->cursor++;
+            out.matched++;
+        } else {
+            out.missing.push_back(i);
+        }
+    }
+
+    for (const KeyGroup& g : groups) {
+        for (size_t j = g.cursor; j < g.end; j++) out.extra.push_back(j);
+    }
+}
+
+static ReconcileItem makeItem(const ReconcileEntry& e, const std::string& arena, bool statementSide) {
+    ReconcileItem item;
+    item.statementRow = statementSide ? (long long)e.row + 1 : 0;
+    item.ledgerID = statementSide ? 0 : (int)e.row;
+    item.kind = e.kind;
+    item.amount = (double)e.cents / 100.0;
+    item.timestamp = e.ts;
+    item.description.assign(arena, e.text, e.length);
+    return item;
+}
+
+// ===== Entry points =====
+
+// Key statement rows [begin, end), numbered from base. Returns the rows
+// skipped for having no date.
+static long long keyRows(const std::vector<ImportRow>& rows, size_t begin, size_t end,
+                         uint32_t base, ReconcileSide& side) {
+    long long undated = 0;
+    for (size_t i = begin; i < end; i++) {
+        const ImportRow& r = rows[i];
+        if (r.timestamp == 0) {
+            undated++;
+            continue;
+        }
+        // Compared as the ledger stores it: cut to a record's description
+        const char* d = r.description.data();
+        addEntry(side, r.kind, r.amount, r.timestamp, d,
+                 recordDescriptionLength(d, r.description.size()), base + (uint32_t)(i - begin));
+    }
+    return undated;
+}
+
+static void appendSide(ReconcileSide& to, const ReconcileSide& from) {
+    uint64_t offset = to.arena.size();
+    to.arena += from.arena;
+    for (ReconcileEntry e : from.entries) {
+        e.text += offset;
+        to.entries.push_back(e);
+    }
+}
+
+// Every posting, archived ones included, through the history cursor
+static void loadLedgerSide(BankLedger& ledger, ReconcileSide& side) {
+    TRACE_SPAN("reconcile.loadLedger");
+    HistoryFilter filter;
+    memset(&filter, 0, sizeof(filter));
+    HistoryCursor cursor = makeHistoryCursor(filter, LEDGER_CHUNK);
+
+    side.entries.reserve((size_t)ledger.getTransactionCount());
+    std::vector<TransactionRecord> chunk(LEDGER_CHUNK);
+    int n;
+    while ((n = ledger.readHistory(cursor, chunk.data())) > 0) {
+        for (int i = 0; i < n; i++) {
+            const TransactionRecord& r = chunk[i];
+            addEntry(side, (unsigned char)r.kind, r.amount, r.timestamp, r.description,
+                     strnlen(r.description, RECORD_DESCRIPTION_SIZE), (uint32_t)r.id);
+        }
+    }
+}
+
+void reconcileBuffer(BankLedger& ledger, const char* data, size_t length, ImportFormat format,
+                     Timestamp window, int threads, ReconcileResult& out) {
+    TRACE_SPAN("reconcile");
+    auto started = std::chrono::steady_clock::now();
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+
+    out.missing.clear();
+    out.extra.clear();
+    ReconcileReport& report = out.report;
+    memset(&report, 0, sizeof(report));
+
+    // The ledger side loads while the statement parses
+    ReconcileSide ledgerSide, statementSide;
+    std::thread loader(loadLedgerSide, std::ref(ledger), std::ref(ledgerSide));
+
+    long long lines = 0, malformed = 0, undated = 0;
+    uint32_t parsed = 0;
+    statementSide.entries.reserve(length / 40 + 1);
+    statementSide.arena.reserve(length / 3 + 1);
+    streamRows(data, length, format, threads, [&](std::vector<ImportRow>& rows) {
+        TRACE_SPAN("reconcile.keyRows");
+        size_t n = rows.size();
+        if (threads == 1 || n < KEY_PARALLEL_MIN) {
+            undated += keyRows(rows, 0, n, parsed, statementSide);
+        } else {
+            std::vector<ReconcileSide> parts(threads);
+            std::vector<long long> skipped(threads, 0);
+            parallelRanges(n, threads, [&](size_t begin, size_t end, int t) {
+                skipped[t] = keyRows(rows, begin, end, parsed + (uint32_t)begin, parts[t]);
+            });
+            for (int t = 0; t < threads; t++) {
+                appendSide(statementSide, parts[t]);
+                undated += skipped[t];
+            }
+        }
+        parsed += (uint32_t)n;
+    }, lines, malformed);
+    loader.join();
+
+    report.statementRows = (long long)parsed - undated;
+    report.rejected = malformed + undated;
+    report.ledgerRows = (long long)ledgerSide.entries.size();
+
+    size_t total = ledgerSide.entries.size() + statementSide.entries.size();
+    int bits = 1;
+    while (bits < 12 && (((size_t)1 << bits) < (size_t)threads * 4 ||
+                         ((size_t)1 << bits) * PARTITION_TARGET < total)) bits++;
+    const size_t parts = (size_t)1 << bits;
+
+    std::vector<ReconcileEntry> ledgerParts, statementParts;
+    std::vector<size_t> ledgerBounds, statementBounds;
+    scatter(ledgerSide.entries, bits, threads, ledgerParts, ledgerBounds);
+    scatter(statementSide.entries, bits, threads, statementParts, statementBounds);
+    std::vector<ReconcileEntry>().swap(ledgerSide.entries);
+    std::vector<ReconcileEntry>().swap(statementSide.entries);
+
+    std::vector<JoinOutput> outputs(threads);
+    std::atomic<size_t> nextPart(0);
+    {
+        TRACE_SPAN("reconcile.join");
+        parallelRanges(threads, threads, [&](size_t, size_t, int t) {
+            for (size_t p; (p = nextPart.fetch_add(1)) < parts;) {
+                joinPartition(ledgerParts, ledgerSide.arena, ledgerBounds[p], ledgerBounds[p + 1],
+                              statementParts, statementSide.arena, statementBounds[p],
+                              statementBounds[p + 1], window, outputs[t]);
+            }
+        });
+    }
+
+    for (const JoinOutput& o : outputs) {
+        report.matched += o.matched;
+        for (size_t i : o.missing) out.missing.push_back(makeItem(statementParts[i], statementSide.arena, true));
+        for (size_t i : o.extra) out.extra.push_back(makeItem(ledgerParts[i], ledgerSide.arena, false));
+    }
+    std::sort(out.missing.begin(), out.missing.end(),
+              [](const ReconcileItem& a, const ReconcileItem& b) { return a.statementRow < b.statementRow; });
+    std::sort(out.extra.begin(), out.extra.end(),
+              [](const ReconcileItem& a, const ReconcileItem& b) { return a.ledgerID < b.ledgerID; });
+    report.missing = (long long)out.missing.size();
+    report.extra = (long long)out.extra.size();
+
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    report.rowsPerSecond = report.seconds > 0 ? (report.statementRows + report.ledgerRows) / report.seconds : 0.0;
+}
+
+bool reconcileFile(BankLedger& ledger, const std::string& path, ImportFormat format,
+                   Timestamp window, int threads, ReconcileResult& out) {
+    return withFileContents(path, [&](const char* data, size_t length) {
+        reconcileBuffer(ledger, data, length, format, window, threads, out);
+    });
+}
+
+// ===== Report file =====
+
+static void writeItem(BufferedWriter& w, const char* status, const ReconcileItem& item) {
+    w.write(status, strlen(status));
+    w.put(',');
+    if (item.statementRow > 0) w.writeInt(item.statementRow);
+    w.put(',');
+    if (item.ledgerID > 0) w.writeInt(item.ledgerID);
+    w.put(',');
+    w.write(item.kind == KIND_DEPOSIT ? "DEPOSIT" : "WITHDRAWAL");
+    w.put(',');
+    w.writeMoney(item.amount);
+    w.put(',');
+    w.writeTimestamp(item.timestamp);
+    w.put(',');
+    w.writeCsvField(item.description);
+    w.put('\n');
+}
+
+bool writeReconcileCsv(const std::string& path, const ReconcileResult& result) {
+    int fd = createOutputFile(path);
+    if (fd < 0) return false;
+
+    bool ok;
+    {
+        BufferedWriter w(fd);
+        w.write("status,statement_row,ledger_id,type,amount,timestamp,description\n");
+        for (const ReconcileItem& item : result.missing) writeItem(w, "missing", item);
+        for (const ReconcileItem& item : result.extra) writeItem(w, "extra", item);
+        ok = w.flush();
+    }
+    return closeOutputFile(fd) && ok;
+}
@@ -0,0 +1,136 @@
+#include "../include/scheduler.h"
+#include "../include/column_store.h"
+#include <algorithm>
+#include <climits>
+
+// ===== Calendar arithmetic (proleptic Gregorian, UTC) =====
+
+static int64_t daysFromCivil(int64_t y, int64_t m, int64_t d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static void civilFromDays(int64_t z, int64_t& y, int64_t& m, int64_t& d) {
+    z += 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = yoe + era * 400 + (m <= 2);
+}
+
+static int64_t daysInMonth(int64_t y, int64_t m) {
+    static const int days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    return (m == 2 && leap) ? 29 : days[m - 1];
+}
+
+// ===== PostingScheduler =====
+
+PostingScheduler::PostingScheduler() {
+    activeCount = 0;
+}
+
+bool PostingScheduler::later(const HeapEntry& a, const HeapEntry& b) {
+    return a.due != b.due ? a.due > b.due : a.id > b.id;
+}
+
+Timestamp PostingScheduler::occurrenceTime(const ScheduleSpec& spec, int done) {
+    if (spec.repeat == REPEAT_INTERVAL) return spec.firstDue + (int64_t)done * spec.every;
+    if (spec.repeat != REPEAT_MONTHLY) return spec.firstDue;
+
+    // Always from the first date, so the 31st comes back after a short month
+    int64_t day = spec.firstDue / MICROS_PER_DAY;
+    if (spec.firstDue % MICROS_PER_DAY < 0) day--;
+    Timestamp timeOfDay = spec.firstDue - day * MICROS_PER_DAY;
+
+    int64_t y, m, d;
+    civilFromDays(day, y, m, d);
+    int64_t months = (m - 1) + (int64_t)done * spec.every;
+    y += months / 12;
+    m = months % 12 + 1;
+    d = std::min(d, daysInMonth(y, m));
+    return daysFromCivil(y, m, d) * MICROS_PER_DAY + timeOfDay;
+}
+
+int PostingScheduler::add(const ScheduleSpec& spec, const std::string& description) {
+    if (spec.amount <= 0.0 || spec.count < 0) return 0;
+    if (spec.kind != KIND_DEPOSIT && spec.kind != KIND_WITHDRAWAL) return 0;
+    if (spec.repeat != REPEAT_ONCE && spec.repeat != REPEAT_INTERVAL && spec.repeat != REPEAT_MONTHLY) {
+        return 0;
+    }
+    if (spec.repeat != REPEAT_ONCE && spec.every <= 0) return 0;
+
+    Schedule s;
+    s.spec = spec;
+    if (spec.repeat == REPEAT_ONCE) s.spec.count = 1;
+    s.description = description;
+    s.nextDue = spec.firstDue;
+    s.done = 0;
+    s.active = true;
+    schedules.push_back(s);
+
+    int id = (int)schedules.size();
+    heap.push_back({ s.nextDue, id });
+    std::push_heap(heap.begin(), heap.end(), later);
+    activeCount++;
+    return id;
+}
+
+bool PostingScheduler::cancel(int id) {
+    if (id <= 0 || id > (int)schedules.size() || !schedules[id - 1].active) return false;
+
+    // Its heap entry is discarded when it reaches the top
+    schedules[id - 1].active = false;
+    activeCount--;
+    return true;
+}
+
+size_t PostingScheduler::collectDue(Timestamp now, std::vector<ScheduledPosting>& out, size_t limit) {
+    size_t n = 0;
+
+    while (n < limit && !heap.empty() && heap.front().due <= now) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        int id = heap.back().id;
+        heap.pop_back();
+
+        Schedule& s = schedules[id - 1];
+        if (!s.active) continue;
+
+        ScheduledPosting p;
+        p.scheduleID = id;
+        p.account = s.spec.account;
+        p.kind = (unsigned char)s.spec.kind;
+        p.amount = s.spec.amount;
+        p.due = s.nextDue;
+        p.occurrence = ++s.done;
+        p.description = s.description;
+        out.push_back(p);
+        n++;
+
+        if (s.spec.count != 0 && s.done >= s.spec.count) {
+            s.active = false;
+            activeCount--;
+            continue;
+        }
+        s.nextDue = occurrenceTime(s.spec, s.done);
+        heap.push_back({ s.nextDue, id });
+        std::push_heap(heap.begin(), heap.end(), later);
+    }
+    return n;
+}
+
+Timestamp PostingScheduler::nextDue() {
+    while (!heap.empty() && !schedules[heap.front().id - 1].active) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        heap.pop_back();
+    }
+    return heap.empty() ? INT64_MAX : heap.front().due;
+}
@@ -0,0 +1,544 @@
+#include "../include/segment_codec.h"
+#include "../include/column_store.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+// Encodings of a double column
+enum DoubleEncoding : unsigned char {
+    DOUBLES_RAW = 0,
+    DOUBLES_CENTS = 1,
+    DOUBLES_DERIVED = 2
+};
+
+// Widest frame-of-reference offset: value << 7 must still fit in a word
+#define MAX_PACKED_WIDTH 56
+
+// ===== Primitive helpers =====
+
+static void putVarint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back((char)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((char)v);
+}
+
+static size_t varintSize(uint64_t v) {
+    size_t n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        n++;
+    }
+    return n;
+}
+
+static inline bool getVarint(const unsigned char*& p, const unsigned char* end, uint64_t& v) {
+    // Fast path: one byte (small deltas are the common case)
+    if (p < end && *p < 0x80) {
+        v = *p++;
+        return true;
+    }
+
+    v = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        unsigned char b = *p++;
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+static inline uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+template <typename T>
+static void putRaw(std::string& out, const T& v) {
+    out.append((const char*)&v, sizeof(T));
+}
+
+template <typename T>
+static bool getRaw(const unsigned char*& p, const unsigned char* end, T& v) {
+    if ((size_t)(end - p) < sizeof(T)) return false;
+    memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+static bool sameBits(double a, double b) {
+    return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+static int bitWidth(uint64_t v) {
+    int w = 0;
+    while (v != 0) {
+        w++;
+        v >>= 1;
+    }
+    return w;
+}
+
+static size_t packedSize(size_t n, int width) {
+    return (n * (size_t)width + 7) / 8 + 8;
+}
+
+// ===== Bit packing =====
+
+static void packBits(std::string& out, const uint64_t* values, size_t n, int width) {
+    size_t start = out.size();
+    out.append(packedSize(n, width), '\0');
+    if (width == 0) return;
+
+    unsigned char* p = (unsigned char*)&out[start];
+    uint64_t bit = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t word;
+        memcpy(&word, p + (bit >> 3), 8);
+        word |= values[i] << (bit & 7);
+        memcpy(p + (bit >> 3), &word, 8);
+        bit += width;
+    }
+}
+
+// One unaligned word load per value; the 8 bytes of slack keep it in bounds
+template <typename T, typename Convert>
+static void unpackBits(const unsigned char* p, size_t n, int width, T* out, Convert convert) {
+    if (width == 0) {
+        for (size_t i = 0; i < n; i++) out[i] = convert(0);
+        return;
+    }
+
+    const uint64_t mask = (1ULL << width) - 1;
+    uint64_t bit = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t word;
+        memcpy(&word, p + (bit >> 3), 8);
+        out[i] = convert((word >> (bit & 7)) & mask);
+        bit += width;
+    }
+}
+
+// ===== Double columns =====
+
+// Pick the smallest exact encoding. amounts/kinds enable DERIVED (balances).
+static void encodeDoubles(std::string& out, const double* v, size_t n,
+                          const double* amounts, const unsigned char* kinds) {
+    size_t rawSize = 1 + 8 * n;
+
+    // Frame of reference over integer cents, when every value round-trips
+    bool centsOk = n > 0;
+    int64_t lo = std::numeric_limits<int64_t>::max();
+    int64_t hi = std::numeric_limits<int64_t>::min();
+    std::vector<int64_t> cents(n);
+    for (size_t i = 0; i < n && centsOk; i++) {
+        double scaled = v[i] * 100.0;
+        if (!(std::fabs(scaled) < 9.0e15)) {
+            centsOk = false;
+            break;
+        }
+        cents[i] = std::llround(scaled);
+        if (!sameBits((double)cents[i] / 100.0, v[i])) centsOk = false;
+        lo = std::min(lo, cents[i]);
+        hi = std::max(hi, cents[i]);
+    }
+    int width = centsOk ? bitWidth((uint64_t)(hi - lo)) : 0;
+    if (width > MAX_PACKED_WIDTH) centsOk = false;
+    size_t centsSize = centsOk ? 1 + 8 + 1 + packedSize(n, width) : SIZE_MAX;
+
+    // Running balance replayed from the amounts, with exceptions where the
+    // ledger's own arithmetic didn't produce the stored value (e.g. after undo)
+    std::vector<uint32_t> exceptions;
+    size_t derivedSize = SIZE_MAX;
+    if (amounts != nullptr && n > 0) {
+        derivedSize = 1 + 8;
+        for (size_t i = 1; i < n; i++) {
+            double expected = kinds[i] ? v[i - 1] - amounts[i] : v[i - 1] + amounts[i];
+            if (!sameBits(expected, v[i])) {
+                exceptions.push_back((uint32_t)i);
+                derivedSize += varintSize(i) + 8;
+            }
+        }
+        derivedSize += varintSize(exceptions.size());
+    }
+
+    if (derivedSize <= centsSize && derivedSize < rawSize) {
+        out.push_back((char)DOUBLES_DERIVED);
+        putRaw(out, v[0]);
+        putVarint(out, exceptions.size());
+        for (uint32_t i : exceptions) {
+            putVarint(out, i);
+            putRaw(out, v[i]);
+        }
+    } else if (centsSize < rawSize) {
+        out.push_back((char)DOUBLES_CENTS);
+        putRaw(out, lo);
+        out.push_back((char)width);
+
+        std::vector<uint64_t> offsets(n);
+        for (size_t i = 0; i < n; i++) offsets[i] = (uint64_t)(cents[i] - lo);
+        packBits(out, offsets.data(), n, width);
+    } else {
+        out.push_back((char)DOUBLES_RAW);
+        out.append((const char*)v, n * sizeof(double));
+    }
+}
+
+static bool decodeDoubles(const unsigned char* p, const unsigned char* end, size_t n,
+                          double* out, const double* amounts, const unsigned char* kinds) {
+    if (p >= end) return false;
+    unsigned char mode = *p++;
+
+    if (mode == DOUBLES_RAW) {
+        if ((size_t)(end - p) < n * sizeof(double)) return false;
+        if (n > 0) memcpy(out, p, n * sizeof(double));
+        return true;
+    }
+
+    if (mode == DOUBLES_CENTS) {
+        int64_t base;
+        if (!getRaw(p, end, base) || p >= end) return false;
+        int width = *p++;
+        if (width > MAX_PACKED_WIDTH || (size_t)(end - p) < packedSize(n, width)) return false;
+
+        unpackBits(p, n, width, out,
+                   [base](uint64_t x) { return (double)(base + (int64_t)x) / 100.0; });
+        return true;
+    }
+
+    if (mode == DOUBLES_DERIVED) {
+        uint64_t exceptionCount, next = 0;
+        if (amounts == nullptr || n == 0) return false;
+        if (!getRaw(p, end, out[0]) || !getVarint(p, end, exceptionCount)) return false;
+
+        double exceptionValue = 0.0;
+        auto readException = [&]() {
+            if (exceptionCount == 0) {
+                next = n;
+                return true;
+            }
+            exceptionCount--;
+            return getVarint(p, end, next) && getRaw(p, end, exceptionValue) && next > 0;
+        };
+        if (!readException()) return false;
+
+        for (size_t i = 1; i < n; i++) {
+            if (i == next) {
+                out[i] = exceptionValue;
+                if (!readException()) return false;
+            } else {
+                out[i] = kinds[i] ? out[i - 1] - amounts[i] : out[i - 1] + amounts[i];
+            }
+        }
+        return next == n;
+    }
+
+    return false;
+}
+
+// ===== Encode =====
+
+std::string encodeSegment(Transaction* const* rows, size_t n, uint64_t firstPosition) {
+    std::string out;
+    out.reserve(n * 8 + 256);
+
+    out.append(SEGMENT_MAGIC, 4);
+    putRaw(out, (uint32_t)SEGMENT_VERSION);
+    putRaw(out, (uint32_t)n);
+    putRaw(out, firstPosition);
+
+    SegmentFooter f;
+    memset(&f, 0, sizeof(f));
+    f.minID = std::numeric_limits<int>::max();
+    f.maxID = std::numeric_limits<int>::min();
+    f.minTimestamp = std::numeric_limits<int64_t>::max();
+    f.maxTimestamp = std::numeric_limits<int64_t>::min();
+    f.minAmount = std::numeric_limits<double>::infinity();
+    f.maxAmount = -std::numeric_limits<double>::infinity();
+
+    std::vector<unsigned char> kinds(n);
+    std::vector<double> amounts(n), balances(n);
+    for (size_t i = 0; i < n; i++) {
+        const Transaction* t = rows[i];
+        kinds[i] = (t->type == "WITHDRAWAL") ? KIND_WITHDRAWAL : KIND_DEPOSIT;
+        amounts[i] = t->amount;
+        balances[i] = t->balanceAfter;
+
+        f.minID = std::min(f.minID, t->id);
+        f.maxID = std::max(f.maxID, t->id);
+        f.minTimestamp = std::min(f.minTimestamp, (int64_t)t->timestamp);
+        f.maxTimestamp = std::max(f.maxTimestamp, (int64_t)t->timestamp);
+        f.minAmount = std::min(f.minAmount, t->amount);
+        f.maxAmount = std::max(f.maxAmount, t->amount);
+    }
+    if (n == 0) {
+        f.minID = f.maxID = 0;
+        f.minTimestamp = f.maxTimestamp = 0;
+        f.minAmount = f.maxAmount = 0.0;
+    }
+
+    f.columnOffset[SEG_COL_IDS] = (uint32_t)out.size();
+    int64_t prev = 0;
+    for (size_t i = 0; i < n; i++) {
+        putVarint(out, zigzag((int64_t)rows[i]->id - prev));
+        prev = rows[i]->id;
+    }
+
+    f.columnOffset[SEG_COL_TIMESTAMPS] = (uint32_t)out.size();
+    prev = 0;
+    for (size_t i = 0; i < n; i++) {
+        int64_t ts = (int64_t)rows[i]->timestamp;
+        putVarint(out, zigzag(ts - prev));
+        prev = ts;
+    }
+
+    f.columnOffset[SEG_COL_KINDS] = (uint32_t)out.size();
+    std::string bitmap((n + 7) / 8, '\0');
+    for (size_t i = 0; i < n; i++) {
+        if (kinds[i] == KIND_WITHDRAWAL) bitmap[i / 8] |= (char)(1 << (i % 8));
+    }
+    out += bitmap;
+
+    f.columnOffset[SEG_COL_AMOUNTS] = (uint32_t)out.size();
+    encodeDoubles(out, amounts.data(), n, nullptr, nullptr);
+
+    f.columnOffset[SEG_COL_BALANCES] = (uint32_t)out.size();
+    encodeDoubles(out, balances.data(), n, amounts.data(), kinds.data());
+
+    // Dictionary in first-seen order
+    f.columnOffset[SEG_COL_DESCRIPTIONS] = (uint32_t)out.size();
+    std::unordered_map<std::string, uint32_t> dict;
+    std::vector<const std::string*> entries;
+    std::vector<uint64_t> indexes(n);
+    for (size_t i = 0; i < n; i++) {
+        auto it = dict.find(rows[i]->description);
+        if (it == dict.end()) {
+            it = dict.emplace(rows[i]->description, (uint32_t)entries.size()).first;
+            entries.push_back(&it->first);
+        }
+        indexes[i] = it->second;
+    }
+
+    putVarint(out, entries.size());
+    for (const std::string* e : entries) {
+        putVarint(out, e->size());
+        out += *e;
+    }
+    int width = entries.empty() ? 0 : bitWidth(entries.size() - 1);
+    out.push_back((char)width);
+    packBits(out, indexes.data(), n, width);
+
+    f.footerOffset = (uint32_t)out.size();
+    for (int c = 0; c < SEGMENT_COLUMN_COUNT; c++) putRaw(out, f.columnOffset[c]);
+    putRaw(out, (int32_t)f.minID);
+    putRaw(out, (int32_t)f.maxID);
+    putRaw(out, f.minTimestamp);
+    putRaw(out, f.maxTimestamp);
+    putRaw(out, f.minAmount);
+    putRaw(out, f.maxAmount);
+    putRaw(out, f.footerOffset);
+
+    return out;
+}
+
+// ===== Decode =====
+
+bool readSegmentFooter(const char* data, size_t size, SegmentFooter& out) {
+    const unsigned char* p = (const unsigned char*)data;
+    const unsigned char* end = p + size;
+
+    uint32_t version;
+    if (size < 4 + 4 || memcmp(p, SEGMENT_MAGIC, 4) != 0) return false;
+    p += 4;
+    if (!getRaw(p, end, version) || version != SEGMENT_VERSION) return false;
+    if (!getRaw(p, end, out.rows) || !getRaw(p, end, out.firstPosition)) return false;
+    size_t headerSize = (size_t)(p - (const unsigned char*)data);
+
+    const size_t footerSize = SEGMENT_COLUMN_COUNT * 4 + 4 + 4 + 8 * 4 + 4;
+    if (size < headerSize + footerSize) return false;
+    memcpy(&out.footerOffset, data + size - 4, 4);
+    if (out.footerOffset < headerSize || out.footerOffset + footerSize != size) return false;
+
+    p = (const unsigned char*)data + out.footerOffset;
+    int32_t minID, maxID;
+    for (int c = 0; c < SEGMENT_COLUMN_COUNT; c++) {
+        if (!getRaw(p, end, out.columnOffset[c])) return false;
+    }
+    if (!getRaw(p, end, minID) || !getRaw(p, end, maxID)) return false;
+    if (!getRaw(p, end, out.minTimestamp) || !getRaw(p, end, out.maxTimestamp)) return false;
+    if (!getRaw(p, end, out.minAmount) || !getRaw(p, end, out.maxAmount)) return false;
+    out.minID = minID;
+    out.maxID = maxID;
+
+    uint32_t previous = (uint32_t)headerSize;
+    for (int c = 0; c < SEGMENT_COLUMN_COUNT; c++) {
+        if (out.columnOffset[c] < previous || out.columnOffset[c] > out.footerOffset) return false;
+        previous = out.columnOffset[c];
+    }
+    return true;
+}
+
+bool decodeSegmentColumns(const char* data, size_t size, SegmentColumns& out, unsigned columns) {
+    SegmentFooter f;
+    if (!readSegmentFooter(data, size, f)) return false;
+
+    const size_t n = f.rows;
+    if (columns & SEG_WANT(SEG_COL_BALANCES)) {
+        columns |= SEG_WANT(SEG_COL_AMOUNTS) | SEG_WANT(SEG_COL_KINDS);
+    }
+
+    auto begin = [&](int c) { return (const unsigned char*)data + f.columnOffset[c]; };
+    auto end = [&](int c) {
+        uint32_t e = (c + 1 < SEGMENT_COLUMN_COUNT) ? f.columnOffset[c + 1] : f.footerOffset;
+        return (const unsigned char*)data + e;
+    };
+
+    if (columns & SEG_WANT(SEG_COL_IDS)) {
+        const unsigned char* p = begin(SEG_COL_IDS);
+        const unsigned char* e = end(SEG_COL_IDS);
+        out.ids.resize(n);
+        int64_t prev = 0;
+        uint64_t v;
+        for (size_t i = 0; i < n; i++) {
+            if (!getVarint(p, e, v)) return false;
+            prev += unzigzag(v);
+            out.ids[i] = (int)prev;
+        }
+    }
+
+    if (columns & SEG_WANT(SEG_COL_TIMESTAMPS)) {
+        const unsigned char* p = begin(SEG_COL_TIMESTAMPS);
+        const unsigned char* e = end(SEG_COL_TIMESTAMPS);
+        out.timestamps.resize(n);
+        int64_t prev = 0;
+        uint64_t v;
+        for (size_t i = 0; i < n; i++) {
+            if (!getVarint(p, e, v)) return false;
+            prev += unzigzag(v);
+            out.timestamps[i] = prev;
+        }
+    }
+
+    if (columns & SEG_WANT(SEG_COL_KINDS)) {
+        const unsigned char* p = begin(SEG_COL_KINDS);
+        if ((size_t)(end(SEG_COL_KINDS) - p) < (n + 7) / 8) return false;
+        out.kinds.resize(n);
+        for (size_t i = 0; i < n; i++) out.kinds[i] = (p[i >> 3] >> (i & 7)) & 1;
+    }
+
+    if (columns & SEG_WANT(SEG_COL_AMOUNTS)) {
+        out.amounts.resize(n);
+        if (!decodeDoubles(begin(SEG_COL_AMOUNTS), end(SEG_COL_AMOUNTS), n,
+                           out.amounts.data(), nullptr, nullptr)) {
+            return false;
+        }
+    }
+
+    if (columns & SEG_WANT(SEG_COL_BALANCES)) {
+        out.balances.resize(n);
+        if (!decodeDoubles(begin(SEG_COL_BALANCES), end(SEG_COL_BALANCES), n,
+                           out.balances.data(), out.amounts.data(), out.kinds.data())) {
+            return false;
+        }
+    }
+
+    if (columns & SEG_WANT(SEG_COL_DESCRIPTIONS)) {
+        const unsigned char* p = begin(SEG_COL_DESCRIPTIONS);
+        const unsigned char* e = end(SEG_COL_DESCRIPTIONS);
+
+        uint64_t count;
+        if (!getVarint(p, e, count) || count > n) return false;
+        out.dictionary.resize(count);
+        for (uint64_t d = 0; d < count; d++) {
+            uint64_t len;
+            if (!getVarint(p, e, len) || (uint64_t)(e - p) < len) return false;
+            out.dictionary[d].assign((const char*)p, len);
+            p += len;
+        }
+
+        if (p >= e) return false;
+        int width = *p++;
+        if (width > 32 || (size_t)(e - p) < packedSize(n, width)) return false;
+
+        out.descriptions.resize(n);
+        unpackBits(p, n, width, out.descriptions.data(), [](uint64_t x) { return (uint32_t)x; });
+        for (size_t i = 0; i < n; i++) {
+            if (out.descriptions[i] >= count) return false;
+        }
+    }
+
+    return true;
+}
+
+bool decodeSegment(const std::string& data, std::vector<Transaction*>& rows,
+                   uint64_t& firstPosition) {
+    SegmentFooter f;
+    SegmentColumns cols;
+    if (!readSegmentFooter(data.data(), data.size(), f) ||
+        !decodeSegmentColumns(data.data(), data.size(), cols)) {
+        return false;
+    }
+    firstPosition = f.firstPosition;
+
+    rows.reserve(rows.size() + f.rows);
+    for (size_t i = 0; i < f.rows; i++) {
+        Transaction* t = new Transaction(cols.ids[i],
+                                         cols.kinds[i] == KIND_WITHDRAWAL ? "WITHDRAWAL" : "DEPOSIT",
+                                         cols.amounts[i], cols.dictionary[cols.descriptions[i]],
+                                         cols.balances[i], cols.timestamps[i]);
+        rows.push_back(t);
+    }
+    return true;
+}
+
+// ===== Scan =====
+
+AggregateResult aggregateSegment(const SegmentColumns& cols, int typeMask,
+                                 int64_t fromTs, int64_t toTs) {
+    bool wantDeposits = (typeMask & AGG_DEPOSITS) != 0;
+    bool wantWithdrawals = (typeMask & AGG_WITHDRAWALS) != 0;
+
+    double sumDeposits = 0.0, sumWithdrawals = 0.0;
+    int64_t depositCount = 0, withdrawalCount = 0;
+    double minAmount = std::numeric_limits<double>::infinity();
+    double maxAmount = -std::numeric_limits<double>::infinity();
+
+    size_t n = cols.amounts.size();
+    for (size_t i = 0; i < n; i++) {
+        if (cols.timestamps[i] < fromTs || cols.timestamps[i] > toTs) continue;
+
+        double a = cols.amounts[i];
+        if (cols.kinds[i] == KIND_WITHDRAWAL) {
+            if (!wantWithdrawals) continue;
+            sumWithdrawals += a;
+            withdrawalCount++;
+        } else {
+            if (!wantDeposits) continue;
+            sumDeposits += a;
+            depositCount++;
+        }
+        minAmount = std::min(minAmount, a);
+        maxAmount = std::max(maxAmount, a);
+    }
+
+    AggregateResult r;
+    r.totalDeposits = sumDeposits;
+    r.totalWithdrawals = sumWithdrawals;
+    r.depositCount = (int)depositCount;
+    r.withdrawalCount = (int)withdrawalCount;
+
+    int64_t matched = depositCount + withdrawalCount;
+    if (matched == 0) {
+        r.minAmount = r.maxAmount = r.avgAmount = 0.0;
+    } else {
+        r.minAmount = minAmount;
+        r.maxAmount = maxAmount;
+        r.avgAmount = (sumDeposits + sumWithdrawals) / (double)matched;
+    }
+    return r;
+}
@@ -0,0 +1,241 @@
+#include "../include/sha256.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SHA_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_SHA
+#else
+#include <cpuid.h>
+#define TARGET_SHA __attribute__((target("sha,sse4.1,ssse3")))
+#endif
+#endif
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+// ===== Digest =====
+
+bool Digest::operator==(const Digest& other) const {
+    return memcmp(bytes, other.bytes, sizeof(bytes)) == 0;
+}
+
+std::string Digest::toHex() const {
+    static const char HEX[] = "0123456789abcdef";
+    std::string out(64, '0');
+    for (int i = 0; i < 32; i++) {
+        out[2 * i] = HEX[bytes[i] >> 4];
+        out[2 * i + 1] = HEX[bytes[i] & 0xF];
+    }
+    return out;
+}
+
+Digest Digest::zero() {
+    Digest d;
+    memset(d.bytes, 0, sizeof(d.bytes));
+    return d;
+}
+
+// ===== SHA extensions (x86) =====
+
+#ifdef SHA_X86
+static bool detectShaExtensions() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+    bool ssse3 = (info[2] & (1 << 9)) != 0;
+    __cpuidex(info, 7, 0);
+    return sse41 && ssse3 && (info[1] & (1 << 29)) != 0;
+#else
+    unsigned a, b, c, d;
+    if (!__get_cpuid(1, &a, &b, &c, &d)) return false;
+    bool sse41 = (c & (1u << 19)) != 0;
+    bool ssse3 = (c & (1u << 9)) != 0;
+    if (!__get_cpuid_count(7, 0, &a, &b, &c, &d)) return false;
+    return sse41 && ssse3 && (b & (1u << 29)) != 0;
+#endif
+}
+
+// CPU features don't change at runtime, detect once
+static const bool hasShaExtensions = detectShaExtensions();
+
+// One block with SHA-NI: four rounds per pair of sha256rnds2, message
+// schedule via sha256msg1/msg2. Lanes hold ABEF / CDGH as the ISA expects.
+TARGET_SHA static void compressShaNi(uint32_t state[8], const unsigned char* chunk) {
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[0]), 0xB1);   // CDAB
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[4]), 0x1B); // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);                                  // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);                                        // CDGH
+
+    const __m128i abefSave = state0;
+    const __m128i cdghSave = state1;
+
+    __m128i msg[4];
+    for (int j = 0; j < 16; j++) {
+        __m128i& cur = msg[j & 3];
+        if (j < 4) cur = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(chunk + 16 * j)), byteSwap);
+
+        __m128i m = _mm_add_epi32(cur, _mm_loadu_si128((const __m128i*)&K[4 * j]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, m);
+
+        // W[4j+4 .. 4j+7] = msg2(msg1 part + W[t-7], W[t-2])
+        if (j >= 3 && j <= 14) {
+            __m128i& next = msg[(j + 1) & 3];
+            next = _mm_add_epi32(next, _mm_alignr_epi8(cur, msg[(j + 3) & 3], 4));
+            next = _mm_sha256msg2_epu32(next, cur);
+        }
+
+        m = _mm_shuffle_epi32(m, 0x0E);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, m);
+
+        if (j >= 1 && j <= 12) {
+            __m128i& prev = msg[(j + 3) & 3];
+            prev = _mm_sha256msg1_epu32(prev, cur);
+        }
+    }
+
+    state0 = _mm_add_epi32(state0, abefSave);
+    state1 = _mm_add_epi32(state1, cdghSave);
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);          // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);       // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);    // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);       // HGFE
+    _mm_storeu_si128((__m128i*)&state[0], state0);
+    _mm_storeu_si128((__m128i*)&state[4], state1);
+}
+#endif
+
+// ===== Sha256 =====
+
+Sha256::Sha256() {
+    static const uint32_t init[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(state, init, sizeof(state));
+    blockUsed = 0;
+    totalBytes = 0;
+}
+
+void Sha256::compress(const unsigned char* chunk) {
+#ifdef SHA_X86
+    if (hasShaExtensions) {
+        compressShaNi(state, chunk);
+        return;
+    }
+#endif
+
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)chunk[4 * i] << 24) | ((uint32_t)chunk[4 * i + 1] << 16) |
+               ((uint32_t)chunk[4 * i + 2] << 8) | (uint32_t)chunk[4 * i + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int i = 0; i < 64; i++) {
+        uint32_t S1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = h + S1 + ch + K[i] + w[i];
+        uint32_t S0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = S0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+void Sha256::update(const void* data, size_t n) {
+    const unsigned char* p = (const unsigned char*)data;
+    totalBytes += n;
+
+    if (blockUsed > 0) {
+        size_t take = 64 - blockUsed;
+        if (take > n) take = n;
+        memcpy(block + blockUsed, p, take);
+        blockUsed += take;
+        p += take;
+        n -= take;
+        if (blockUsed < 64) return;
+        compress(block);
+        blockUsed = 0;
+    }
+
+    while (n >= 64) {
+        compress(p);
+        p += 64;
+        n -= 64;
+    }
+
+    if (n > 0) {
+        memcpy(block, p, n);
+        blockUsed = n;
+    }
+}
+
+Digest Sha256::finish() {
+    uint64_t bits = totalBytes * 8;
+
+    block[blockUsed++] = 0x80;
+    if (blockUsed > 56) {
+        memset(block + blockUsed, 0, 64 - blockUsed);
+        compress(block);
+        blockUsed = 0;
+    }
+    memset(block + blockUsed, 0, 56 - blockUsed);
+    for (int i = 0; i < 8; i++) {
+        block[56 + i] = (unsigned char)(bits >> (56 - 8 * i));
+    }
+    compress(block);
+
+    Digest d;
+    for (int i = 0; i < 8; i++) {
+        d.bytes[4 * i] = (unsigned char)(state[i] >> 24);
+        d.bytes[4 * i + 1] = (unsigned char)(state[i] >> 16);
+        d.bytes[4 * i + 2] = (unsigned char)(state[i] >> 8);
+        d.bytes[4 * i + 3] = (unsigned char)state[i];
+    }
+    return d;
+}
+
+Digest Sha256::hash(const void* data, size_t n) {
+    Sha256 h;
+    h.update(data, n);
+    return h.finish();
+}
@@ -1,29 +1,32 @@
 #include "../include/stack.h"
 
 Stack::Stack(int max) {
-    top = nullptr;
+    maxSize = max > 0 ? max : 0;
+    slots = maxSize > 0 ? new Transaction*[maxSize] : nullptr;
+    head = 0;
     count = 0;
-    maxSize = max;
 }
 
 Stack::~Stack() {
-    while (top != nullptr) {
-        StackNode* temp = top;
-        top = top->next;
-
-        delete temp->data;   // free transaction
-        delete temp;         // free node
+    while (count > 0) {
+        delete pop();   // free transaction
     }
+    delete[] slots;
 }
 
 bool Stack::push(Transaction* t) {
-    if (isFull()) {
+    if (maxSize <= 0) {
         return false;
     }
 
-    StackNode* newNode = new StackNode(t);
-    newNode->next = top;
-    top = newNode;
+    // When full, head is the oldest entry's slot: overwrite it
+    if (isFull()) {
+        delete slots[head];
+        count--;
+    }
+
+    slots[head] = t;
+    head = (head + 1) % maxSize;
     count++;
 
     return true;
@@ -34,12 +37,8 @@ Transaction* Stack::pop() {
         return nullptr;
     }
 
-    StackNode* temp = top;
-    Transaction* t = temp->data;
-
-    top = top->next;
-    delete temp;     // delete only node, NOT transaction (you return it)
+    head = (head + maxSize - 1) % maxSize;
     count--;
 
-    return t;        // caller will delete t when needed
+    return slots[head];   // caller will delete it when needed
 }
@@ -0,0 +1,123 @@
+#include "../include/timer_wheel.h"
+
+TimerWheel::TimerWheel(Timestamp start, Timestamp tickWidth) {
+    this->tickWidth = tickWidth > 0 ? tickWidth : 1;
+    for (int i = 0; i < WHEEL_LEVELS * WHEEL_SLOTS; i++) heads[i] = -1;
+    freeList = -1;
+    pending = 0;
+    currentTick = tickOf(start);
+}
+
+int64_t TimerWheel::tickOf(Timestamp t) const {
+    int64_t q = t / tickWidth;
+    return (t % tickWidth < 0) ? q - 1 : q;    // floor
+}
+
+void TimerWheel::file(int n) {
+    Node& node = nodes[n];
+    int64_t delta = node.expiryTick - currentTick;
+
+    // Lowest level whose turn still reaches the expiry; beyond the top
+    // level's range, park in the top level's furthest slot and re-file later
+    int64_t tick = node.expiryTick;
+    int level = 0;
+    while (level < WHEEL_LEVELS - 1 && delta >= ((int64_t)1 << (WHEEL_SLOT_BITS * (level + 1)))) level++;
+    if (delta >= ((int64_t)1 << (WHEEL_SLOT_BITS * WHEEL_LEVELS))) {
+        tick = currentTick + ((int64_t)1 << (WHEEL_SLOT_BITS * WHEEL_LEVELS)) - 1;
+    }
+
+    int slot = level * WHEEL_SLOTS + (int)((tick >> (WHEEL_SLOT_BITS * level)) & (WHEEL_SLOTS - 1));
+    node.slot = slot;
+    node.prev = -1;
+    node.next = heads[slot];
+    if (node.next >= 0) nodes[node.next].prev = n;
+    heads[slot] = n;
+}
+
+void TimerWheel::unlink(int n) {
+    Node& node = nodes[n];
+    if (node.prev >= 0) nodes[node.prev].next = node.next;
+    else heads[node.slot] = node.next;
+    if (node.next >= 0) nodes[node.next].prev = node.prev;
+}
+
+void TimerWheel::restart(Timestamp start) {
+    if (pending == 0) currentTick = tickOf(start);
+}
+
+int TimerWheel::schedule(Timestamp expiresAt, int payload) {
+    int n;
+    if (freeList >= 0) {
+        n = freeList;
+        freeList = nodes[n].next;
+    } else {
+        n = (int)nodes.size();
+        nodes.emplace_back();
+    }
+
+    // Round up: a timer never fires before its time
+    int64_t tick = tickOf(expiresAt);
+    if (tick * tickWidth < expiresAt) tick++;
+    if (tick <= currentTick) tick = currentTick + 1;
+
+    nodes[n].expiryTick = tick;
+    nodes[n].payload = payload;
+    file(n);
+    pending++;
+    return n;
+}
+
+void TimerWheel::cancel(int handle) {
+    if (handle < 0 || handle >= (int)nodes.size() || nodes[handle].slot < 0) return;
+    unlink(handle);
+    nodes[handle].slot = -1;
+    nodes[handle].next = freeList;
+    freeList = handle;
+    pending--;
+}
+
+void TimerWheel::advance(Timestamp now, std::vector<int>& fired) {
+    int64_t target = tickOf(now);
+
+    while (currentTick < target) {
+        // Nothing pending: jump straight there
+        if (pending == 0) {
+            currentTick = target;
+            break;
+        }
+        currentTick++;
+
+        // Cascade every level that wrapped, highest first, so re-filed
+        // timers never land in a slot that was already emptied this tick
+        int wrapped = 0;
+        while (wrapped + 1 < WHEEL_LEVELS &&
+               (currentTick & (((int64_t)1 << (WHEEL_SLOT_BITS * (wrapped + 1))) - 1)) == 0) {
+            wrapped++;
+        }
+        for (int level = wrapped; level >= 1; level--) {
+            int slot = level * WHEEL_SLOTS +
+                       (int)((currentTick >> (WHEEL_SLOT_BITS * level)) & (WHEEL_SLOTS - 1));
+            int n = heads[slot];
+            heads[slot] = -1;
+            while (n >= 0) {
+                int next = nodes[n].next;
+                file(n);
+                n = next;
+            }
+        }
+
+        // Level 0: everything in this slot is due now
+        int slot = (int)(currentTick & (WHEEL_SLOTS - 1));
+        int n = heads[slot];
+        heads[slot] = -1;
+        while (n >= 0) {
+            int next = nodes[n].next;
+            fired.push_back(nodes[n].payload);
+            nodes[n].slot = -1;
+            nodes[n].next = freeList;
+            freeList = n;
+            pending--;
+            n = next;
+        }
+    }
+}
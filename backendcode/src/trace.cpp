@@ -0,0 +1,152 @@
+#include "../include/trace.h"
+#include "../include/exporter.h"
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+
+std::atomic<bool> tracingActive(false);
+
+// ===== Per-thread rings =====
+
+// Rings are never freed: a thread that exits hands its ring back and the
+// next new thread reuses it, so short-lived workers don't grow memory.
+struct ThreadRing {
+    TraceEvent events[TRACE_RING_CAPACITY];
+    std::atomic<uint64_t> written;    // total events ever written (single writer)
+    std::atomic<uint64_t> floor;      // events before this were cleared
+    std::atomic<bool> inUse;
+    std::atomic<const char*> threadName;
+    int tid;
+    ThreadRing* next;
+};
+
+static std::atomic<ThreadRing*> rings(nullptr);
+static std::atomic<int> nextTid(1);
+static const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+
+static int64_t traceNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - traceEpoch).count();
+}
+
+static ThreadRing* acquireRing() {
+    // Reuse a ring released by a finished thread
+    for (ThreadRing* r = rings.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+        bool expected = false;
+        if (r->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return r;
+        }
+    }
+
+    ThreadRing* r = new ThreadRing();
+    r->written.store(0, std::memory_order_relaxed);
+    r->floor.store(0, std::memory_order_relaxed);
+    r->inUse.store(true, std::memory_order_relaxed);
+    r->threadName.store(nullptr, std::memory_order_relaxed);
+    r->tid = nextTid.fetch_add(1, std::memory_order_relaxed);
+
+    ThreadRing* head = rings.load(std::memory_order_relaxed);
+    do {
+        r->next = head;
+    } while (!rings.compare_exchange_weak(head, r, std::memory_order_release,
+                                          std::memory_order_relaxed));
+    return r;
+}
+
+// Owns the calling thread's ring; releases it when the thread exits
+struct RingLease {
+    ThreadRing* ring = nullptr;
+
+    ~RingLease() {
+        if (ring != nullptr) ring->inUse.store(false, std::memory_order_release);
+    }
+};
+
+static thread_local RingLease lease;
+
+static ThreadRing* localRing() {
+    if (lease.ring == nullptr) lease.ring = acquireRing();
+    return lease.ring;
+}
+
+// ===== Spans =====
+
+void TraceSpan::begin(const char* spanName) {
+    name = spanName;
+    start = traceNow();
+}
+
+void TraceSpan::end() {
+    int64_t stop = traceNow();
+    ThreadRing* r = localRing();
+
+    uint64_t idx = r->written.load(std::memory_order_relaxed);
+    TraceEvent& e = r->events[idx & (TRACE_RING_CAPACITY - 1)];
+    e.name = name;
+    e.startNs = start;
+    e.durationNs = stop - start;
+    r->written.store(idx + 1, std::memory_order_release);
+}
+
+void setTracingEnabled(bool enabled) {
+    tracingActive.store(enabled, std::memory_order_relaxed);
+}
+
+bool isTracingEnabled() {
+    return tracingActive.load(std::memory_order_relaxed);
+}
+
+void setTraceThreadName(const char* name) {
+#if BANK_LEDGER_TRACING
+    localRing()->threadName.store(name, std::memory_order_relaxed);
+#else
+    (void)name;
+#endif
+}
+
+void clearTraceBuffers() {
+    for (ThreadRing* r = rings.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+        r->floor.store(r->written.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+// ===== Chrome trace_event export =====
+
+static void writeMicros(std::ofstream& out, int64_t ns) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%lld.%03lld", (long long)(ns / 1000), (long long)(ns % 1000));
+    out << buf;
+}
+
+bool writeChromeTrace(const std::string& path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+           "\"args\":{\"name\":\"bank_ledger\"}}";
+
+    for (ThreadRing* r = rings.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+        const char* threadName = r->threadName.load(std::memory_order_relaxed);
+        std::string label = threadName ? threadName : "thread " + std::to_string(r->tid);
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << r->tid
+            << ",\"args\":{\"name\":\"" << jsonEscape(label) << "\"}}";
+
+        uint64_t written = r->written.load(std::memory_order_acquire);
+        uint64_t first = r->floor.load(std::memory_order_relaxed);
+        if (written - first > TRACE_RING_CAPACITY) first = written - TRACE_RING_CAPACITY;
+
+        for (uint64_t i = first; i < written; i++) {
+            const TraceEvent& e = r->events[i & (TRACE_RING_CAPACITY - 1)];
+            out << ",\n{\"name\":\"" << jsonEscape(e.name) << "\",\"cat\":\"ledger\",\"ph\":\"X\","
+                << "\"pid\":1,\"tid\":" << r->tid << ",\"ts\":";
+            writeMicros(out, e.startNs);
+            out << ",\"dur\":";
+            writeMicros(out, e.durationNs);
+            out << "}";
+        }
+    }
+
+    out << "\n]}\n";
+    return (bool)out;
+}
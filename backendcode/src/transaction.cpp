@@ -3,14 +3,15 @@
 #include <iomanip>
 
 Transaction::Transaction(int id, const std::string& type, double amount,
-                         const std::string& desc, double balanceAfter)
+                         const std::string& desc, double balanceAfter, Timestamp timestamp)
 {
     this->id = id;
     this->type = type;
     this->amount = amount;
     this->description = desc;
     this->balanceAfter = balanceAfter;
-    this->timestamp = time(nullptr);
+    this->timestamp = timestamp;
+    this->chainHash = Digest::zero();
 }
 
 void Transaction::display() const {
@@ -0,0 +1,79 @@
+#include "../include/vector_history.h"
+#include <algorithm>
+#include <iostream>
+
+VectorHistory::~VectorHistory() {
+    for (Transaction* t : items) delete t;
+}
+
+Transaction* VectorHistory::removeLast() {
+    if (items.empty()) return nullptr;
+
+    Transaction* t = items.back();
+    items.pop_back();
+    return t;
+}
+
+Transaction* VectorHistory::removeByID(int id) {
+    if (items.empty()) return nullptr;
+
+    // Fast path: newest posting is still last (not re-sorted)
+    if (items.back()->id == id) return removeLast();
+
+    auto it = std::find_if(items.begin(), items.end(),
+                           [id](const Transaction* t) { return t->id == id; });
+    if (it == items.end()) return nullptr;
+
+    Transaction* t = *it;
+    items.erase(it);
+    return t;
+}
+
+int VectorHistory::discardBefore(int id) {
+    auto keep = std::stable_partition(items.begin(), items.end(),
+                                      [id](const Transaction* t) { return t->id >= id; });
+    int removed = (int)(items.end() - keep);
+    for (auto it = keep; it != items.end(); ++it) delete *it;
+    items.erase(keep, items.end());
+    return removed;
+}
+
+void VectorHistory::display() {
+    if (items.empty()) {
+        std::cout << "No transactions found.\n";
+        return;
+    }
+
+    std::cout << "\n=== Transaction History ===\n";
+    std::cout << "Total Transactions: " << items.size() << "\n";
+    std::cout << "----------------------------\n";
+
+    int num = 1;
+    for (Transaction* t : items) {
+        std::cout << num++ << ". ";
+        t->display();
+    }
+}
+
+void VectorHistory::sortByDate() {
+    std::stable_sort(items.begin(), items.end(),
+                     [](const Transaction* a, const Transaction* b) { return a->timestamp < b->timestamp; });
+}
+
+void VectorHistory::sortByAmount() {
+    std::stable_sort(items.begin(), items.end(),
+                     [](const Transaction* a, const Transaction* b) { return a->amount < b->amount; });
+}
+
+Transaction** VectorHistory::toArray() {
+    if (items.empty()) return nullptr;
+
+    Transaction** arr = new Transaction*[items.size()];
+    std::copy(items.begin(), items.end(), arr);
+    return arr;
+}
+
+Transaction* VectorHistory::getAt(int index) {
+    if (index < 0 || index >= (int)items.size()) return nullptr;
+    return items[index];
+}
@@ -0,0 +1,103 @@
+#include "../include/velocity_limits.h"
+#include <cmath>
+
+VelocityLimits::VelocityLimits() {
+    ruleCount = 0;
+}
+
+#define SLOT(e) ((int)((e) & (VELOCITY_BUCKETS - 1)))
+
+int64_t VelocityLimits::cents(double amount) {
+    return (int64_t)std::llround(amount * 100.0);
+}
+
+int64_t VelocityLimits::epochOf(const Window& w, Timestamp t) {
+    // Postings mostly land in the newest bucket: skip the division
+    if (t >= w.newestStart && t - w.newestStart < w.bucketWidth) return w.newestEpoch;
+    int64_t e = t / w.bucketWidth;
+    return (t % w.bucketWidth < 0) ? e - 1 : e;
+}
+
+void VelocityLimits::slide(Window& w, int64_t epoch) {
+    if (epoch <= w.newestEpoch) return;
+
+    // Slots that fall out of the window: at most one lap, however long the gap
+    int64_t from = w.newestEpoch + 1;
+    if (epoch - from >= VELOCITY_BUCKETS) from = epoch - VELOCITY_BUCKETS + 1;
+    for (int64_t e = from; e <= epoch; e++) {
+        int slot = SLOT(e);
+        w.total -= w.units[slot];
+        w.units[slot] = 0;
+        w.epochs[slot] = e;
+    }
+    w.newestEpoch = epoch;
+    w.newestStart = epoch * w.bucketWidth;
+}
+
+int VelocityLimits::setRules(const VelocityRule* rules, int n) {
+    ruleCount = 0;
+    for (int i = 0; i < n && ruleCount < VELOCITY_MAX_RULES; i++) {
+        const VelocityRule& r = rules[i];
+        if (r.window < VELOCITY_BUCKETS || r.limit < 0.0) continue;
+        if (r.metric != VELOCITY_AMOUNT && r.metric != VELOCITY_COUNT) continue;
+
+        Window& w = windows[ruleCount++];
+        w.rule = r;
+        w.bucketWidth = r.window / VELOCITY_BUCKETS;
+        w.limitUnits = (r.metric == VELOCITY_COUNT) ? (int64_t)r.limit : cents(r.limit);
+        for (int s = 0; s < VELOCITY_BUCKETS; s++) {
+            w.epochs[s] = INT64_MIN;
+            w.units[s] = 0;
+        }
+        w.total = 0;
+        w.newestEpoch = INT64_MIN / 2;   // far past: the first slide clears one lap
+        w.newestStart = INT64_MAX;
+    }
+    return ruleCount;
+}
+
+int VelocityLimits::getRules(VelocityRule* out) const {
+    for (int i = 0; i < ruleCount; i++) out[i] = windows[i].rule;
+    return ruleCount;
+}
+
+int VelocityLimits::check(Timestamp now, double amount) {
+    int64_t c = cents(amount);
+    for (int i = 0; i < ruleCount; i++) {
+        Window& w = windows[i];
+        slide(w, epochOf(w, now));
+        if (w.total + (w.rule.metric == VELOCITY_COUNT ? 1 : c) > w.limitUnits) return i;
+    }
+    return -1;
+}
+
+void VelocityLimits::record(Timestamp t, double amount) {
+    int64_t c = cents(amount);
+    for (int i = 0; i < ruleCount; i++) {
+        Window& w = windows[i];
+        int64_t e = epochOf(w, t);
+        slide(w, e);
+
+        // Older than the window (e.g. imported history): nothing to count
+        int slot = SLOT(e);
+        if (w.epochs[slot] != e) continue;
+        int64_t u = (w.rule.metric == VELOCITY_COUNT) ? 1 : c;
+        w.units[slot] += u;
+        w.total += u;
+    }
+}
+
+void VelocityLimits::revert(Timestamp t, double amount) {
+    int64_t c = cents(amount);
+    for (int i = 0; i < ruleCount; i++) {
+        Window& w = windows[i];
+        int64_t e = epochOf(w, t);
+
+        // Only if its bucket is still in the window
+        int slot = SLOT(e);
+        if (w.epochs[slot] != e) continue;
+        int64_t u = (w.rule.metric == VELOCITY_COUNT) ? 1 : c;
+        w.units[slot] -= u;
+        w.total -= u;
+    }
+}
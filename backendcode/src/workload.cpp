@@ -0,0 +1,331 @@
+#include "../include/workload.h"
+#include "../include/bank_ledger.h"
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <thread>
+#include <deque>
+#include <cmath>
+#include <cstring>
+
+WorkloadConfig::WorkloadConfig() {
+    seed = 42;
+    operations = 100000;
+
+    depositWeight = 0.55;
+    withdrawWeight = 0.30;
+    undoWeight = 0.05;
+    queryWeight = 0.10;
+
+    amountMu = 3.5;           // median ~$33
+    amountSigma = 1.2;
+    overdraftRate = 0.02;
+
+    vocabularySize = 500;
+    zipfExponent = 1.1;
+
+    ratePerSecond = 2000.0;
+    burstFactor = 20.0;
+    burstProbability = 0.001;
+    meanBurstLength = 200.0;
+
+    initialBalance = 1000.0;
+}
+
+// ===== Random numbers =====
+
+static uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+WorkloadRandom::WorkloadRandom(uint64_t seed) {
+    for (int i = 0; i < 4; i++) s[i] = splitmix64(seed);
+}
+
+uint64_t WorkloadRandom::next() {
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+double WorkloadRandom::uniform() {
+    return (double)(next() >> 11) * (1.0 / 9007199254740992.0);   // 53 bits
+}
+
+double WorkloadRandom::exponential(double mean) {
+    return -mean * std::log(1.0 - uniform());
+}
+
+double WorkloadRandom::normal() {
+    // Box-Muller; one value per call keeps the stream easy to reason about
+    double u1 = 1.0 - uniform();
+    double u2 = uniform();
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+}
+
+// ===== Generator =====
+
+static const char* VOCABULARY_STEMS[] = {
+    "Groceries", "Salary", "Rent", "Coffee", "Fuel", "Utilities", "Dining",
+    "Transfer", "Subscription", "Pharmacy", "Travel", "Insurance", "Refund",
+    "Gift", "ATM Cash", "Online Shopping", "Gym", "Phone Bill", "Parking", "Books"
+};
+static const int VOCABULARY_STEM_COUNT = sizeof(VOCABULARY_STEMS) / sizeof(VOCABULARY_STEMS[0]);
+
+static std::string vocabularyWord(int index) {
+    std::string word = VOCABULARY_STEMS[index % VOCABULARY_STEM_COUNT];
+    if (index >= VOCABULARY_STEM_COUNT) word += " #" + std::to_string(index / VOCABULARY_STEM_COUNT);
+    return word;
+}
+
+static double centsAmount(WorkloadRandom& rng, double mu, double sigma) {
+    double v = std::exp(mu + sigma * rng.normal());
+    v = std::round(v * 100.0) / 100.0;
+    return v < 0.01 ? 0.01 : v;
+}
+
+void generateWorkload(const WorkloadConfig& config, std::vector<TraceOp>& ops) {
+    WorkloadRandom rng(config.seed);
+
+    ops.clear();
+    ops.reserve((size_t)config.operations);
+
+    // Zipf CDF over the vocabulary; rank 0 is the most common description
+    int vocab = config.vocabularySize > 0 ? config.vocabularySize : 1;
+    std::vector<double> zipfCdf(vocab);
+    double sum = 0.0;
+    for (int i = 0; i < vocab; i++) {
+        sum += 1.0 / std::pow((double)(i + 1), config.zipfExponent);
+        zipfCdf[i] = sum;
+    }
+    std::vector<std::string> words(vocab);
+    for (int i = 0; i < vocab; i++) words[i] = vocabularyWord(i);
+
+    double totalWeight = config.depositWeight + config.withdrawWeight +
+                         config.undoWeight + config.queryWeight;
+    if (totalWeight <= 0.0) return;
+
+    // Model of the ledger, so rejections and undos are intentional
+    double balance = config.initialBalance;
+    std::deque<double> undoDeltas;      // bounded like the ledger's undo stack
+    int lastID = 0;
+
+    double clock = 0.0;
+    long long burstLeft = 0;
+
+    for (long long n = 0; n < config.operations; n++) {
+        // Markov-modulated Poisson arrivals
+        if (burstLeft == 0 && rng.uniform() < config.burstProbability) {
+            burstLeft = 1 + (long long)rng.exponential(config.meanBurstLength);
+        }
+        double rate = config.ratePerSecond;
+        if (burstLeft > 0) {
+            rate *= config.burstFactor;
+            burstLeft--;
+        }
+        clock += rng.exponential(1e9 / rate);
+
+        TraceOp op;
+        op.arrivalNs = (int64_t)clock;
+        op.amount = 0.0;
+        op.arg = 0;
+
+        double pick = rng.uniform() * totalWeight;
+        if (pick < config.depositWeight) {
+            op.kind = TRACE_DEPOSIT;
+            op.amount = centsAmount(rng, config.amountMu, config.amountSigma);
+        } else if ((pick -= config.depositWeight) < config.withdrawWeight) {
+            op.kind = TRACE_WITHDRAW;
+            if (rng.uniform() < config.overdraftRate || balance < 0.01) {
+                op.amount = std::round((balance + centsAmount(rng, config.amountMu,
+                                        config.amountSigma)) * 100.0) / 100.0;
+            } else {
+                op.amount = centsAmount(rng, config.amountMu, config.amountSigma);
+                if (op.amount > balance) op.amount = std::floor(balance * rng.uniform() * 100.0) / 100.0;
+                if (op.amount < 0.01) op.amount = 0.01;
+            }
+        } else if ((pick -= config.withdrawWeight) < config.undoWeight) {
+            op.kind = TRACE_UNDO;
+        } else {
+            double q = rng.uniform();
+            if (q < 0.6) {
+                op.kind = TRACE_BALANCE;
+            } else if (q < 0.9) {
+                op.kind = TRACE_AGGREGATE;
+                op.arg = 1 + (int)(rng.next() % 3);      // AGG_DEPOSITS..AGG_ALL
+            } else {
+                op.kind = TRACE_SEARCH;
+                // Mostly hits, with a few IDs past the end
+                op.arg = 1 + (int)(rng.uniform() * (lastID + lastID / 10 + 1));
+            }
+        }
+
+        if (op.kind == TRACE_DEPOSIT || op.kind == TRACE_WITHDRAW) {
+            op.description = words[std::lower_bound(zipfCdf.begin(), zipfCdf.end(),
+                                                    rng.uniform() * sum) - zipfCdf.begin()];
+        }
+
+        // Advance the model exactly as the ledger will
+        if (op.kind == TRACE_DEPOSIT) {
+            balance += op.amount;
+            lastID++;
+            undoDeltas.push_back(op.amount);
+        } else if (op.kind == TRACE_WITHDRAW && op.amount <= balance) {
+            balance -= op.amount;
+            lastID++;
+            undoDeltas.push_back(-op.amount);
+        } else if (op.kind == TRACE_UNDO && !undoDeltas.empty()) {
+            balance -= undoDeltas.back();
+            undoDeltas.pop_back();
+        }
+        if (undoDeltas.size() > UNDO_LIMIT) undoDeltas.pop_front();
+
+        ops.push_back(std::move(op));
+    }
+}
+
+// ===== Trace files =====
+
+bool writeTrace(const std::string& path, const TraceHeader& header,
+                const std::vector<TraceOp>& ops) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    out << "# bank_ledger trace v1 seed=" << header.seed << " balance="
+        << std::fixed << std::setprecision(2) << header.initialBalance << "\n";
+
+    for (const TraceOp& op : ops) {
+        out << op.arrivalNs << ' ' << op.kind << ' ' << op.amount << ' ' << op.arg;
+        if (!op.description.empty()) out << ' ' << op.description;
+        out << '\n';
+    }
+    return (bool)out;
+}
+
+// Parse one whitespace-delimited field and advance p past it
+template <typename T>
+static bool parseField(const char*& p, const char* end, T& value) {
+    while (p < end && *p == ' ') p++;
+    std::from_chars_result r = std::from_chars(p, end, value);
+    if (r.ec != std::errc()) return false;
+    p = r.ptr;
+    return true;
+}
+
+bool readTrace(const std::string& path, TraceHeader& header, std::vector<TraceOp>& ops) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    std::string line;
+    if (!std::getline(in, line)) return false;
+
+    const char* magic = "# bank_ledger trace v1";
+    if (line.compare(0, strlen(magic), magic) != 0) return false;
+
+    header.seed = 0;
+    header.initialBalance = 0.0;
+    size_t at = line.find("seed=");
+    if (at != std::string::npos) {
+        const char* p = line.c_str() + at + 5;
+        parseField(p, line.c_str() + line.size(), header.seed);
+    }
+    at = line.find("balance=");
+    if (at != std::string::npos) {
+        const char* p = line.c_str() + at + 8;
+        parseField(p, line.c_str() + line.size(), header.initialBalance);
+    }
+
+    ops.clear();
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+
+        const char* p = line.c_str();
+        const char* end = p + line.size();
+        TraceOp op;
+
+        if (!parseField(p, end, op.arrivalNs)) return false;
+        while (p < end && *p == ' ') p++;
+        if (p == end) return false;
+        op.kind = *p++;
+        if (!parseField(p, end, op.amount) || !parseField(p, end, op.arg)) return false;
+        if (p < end && *p == ' ') p++;
+        op.description.assign(p, end);
+
+        ops.push_back(std::move(op));
+    }
+    return true;
+}
+
+// ===== Replay =====
+
+ReplayReport replayTrace(BankLedger& ledger, const std::vector<TraceOp>& ops, bool paced) {
+    ReplayReport report;
+    memset(&report, 0, sizeof(report));
+
+    volatile double sink = 0.0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (const TraceOp& op : ops) {
+        if (paced) {
+            std::this_thread::sleep_until(start + std::chrono::nanoseconds(op.arrivalNs));
+        }
+
+        switch (op.kind) {
+            case TRACE_DEPOSIT:
+            case TRACE_WITHDRAW: {
+                int before = ledger.getTransactionCount();
+                if (op.kind == TRACE_DEPOSIT) ledger.deposit(op.amount, op.description);
+                else ledger.withdraw(op.amount, op.description);
+
+                if (ledger.getTransactionCount() != before) report.postings++;
+                else report.rejected++;
+                break;
+            }
+            case TRACE_UNDO:
+                if (ledger.canUndo()) report.undos++;
+                else report.rejected++;
+                ledger.undo();
+                break;
+            case TRACE_SEARCH:
+                ledger.searchByID(op.arg);
+                report.queries++;
+                break;
+            case TRACE_AGGREGATE: {
+                AggregateResult r;
+                if (ledger.aggregate(op.arg, 0, INT64_MAX, r)) sink = sink + r.totalDeposits;
+                report.queries++;
+                break;
+            }
+            case TRACE_BALANCE:
+                sink = sink + ledger.getBalance();
+                report.queries++;
+                break;
+            default:
+                report.rejected++;
+                break;
+        }
+        report.operations++;
+    }
+
+    auto stop = std::chrono::steady_clock::now();
+    report.seconds = std::chrono::duration<double>(stop - start).count();
+    report.opsPerSecond = report.seconds > 0 ? report.operations / report.seconds : 0.0;
+    report.finalBalance = ledger.getBalance();
+    (void)sink;
+    return report;
+}
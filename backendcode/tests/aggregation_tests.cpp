@@ -0,0 +1,107 @@
+#include "test_util.h"
+#include "../include/aggregation.h"
+#include "../include/transaction.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+struct Row {
+    unsigned char kind;
+    double amount;
+    int64_t timestamp;
+};
+
+static std::vector<Row> sampleRows(size_t n) {
+    std::vector<Row> rows(n);
+    unsigned long long state = 7 + n;
+    for (size_t i = 0; i < n; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        rows[i].kind = ((state >> 40) & 1) ? KIND_WITHDRAWAL : KIND_DEPOSIT;
+        rows[i].amount = (double)((state >> 20) % 100000) / 100.0 + 0.01;
+        rows[i].timestamp = START + (int64_t)i * MINUTE;
+    }
+    return rows;
+}
+
+// Plain loop the kernels must agree with
+static AggregateResult reference(const std::vector<Row>& rows, int typeMask, int64_t fromTs, int64_t toTs) {
+    AggregateResult r = AggregateResult();
+    double lo = std::numeric_limits<double>::infinity(), hi = -lo;
+    for (const Row& row : rows) {
+        if (row.timestamp < fromTs || row.timestamp > toTs) continue;
+        bool withdrawal = (row.kind == KIND_WITHDRAWAL);
+        if (!(typeMask & (withdrawal ? AGG_WITHDRAWALS : AGG_DEPOSITS))) continue;
+        if (withdrawal) {
+            r.totalWithdrawals += row.amount;
+            r.withdrawalCount++;
+        } else {
+            r.totalDeposits += row.amount;
+            r.depositCount++;
+        }
+        if (row.amount < lo) lo = row.amount;
+        if (row.amount > hi) hi = row.amount;
+    }
+    int count = r.depositCount + r.withdrawalCount;
+    if (count > 0) {
+        r.minAmount = lo;
+        r.maxAmount = hi;
+        r.avgAmount = (r.totalDeposits + r.totalWithdrawals) / count;
+    }
+    return r;
+}
+
+// Sums may be added in a different order; everything else is exact
+static bool sameResult(const AggregateResult& a, const AggregateResult& b) {
+    return a.depositCount == b.depositCount && a.withdrawalCount == b.withdrawalCount &&
+           a.minAmount == b.minAmount && a.maxAmount == b.maxAmount &&
+           std::fabs(a.totalDeposits - b.totalDeposits) < 1e-6 &&
+           std::fabs(a.totalWithdrawals - b.totalWithdrawals) < 1e-6 &&
+           std::fabs(a.avgAmount - b.avgAmount) < 1e-9;
+}
+
+TEST(aggregation, kernelsMatchScalarReference) {
+    const size_t lengths[] = { 0, 1, 2, 3, 5, 7, 8, 9, 15, 16, 17, 31, 33, 63, 65, 1001 };
+    const int masks[] = { AGG_DEPOSITS, AGG_WITHDRAWALS, AGG_ALL };
+    const AggregationKernel kernels[] = { KERNEL_SCALAR, KERNEL_SSE42, KERNEL_AVX2 };
+
+    for (size_t n : lengths) {
+        std::vector<Row> rows = sampleRows(n);
+        TransactionColumns cols;
+        std::vector<Transaction> postings;
+        std::vector<Transaction*> items;
+        postings.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            cols.append((int)i + 1, rows[i].kind, rows[i].amount, rows[i].timestamp, 0.0);
+            postings.emplace_back((int)i + 1, rows[i].kind == KIND_WITHDRAWAL ? "WITHDRAWAL" : "DEPOSIT",
+                                  rows[i].amount, "Row", 0.0, rows[i].timestamp);
+        }
+        for (Transaction& t : postings) items.push_back(&t);
+
+        // Whole range, a window starting and ending mid-vector, and nothing
+        int64_t windows[][2] = { { INT64_MIN, INT64_MAX },
+                                 { START + 3 * MINUTE, START + (int64_t)(n / 2 + 1) * MINUTE },
+                                 { START - 2 * MINUTE, START - MINUTE } };
+        for (auto& w : windows) {
+            for (int mask : masks) {
+                AggregateResult want = reference(rows, mask, w[0], w[1]);
+                for (AggregationKernel k : kernels) {
+                    CHECK(sameResult(aggregateWithKernel(cols, mask, w[0], w[1], k), want));
+                }
+                CHECK(sameResult(aggregateTransactions(cols, mask, w[0], w[1]), want));
+                CHECK(sameResult(aggregateArrayScalar(items.data(), (int)n, mask, w[0], w[1]), want));
+            }
+        }
+    }
+}
+
+TEST(aggregation, combineDisjointResults) {
+    std::vector<Row> rows = sampleRows(100);
+    std::vector<Row> first(rows.begin(), rows.begin() + 37), second(rows.begin() + 37, rows.end());
+
+    AggregateResult merged = combineAggregates(reference(first, AGG_ALL, INT64_MIN, INT64_MAX),
+                                               reference(second, AGG_ALL, INT64_MIN, INT64_MAX));
+    CHECK(sameResult(merged, reference(rows, AGG_ALL, INT64_MIN, INT64_MAX)));
+
+    AggregateResult none = AggregateResult();
+    CHECK(sameResult(combineAggregates(none, merged), merged));
+}
@@ -0,0 +1,163 @@
+#include "test_util.h"
+#include "../include/bank_ledger.h"
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Same postings into an archived ledger (hot limit 1000, so IDs 1..8192 go
+// to two segments) and an all-in-memory one, which serves as the reference
+static const int POSTINGS = 10000;
+static const int SEGMENT = (int)ARCHIVE_SEGMENT_ROWS;
+static const int FIRST_HOT = 2 * SEGMENT + 1;
+
+static std::filesystem::path archiveDir() {
+    return std::filesystem::temp_directory_path() / "bank_ledger_archive_tests";
+}
+
+static std::filesystem::path segmentFile(int index) {
+    char name[32];
+    snprintf(name, sizeof(name), "segment_%06d.blgs", index);
+    return archiveDir() / name;
+}
+
+static Timestamp timeOf(int id) { return START + (Timestamp)(id - 1) * MINUTE; }
+
+static void fillLedger(BankLedger& ledger) {
+    ledger.setClock(LedgerClock::fake(START, MINUTE));
+    for (int id = 1; id <= POSTINGS; id++) {
+        double amount = 1.0 + id % 17;
+        if (id % 3 == 0) ledger.withdraw(amount, "Withdrawal " + std::to_string(id));
+        else ledger.deposit(amount, "Deposit " + std::to_string(id));
+    }
+}
+
+static bool sameAggregate(const AggregateResult& a, const AggregateResult& b) {
+    return a.depositCount == b.depositCount && a.withdrawalCount == b.withdrawalCount &&
+           a.minAmount == b.minAmount && a.maxAmount == b.maxAmount &&
+           std::fabs(a.totalDeposits - b.totalDeposits) < 1e-6 &&
+           std::fabs(a.totalWithdrawals - b.totalWithdrawals) < 1e-6;
+}
+
+static bool sameRecord(const TransactionRecord& a, const TransactionRecord& b) {
+    return a.id == b.id && a.kind == b.kind && a.amount == b.amount && a.timestamp == b.timestamp &&
+           a.balanceAfter == b.balanceAfter && strcmp(a.description, b.description) == 0;
+}
+
+TEST(archive, compactedLedgerMatchesInMemory) {
+    std::filesystem::remove_all(archiveDir());
+    {
+        BankLedger archived(1000000.0, true), plain(1000000.0, true);
+        fillLedger(archived);
+        fillLedger(plain);
+        CHECK(archived.enableArchive(archiveDir().string(), 1000));
+        CHECK(archived.getArchivedCount() == (uint64_t)(FIRST_HOT - 1));
+        CHECK(std::filesystem::exists(segmentFile(1)));
+
+        // Everything (segment summaries only), windows cutting into each
+        // segment, one inside a segment and one in memory only
+        Timestamp windows[][2] = { { 0, INT64_MAX },
+                                   { timeOf(100), timeOf(5000) },
+                                   { timeOf(5000), timeOf(9000) },
+                                   { timeOf(4200), timeOf(4300) },
+                                   { timeOf(FIRST_HOT), timeOf(POSTINGS) } };
+        for (auto& w : windows) {
+            for (int mask : { AGG_DEPOSITS, AGG_WITHDRAWALS, AGG_ALL }) {
+                AggregateResult got, want;
+                CHECK(archived.aggregate(mask, w[0], w[1], got));
+                CHECK(plain.aggregate(mask, w[0], w[1], want));
+                CHECK(sameAggregate(got, want));
+            }
+        }
+
+        // Search in each segment and in memory
+        for (int id : { 1, SEGMENT, SEGMENT + 1, FIRST_HOT - 1, FIRST_HOT }) {
+            Transaction* a = archived.searchByID(id);
+            Transaction* p = plain.searchByID(id);
+            CHECK(a != nullptr && p != nullptr);
+            if (!a || !p) continue;
+            CHECK(a->id == id && a->type == p->type && a->amount == p->amount &&
+                  a->timestamp == p->timestamp && a->description == p->description);
+            CHECK_MONEY(a->balanceAfter, p->balanceAfter);
+        }
+        CHECK(archived.searchByID(POSTINGS + 1) == nullptr);
+
+        // A full history scan reads the same rows
+        HistoryFilter all;
+        memset(&all, 0, sizeof(all));
+        HistoryCursor a = makeHistoryCursor(all, 500), p = makeHistoryCursor(all, 500);
+        std::vector<TransactionRecord> fromArchive(500), fromMemory(500);
+        int n, rows = 0;
+        bool same = true;
+        while ((n = archived.readHistory(a, fromArchive.data())) > 0) {
+            same = same && plain.readHistory(p, fromMemory.data()) == n;
+            for (int i = 0; same && i < n; i++) {
+                same = sameRecord(fromArchive[(size_t)i], fromMemory[(size_t)i]);
+            }
+            rows += n;
+        }
+        CHECK(n == 0);
+        CHECK(same);
+        CHECK(rows == POSTINGS);
+
+        // The segments still prove against the chain
+        CHECK(archived.verifyHistory(1, POSTINGS));
+        CHECK(archived.verifyHistory(SEGMENT - 5, SEGMENT + 5));
+        CHECK(archived.verifyHistory(FIRST_HOT - 5, FIRST_HOT + 5));
+        CHECK(archived.getAuditRoot() == plain.getAuditRoot());
+    }
+    std::filesystem::remove_all(archiveDir());
+}
+
+TEST(archive, unreadableSegmentIsReported) {
+    std::filesystem::remove_all(archiveDir());
+    {
+        BankLedger ledger(1000000.0, true);
+        fillLedger(ledger);
+        CHECK(ledger.enableArchive(archiveDir().string(), 1000));
+
+        // Nothing loaded yet, so the cache can't hide the missing file
+        CHECK(std::filesystem::remove(segmentFile(1)));
+
+        // Windows wholly covering the segment only need its summary
+        AggregateResult r;
+        CHECK(ledger.aggregate(AGG_ALL, 0, INT64_MAX, r));
+        CHECK(r.depositCount + r.withdrawalCount == POSTINGS);
+
+        // Partial overlaps need the file
+        CHECK(!ledger.aggregate(AGG_ALL, timeOf(5000), timeOf(9000), r));
+        CHECK(ledger.aggregate(AGG_ALL, timeOf(100), timeOf(200), r));   // segment 0 only
+        CHECK(r.depositCount + r.withdrawalCount == 101);
+
+        CHECK(ledger.searchByID(5000) == nullptr);
+        CHECK(ledger.searchByID(100) != nullptr);
+        CHECK(!ledger.verifyHistory(1, POSTINGS));
+        CHECK(ledger.verifyHistory(1, SEGMENT));
+
+        HistoryFilter all;
+        memset(&all, 0, sizeof(all));
+        HistoryCursor cursor = makeHistoryCursor(all, SEGMENT);
+        std::vector<TransactionRecord> chunk(SEGMENT);
+        CHECK(ledger.readHistory(cursor, chunk.data()) == SEGMENT);
+        CHECK(ledger.readHistory(cursor, chunk.data()) == -1);
+    }
+    std::filesystem::remove_all(archiveDir());
+}
+
+TEST(archive, truncatedSegmentIsReported) {
+    std::filesystem::remove_all(archiveDir());
+    {
+        BankLedger ledger(1000000.0, true);
+        fillLedger(ledger);
+        CHECK(ledger.enableArchive(archiveDir().string(), 1000));
+
+        std::filesystem::resize_file(segmentFile(0), std::filesystem::file_size(segmentFile(0)) / 2);
+
+        AggregateResult r;
+        CHECK(!ledger.aggregate(AGG_DEPOSITS, timeOf(100), timeOf(5000), r));
+        CHECK(ledger.aggregate(AGG_DEPOSITS, timeOf(5000), timeOf(9000), r));
+        CHECK(ledger.searchByID(100) == nullptr);
+        CHECK(!ledger.verifyHistory(100, 200));
+    }
+    std::filesystem::remove_all(archiveDir());
+}
@@ -0,0 +1,85 @@
+#include "test_util.h"
+#include "../include/bank_ledger.h"
+#include "../include/async_executor.h"
+#include "../include/exporter.h"
+#include "../include/importer.h"
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <string>
+
+// The C API (src/ffi_bridge.cpp)
+extern "C" {
+    void* createBankLedger(double initialBalance);
+    void deleteBankLedger(void* ledger);
+    long long asyncImportTransactionsFromFile(void* ledger, const char* path, int format, int threads);
+    long long asyncExportStatement(void* ledger, const char* path, int format);
+    int waitCompletion(long long requestId, int timeoutMs, AsyncCompletion* out);
+}
+
+static std::filesystem::path tempFile(const char* name) {
+    return std::filesystem::temp_directory_path() / name;
+}
+
+TEST(async, takeOnlyWaitsForPendingRequests) {
+    AsyncExecutor executor(1);
+    AsyncCompletion c;
+
+    // Never issued: returns at once instead of waiting forever
+    CHECK(!executor.take(12345, -1, c));
+
+    std::promise<void> release;
+    std::shared_future<void> gate = release.get_future().share();
+    long long id = executor.submit(nullptr, [gate]() {
+        gate.wait();
+        return AsyncResult{ 1, 7, "done" };
+    });
+    CHECK(!executor.take(id, 0, c));          // still running
+    release.set_value();
+    CHECK(executor.take(id, -1, c));
+    CHECK(c.requestId == id && c.status == 1 && c.value == 7);
+
+    // Already collected, by take or by poll
+    CHECK(!executor.take(id, -1, c));
+    long long next = executor.submit(nullptr, []() { return AsyncResult{ 1, 0, "" }; });
+    executor.drain(nullptr);
+    CHECK(executor.poll(c));
+    CHECK(c.requestId == next);
+    CHECK(!executor.take(next, -1, c));
+}
+
+TEST(async, importAndExportThroughTheBridge) {
+    std::filesystem::path input = tempFile("bank_ledger_async_import.csv");
+    std::filesystem::path output = tempFile("bank_ledger_async_export.csv");
+    {
+        std::ofstream csv(input);
+        for (int i = 1; i <= 1000; i++) {
+            csv << (i % 4 == 0 ? "WITHDRAWAL" : "DEPOSIT") << ",1.00,Row " << i << "\n";
+        }
+    }
+
+    void* ledger = createBankLedger(100.0);
+    AsyncCompletion c;
+    long long id = asyncImportTransactionsFromFile(ledger, input.string().c_str(), IMPORT_CSV, 2);
+    CHECK(id > 0);
+    CHECK(waitCompletion(id, -1, &c) == 1);
+    CHECK(c.status == 1 && c.value == 1000);
+    CHECK(((BankLedger*)ledger)->getTransactionCount() == 1000);
+    CHECK_MONEY(((BankLedger*)ledger)->getBalance(), 100.0 + 750.0 - 250.0);
+
+    // The export works from a copy of the rows; the file holds all of them
+    id = asyncExportStatement(ledger, output.string().c_str(), EXPORT_CSV);
+    CHECK(id > 0);
+    CHECK(waitCompletion(id, -1, &c) == 1);
+    CHECK(c.status == 1 && c.value == 1000);
+
+    std::ifstream in(output);
+    std::string line;
+    int lines = 0;
+    while (std::getline(in, line)) lines++;
+    CHECK(lines == 1001);                      // header + rows
+
+    deleteBankLedger(ledger);
+    std::filesystem::remove(input);
+    std::filesystem::remove(output);
+}
@@ -0,0 +1,100 @@
+#include "test_util.h"
+#include "../include/bank_ledger.h"
+#include "../include/hash_chain.h"
+#include <vector>
+
+static const int BLOCK = (int)HashChain::CHECKPOINT_INTERVAL;
+
+static void fillLedger(BankLedger& ledger, int postings) {
+    ledger.setClock(LedgerClock::fake(START, MINUTE));
+    for (int i = 1; i <= postings; i++) ledger.deposit(1.0 + (i % 7), "Deposit " + std::to_string(i));
+}
+
+TEST(chain, intactRangesVerify) {
+    BankLedger ledger(0.0, true);
+    fillLedger(ledger, 3 * BLOCK + 100);
+
+    CHECK(ledger.verifyHistory(1, 3 * BLOCK + 100));
+    CHECK(ledger.verifyHistory(1, 1));
+    CHECK(ledger.verifyHistory(BLOCK, BLOCK + 1));            // across a checkpoint
+    CHECK(ledger.verifyHistory(3 * BLOCK + 50, 3 * BLOCK + 100));   // tail past the last one
+    CHECK(!ledger.verifyHistory(10, 5));
+}
+
+TEST(chain, tamperedAmountIsDetected) {
+    BankLedger ledger(0.0, true);
+    fillLedger(ledger, 2 * BLOCK + 10);
+
+    Transaction* t = ledger.searchByID(BLOCK + 500);
+    CHECK(t != nullptr);
+    if (!t) return;
+    double original = t->amount;
+    t->amount += 0.01;
+
+    CHECK(!ledger.verifyHistory(BLOCK + 400, BLOCK + 600));
+    CHECK(!ledger.verifyHistory(1, 2 * BLOCK + 10));
+    CHECK(ledger.verifyHistory(1, BLOCK));                    // other blocks still prove
+
+    t->amount = original;
+    CHECK(ledger.verifyHistory(1, 2 * BLOCK + 10));
+}
+
+TEST(chain, tamperedDescriptionIsDetected) {
+    BankLedger ledger(0.0, true);
+    fillLedger(ledger, BLOCK + 20);
+
+    // In the tail after the last checkpoint, checked against the head
+    Transaction* t = ledger.searchByID(BLOCK + 10);
+    CHECK(t != nullptr);
+    if (!t) return;
+    t->description = "Deposit 9999";
+    CHECK(!ledger.verifyHistory(BLOCK + 1, BLOCK + 20));
+    CHECK(ledger.verifyHistory(1, BLOCK));
+}
+
+TEST(chain, rollbackAcrossACheckpoint) {
+    std::vector<Transaction*> rows;
+    for (int i = 1; i <= BLOCK + 1; i++) {
+        rows.push_back(new Transaction(i, "DEPOSIT", 1.0, "Row", (double)i, START + i));
+    }
+    Transaction junkA(BLOCK, "WITHDRAWAL", 9.0, "Junk", 0.0, START);
+    Transaction junkB(BLOCK + 1, "WITHDRAWAL", 9.0, "Junk", 0.0, START);
+
+    HashChain straight, undone;
+    for (Transaction* t : rows) straight.append(*t);
+
+    // Same rows, but the last two first go in as junk and are rolled back,
+    // taking the chain back below the checkpoint at BLOCK
+    for (int i = 0; i < BLOCK - 1; i++) undone.append(*rows[(size_t)i]);
+    Digest beforeJunk = undone.getHead();
+    undone.append(junkA);
+    undone.append(junkB);
+    CHECK(undone.checkpointCount() == 1);
+    undone.rollback(junkA.chainHash);
+    undone.rollback(beforeJunk);
+    CHECK(undone.checkpointCount() == 0);
+    CHECK(undone.size() == (size_t)BLOCK - 1);
+
+    Digest headBefore = rows[(size_t)BLOCK - 1]->chainHash;
+    undone.append(*rows[(size_t)BLOCK - 1]);
+    undone.append(*rows[(size_t)BLOCK]);
+    CHECK(rows[(size_t)BLOCK - 1]->chainHash == headBefore);
+    CHECK(undone.getHead() == straight.getHead());
+    CHECK(undone.root() == straight.root());
+    CHECK(undone.verify(rows.data(), rows.size(), 0, rows.size() - 1));
+
+    for (Transaction* t : rows) delete t;
+}
+
+TEST(chain, ledgerUndoAcrossACheckpoint) {
+    BankLedger ledger(0.0, true);
+    fillLedger(ledger, BLOCK + 1);
+    ledger.undo();
+    ledger.undo();                                            // back below the checkpoint
+    CHECK(ledger.verifyHistory(1, BLOCK - 1));
+
+    ledger.deposit(3.0, "Again");
+    ledger.deposit(4.0, "Again");
+    CHECK(ledger.getTransactionCount() == BLOCK + 1);
+    CHECK(ledger.verifyHistory(1, BLOCK + 3));
+}
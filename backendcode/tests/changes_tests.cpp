@@ -0,0 +1,73 @@
+#include "test_util.h"
+#include "../include/bank_ledger.h"
+#include "../include/change_feed.h"
+
+static Transaction posting(int id, double amount, double balanceAfter) {
+    return Transaction(id, "DEPOSIT", amount, "Row", balanceAfter, START + id);
+}
+
+TEST(changes, ringWrapsAndKeepsTheNewest) {
+    ChangeFeed feed(8);
+    CHECK(feed.latestSeq() == 0);
+    CHECK(feed.oldestSeq() == 1);
+
+    for (int id = 1; id <= 20; id++) feed.recordAppend(posting(id, 1.0, id), KIND_DEPOSIT);
+    CHECK(feed.latestSeq() == 20);
+    CHECK(feed.oldestSeq() == 13);
+
+    ChangeRecord out[8];
+    CHECK(feed.since(12, out, 8) == 8);
+    for (int i = 0; i < 8; i++) {
+        CHECK(out[i].seq == (uint64_t)(13 + i));
+        CHECK(out[i].transactionID == 13 + i);
+        CHECK(out[i].kind == CHANGE_APPEND);
+    }
+
+    // Capacity smaller than the backlog: the oldest come first
+    CHECK(feed.since(15, out, 2) == 2);
+    CHECK(out[0].seq == 16 && out[1].seq == 17);
+
+    CHECK(feed.since(20, out, 8) == 0);                       // up to date
+}
+
+TEST(changes, tooFarBehindNeedsASnapshot) {
+    ChangeFeed feed(8);
+    for (int id = 1; id <= 20; id++) feed.recordAppend(posting(id, 1.0, id), KIND_DEPOSIT);
+
+    ChangeRecord out[8];
+    CHECK(feed.since(11, out, 8) == CHANGES_SNAPSHOT_REQUIRED);   // seq 12 is gone
+    CHECK(feed.since(0, out, 8) == CHANGES_SNAPSHOT_REQUIRED);
+    CHECK(feed.since(21, out, 8) == CHANGES_SNAPSHOT_REQUIRED);   // another ledger's seq
+}
+
+TEST(changes, ledgerRecordsAppendsAndUndos) {
+    BankLedger ledger(0.0, true);
+    ledger.setClock(LedgerClock::fake(START, MINUTE));
+    ledger.deposit(100.0, "Salary");
+    ledger.withdraw(30.0, "Rent");
+    ledger.undo();
+
+    ChangeRecord out[8];
+    uint64_t latest = 0;
+    CHECK(ledger.getChangesSince(0, out, 8, latest) == 3);
+    CHECK(latest == 3);
+
+    CHECK(out[0].kind == CHANGE_APPEND && out[0].transactionID == 1);
+    CHECK_MONEY(out[0].balanceAfter, 100.0);
+    CHECK(out[1].kind == CHANGE_APPEND && out[1].postingKind == KIND_WITHDRAWAL);
+    CHECK_MONEY(out[1].balanceAfter, 70.0);
+    CHECK(out[1].timestamp == START + MINUTE);
+
+    // The undo names the posting it removed and the balance after it
+    CHECK(out[2].kind == CHANGE_UNDO);
+    CHECK(out[2].transactionID == 2);
+    CHECK(out[2].postingKind == KIND_WITHDRAWAL);
+    CHECK_MONEY(out[2].amount, 30.0);
+    CHECK_MONEY(out[2].balanceAfter, 100.0);
+
+    // Incremental poll from the last seq seen
+    ledger.deposit(5.0, "Interest");
+    CHECK(ledger.getChangesSince(latest, out, 8, latest) == 1);
+    CHECK(latest == 4);
+    CHECK(out[0].transactionID == 3);
+}
@@ -0,0 +1,142 @@
+#include "test_util.h"
+#include "../include/bank_ledger.h"
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+static const uint64_t BLOCK = EVENT_CHECKPOINT_INTERVAL;
+
+static std::filesystem::path spillDir() {
+    return std::filesystem::temp_directory_path() / "bank_ledger_event_tests";
+}
+
+static std::filesystem::path blockFile(int index) {
+    char name[32];
+    snprintf(name, sizeof(name), "events_%06d.blge", index);
+    return spillDir() / name;
+}
+
+// Postings with an undo every fifth event, plus one undo as the first event
+// of each block that takes back the last posting of the block before.
+// Records the log's state after every event for later comparison.
+static void logEvents(BankLedger& ledger, uint64_t upTo, std::vector<LedgerStateAt>& states) {
+    const EventLog* log = ledger.getEventLog();
+    while (log->size() < upTo) {
+        uint64_t n = log->size();
+        bool undo = (n > 0 && n % BLOCK == 0) || (n % 5 == 3 && n % BLOCK != BLOCK - 1);
+        if (undo) {
+            ledger.undo();
+        } else if (n % 2 == 0) {
+            ledger.deposit(10.0, "Posting " + std::to_string(n));
+        } else {
+            ledger.withdraw(3.0, "Posting " + std::to_string(n));
+        }
+        states.push_back(log->currentState());
+    }
+}
+
+static bool sameState(const LedgerStateAt& a, const LedgerStateAt& b) {
+    return a.events == b.events && a.asOf == b.asOf && a.balance == b.balance &&
+           a.newestLive == b.newestLive && a.livePostings == b.livePostings &&
+           a.undonePostings == b.undonePostings && a.depositTotal == b.depositTotal &&
+           a.withdrawalTotal == b.withdrawalTotal && a.depositCount == b.depositCount &&
+           a.withdrawalCount == b.withdrawalCount && a.lastTransactionID == b.lastTransactionID;
+}
+
+static bool replaysEveryState(const BankLedger& ledger, const std::vector<LedgerStateAt>& states) {
+    bool all = true;
+    LedgerStateAt s;
+    for (const LedgerStateAt& expected : states) {
+        all = all && ledger.getStateAt(expected.asOf, s) && sameState(s, expected);
+    }
+    return all;
+}
+
+TEST(events, stateAtAcrossCheckpointAndUndo) {
+    BankLedger ledger(100.0, true);
+    ledger.setClock(LedgerClock::fake(START, MICROS_PER_SECOND));
+    std::vector<LedgerStateAt> states;
+    logEvents(ledger, BLOCK + 10, states);
+
+    // Event BLOCK undoes the posting just before the checkpoint
+    const LedgerStateAt& sealed = states[BLOCK - 1];
+    const LedgerStateAt& undone = states[BLOCK];
+    CHECK(undone.undonePostings == sealed.undonePostings + 1);
+    CHECK(undone.newestLive < sealed.newestLive);
+    CHECK_MONEY(undone.balance, states[BLOCK - 2].balance);
+
+    CHECK(replaysEveryState(ledger, states));
+
+    // Before the first event: the opening balance
+    LedgerStateAt s;
+    CHECK(ledger.getStateAt(START - 1, s));
+    CHECK(s.events == 0 && s.livePostings == 0);
+    CHECK_MONEY(s.balance, 100.0);
+}
+
+TEST(events, spilledBlocksReplayTheSameStates) {
+    std::filesystem::remove_all(spillDir());
+    std::vector<LedgerStateAt> states;
+    {
+        BankLedger ledger(100.0, true);
+        ledger.setClock(LedgerClock::fake(START, MICROS_PER_SECOND));
+        const EventLog* log = ledger.getEventLog();
+
+        // Blocks already full are written when archiving starts, later ones
+        // as they fill; only the open block stays in memory
+        logEvents(ledger, 2 * BLOCK + 100, states);
+        CHECK(ledger.enableArchive(spillDir().string(), 0));
+        CHECK(log->spilledBlocks() == 2);
+        logEvents(ledger, 3 * BLOCK + 5, states);
+        CHECK(log->spilledBlocks() == 3);
+        CHECK(log->spilledEvents() == 3 * BLOCK);
+        CHECK(std::filesystem::exists(blockFile(2)));
+
+        CHECK(replaysEveryState(ledger, states));
+
+        // Live and undone postings come back with their descriptions,
+        // whichever block they were spilled in
+        const LedgerStateAt& now = log->currentState();
+        std::vector<LoggedPosting> live, undone;
+        CHECK(log->livePostings(now, live));
+        CHECK(log->undonePostings(now, undone));
+        CHECK(live.size() == (size_t)ledger.getTransactionCount());
+        CHECK(undone.size() == (size_t)now.undonePostings);
+        if (!live.empty()) {
+            CHECK(live.front().description == "Posting 0");
+            CHECK(live.back().event.transactionID == now.lastTransactionID);
+        }
+        if (!undone.empty()) CHECK(undone.front().description == "Posting 2");
+
+        // An undo in the open block reaching into a spilled one
+        int before = now.undonePostings;
+        while (log->size() % BLOCK != 0) ledger.deposit(1.0, "Filler");
+        ledger.undo();
+        ledger.undo();
+        CHECK(log->currentState().undonePostings == before + 2);
+    }
+    // Block files go with the ledger
+    CHECK(!std::filesystem::exists(blockFile(0)));
+    std::filesystem::remove_all(spillDir());
+}
+
+TEST(events, unreadableBlockFailsTheQuery) {
+    std::filesystem::remove_all(spillDir());
+    BankLedger ledger(100.0, true);
+    ledger.setClock(LedgerClock::fake(START, MICROS_PER_SECOND));
+    CHECK(ledger.enableArchive(spillDir().string(), 0));
+    std::vector<LedgerStateAt> states;
+    logEvents(ledger, 3 * BLOCK + 5, states);
+
+    // Load blocks 1 and 2, so block 0 is no longer cached
+    LedgerStateAt s;
+    CHECK(ledger.getStateAt(states[BLOCK + 5].asOf, s));
+    CHECK(ledger.getStateAt(states[2 * BLOCK + 5].asOf, s));
+    std::filesystem::remove(blockFile(0));
+
+    CHECK(!ledger.getStateAt(states[5].asOf, s));
+    CHECK(ledger.getStateAt(states.back().asOf, s));       // in memory
+    CHECK(sameState(s, states.back()));
+    std::filesystem::remove_all(spillDir());
+}
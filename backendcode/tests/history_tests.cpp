@@ -0,0 +1,104 @@
+#include "test_util.h"
+#include "../include/bank_ledger.h"
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// 10000 postings with archiving on (hot limit 1000) leave IDs 1..8192 in two
+// archived segments and 8193..10000 in memory
+static const int POSTINGS = 10000;
+static const int FIRST_HOT = 2 * ARCHIVE_SEGMENT_ROWS + 1;
+
+static double amountOf(int id) { return 1.0 + id % 13; }
+static std::string descriptionOf(int id) { return "Posting " + std::to_string(id); }
+
+static std::filesystem::path archiveDir() {
+    return std::filesystem::temp_directory_path() / "bank_ledger_history_tests";
+}
+
+static void fillLedger(BankLedger& ledger) {
+    ledger.setClock(LedgerClock::fake(START, MINUTE));
+    for (int id = 1; id <= POSTINGS; id++) ledger.deposit(amountOf(id), descriptionOf(id));
+}
+
+static bool isPosting(const TransactionRecord& r, int id) {
+    return r.id == id && r.kind == KIND_DEPOSIT && r.amount == amountOf(id) &&
+           r.timestamp == START + (Timestamp)(id - 1) * MINUTE &&
+           descriptionOf(id) == r.description;
+}
+
+TEST(history, getByIDsAcrossArchiveAndMemory) {
+    std::filesystem::remove_all(archiveDir());
+    {
+        BankLedger ledger(0.0, true);
+        fillLedger(ledger);
+        CHECK(ledger.enableArchive(archiveDir().string(), 1000));
+        CHECK(ledger.getArchivedCount() == (uint64_t)(FIRST_HOT - 1));
+
+        // Unsorted, with repeats, both sides of each boundary and two misses
+        int ids[] = { FIRST_HOT, 1, POSTINGS, FIRST_HOT - 1, 0, ARCHIVE_SEGMENT_ROWS,
+                      ARCHIVE_SEGMENT_ROWS + 1, POSTINGS + 1, 1, 5000 };
+        const int n = (int)(sizeof(ids) / sizeof(ids[0]));
+        TransactionRecord out[n];
+        CHECK(ledger.getByIDs(ids, n, out) == n - 2);
+        for (int i = 0; i < n; i++) {
+            if (ids[i] == 0 || ids[i] > POSTINGS) CHECK(out[i].id == 0);
+            else CHECK(isPosting(out[i], ids[i]));
+        }
+
+        // Balances agree with a running sum
+        double balance = 0.0;
+        for (int id = 1; id <= FIRST_HOT; id++) balance += amountOf(id);
+        CHECK_MONEY(out[0].balanceAfter, balance);
+    }
+    std::filesystem::remove_all(archiveDir());
+}
+
+TEST(history, cursorReadsAcrossArchiveAndMemory) {
+    std::filesystem::remove_all(archiveDir());
+    {
+        BankLedger ledger(0.0, true);
+        fillLedger(ledger);
+        CHECK(ledger.enableArchive(archiveDir().string(), 1000));
+
+        // Everything, in chunks that straddle both boundaries
+        HistoryFilter all;
+        memset(&all, 0, sizeof(all));
+        HistoryCursor cursor = makeHistoryCursor(all, 700);
+        std::vector<TransactionRecord> chunk(700);
+        int expected = 1, n;
+        bool inOrder = true;
+        while ((n = ledger.readHistory(cursor, chunk.data())) > 0) {
+            for (int i = 0; i < n; i++) inOrder = inOrder && isPosting(chunk[(size_t)i], expected++);
+        }
+        CHECK(n == 0);
+        CHECK(inOrder);
+        CHECK(expected == POSTINGS + 1);
+
+        // A filtered range across the archive/memory boundary
+        HistoryFilter f;
+        memset(&f, 0, sizeof(f));
+        f.fromID = FIRST_HOT - 100;
+        f.toID = FIRST_HOT + 100;
+        f.minAmount = 10.0;
+        f.maxAmount = 13.0;
+        cursor = makeHistoryCursor(f, 16);
+        int want = 0, got = 0;
+        for (int id = f.fromID; id <= f.toID; id++) {
+            if (amountOf(id) >= 10.0) want++;
+        }
+        bool matches = true;
+        while ((n = ledger.readHistory(cursor, chunk.data())) > 0) {
+            for (int i = 0; i < n; i++) {
+                const TransactionRecord& r = chunk[(size_t)i];
+                matches = matches && r.id >= f.fromID && r.id <= f.toID && r.amount >= 10.0 &&
+                          isPosting(r, r.id);
+            }
+            got += n;
+        }
+        CHECK(matches);
+        CHECK(got == want);
+    }
+    std::filesystem::remove_all(archiveDir());
+}
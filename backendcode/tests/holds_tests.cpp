@@ -0,0 +1,66 @@
+#include "test_util.h"
+#include "../include/bank_ledger.h"
+
+TEST(holds, importedWithdrawalCannotSpendHeldMoney) {
+    BankLedger ledger(100.0, true);
+    int hold = ledger.placeHold(80.0, "Card authorization", INT64_MAX);
+    CHECK(hold != 0);
+    CHECK_MONEY(ledger.getAvailableBalance(), 20.0);
+
+    CHECK(!ledger.postImported(KIND_WITHDRAWAL, 90.0, "Imported", 0));
+    CHECK_MONEY(ledger.getBalance(), 100.0);
+    CHECK_MONEY(ledger.getAvailableBalance(), 20.0);
+
+    CHECK(ledger.postImported(KIND_WITHDRAWAL, 20.0, "Imported", 0));
+    CHECK_MONEY(ledger.getAvailableBalance(), 0.0);
+
+    // The hold is still fully covered
+    CHECK(ledger.settleHold(hold));
+    CHECK_MONEY(ledger.getBalance(), 0.0);
+    CHECK_MONEY(ledger.getHeldBalance(), 0.0);
+}
+
+TEST(holds, importedWithdrawalSeesExpiredHolds) {
+    BankLedger ledger(100.0, true);
+    ledger.setClock(LedgerClock::fake(START, HOUR));
+
+    // Placed at START, due half an hour later; the import reads START + 1h
+    CHECK(ledger.placeHold(80.0, "Card authorization", START + HOUR / 2) != 0);
+    CHECK(ledger.postImported(KIND_WITHDRAWAL, 90.0, "Imported", 0));
+    CHECK(ledger.getActiveHoldCount() == 0);
+    CHECK_MONEY(ledger.getBalance(), 10.0);
+}
+
+TEST(holds, liveWithdrawalRespectsHolds) {
+    BankLedger ledger(100.0, true);
+    CHECK(ledger.placeHold(80.0, "Card authorization", INT64_MAX) != 0);
+
+    ledger.withdraw(30.0, "ATM");
+    CHECK(ledger.getTransactionCount() == 0);
+    ledger.withdraw(20.0, "ATM");
+    CHECK(ledger.getTransactionCount() == 1);
+    CHECK_MONEY(ledger.getAvailableBalance(), 0.0);
+}
+
+TEST(holds, settleChecksAmount) {
+    BankLedger ledger(100.0, true);
+    int hold = ledger.placeHold(50.0, "Hotel", INT64_MAX);
+
+    CHECK(!ledger.settleHold(hold, 60.0));     // more than reserved
+    CHECK(!ledger.settleHold(hold, -1.0));
+    CHECK(!ledger.settleHold(hold + 1));       // no such hold
+    CHECK(ledger.getActiveHoldCount() == 1);
+
+    CHECK(ledger.settleHold(hold, 42.5));      // the rest is released
+    CHECK_MONEY(ledger.getBalance(), 57.5);
+    CHECK_MONEY(ledger.getHeldBalance(), 0.0);
+    CHECK(!ledger.settleHold(hold));
+}
+
+TEST(holds, placeHoldOnlyFromAvailableBalance) {
+    BankLedger ledger(100.0, true);
+    CHECK(ledger.placeHold(70.0, "A", INT64_MAX) != 0);
+    CHECK(ledger.placeHold(40.0, "B", INT64_MAX) == 0);
+    CHECK(ledger.placeHold(30.0, "C", INT64_MAX) != 0);
+    CHECK_MONEY(ledger.getAvailableBalance(), 0.0);
+}
@@ -0,0 +1,94 @@
+#include "test_util.h"
+#include "../include/bank_ledger.h"
+#include "../include/idempotency.h"
+
+static int post(BankLedger& ledger, unsigned char kind, double amount, const char* key, bool& duplicate) {
+    return ledger.postWithKey(kind, amount, "Payment", key, duplicate);
+}
+
+TEST(idempotency, duplicateKeyReturnsTheOriginalID) {
+    BankLedger ledger(0.0, true);
+    ledger.setClock(LedgerClock::fake(START, MINUTE));
+    bool duplicate = true;
+
+    int id = post(ledger, KIND_DEPOSIT, 50.0, "req-1", duplicate);
+    CHECK(id == 1);
+    CHECK(!duplicate);
+
+    CHECK(post(ledger, KIND_DEPOSIT, 50.0, "req-1", duplicate) == id);
+    CHECK(duplicate);
+    CHECK(ledger.getTransactionCount() == 1);
+    CHECK_MONEY(ledger.getBalance(), 50.0);
+
+    // Other keys and keyless postings go through
+    CHECK(post(ledger, KIND_DEPOSIT, 5.0, "req-2", duplicate) == 2);
+    CHECK(post(ledger, KIND_DEPOSIT, 5.0, "", duplicate) == 3);
+    CHECK(post(ledger, KIND_DEPOSIT, 5.0, "", duplicate) == 4);
+    CHECK(!duplicate);
+
+    // Undo doesn't forget the key
+    ledger.undo();
+    ledger.undo();
+    ledger.undo();
+    CHECK(post(ledger, KIND_DEPOSIT, 5.0, "req-2", duplicate) == 2);
+    CHECK(duplicate);
+    CHECK(ledger.getTransactionCount() == 1);
+}
+
+TEST(idempotency, rejectedPostingIsNotRemembered) {
+    BankLedger ledger(10.0, true);
+    bool duplicate = true;
+
+    CHECK(post(ledger, KIND_WITHDRAWAL, 25.0, "req-1", duplicate) == 0);
+    CHECK(!duplicate);
+
+    ledger.deposit(20.0, "Top-up");
+    int id = post(ledger, KIND_WITHDRAWAL, 25.0, "req-1", duplicate);
+    CHECK(id == 2);
+    CHECK(!duplicate);
+    CHECK_MONEY(ledger.getBalance(), 5.0);
+}
+
+TEST(idempotency, keyIsRememberedAtThePostingTime) {
+    BankLedger ledger(0.0, true);
+    ledger.setClock(LedgerClock::fake(START, MINUTE));
+    bool duplicate;
+    int id = post(ledger, KIND_DEPOSIT, 1.0, "req-1", duplicate);
+
+    TransactionRecord r;
+    CHECK(ledger.getByIDs(&id, 1, &r) == 1);
+    CHECK(r.timestamp == START);       // one clock reading for key and posting
+}
+
+TEST(idempotency, keysExpireAfterOneToTwoWindows) {
+    IdempotencyIndex index(HOUR);
+    index.remember("a", 1, START);
+    CHECK(index.find("a", START + HOUR / 2) == 1);
+
+    // First rotation: "a" moves to the older generation and is still found
+    CHECK(index.find("a", START + HOUR + 1) == 1);
+    index.remember("b", 2, START + HOUR + 1);
+    CHECK(index.size() == 2);
+
+    // Second rotation drops the generation holding "a"
+    CHECK(index.find("a", START + 2 * HOUR + 1) == 0);
+    CHECK(index.find("b", START + 2 * HOUR + 1) == 2);
+    CHECK(index.size() == 1);
+
+    // Idle for two windows: everything has expired
+    CHECK(index.find("b", START + 5 * HOUR) == 0);
+    CHECK(index.size() == 0);
+}
+
+TEST(idempotency, ledgerForgetsKeysAfterTheWindow) {
+    BankLedger ledger(0.0, true);
+    ledger.setClock(LedgerClock::fake(START, IDEMPOTENCY_WINDOW));
+    bool duplicate;
+
+    // Clock readings: START, START + 1 window, START + 2 windows, ...
+    CHECK(post(ledger, KIND_DEPOSIT, 1.0, "req-1", duplicate) == 1);
+    CHECK(post(ledger, KIND_DEPOSIT, 1.0, "req-1", duplicate) == 1);
+    CHECK(duplicate);
+    CHECK(post(ledger, KIND_DEPOSIT, 1.0, "req-1", duplicate) == 2);
+    CHECK(!duplicate);
+}
@@ -0,0 +1,90 @@
+#include "test_util.h"
+#include "../include/bank_ledger.h"
+#include "../include/importer.h"
+#include <cmath>
+#include <cstring>
+#include <string>
+
+static ImportReport importText(BankLedger& ledger, const std::string& text, ImportFormat format) {
+    return importBuffer(ledger, text.data(), text.size(), format, 2);
+}
+
+TEST(import, csvRowsApplyInFileOrder) {
+    BankLedger ledger(0.0, true);
+    ImportReport r = importText(ledger,
+        "type,amount,description,timestamp\n"
+        "DEPOSIT,100,Salary,1700000000\n"
+        "\n"
+        "WITHDRAWAL,30.5,\"Rent, March\",1700000060.25\n", IMPORT_AUTO);
+
+    CHECK(r.rowsRead == 2);
+    CHECK(r.rowsApplied == 2);
+    CHECK(r.rowsRejected == 0);
+    CHECK_MONEY(ledger.getBalance(), 69.5);
+
+    Transaction* rent = ledger.searchByID(2);
+    CHECK(rent != nullptr);
+    if (rent) {
+        CHECK(rent->description == "Rent, March");
+        CHECK(rent->timestamp == 1700000060250000LL);
+    }
+}
+
+TEST(import, ndjsonRows) {
+    BankLedger ledger(0.0, true);
+    ImportReport r = importText(ledger,
+        "{\"type\":\"DEPOSIT\",\"amount\":12.5,\"description\":\"caf\\u00e9\",\"timestamp\":1700000000}\n"
+        "{\"type\":\"WITHDRAWAL\",\"amount\":2.5,\"description\":\"tip\"}\n", IMPORT_AUTO);
+
+    CHECK(r.rowsApplied == 2);
+    CHECK_MONEY(ledger.getBalance(), 10.0);
+    Transaction* t = ledger.searchByID(1);
+    CHECK(t != nullptr && t->description == "caf\xC3\xA9");
+}
+
+TEST(import, rejectsMalformedAndOverdrawnRows) {
+    BankLedger ledger(0.0, true);
+    ImportReport r = importText(ledger,
+        "DEPOSIT,10,ok\n"
+        "DEPOSIT,abc,not a number\n"
+        "REFUND,5,unknown type\n"
+        "DEPOSIT,-5,negative\n"
+        "WITHDRAWAL,50,overdraws\n", IMPORT_CSV);
+
+    CHECK(r.rowsRead == 5);
+    CHECK(r.rowsApplied == 1);
+    CHECK(r.rowsRejected == 4);
+    CHECK_MONEY(ledger.getBalance(), 10.0);
+}
+
+TEST(import, rejectsNonFiniteAmounts) {
+    ImportRow row;
+    const char* lines[] = { "DEPOSIT,nan,x", "DEPOSIT,inf,x", "WITHDRAWAL,-inf,x", "DEPOSIT,NaN,x" };
+    for (const char* line : lines) CHECK(!parseCsvLine(line, line + strlen(line), row));
+
+    const char* json = "{\"type\":\"DEPOSIT\",\"amount\":nan,\"description\":\"x\"}";
+    CHECK(!parseNdjsonLine(json, json + strlen(json), row));
+
+    BankLedger ledger(0.0, true);
+    ImportReport r = importText(ledger,
+        "DEPOSIT,100,ok\nDEPOSIT,nan,a\nWITHDRAWAL,inf,b\nDEPOSIT,infinity,c\n", IMPORT_CSV);
+    CHECK(r.rowsApplied == 1);
+    CHECK(r.rowsRejected == 3);
+    CHECK(std::isfinite(ledger.getBalance()));
+    CHECK_MONEY(ledger.getBalance(), 100.0);
+}
+
+TEST(import, ledgerRejectsNonFiniteAmounts) {
+    BankLedger ledger(100.0, true);
+    int count = ledger.getTransactionCount();
+
+    CHECK(!ledger.postImported(KIND_DEPOSIT, NAN, "nan", 0));
+    CHECK(!ledger.postImported(KIND_WITHDRAWAL, INFINITY, "inf", 0));
+    ledger.deposit(NAN, "nan");
+    ledger.deposit(INFINITY, "inf");
+    ledger.withdraw(NAN, "nan");
+    ledger.withdraw(-INFINITY, "-inf");
+
+    CHECK(ledger.getTransactionCount() == count);
+    CHECK_MONEY(ledger.getBalance(), 100.0);
+}
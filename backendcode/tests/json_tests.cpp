@@ -0,0 +1,72 @@
+#include "test_util.h"
+#include "../include/exporter.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+static std::filesystem::path outputPath() {
+    return std::filesystem::temp_directory_path() / "bank_ledger_json_tests.json";
+}
+
+// Run writeJsonString through a file and return what landed on disk
+static std::string written(const std::string& s, size_t capacity) {
+    int fd = createOutputFile(outputPath().string());
+    if (fd < 0) return "<open failed>";
+    {
+        BufferedWriter w(fd, capacity);
+        w.writeJsonString(s);
+        if (!w.flush()) return "<write failed>";
+    }
+    closeOutputFile(fd);
+
+    std::ifstream in(outputPath(), std::ios::binary);
+    std::string out((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::filesystem::remove(outputPath());
+    return out;
+}
+
+TEST(json, escapesQuotesBackslashesAndControlBytes) {
+    CHECK(jsonEscape("") == "");
+    CHECK(jsonEscape("Rent March") == "Rent March");
+    CHECK(jsonEscape("say \"hi\"") == "say \\\"hi\\\"");
+    CHECK(jsonEscape("C:\\temp\\") == "C:\\\\temp\\\\");
+    CHECK(jsonEscape("a\nb\rc\td") == "a\\nb\\rc\\td");
+    CHECK(jsonEscape("\b\f") == "\\b\\f");
+    CHECK(jsonEscape(std::string("\x01\x1f\x00", 3)) == "\\u0001\\u001f\\u0000");
+    CHECK(jsonEscape("/ and \x7f") == "/ and \x7f");            // not control bytes
+    CHECK(jsonEscape("caf\xc3\xa9 \xe2\x82\xac") == "caf\xc3\xa9 \xe2\x82\xac");   // UTF-8 kept
+}
+
+TEST(json, writerMatchesEscape) {
+    const std::string samples[] = {
+        "",
+        "plain",
+        "\"",
+        "quote \" backslash \\ newline \n tab \t bell \x07 unit \x1f end",
+        std::string("nul \0 inside", 12),
+        "caf\xc3\xa9 \"\xe2\x82\xac\"",
+    };
+    for (const std::string& s : samples) {
+        CHECK(written(s, 1 << 20) == "\"" + jsonEscape(s) + "\"");
+        CHECK(written(s, 4) == "\"" + jsonEscape(s) + "\"");     // buffer fills mid-string
+    }
+}
+
+TEST(json, escapeAtEveryOffset) {
+    // One special byte at each position of a long run, so it lands at the
+    // start, middle and end of whatever chunk the scan copies
+    const char specials[] = { '"', '\\', '\n', '\x01', '\x1f' };
+    bool allMatch = true;
+    for (char special : specials) {
+        for (size_t at = 0; at < 70; at++) {
+            std::string s(70, 'x');
+            s[at] = special;
+            std::string expected = jsonEscape(s);
+            allMatch = allMatch && expected.size() > s.size() &&
+                       expected.substr(0, at) == std::string(at, 'x') &&
+                       written(s, 64) == "\"" + expected + "\"";
+        }
+    }
+    CHECK(allMatch);
+}
@@ -0,0 +1,47 @@
+#include "test_util.h"
+#include "../include/metrics.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(metrics, threadKeepsOneShardAcrossManyLedgers) {
+    // More ledgers than the per-thread cache holds, visited round-robin
+    const int LEDGERS = 20;
+    const int ROUNDS = 500;
+    std::vector<LedgerMetrics*> all;
+    for (int i = 0; i < LEDGERS; i++) all.push_back(new LedgerMetrics());
+
+    for (int r = 0; r < ROUNDS; r++) {
+        for (LedgerMetrics* m : all) m->record(OP_DEPOSIT, 100);
+    }
+
+    for (LedgerMetrics* m : all) {
+        CHECK(m->shardCount() == 1);
+        LedgerMetricsSnapshot snap;
+        m->snapshot(snap);
+        CHECK(snap.ops[OP_DEPOSIT].count == (uint64_t)ROUNDS);
+        delete m;
+    }
+}
+
+TEST(metrics, eachThreadWritesItsOwnShard) {
+    LedgerMetrics metrics;
+    std::atomic<int> started(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&]() {
+            // All alive at once, so no thread ID is reused between them
+            started++;
+            while (started.load() < 4) std::this_thread::yield();
+            for (int i = 0; i < 1000; i++) metrics.record(OP_WITHDRAW, 50 + i);
+        });
+    }
+    for (std::thread& t : threads) t.join();
+
+    CHECK(metrics.shardCount() == 4);
+    LedgerMetricsSnapshot snap;
+    metrics.snapshot(snap);
+    CHECK(snap.ops[OP_WITHDRAW].count == 4000);
+    CHECK(snap.ops[OP_WITHDRAW].minNs == 50);
+    CHECK(snap.ops[OP_WITHDRAW].maxNs == 1049);
+}
@@ -0,0 +1,176 @@
+#include "test_util.h"
+#include "../include/bank_ledger.h"
+#include "../include/query.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+static const char* DESCRIPTIONS[] = { "Rent payment", "Coffee shop", "Salary ACME", "Grocery store",
+                                      "rent refund" };
+
+// Seeded mix of deposits and withdrawals, one posting per fake-clock second
+template <typename Ledger>
+static void fillLedger(Ledger& ledger, int postings) {
+    ledger.setClock(LedgerClock::fake(START, MICROS_PER_SECOND));
+    unsigned long long state = 12345;
+    for (int i = 0; i < postings; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        unsigned r = (unsigned)(state >> 33);
+        double amount = (double)(r % 20000) / 100.0 + 0.01;
+        std::string description = DESCRIPTIONS[(r >> 16) % 5];
+        if (r % 3 == 0 && ledger.getBalance() > amount) ledger.withdraw(amount, description);
+        else ledger.deposit(amount, description);
+    }
+}
+
+template <typename Ledger>
+static std::vector<TransactionRecord> allRecords(Ledger& ledger) {
+    HistoryFilter all = HistoryFilter();
+    HistoryCursor cursor = makeHistoryCursor(all, 512);
+    std::vector<TransactionRecord> rows, chunk(512);
+    int n;
+    while ((n = ledger.readHistory(cursor, chunk.data())) > 0) {
+        rows.insert(rows.end(), chunk.begin(), chunk.begin() + n);
+    }
+    return rows;
+}
+
+static std::string lower(std::string s) {
+    for (char& c : s) c = (char)std::tolower((unsigned char)c);
+    return s;
+}
+
+typedef std::function<bool(const TransactionRecord&)> Expected;
+
+// Run `text` and compare the matched IDs with a brute-force filter over every record
+template <typename Ledger>
+static bool matchesBruteForce(Ledger& ledger, const std::vector<TransactionRecord>& rows,
+                              const std::string& text, Expected expected) {
+    CompiledQuery query;
+    std::string error;
+    if (!compileQuery(text, query, error)) return false;
+
+    std::vector<int> want;
+    for (const TransactionRecord& r : rows) {
+        if (expected(r)) want.push_back(r.id);
+    }
+
+    std::vector<TransactionRecord> out(rows.size() + 1);
+    QueryReport report;
+    int n = ledger.runQuery(query, out.data(), (int)out.size(), report);
+    if (n < 0 || report.rowsMatched != (long long)want.size()) return false;
+
+    std::vector<int> got;
+    for (int i = 0; i < n; i++) got.push_back(out[(size_t)i].id);
+    return got == want;
+}
+
+template <typename Ledger>
+static void checkQueries(Ledger& ledger) {
+    std::vector<TransactionRecord> rows = allRecords(ledger);
+    CHECK(!rows.empty());
+
+    long long from = START_SECONDS + 3000, to = START_SECONDS + 7000;
+    std::string tsQuery = "ts >= " + std::to_string(from) + " AND ts < " + std::to_string(to);
+
+    CHECK(matchesBruteForce(ledger, rows, "", [](const TransactionRecord&) { return true; }));
+    CHECK(matchesBruteForce(ledger, rows, "type = WITHDRAWAL AND amount > 100",
+                            [](const TransactionRecord& r) {
+                                return r.kind == KIND_WITHDRAWAL && r.amount > 100.0;
+                            }));
+    CHECK(matchesBruteForce(ledger, rows, "id BETWEEN 2000 AND 6000 AND type != DEPOSIT",
+                            [](const TransactionRecord& r) {
+                                return r.id >= 2000 && r.id <= 6000 && r.kind != KIND_DEPOSIT;
+                            }));
+    CHECK(matchesBruteForce(ledger, rows, tsQuery, [&](const TransactionRecord& r) {
+        return r.timestamp >= from * MICROS_PER_SECOND && r.timestamp < to * MICROS_PER_SECOND;
+    }));
+    CHECK(matchesBruteForce(ledger, rows, "desc ~ \"RENT\"", [](const TransactionRecord& r) {
+        return lower(r.description).find("rent") != std::string::npos;
+    }));
+    CHECK(matchesBruteForce(ledger, rows, "desc = \"Coffee shop\" AND balance <= 5000",
+                            [](const TransactionRecord& r) {
+                                return std::string(r.description) == "Coffee shop" &&
+                                       r.balanceAfter <= 5000.0;
+                            }));
+    CHECK(matchesBruteForce(ledger, rows, "amount != 50.01 AND desc != \"Salary ACME\"",
+                            [](const TransactionRecord& r) {
+                                return r.amount != 50.01 && std::string(r.description) != "Salary ACME";
+                            }));
+    CHECK(matchesBruteForce(ledger, rows, "amount < 0",
+                            [](const TransactionRecord&) { return false; }));
+    CHECK(matchesBruteForce(ledger, rows, "id > 5 AND id < 3",
+                            [](const TransactionRecord&) { return false; }));
+}
+
+TEST(query, matchesBruteForceAcrossArchiveAndMemory) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "bank_ledger_query_tests";
+    std::filesystem::remove_all(dir);
+    {
+        BankLedger ledger(0.0, true);
+        fillLedger(ledger, 10000);
+        CHECK(ledger.enableArchive(dir.string(), 1000));
+        CHECK(ledger.getArchivedCount() > 0);
+        checkQueries(ledger);
+
+        // Segments outside the id bound are ruled out by their footer
+        CompiledQuery query;
+        std::string error;
+        CHECK(compileQuery("id > 9500", query, error));
+        TransactionRecord out[600];
+        QueryReport report;
+        CHECK(ledger.runQuery(query, out, 600, report) == 500);
+        CHECK(report.segmentsSkipped > 0);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(query, matchesBruteForceWithoutColumns) {
+    EmbeddedLedger ledger(0.0, true);
+    fillLedger(ledger, 3000);
+    checkQueries(ledger);
+}
+
+TEST(query, projectionAndCapacity) {
+    BankLedger ledger(0.0, true);
+    fillLedger(ledger, 500);
+
+    CompiledQuery query;
+    std::string error;
+    CHECK(compileQuery("SELECT id, amount WHERE type = DEPOSIT", query, error));
+
+    TransactionRecord out[10];
+    QueryReport report;
+    CHECK(ledger.runQuery(query, out, 10, report) == 10);
+    CHECK(report.rowsMatched > 10);           // counted past the capacity
+    CHECK(report.rowsScanned >= report.rowsMatched);
+    for (const TransactionRecord& r : out) {
+        CHECK(r.id > 0);
+        CHECK(r.amount > 0.0);
+        CHECK(r.timestamp == 0);              // not selected
+        CHECK(r.balanceAfter == 0.0);
+        CHECK(r.description[0] == '\0');
+    }
+}
+
+TEST(query, syntaxErrorsAreReported) {
+    const char* bad[] = {
+        "amount >",
+        "type < DEPOSIT",
+        "desc > 5",
+        "foo = 1",
+        "amount ~ 5",
+        "ts = 2024-13-01",
+        "id BETWEEN 1 5",
+        "type = DEPOSIT OR type = WITHDRAWAL",
+    };
+    for (const char* text : bad) {
+        CompiledQuery query;
+        std::string error;
+        CHECK(!compileQuery(text, query, error));
+        CHECK(!error.empty());
+    }
+}
@@ -0,0 +1,131 @@
+#include "test_util.h"
+#include "../include/bank_ledger.h"
+#include "../include/reconcile.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static std::string normalized(const std::string& s) {
+    return normalizeDescription(s.data(), s.data() + s.size());
+}
+
+static void reconcileText(BankLedger& ledger, const std::string& text, int threads,
+                          ReconcileResult& out) {
+    reconcileBuffer(ledger, text.data(), text.size(), IMPORT_CSV, RECONCILE_DEFAULT_WINDOW,
+                    threads, out);
+}
+
+TEST(reconcile, descriptionsAreNormalized) {
+    CHECK(normalized("ACME Corp. #42") == "acme corp 42");
+    CHECK(normalized("  acme   corp 42 ") == "acme corp 42");
+    CHECK(normalized("Rent, March") == normalized("rent march"));
+    CHECK(normalized("caf\xc3\xa9 Latte") == "caf\xc3\xa9 latte");   // non-ASCII kept
+    CHECK(normalized("...") == "");
+}
+
+TEST(reconcile, countsMatchedMissingExtraAndRejected) {
+    BankLedger ledger(0.0, true);
+    ledger.setClock(LedgerClock::fake(START, HOUR));
+    ledger.deposit(100.0, "Salary ACME");       // id 1, START
+    ledger.withdraw(30.5, "Rent, March");       // id 2, START + 1h
+    ledger.withdraw(4.2, "Coffee");             // id 3, START + 2h
+    ledger.deposit(10.0, "Refund");             // id 4, START + 3h
+
+    std::string s = std::to_string(START_SECONDS);
+    std::string tenDays = std::to_string(START_SECONDS + 10 * 86400);
+    std::string statement =
+        "DEPOSIT,100.00,salary acme.," + std::to_string(START_SECONDS + 86400) + "\n"   // in window
+        "WITHDRAWAL,30.50,rent march," + std::to_string(START_SECONDS + 3600) + "\n"
+        "WITHDRAWAL,4.20,Coffee," + tenDays + "\n"                                      // too late
+        "DEPOSIT,10,Refund\n"                                                          // no date
+        "BOGUS,x\n"                                                                    // malformed
+        "WITHDRAWAL,99,Unknown," + s + "\n";
+
+    ReconcileResult result;
+    reconcileText(ledger, statement, 1, result);
+    const ReconcileReport& r = result.report;
+    CHECK(r.ledgerRows == 4);
+    CHECK(r.statementRows == 4);
+    CHECK(r.matched == 2);
+    CHECK(r.missing == 2);
+    CHECK(r.extra == 2);
+    CHECK(r.rejected == 2);
+
+    CHECK(result.missing.size() == 2);
+    if (result.missing.size() == 2) {
+        CHECK(result.missing[0].statementRow == 3);
+        CHECK(result.missing[0].description == "coffee");
+        CHECK(result.missing[1].statementRow == 5);
+        CHECK_MONEY(result.missing[1].amount, 99.0);
+    }
+    CHECK(result.extra.size() == 2);
+    if (result.extra.size() == 2) {
+        CHECK(result.extra[0].ledgerID == 3);
+        CHECK(result.extra[1].ledgerID == 4);
+        CHECK(result.extra[1].kind == KIND_DEPOSIT);
+    }
+}
+
+TEST(reconcile, repeatedKeysPairOnce) {
+    BankLedger ledger(0.0, true);
+    ledger.setClock(LedgerClock::fake(START, HOUR));
+    ledger.deposit(5.0, "Interest");            // id 1
+    ledger.deposit(5.0, "Interest");            // id 2
+
+    std::string at = std::to_string(START_SECONDS);
+    ReconcileResult result;
+    reconcileText(ledger,
+                  "DEPOSIT,5,Interest," + at + "\n"
+                  "DEPOSIT,5,Interest," + at + "\n"
+                  "DEPOSIT,5,Interest," + at + "\n", 1, result);
+    CHECK(result.report.matched == 2);
+    CHECK(result.report.missing == 1);
+    CHECK(result.report.extra == 0);
+}
+
+TEST(reconcile, threadCountDoesNotChangeTheResult) {
+    BankLedger ledger(1000000.0, true);
+    ledger.setClock(LedgerClock::fake(START, 90LL * MICROS_PER_SECOND));
+    static const char* names[] = { "Salary", "Rent", "Groceries", "Coffee", "Fuel" };
+    const int postings = 20000;
+    for (int i = 0; i < postings; i++) {
+        double amount = (double)(i % 997) + 0.25;
+        if (i % 4 == 1) ledger.withdraw(amount, names[i % 5]);
+        else ledger.deposit(amount, names[i % 5]);
+    }
+
+    // The statement repeats the ledger, minus every 10th posting, plus 50 unknown rows
+    std::string statement;
+    char line[160];
+    for (int id = 1; id <= postings; id++) {
+        if (id % 10 == 0) continue;
+        Transaction* t = ledger.searchByID(id);
+        if (!t) continue;
+        snprintf(line, sizeof(line), "%s,%.2f,%s,%lld\n", t->type.c_str(), t->amount,
+                 t->description.c_str(), (long long)(t->timestamp / MICROS_PER_SECOND));
+        statement += line;
+    }
+    for (int i = 0; i < 50; i++) {
+        snprintf(line, sizeof(line), "WITHDRAWAL,1234.56,Unknown %d,%lld\n", i, START_SECONDS);
+        statement += line;
+    }
+
+    ReconcileResult single, parallel;
+    reconcileText(ledger, statement, 1, single);
+    reconcileText(ledger, statement, 4, parallel);
+
+    CHECK(single.report.matched == postings - postings / 10);
+    CHECK(single.report.missing == 50);
+    CHECK(single.report.extra == postings / 10);
+    CHECK(single.report.rejected == 0);
+
+    CHECK(parallel.report.matched == single.report.matched);
+    CHECK(parallel.report.missing == single.report.missing);
+    CHECK(parallel.report.extra == single.report.extra);
+    CHECK(parallel.missing.size() == single.missing.size());
+    CHECK(parallel.extra.size() == single.extra.size());
+    for (size_t i = 0; i < parallel.extra.size() && i < single.extra.size(); i++) {
+        CHECK(parallel.extra[i].ledgerID == single.extra[i].ledgerID);
+    }
+    for (size_t i = 0; i < single.extra.size(); i++) CHECK(single.extra[i].ledgerID % 10 == 0);
+}
@@ -0,0 +1,127 @@
+#include "test_util.h"
+#include "../include/bank_ledger.h"
+#include "../include/scheduler.h"
+
+// The C API (src/ffi_bridge.cpp)
+extern "C" {
+    void* createBankLedger(double initialBalance);
+    void deleteBankLedger(void* ledger);
+    void* createScheduler();
+    void deleteScheduler(void* scheduler);
+    int addSchedule(void* scheduler, void* ledger, int kind, double amount,
+                    const char* description, long long firstDueUs, int repeat,
+                    long long every, int count);
+    int runDueSchedules(void* scheduler, long long nowUs, int* rejected);
+}
+
+static ScheduleSpec withdrawalEveryHour(double amount, int count) {
+    ScheduleSpec spec;
+    spec.account = 0;
+    spec.kind = KIND_WITHDRAWAL;
+    spec.amount = amount;
+    spec.firstDue = START;
+    spec.repeat = REPEAT_INTERVAL;
+    spec.every = HOUR;
+    spec.count = count;
+    return spec;
+}
+
+static ScheduleRunReport runInto(BankLedger& ledger, PostingScheduler& scheduler, Timestamp now) {
+    return runDueSchedules(scheduler, now, [&](const ScheduledPosting& p) {
+        return ledger.postAt(p.kind, p.amount, p.description, p.due) != 0;
+    });
+}
+
+TEST(scheduler, postsAtDueTimeAndCanBeUndone) {
+    BankLedger ledger(100.0, true);
+    ledger.setClock(LedgerClock::fake(START + 10 * HOUR, HOUR));
+    PostingScheduler scheduler;
+    CHECK(scheduler.add(withdrawalEveryHour(10.0, 3), "Rent") != 0);
+
+    ScheduleRunReport report = runInto(ledger, scheduler, START + 5 * HOUR);
+    CHECK(report.posted == 3);
+    CHECK(report.rejected == 0);
+    CHECK_MONEY(ledger.getBalance(), 70.0);
+
+    int ids[3] = { 1, 2, 3 };
+    TransactionRecord out[3];
+    CHECK(ledger.getByIDs(ids, 3, out) == 3);
+    for (int i = 0; i < 3; i++) CHECK(out[i].timestamp == START + i * HOUR);
+
+    ledger.undo();
+    CHECK(ledger.getTransactionCount() == 2);
+    CHECK_MONEY(ledger.getBalance(), 80.0);
+}
+
+TEST(scheduler, withdrawalCannotSpendHeldMoney) {
+    BankLedger ledger(100.0, true);
+    ledger.setClock(LedgerClock::fake(START, HOUR));
+    CHECK(ledger.placeHold(80.0, "Card authorization", INT64_MAX) != 0);
+
+    PostingScheduler scheduler;
+    CHECK(scheduler.add(withdrawalEveryHour(15.0, 2), "Subscription") != 0);
+
+    ScheduleRunReport report = runInto(ledger, scheduler, START + HOUR);
+    CHECK(report.posted == 1);
+    CHECK(report.rejected == 1);
+    CHECK_MONEY(ledger.getBalance(), 85.0);
+    CHECK_MONEY(ledger.getAvailableBalance(), 5.0);
+}
+
+TEST(scheduler, holdsExpireAtTheDueTime) {
+    BankLedger ledger(100.0, true);
+    ledger.setClock(LedgerClock::fake(START, HOUR));
+    CHECK(ledger.placeHold(80.0, "Card authorization", START + HOUR / 2) != 0);
+
+    PostingScheduler scheduler;
+    CHECK(scheduler.add(withdrawalEveryHour(50.0, 2), "Transfer") != 0);
+
+    // Due at START the hold still stands; at START + 1h it has lapsed
+    ScheduleRunReport report = runInto(ledger, scheduler, START + HOUR);
+    CHECK(report.posted == 1);
+    CHECK(report.rejected == 1);
+    CHECK(ledger.getActiveHoldCount() == 0);
+    CHECK_MONEY(ledger.getBalance(), 50.0);
+}
+
+TEST(scheduler, withdrawalsCountTowardVelocity) {
+    BankLedger ledger(1000.0, true);
+    ledger.setClock(LedgerClock::fake(START, HOUR));
+    VelocityRule rule = { VELOCITY_COUNT, 2, 4 * HOUR };
+    CHECK(ledger.setVelocityLimits(&rule, 1) == 1);
+
+    PostingScheduler scheduler;
+    CHECK(scheduler.add(withdrawalEveryHour(10.0, 3), "Standing order") != 0);
+
+    ScheduleRunReport report = runInto(ledger, scheduler, START + 2 * HOUR);
+    CHECK(report.posted == 2);
+    CHECK(report.rejected == 1);
+    CHECK(ledger.getLastVelocityBreach() == 0);
+    CHECK_MONEY(ledger.getBalance(), 980.0);
+}
+
+TEST(scheduler, ffiDropsSchedulesOfDeletedLedgers) {
+    void* scheduler = createScheduler();
+    void* first = createBankLedger(100.0);
+    CHECK(addSchedule(scheduler, first, KIND_DEPOSIT, 5.0, "Interest", START, REPEAT_ONCE, 0, 1) != 0);
+    deleteBankLedger(first);
+
+    // Likely at the same address; either way it must not get first's schedule
+    void* second = createBankLedger(100.0);
+    int rejected = -1;
+    CHECK(runDueSchedules(scheduler, START, &rejected) == 0);
+    CHECK(rejected == 1);
+    CHECK(((BankLedger*)second)->getTransactionCount() == 0);
+    CHECK_MONEY(((BankLedger*)second)->getBalance(), 100.0);
+
+    // Cancelled, so the next run has nothing left
+    CHECK(runDueSchedules(scheduler, START + HOUR, &rejected) == 0);
+    CHECK(rejected == 0);
+
+    CHECK(addSchedule(scheduler, second, KIND_DEPOSIT, 5.0, "Interest", START, REPEAT_ONCE, 0, 1) != 0);
+    CHECK(runDueSchedules(scheduler, START, &rejected) == 1);
+    CHECK_MONEY(((BankLedger*)second)->getBalance(), 105.0);
+
+    deleteBankLedger(second);
+    deleteScheduler(scheduler);
+}
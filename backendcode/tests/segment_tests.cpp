@@ -0,0 +1,98 @@
+#include "test_util.h"
+#include "../include/segment_codec.h"
+#include <cstring>
+#include <vector>
+
+// Deposits and withdrawals with cent amounts, a few raw doubles and
+// repeating descriptions, so every column encoding is exercised
+static std::vector<Transaction*> samplePostings(int n) {
+    static const char* names[] = { "Salary", "Rent", "Groceries", "Coffee" };
+    std::vector<Transaction*> rows;
+    double balance = 1000.0;
+    for (int i = 0; i < n; i++) {
+        bool withdrawal = (i % 3 == 1);
+        double amount = (i % 7 == 0) ? 0.1 * (i + 1) : (double)(i % 50) + 0.25;
+        balance += withdrawal ? -amount : amount;
+        rows.push_back(new Transaction(100 + i, withdrawal ? "WITHDRAWAL" : "DEPOSIT", amount,
+                                       names[i % 4], balance, START + (Timestamp)i * 977));
+    }
+    return rows;
+}
+
+static void freeRows(std::vector<Transaction*>& rows) {
+    for (Transaction* t : rows) delete t;
+    rows.clear();
+}
+
+TEST(segment, footerAndRowsRoundTrip) {
+    std::vector<Transaction*> rows = samplePostings(300);
+    std::string data = encodeSegment(rows.data(), rows.size(), 42);
+
+    SegmentFooter f;
+    CHECK(readSegmentFooter(data.data(), data.size(), f));
+    CHECK(f.rows == 300);
+    CHECK(f.firstPosition == 42);
+    CHECK(f.minID == 100);
+    CHECK(f.maxID == 399);
+    CHECK(f.minTimestamp == START);
+    CHECK(f.maxTimestamp == START + 299 * 977);
+
+    std::vector<Transaction*> decoded;
+    uint64_t firstPosition = 0;
+    CHECK(decodeSegment(data, decoded, firstPosition));
+    CHECK(firstPosition == 42);
+    CHECK(decoded.size() == rows.size());
+    for (size_t i = 0; i < decoded.size() && i < rows.size(); i++) {
+        CHECK(decoded[i]->id == rows[i]->id);
+        CHECK(decoded[i]->type == rows[i]->type);
+        CHECK(decoded[i]->amount == rows[i]->amount);              // bit for bit
+        CHECK(decoded[i]->balanceAfter == rows[i]->balanceAfter);
+        CHECK(decoded[i]->timestamp == rows[i]->timestamp);
+        CHECK(decoded[i]->description == rows[i]->description);
+    }
+
+    freeRows(decoded);
+    freeRows(rows);
+}
+
+TEST(segment, truncatedBuffersAreRejected) {
+    std::vector<Transaction*> rows = samplePostings(40);
+    std::string data = encodeSegment(rows.data(), rows.size(), 0);
+
+    for (size_t size = 0; size < data.size(); size++) {
+        SegmentFooter f;
+        CHECK(!readSegmentFooter(data.data(), size, f));
+
+        std::vector<Transaction*> decoded;
+        uint64_t firstPosition;
+        CHECK(!decodeSegment(data.substr(0, size), decoded, firstPosition));
+        CHECK(decoded.empty());
+    }
+    freeRows(rows);
+}
+
+TEST(segment, corruptOffsetsAreRejected) {
+    std::vector<Transaction*> rows = samplePostings(40);
+    std::string data = encodeSegment(rows.data(), rows.size(), 0);
+    SegmentFooter f;
+    CHECK(readSegmentFooter(data.data(), data.size(), f));
+
+    // Trailer pointing past the footer
+    std::string bad = data;
+    uint32_t offset = f.footerOffset + 1;
+    memcpy(&bad[bad.size() - 4], &offset, 4);
+    CHECK(!readSegmentFooter(bad.data(), bad.size(), f));
+
+    // Column offsets out of order
+    bad = data;
+    uint32_t swapped[2] = { f.columnOffset[2], f.columnOffset[1] };
+    memcpy(&bad[f.footerOffset + 4], swapped, sizeof(swapped));
+    CHECK(!readSegmentFooter(bad.data(), bad.size(), f));
+
+    // Wrong magic
+    bad = data;
+    bad[0] = 'X';
+    CHECK(!readSegmentFooter(bad.data(), bad.size(), f));
+
+    freeRows(rows);
+}
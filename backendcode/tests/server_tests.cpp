@@ -0,0 +1,201 @@
+#include "test_util.h"
+#include "../include/ledger_server.h"
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+struct Response {
+    FrameHeader header;
+    std::string payload;
+};
+
+// A server on its own thread, stopped and joined on scope exit
+class RunningServer {
+private:
+    LedgerServer server;
+    std::thread loop;
+
+public:
+    std::string path;
+
+    explicit RunningServer(BankLedger& ledger) : server(ledger) {
+        path = (std::filesystem::temp_directory_path() / "bank_ledger_server_tests.sock").string();
+        if (server.listen(path)) loop = std::thread([this]() { server.run(); });
+    }
+    ~RunningServer() {
+        server.stop();
+        if (loop.joinable()) loop.join();
+    }
+    bool running() const { return loop.joinable(); }
+};
+
+static int connectTo(const std::string& path) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += (size_t)n;
+    }
+    return true;
+}
+
+// Up to `count` responses; fewer if the server hangs up first
+static std::vector<Response> readResponses(int fd, size_t count) {
+    std::vector<Response> out;
+    std::string buffer;
+    size_t pos = 0;
+    char chunk[65536];
+    FrameHeader h;
+
+    while (out.size() < count) {
+        while (out.size() < count && readFrameHeader(buffer.data() + pos, buffer.size() - pos, h) &&
+               buffer.size() - pos >= PROTOCOL_HEADER_SIZE + h.length) {
+            out.push_back(Response{ h, buffer.substr(pos + PROTOCOL_HEADER_SIZE, h.length) });
+            pos += PROTOCOL_HEADER_SIZE + h.length;
+        }
+        if (out.size() == count) break;
+
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) break;
+        buffer.append(chunk, (size_t)n);
+    }
+    return out;
+}
+
+static double balanceOf(const Response& r) {
+    double balance = 0.0;
+    if (r.payload.size() == 8) memcpy(&balance, r.payload.data(), 8);
+    return balance;
+}
+
+TEST(server, pipelinedPostingsAnswerInOrder) {
+    BankLedger ledger(0.0, true);
+    RunningServer server(ledger);
+    CHECK(server.running());
+    int fd = connectTo(server.path);
+    CHECK(fd >= 0);
+    if (fd < 0) return;
+
+    std::string requests;
+    appendPostingRequest(requests, REQ_DEPOSIT, 1, 100.0, "Salary");
+    appendPostingRequest(requests, REQ_WITHDRAW, 2, 30.0, "Rent");
+    appendPostingRequest(requests, REQ_WITHDRAW, 3, 1000.0, "Car");       // more than the balance
+    appendFrame(requests, REQ_COUNT, 0, 4, nullptr, 0);
+    appendPostingRequest(requests, REQ_DEPOSIT, 5, 5.0, "Interest");
+    appendFrame(requests, REQ_UNDO, 0, 6, nullptr, 0);
+    CHECK(sendAll(fd, requests));
+
+    std::vector<Response> r = readResponses(fd, 6);
+    CHECK(r.size() == 6);
+    if (r.size() == 6) {
+        for (uint32_t i = 0; i < 6; i++) CHECK(r[i].header.tag == i + 1);
+        CHECK(r[0].header.status == RESP_OK);
+        CHECK_MONEY(balanceOf(r[0]), 100.0);
+        CHECK(r[1].header.status == RESP_OK);
+        CHECK_MONEY(balanceOf(r[1]), 70.0);
+        CHECK(r[2].header.status == RESP_REJECTED);
+        CHECK_MONEY(balanceOf(r[2]), 70.0);
+
+        int64_t count = 0;
+        memcpy(&count, r[3].payload.data(), 8);
+        CHECK(count == 2);                      // the batch before it was applied first
+        CHECK_MONEY(balanceOf(r[4]), 75.0);
+        CHECK(r[5].header.status == RESP_OK);
+        CHECK_MONEY(balanceOf(r[5]), 70.0);
+    }
+    close(fd);
+}
+
+TEST(server, badRequestClosesTheConnection) {
+    BankLedger ledger(0.0, true);
+    RunningServer server(ledger);
+    const unsigned char shortPayload[4] = { 0, 0, 0, 0 };
+
+    // An unknown opcode, then a deposit whose payload is too short
+    for (int bad = 0; bad < 2; bad++) {
+        int fd = connectTo(server.path);
+        CHECK(fd >= 0);
+        if (fd < 0) return;
+
+        std::string requests;
+        appendPostingRequest(requests, REQ_DEPOSIT, 1, 5.0, "Before");
+        if (bad == 0) appendFrame(requests, 99, 0, 2, nullptr, 0);
+        else appendFrame(requests, REQ_DEPOSIT, 0, 2, shortPayload, sizeof(shortPayload));
+        appendPostingRequest(requests, REQ_DEPOSIT, 3, 5.0, "After");
+        CHECK(sendAll(fd, requests));
+
+        // The deposit before, the error, then end of stream
+        std::vector<Response> r = readResponses(fd, 3);
+        CHECK(r.size() == 2);
+        if (r.size() == 2) {
+            CHECK(r[0].header.status == RESP_OK);
+            CHECK(r[1].header.status == RESP_BAD_REQUEST);
+            CHECK(r[1].header.tag == 2);
+        }
+        close(fd);
+    }
+
+    // Checked from a fresh connection, so the server thread has applied them
+    int fd = connectTo(server.path);
+    std::string count;
+    appendFrame(count, REQ_COUNT, 0, 1, nullptr, 0);
+    CHECK(sendAll(fd, count));
+    std::vector<Response> r = readResponses(fd, 1);
+    int64_t n = 0;
+    if (r.size() == 1) memcpy(&n, r[0].payload.data(), 8);
+    CHECK(n == 2);                              // neither "After" went through
+    close(fd);
+}
+
+TEST(server, clientThatDoesNotReadIsThrottled) {
+    BankLedger ledger(0.0, true);
+    RunningServer server(ledger);
+    int fd = connectTo(server.path);
+    CHECK(fd >= 0);
+    if (fd < 0) return;
+
+    // Three times the output limit in balance answers
+    const size_t requests = 3 * SERVER_OUTPUT_LIMIT / (PROTOCOL_HEADER_SIZE + 8);
+    std::string data;
+    for (size_t i = 0; i < requests; i++) appendFrame(data, REQ_BALANCE, 0, (uint32_t)i, nullptr, 0);
+
+    std::atomic<bool> sent(false);
+    std::thread sender([&]() {
+        sendAll(fd, data);
+        sent.store(true);
+    });
+
+    // The server stops reading once its answers pile up, so the sender stalls
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    CHECK(!sent.load());
+
+    // Reading lets everything through, in order
+    std::vector<Response> r = readResponses(fd, requests);
+    sender.join();
+    CHECK(sent.load());
+    CHECK(r.size() == requests);
+    bool inOrder = true;
+    for (size_t i = 0; i < r.size(); i++) inOrder = inOrder && r[i].header.tag == (uint32_t)i;
+    CHECK(inOrder);
+    close(fd);
+}
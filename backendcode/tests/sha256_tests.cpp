@@ -0,0 +1,45 @@
+#include "test_util.h"
+#include "../include/sha256.h"
+#include <cstring>
+#include <string>
+
+static std::string hexOf(const std::string& message) {
+    return Sha256::hash(message.data(), message.size()).toHex();
+}
+
+// FIPS 180-2 appendix B examples, plus the empty message
+TEST(sha256, fipsVectors) {
+    CHECK(hexOf("") == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    CHECK(hexOf("abc") == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    CHECK(hexOf("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") ==
+          "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    CHECK(hexOf(std::string(1000000, 'a')) ==
+          "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+TEST(sha256, paddingBoundaries) {
+    // 55 bytes pad into one block, 56 need a second one
+    CHECK(hexOf(std::string(55, 'a')) == "9f4390f8d30c2dd92ec9f095b65e2b9ae9b0a925a5258e241c9f1e910f734318");
+    CHECK(hexOf(std::string(56, 'a')) == "b35439a4ac6f0948b6d6f9e3c6af0f5f590ce20f1bde7090ef7970686ec6738a");
+    CHECK(hexOf(std::string(64, 'a')) == "ffe054fe7ae0cb6dc65c3af9b61d5209f439851db43d0ba5997337df154668eb");
+}
+
+TEST(sha256, streamedInPiecesMatchesOneShot) {
+    std::string message;
+    for (int i = 0; i < 300; i++) message.push_back((char)(i * 31 + 7));
+    Digest whole = Sha256::hash(message.data(), message.size());
+
+    // Every split point, so pieces end before, on and after block edges
+    bool allMatch = true;
+    for (size_t split = 0; split <= message.size(); split++) {
+        Sha256 h;
+        h.update(message.data(), split);
+        h.update(message.data() + split, message.size() - split);
+        allMatch = allMatch && h.finish() == whole;
+    }
+    CHECK(allMatch);
+
+    Sha256 bytewise;
+    for (char c : message) bytewise.update(&c, 1);
+    CHECK(bytewise.finish() == whole);
+}
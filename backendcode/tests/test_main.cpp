@@ -0,0 +1,52 @@
+#include "test_util.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+struct RegisteredTest {
+    const char* suite;
+    const char* name;
+    TestFn fn;
+};
+
+// Function-local so registration from other files' static initializers is safe
+static std::vector<RegisteredTest>& registry() {
+    static std::vector<RegisteredTest> tests;
+    return tests;
+}
+
+static int failures = 0;
+
+int registerTest(const char* suite, const char* name, TestFn fn) {
+    registry().push_back({ suite, name, fn });
+    return (int)registry().size();
+}
+
+void reportFailure(const char* file, int line, const char* expr) {
+    std::cout << "  " << file << ":" << line << ": CHECK(" << expr << ") failed" << std::endl;
+    failures++;
+}
+
+// Usage: bank_ledger_unit_tests [suite]   (no suite = every test)
+int main(int argc, char** argv) {
+    const char* only = argc > 1 ? argv[1] : nullptr;
+    int run = 0, failed = 0;
+
+    for (const RegisteredTest& t : registry()) {
+        if (only && strcmp(only, t.suite) != 0) continue;
+
+        int before = failures;
+        t.fn();
+        run++;
+        bool ok = failures == before;
+        if (!ok) failed++;
+        std::cout << (ok ? "[ ok ] " : "[FAIL] ") << t.suite << "." << t.name << std::endl;
+    }
+
+    if (run == 0) {
+        std::cout << "No tests match '" << (only ? only : "") << "'" << std::endl;
+        return 1;
+    }
+    std::cout << run - failed << "/" << run << " passed" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
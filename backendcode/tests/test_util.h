@@ -0,0 +1,38 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include "../include/clock.h"
+#include <cmath>
+
+// ===== Minimal test registry =====
+//
+// TEST(suite, name) registers a case; ctest runs one suite per test entry
+// (bank_ledger_unit_tests <suite>). CHECK records a failure and carries on,
+// so one run reports every broken expectation in a case.
+
+typedef void (*TestFn)();
+
+int registerTest(const char* suite, const char* name, TestFn fn);
+void reportFailure(const char* file, int line, const char* expr);
+
+#define TEST(suite, name)                                                          \
+    static void test_##suite##_##name();                                           \
+    [[maybe_unused]] static int registered_##suite##_##name =                      \
+        registerTest(#suite, #name, test_##suite##_##name);                        \
+    static void test_##suite##_##name()
+
+#define CHECK(cond)                                                                \
+    do {                                                                           \
+        if (!(cond)) reportFailure(__FILE__, __LINE__, #cond);                     \
+    } while (0)
+
+// Fake-clock anchors shared by the suites (2023-11-14 22:13:20 UTC)
+static const long long START_SECONDS = 1700000000LL;
+static const Timestamp START = START_SECONDS * MICROS_PER_SECOND;
+static const Timestamp MINUTE = 60LL * MICROS_PER_SECOND;
+static const Timestamp HOUR = 60 * MINUTE;
+
+// Money compares to the cent
+#define CHECK_MONEY(actual, expected) CHECK(std::fabs((actual) - (expected)) < 0.005)
+
+#endif
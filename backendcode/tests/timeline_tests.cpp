@@ -0,0 +1,114 @@
+#include "test_util.h"
+#include "../include/bank_ledger.h"
+#include <vector>
+
+// Width of timeline level k (TIMELINE_BASE_WIDTH * TIMELINE_FANOUT^k)
+static Timestamp levelWidth(int k) {
+    Timestamp w = TIMELINE_BASE_WIDTH;
+    for (int i = 0; i < k; i++) w *= TIMELINE_FANOUT;
+    return w;
+}
+
+// Seeded deposits and withdrawals, one every seven fake-clock minutes
+static void fillLedger(BankLedger& ledger, int postings) {
+    ledger.setClock(LedgerClock::fake(START, 7 * MINUTE));
+    unsigned long long state = 99;
+    for (int i = 0; i < postings; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        double amount = (double)((state >> 33) % 50000) / 100.0 + 1.0;
+        if ((state >> 20) % 2 == 0 && ledger.getBalance() > amount) ledger.withdraw(amount, "Out");
+        else ledger.deposit(amount, "In");
+    }
+}
+
+// Compare n slices of `slice` microseconds from `from` with a scan of the history
+static bool matchesHistory(BankLedger& ledger, Timestamp from, Timestamp slice, int n) {
+    std::vector<TimelinePoint> points((size_t)n);
+    if (ledger.getBalanceTimeline(from, from + slice * n - 1, n, points.data()) != n) return false;
+
+    HistoryFilter all = HistoryFilter();
+    HistoryCursor cursor = makeHistoryCursor(all, 256);
+    std::vector<TransactionRecord> chunk(256);
+    std::vector<TimelinePoint> want((size_t)n, TimelinePoint());
+    int got;
+    while ((got = ledger.readHistory(cursor, chunk.data())) > 0) {
+        for (int i = 0; i < got; i++) {
+            const TransactionRecord& r = chunk[(size_t)i];
+            if (r.timestamp < from || r.timestamp >= from + slice * n) continue;
+            TimelinePoint& p = want[(size_t)((r.timestamp - from) / slice)];
+            if (p.count == 0 || r.balanceAfter < p.minBalance) p.minBalance = r.balanceAfter;
+            if (p.count == 0 || r.balanceAfter > p.maxBalance) p.maxBalance = r.balanceAfter;
+            p.closeBalance = r.balanceAfter;
+            p.count++;
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        const TimelinePoint& p = points[(size_t)i];
+        const TimelinePoint& w = want[(size_t)i];
+        if (p.count != w.count) return false;
+        if (w.count > 0 && (p.minBalance != w.minBalance || p.maxBalance != w.maxBalance ||
+                            p.closeBalance != w.closeBalance)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(timeline, slicesMatchHistoryAtEveryLevel) {
+    BankLedger ledger(0.0, true);
+    fillLedger(ledger, 3000);
+
+    // Slices exactly one bucket wide, aligned to the bucket grid
+    for (int level = 0; level <= 6; level++) {
+        Timestamp w = levelWidth(level);
+        Timestamp from = START / w * w;
+        CHECK(matchesHistory(ledger, from, w, 16));
+    }
+}
+
+TEST(timeline, smallRangeAndEmptySlices) {
+    BankLedger ledger(0.0, true);
+    ledger.setClock(LedgerClock::fake(START, MINUTE));
+    ledger.deposit(100.0, "a");     // 100 at START
+    ledger.withdraw(80.0, "b");     // 20 at START + 1m
+    ledger.deposit(150.0, "c");     // 170 at START + 2m
+
+    Timestamp from = START / MINUTE * MINUTE;
+    TimelinePoint one;
+    CHECK(ledger.getBalanceTimeline(from, from + 3 * MINUTE - 1, 1, &one) == 1);
+    CHECK(one.count == 3);
+    CHECK_MONEY(one.minBalance, 20.0);
+    CHECK_MONEY(one.maxBalance, 170.0);
+    CHECK_MONEY(one.closeBalance, 170.0);
+
+    // After the last posting the balance carries forward
+    TimelinePoint later[2];
+    CHECK(ledger.getBalanceTimeline(from + 10 * MINUTE, from + 12 * MINUTE - 1, 2, later) == 2);
+    CHECK(later[0].count == 0 && later[1].count == 0);
+    CHECK_MONEY(later[1].closeBalance, 170.0);
+    CHECK_MONEY(later[1].minBalance, 170.0);
+}
+
+TEST(timeline, undoRestoresBuckets) {
+    BankLedger ledger(0.0, true);
+    fillLedger(ledger, 200);
+    Timestamp w = levelWidth(4);
+    Timestamp from = START / w * w;
+    CHECK(matchesHistory(ledger, from, w, 8));
+
+    // A spike, then undone: min/max must drop it again at every level
+    ledger.withdraw(ledger.getBalance() - 0.5, "Spike");
+    ledger.deposit(1000000.0, "Spike");
+    ledger.undo();
+    ledger.undo();
+    CHECK(matchesHistory(ledger, from, w, 8));
+    CHECK(matchesHistory(ledger, from, levelWidth(1), 512));
+
+    // Undo all the way down the ring: the journal is as deep as the undo
+    // stack, which lost its two oldest entries to the spike
+    while (ledger.canUndo()) ledger.undo();
+    CHECK(ledger.getTransactionCount() == 200 - (UNDO_LIMIT - 2));
+    CHECK(matchesHistory(ledger, from, w, 8));
+    CHECK(matchesHistory(ledger, from, levelWidth(0), 2048));
+}
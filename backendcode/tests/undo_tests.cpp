@@ -0,0 +1,123 @@
+#include "test_util.h"
+#include "../include/bank_ledger.h"
+#include "../include/stack.h"
+#include "../include/ledger_stats.h"
+
+static Transaction* posting(int id) {
+    return new Transaction(id, "DEPOSIT", 1.0, "t", 0.0, START);
+}
+
+TEST(undo, stackKeepsTheNewestEntries) {
+    Stack stack(3);
+    for (int id = 1; id <= 5; id++) CHECK(stack.push(posting(id)));
+    CHECK(stack.size() == 3);
+    CHECK(stack.isFull());
+
+    for (int id = 5; id >= 3; id--) {
+        CHECK(stack.peek()->id == id);
+        Transaction* t = stack.pop();
+        CHECK(t->id == id);
+        delete t;
+    }
+    CHECK(stack.isEmpty());
+    CHECK(stack.pop() == nullptr);
+    CHECK(stack.peek() == nullptr);
+
+    // Still usable after wrapping around and draining
+    CHECK(stack.push(posting(6)));
+    CHECK(stack.peek()->id == 6);
+}
+
+TEST(undo, zeroDepthStackRefusesPushes) {
+    Stack stack(0);
+    Transaction* t = posting(1);
+    CHECK(!stack.push(t));
+    CHECK(stack.isEmpty());
+    delete t;
+}
+
+TEST(undo, statsJournalKeepsTheNewestEntries) {
+    LedgerStatsTracker tracker(0.0, 2);
+    double balance = 0.0;
+    for (int id = 1; id <= 4; id++) {
+        balance += 10.0 * id;
+        tracker.record(id, false, 10.0 * id, START, balance);
+    }
+
+    tracker.revert();
+    CHECK(tracker.getTotal().depositCount == 3);
+    CHECK_MONEY(tracker.getTotal().depositTotal, 60.0);
+    tracker.revert();
+    CHECK(tracker.getTotal().depositCount == 2);
+    CHECK_MONEY(tracker.getTotal().depositTotal, 30.0);
+
+    // Older entries were dropped with the undo stack's
+    tracker.revert();
+    CHECK(tracker.getTotal().depositCount == 2);
+}
+
+TEST(undo, ledgerUndoesUpToItsDepth) {
+    BankLedger ledger(0.0, true);
+    int postings = UNDO_LIMIT + 10;
+    for (int i = 1; i <= postings; i++) ledger.deposit(1.0, "Deposit");
+
+    int undone = 0;
+    while (ledger.canUndo()) {
+        ledger.undo();
+        undone++;
+    }
+    CHECK(undone == UNDO_LIMIT);
+    CHECK(ledger.getTransactionCount() == postings - UNDO_LIMIT);
+    CHECK_MONEY(ledger.getBalance(), 10.0);
+    CHECK(ledger.getStats().depositCount == postings - UNDO_LIMIT);
+    CHECK_MONEY(ledger.getStats().depositTotal, 10.0);
+
+    ledger.deposit(5.0, "After");
+    ledger.undo();
+    CHECK_MONEY(ledger.getBalance(), 10.0);
+}
+
+TEST(undo, eventLogKeepsUndonePostings) {
+    BankLedger ledger(100.0, true);
+    ledger.setClock(LedgerClock::fake(START, MICROS_PER_SECOND));
+    ledger.deposit(50.0, "Refund");         // at START
+    ledger.withdraw(30.0, "Mistake");       // at START + 1s
+    ledger.undo();                          // at START + 2s
+
+    // The live view no longer has the withdrawal
+    CHECK(ledger.getTransactionCount() == 1);
+    CHECK(ledger.searchByID(2) == nullptr);
+    CHECK_MONEY(ledger.getBalance(), 150.0);
+
+    LedgerStateAt before, after;
+    CHECK(ledger.getStateAt(START + MICROS_PER_SECOND, before));
+    CHECK(before.livePostings == 2);
+    CHECK(before.undonePostings == 0);
+    CHECK_MONEY(before.balance, 120.0);
+
+    CHECK(ledger.getStateAt(START + 2 * MICROS_PER_SECOND, after));
+    CHECK(after.livePostings == 1);
+    CHECK(after.undonePostings == 1);
+    CHECK_MONEY(after.balance, 150.0);
+}
+
+TEST(undo, importedPostingSealsUndoHistory) {
+    BankLedger ledger(0.0, true);
+    ledger.deposit(100.0, "Deposit");
+    CHECK(ledger.postImported(KIND_DEPOSIT, 5.0, "Imported", 0));
+    CHECK(!ledger.canUndo());
+
+    ledger.undo();                          // nothing to take back
+    CHECK(ledger.getTransactionCount() == 2);
+    CHECK_MONEY(ledger.getBalance(), 105.0);
+    CHECK(ledger.getStats().depositCount == 2);
+    CHECK(ledger.verifyHistory(1, 2));
+
+    // Later live postings are undoable again
+    ledger.withdraw(20.0, "ATM");
+    ledger.undo();
+    CHECK(ledger.getTransactionCount() == 2);
+    CHECK_MONEY(ledger.getBalance(), 105.0);
+    CHECK_MONEY(ledger.getStats().depositTotal, 105.0);
+    CHECK(ledger.verifyHistory(1, 2));
+}
@@ -0,0 +1,117 @@
+#include "test_util.h"
+#include "../include/bank_ledger.h"
+#include <filesystem>
+
+TEST(velocity, countRuleRejectsAndSlides) {
+    BankLedger ledger(1000.0, true);
+    ledger.setClock(LedgerClock::fake(START, MINUTE));
+    VelocityRule rule = { VELOCITY_COUNT, 2, HOUR };
+    CHECK(ledger.setVelocityLimits(&rule, 1) == 1);
+
+    ledger.withdraw(10.0, "a");
+    ledger.withdraw(10.0, "b");
+    ledger.withdraw(10.0, "c");
+    CHECK(ledger.getTransactionCount() == 2);
+    CHECK(ledger.getLastVelocityBreach() == 0);
+
+    // Two hours later (fake clock: a minute per reading) the window is clear
+    ledger.setClock(LedgerClock::fake(START + 2 * HOUR, MINUTE));
+    ledger.withdraw(10.0, "d");
+    CHECK(ledger.getTransactionCount() == 3);
+    CHECK(ledger.getLastVelocityBreach() == -1);
+}
+
+TEST(velocity, amountRuleAndUndo) {
+    BankLedger ledger(1000.0, true);
+    ledger.setClock(LedgerClock::fake(START, MINUTE));
+    VelocityRule rule = { VELOCITY_AMOUNT, 100.0, HOUR };
+    ledger.setVelocityLimits(&rule, 1);
+
+    ledger.withdraw(60.0, "a");
+    ledger.withdraw(50.0, "b");          // 110 > 100
+    CHECK(ledger.getTransactionCount() == 1);
+
+    ledger.undo();                       // gives its 60 back to the window
+    ledger.withdraw(100.0, "c");
+    CHECK(ledger.getTransactionCount() == 1);
+    CHECK_MONEY(ledger.getBalance(), 900.0);
+}
+
+TEST(velocity, liveImportedWithdrawalIsLimited) {
+    BankLedger ledger(1000.0, true);
+    ledger.setClock(LedgerClock::fake(START, MINUTE));
+    VelocityRule rule = { VELOCITY_AMOUNT, 100.0, HOUR };
+    ledger.setVelocityLimits(&rule, 1);
+
+    ledger.withdraw(100.0, "exhausts the hour");
+    CHECK(!ledger.postImported(KIND_WITHDRAWAL, 500.0, "no timestamp: posted now", 0));
+    CHECK(ledger.getLastVelocityBreach() == 0);
+    CHECK_MONEY(ledger.getBalance(), 900.0);
+
+    // Deposits are never limited
+    CHECK(ledger.postImported(KIND_DEPOSIT, 500.0, "salary", 0));
+}
+
+TEST(velocity, historicImportedRowsCountButPass) {
+    BankLedger ledger(1000.0, true);
+    ledger.setClock(LedgerClock::fake(START, MINUTE));
+    VelocityRule rule = { VELOCITY_AMOUNT, 100.0, HOUR };
+    ledger.setVelocityLimits(&rule, 1);
+
+    // Already happened: kept, and it fills the window it falls in
+    CHECK(ledger.postImported(KIND_WITHDRAWAL, 150.0, "history", START - MINUTE));
+    ledger.withdraw(10.0, "live");
+    CHECK(ledger.getTransactionCount() == 1);
+    CHECK_MONEY(ledger.getBalance(), 850.0);
+}
+
+TEST(velocity, ruleValidation) {
+    VelocityLimits limits;
+    VelocityRule rules[3] = { { VELOCITY_COUNT, 5, HOUR },
+                              { 7, 5, HOUR },                    // unknown metric
+                              { VELOCITY_AMOUNT, 10.0, 1 } };    // window too short
+    CHECK(limits.setRules(rules, 3) == 1);
+    CHECK(limits.active());
+
+    for (int i = 0; i < 5; i++) {
+        CHECK(limits.check(START + i, 1.0) == -1);
+        limits.record(START + i, 1.0);
+    }
+    CHECK(limits.check(START + 10, 1.0) == 0);
+    limits.revert(START, 1.0);
+    CHECK(limits.check(START + 10, 1.0) == -1);
+}
+
+TEST(velocity, recountIncludesArchivedWithdrawals) {
+    // 10000 withdrawals a second apart; with hot limit 1000, IDs 1..8192 are archived
+    const Timestamp SECOND = MINUTE / 60;
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "bank_ledger_velocity_tests";
+    std::filesystem::remove_all(dir);
+    {
+        BankLedger ledger(1000000.0, true);
+        ledger.setClock(LedgerClock::fake(START, SECOND));
+        for (int i = 0; i < 10000; i++) ledger.withdraw(1.0, "Card");
+        CHECK(ledger.enableArchive(dir.string(), 1000));
+        CHECK(ledger.getArchivedCount() == 8192);
+
+        // The whole run is inside a day: 10000 already count
+        VelocityRule perDay = { VELOCITY_AMOUNT, 9000.0, 24 * HOUR };
+        CHECK(ledger.setVelocityLimits(&perDay, 1) == 1);
+        ledger.withdraw(1.0, "Card");
+        CHECK(ledger.getTransactionCount() == 10000);
+        CHECK(ledger.getLastVelocityBreach() == 0);
+
+        // A window reaching back into the archive counts only the rows in
+        // it: about 5000, give or take a bucket
+        VelocityRule recent[2] = { { VELOCITY_COUNT, 4500, 5000 * SECOND },
+                                   { VELOCITY_COUNT, 6000, 5000 * SECOND } };
+        CHECK(ledger.setVelocityLimits(&recent[0], 1) == 1);
+        ledger.withdraw(1.0, "Card");
+        CHECK(ledger.getTransactionCount() == 10000);
+
+        CHECK(ledger.setVelocityLimits(&recent[1], 1) == 1);
+        ledger.withdraw(1.0, "Card");
+        CHECK(ledger.getTransactionCount() == 10001);
+    }
+    std::filesystem::remove_all(dir);
+}
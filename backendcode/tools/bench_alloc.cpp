@@ -0,0 +1,24 @@
+// Global operator new/delete for bank_ledger_bench, counting heap allocations.
+//
+// Kept out of bench_main.cpp so the replacements are never inlined at a call
+// site: inlined, GCC pairs `new T` with the free() inside operator delete and
+// reports a mismatched deallocation (-Wmismatched-new-delete).
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<unsigned long long> allocationCount(0);
+
+unsigned long long benchAllocationCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t n) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
@@ -0,0 +1,457 @@
+#include "../include/bank_ledger.h"
+#include "../include/importer.h"
+#include "../include/reconcile.h"
+#include "../include/exporter.h"
+#include "../include/segment_codec.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define NULL_DEVICE "NUL"
+#define OPEN_NULL() _open(NULL_DEVICE, _O_WRONLY)
+#define CLOSE_FD(fd) _close(fd)
+#else
+#include <unistd.h>
+#define NULL_DEVICE "/dev/null"
+#define OPEN_NULL() ::open(NULL_DEVICE, O_WRONLY)
+#define CLOSE_FD(fd) ::close(fd)
+#endif
+
+using namespace std;
+using namespace std::chrono;
+
+// -------------------- Allocation counting --------------------
+// Replacing global new lets every benchmark report heap allocations per
+// operation (bench_alloc.cpp).
+unsigned long long benchAllocationCount();
+
+// -------------------- Harness --------------------
+struct BenchResult {
+    string op;
+    long long n;
+    int samples;
+    long long opsPerSample;
+    double medianNs;
+    double p99Ns;
+    double meanNs;
+    double stddevNs;
+    double minNs;
+    double allocsPerOp;
+};
+
+struct BenchCase {
+    string op;
+    long long opsPerSample;
+    function<void()> setup;    // untimed, before every sample
+    function<void()> body;     // timed
+};
+
+struct BenchOptions {
+    long long minN = 1000;
+    long long maxN = 1000000;
+    int samples = 0;           // 0 = scale with N
+    int warmup = 2;
+    string filter;
+    string jsonPath;
+};
+
+static volatile double sink;   // keeps results observable to the optimizer
+
+#ifndef BENCH_COMPILER
+#define BENCH_COMPILER "unknown"
+#endif
+#ifndef BENCH_BUILD_TYPE
+#define BENCH_BUILD_TYPE ""
+#endif
+
+static const char* buildType() {
+    return BENCH_BUILD_TYPE[0] ? BENCH_BUILD_TYPE : "unspecified";
+}
+
+static double percentile(const vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    double rank = p * (sorted.size() - 1);
+    size_t lo = (size_t)rank;
+    size_t hi = min(lo + 1, sorted.size() - 1);
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * (rank - lo);
+}
+
+static int defaultSamples(long long n) {
+    if (n <= 10000) return 30;
+    if (n <= 100000) return 15;
+    if (n <= 1000000) return 7;
+    return 3;
+}
+
+static BenchResult runCase(const BenchCase& c, long long n, const BenchOptions& opt) {
+    int samples = opt.samples > 0 ? opt.samples : defaultSamples(n);
+    vector<double> perOp;
+    perOp.reserve(samples);
+    unsigned long long allocs = 0;
+
+    for (int i = 0; i < opt.warmup + samples; i++) {
+        if (c.setup) c.setup();
+
+        unsigned long long before = benchAllocationCount();
+        auto start = steady_clock::now();
+        c.body();
+        auto end = steady_clock::now();
+        unsigned long long after = benchAllocationCount();
+
+        if (i < opt.warmup) continue;
+        perOp.push_back(duration<double, nano>(end - start).count() / c.opsPerSample);
+        allocs += after - before;
+    }
+
+    vector<double> sorted = perOp;
+    sort(sorted.begin(), sorted.end());
+
+    double mean = 0.0;
+    for (double v : perOp) mean += v;
+    mean /= perOp.size();
+
+    double var = 0.0;
+    for (double v : perOp) var += (v - mean) * (v - mean);
+    var = perOp.size() > 1 ? var / (perOp.size() - 1) : 0.0;
+
+    BenchResult r;
+    r.op = c.op;
+    r.n = n;
+    r.samples = samples;
+    r.opsPerSample = c.opsPerSample;
+    r.medianNs = percentile(sorted, 0.5);
+    r.p99Ns = percentile(sorted, 0.99);
+    r.meanNs = mean;
+    r.stddevNs = sqrt(var);
+    r.minNs = sorted.front();
+    r.allocsPerOp = (double)allocs / ((double)samples * c.opsPerSample);
+    return r;
+}
+
+// -------------------- Fixtures --------------------
+static BankLedger* buildLedger(long long n) {
+    BankLedger* ledger = new BankLedger(0.0, true);
+    mt19937_64 rng(42);
+    uniform_real_distribution<double> amount(1.0, 1000.0);
+
+    for (long long i = 0; i < n; i++) {
+        // Roughly 2:1 deposits to withdrawals, never overdrawn
+        bool withdraw = (i % 3 == 2);
+        ledger->postImported(withdraw ? KIND_WITHDRAWAL : KIND_DEPOSIT,
+                             withdraw ? amount(rng) * 0.5 : amount(rng), "Auto",
+                             secondsToTimestamp(1600000000 + i));
+    }
+    return ledger;
+}
+
+static string buildCsv(long long n) {
+    string csv;
+    csv.reserve((size_t)n * 32);
+    csv += "type,amount,description,timestamp\n";
+    for (long long i = 0; i < n; i++) {
+        csv += (i % 3 == 2) ? "WITHDRAWAL," : "DEPOSIT,";
+        csv += to_string(10 + i % 500);
+        csv += ".25,Imported row,";
+        csv += to_string(1600000000 + i);
+        csv += '\n';
+    }
+    return csv;
+}
+
+// The ledger's postings as a bank statement, every row dated a day late
+static string buildStatement(BankLedger& ledger) {
+    string csv = "type,amount,description,timestamp\n";
+    csv.reserve((size_t)ledger.getTransactionCount() * 40);
+    vector<TransactionRecord> chunk(4096);
+    HistoryCursor cursor = makeHistoryCursor(HistoryFilter(), (int)chunk.size());
+    char line[128];
+    int got;
+    while ((got = ledger.readHistory(cursor, chunk.data())) > 0) {
+        for (int i = 0; i < got; i++) {
+            const TransactionRecord& r = chunk[i];
+            int len = snprintf(line, sizeof(line), "%s,%.2f,%s,%lld\n",
+                               r.kind == KIND_DEPOSIT ? "DEPOSIT" : "WITHDRAWAL", r.amount, r.description,
+                               (long long)(r.timestamp / MICROS_PER_SECOND + 86400));
+            csv.append(line, (size_t)len);
+        }
+    }
+    return csv;
+}
+
+// -------------------- Benchmarks --------------------
+static vector<BenchResult> runSize(long long n, const BenchOptions& opt) {
+    vector<BenchResult> results;
+    BankLedger* ledger = buildLedger(n);
+    mt19937 rng(7);
+    int maxID = ledger->getTransactionCount();
+    int nullFd = OPEN_NULL();
+    string csv;
+    string statement;
+    ReconcileResult reconciled;
+    BankLedger* importTarget = nullptr;
+    HashChain chain;
+    vector<int> lookupIDs(1000);
+    vector<TransactionRecord> records(1000);
+    vector<TimelinePoint> chart(500);
+    LedgerClock coarseClock = LedgerClock::coarse();
+    LedgerClock systemClock = LedgerClock::system();
+    // $5,000 per 24h and 1M withdrawals per hour: undo keeps the withdraw cases under both
+    VelocityRule limits[2] = { { VELOCITY_AMOUNT, 5000.0, 24LL * 3600 * MICROS_PER_SECOND },
+                               { VELOCITY_COUNT, 1000000, 3600LL * MICROS_PER_SECOND } };
+    VelocityLimits velocity;
+    velocity.setRules(limits, 2);
+    Timestamp velocityNow = secondsToTimestamp(1600000000);
+    // Compiled once; the cases time execution only
+    CompiledQuery numericQuery, textQuery;
+    QueryReport queryReport;
+    string queryError;
+    compileQuery("type = WITHDRAWAL AND amount > 100 AND ts BETWEEN 1600000000 AND " +
+                 to_string(1600000000 + n / 2), numericQuery, queryError);
+    compileQuery("amount > 400 AND desc ~ \"rent\"", textQuery, queryError);
+    Transaction sample(0, "DEPOSIT", 10.0, "Auto", 10.0, secondsToTimestamp(1600000000));
+    vector<Transaction*> segmentRows;
+    string segment;
+    SegmentColumns decoded;
+    function<void()> buildSegment = [&]() {
+        if (!segment.empty()) return;
+        Transaction** arr = ledger->getTransactionList()->toArray();
+        segmentRows.assign(arr, arr + ledger->getTransactionCount());
+        delete[] arr;
+        sort(segmentRows.begin(), segmentRows.end(),
+             [](Transaction* a, Transaction* b) { return a->id < b->id; });
+        segment = encodeSegment(segmentRows.data(), segmentRows.size(), 0);
+    };
+    function<void()> undoAll = [&]() {
+        while (ledger->canUndo()) ledger->undo();
+    };
+
+    vector<BenchCase> cases = {
+        // Posting cases undo their own rows (untimed) so the ledger stays at N
+        { "deposit", UNDO_LIMIT, undoAll, [&]() {
+            for (int i = 0; i < UNDO_LIMIT; i++) ledger->deposit(25.0, "Bench deposit");
+        } },
+        { "withdraw", UNDO_LIMIT, undoAll, [&]() {
+            for (int i = 0; i < UNDO_LIMIT; i++) ledger->withdraw(1.0, "Bench withdrawal");
+        } },
+        { "withdraw_limited", UNDO_LIMIT, [&]() {
+            undoAll();
+            ledger->setVelocityLimits(limits, 2);
+        }, [&]() {
+            for (int i = 0; i < UNDO_LIMIT; i++) ledger->withdraw(1.0, "Bench withdrawal");
+        } },
+        { "undo", UNDO_LIMIT, [&]() {
+            ledger->setVelocityLimits(nullptr, 0);   // from withdraw_limited
+            undoAll();
+            for (int i = 0; i < UNDO_LIMIT; i++) ledger->deposit(5.0, "Undo me");
+        }, [&]() {
+            for (int i = 0; i < UNDO_LIMIT; i++) ledger->undo();
+        } },
+        { "sort_by_date", 1, [&]() { ledger->sortByAmount(); }, [&]() { ledger->sortByDate(); } },
+        { "sort_by_amount", 1, [&]() { ledger->sortByDate(); }, [&]() { ledger->sortByAmount(); } },
+        { "search_by_id", 1, nullptr, [&]() {
+            Transaction* t = ledger->searchByID((int)(rng() % maxID) + 1);
+            sink = t ? t->amount : 0.0;
+        } },
+        { "multi_get_1000", 1000, nullptr, [&]() {
+            for (int i = 0; i < 1000; i++) lookupIDs[i] = (int)(rng() % maxID) + 1;
+            sink = ledger->getByIDs(lookupIDs.data(), 1000, records.data());
+        } },
+        { "history_cursor", 1, nullptr, [&]() {
+            HistoryCursor cursor = makeHistoryCursor(HistoryFilter(), (int)records.size());
+            while (ledger->readHistory(cursor, records.data()) > 0) sink = records[0].amount;
+        } },
+        { "query_numeric", 1, nullptr, [&]() {
+            sink = ledger->runQuery(numericQuery, records.data(), (int)records.size(), queryReport);
+        } },
+        { "query_desc", 1, nullptr, [&]() {
+            sink = ledger->runQuery(textQuery, records.data(), (int)records.size(), queryReport);
+        } },
+        { "balance_timeline_500", 1, nullptr, [&]() {
+            // The whole ledger, as buildLedger stamps it (one posting per second)
+            sink = ledger->getBalanceTimeline(secondsToTimestamp(1600000000),
+                                              secondsToTimestamp(1600000000 + n), (int)chart.size(),
+                                              chart.data());
+        } },
+        { "aggregate_simd", 1, nullptr, [&]() {
+            AggregateResult r;
+            ledger->aggregate(AGG_ALL, 0, INT64_MAX, r);
+            sink = r.totalDeposits;
+        } },
+        { "aggregate_list_scalar", 1, nullptr, [&]() {
+            sink = aggregateListScalar(*ledger->getTransactionList(), AGG_ALL, 0, INT64_MAX).totalDeposits;
+        } },
+        { "get_stats", 10000, nullptr, [&]() {
+            for (int i = 0; i < 10000; i++) sink = ledger->getStats().depositTotal;
+        } },
+        { "clock_coarse", 10000, nullptr, [&]() {
+            for (int i = 0; i < 10000; i++) sink = (double)coarseClock.now();
+        } },
+        { "clock_system", 10000, nullptr, [&]() {
+            for (int i = 0; i < 10000; i++) sink = (double)systemClock.now();
+        } },
+        { "velocity_check", 10000, nullptr, [&]() {
+            // Check and count one withdrawal a second against both rules
+            for (int i = 0; i < 10000; i++) {
+                velocityNow += MICROS_PER_SECOND;
+                if (velocity.check(velocityNow, 0.01) < 0) velocity.record(velocityNow, 0.01);
+            }
+        } },
+        { "hash_chain_append", 1000, nullptr, [&]() {
+            for (int i = 0; i < 1000; i++) {
+                sample.id = i;
+                chain.append(sample);
+            }
+        } },
+        { "verify_range_100", 1, nullptr, [&]() {
+            int from = (int)(rng() % maxID) + 1;
+            sink = ledger->verifyHistory(from, from + 99);
+        } },
+        { "export_csv", 1, nullptr, [&]() {
+            sink = (double)exportTransactions(*ledger->getTransactionList(), nullFd, EXPORT_CSV);
+        } },
+        { "export_jsonl", 1, nullptr, [&]() {
+            sink = (double)exportTransactions(*ledger->getTransactionList(), nullFd, EXPORT_JSONL);
+        } },
+        { "segment_encode", 1, buildSegment, [&]() {
+            sink = (double)encodeSegment(segmentRows.data(), segmentRows.size(), 0).size();
+        } },
+        { "segment_decode", 1, buildSegment, [&]() {
+            sink = decodeSegmentColumns(segment.data(), segment.size(), decoded) ? 1.0 : 0.0;
+        } },
+        { "segment_scan", 1, buildSegment, [&]() {
+            decodeSegmentColumns(segment.data(), segment.size(), decoded, SEG_SCAN_COLUMNS);
+            sink = aggregateSegment(decoded, AGG_ALL, 0, INT64_MAX).totalDeposits;
+        } },
+        { "reconcile", 1, [&]() {
+            if (statement.empty()) statement = buildStatement(*ledger);
+        }, [&]() {
+            reconcileBuffer(*ledger, statement.data(), statement.size(), IMPORT_CSV,
+                            RECONCILE_DEFAULT_WINDOW, 0, reconciled);
+            sink = (double)reconciled.report.matched;
+        } },
+        { "import_csv", 1, [&]() {
+            if (csv.empty()) csv = buildCsv(n);
+            delete importTarget;
+            importTarget = new BankLedger(1e12, true);
+        }, [&]() {
+            sink = (double)importBuffer(*importTarget, csv.data(), csv.size(), IMPORT_CSV).rowsApplied;
+        } },
+    };
+
+    for (BenchCase& c : cases) {
+        if (!opt.filter.empty() && c.op.find(opt.filter) == string::npos) continue;
+
+        // Per-row cases report cost per row, not per call
+        if (c.op.rfind("export", 0) == 0 || c.op.rfind("segment", 0) == 0 || c.op == "import_csv" || c.op == "reconcile" ||
+            c.op == "history_cursor") {
+            c.opsPerSample = n;
+        }
+
+        BenchResult r = runCase(c, n, opt);
+        results.push_back(r);
+
+        cout << left << setw(24) << r.op << right
+             << setw(12) << r.n
+             << setw(14) << fixed << setprecision(1) << r.medianNs
+             << setw(14) << r.p99Ns
+             << setw(14) << r.stddevNs
+             << setw(12) << setprecision(2) << r.allocsPerOp << endl;
+    }
+
+    if (!segment.empty()) {
+        cout << "  (segment: " << segment.size() << " bytes, "
+             << fixed << setprecision(2) << (double)segment.size() / n << " bytes/row)" << endl;
+    }
+
+    delete importTarget;
+    delete ledger;
+    if (nullFd >= 0) CLOSE_FD(nullFd);
+    return results;
+}
+
+// -------------------- Output --------------------
+static void writeJson(const string& path, const vector<BenchResult>& results) {
+    ofstream out(path);
+    if (!out) {
+        cout << "Error: Cannot write " << path << endl;
+        return;
+    }
+
+    // One object per line, stable key order, so two runs diff line by line
+    out << "{\"meta\":{\"compiler\":\"" << BENCH_COMPILER << "\",\"build\":\"" << buildType()
+        << "\",\"aggregation_kernel\":\"" << aggregationKernelName(detectAggregationKernel()) << "\"}}\n";
+    out << fixed << setprecision(2);
+    for (const BenchResult& r : results) {
+        out << "{\"op\":\"" << r.op << "\",\"n\":" << r.n
+            << ",\"samples\":" << r.samples
+            << ",\"ops_per_sample\":" << r.opsPerSample
+            << ",\"median_ns\":" << r.medianNs
+            << ",\"p99_ns\":" << r.p99Ns
+            << ",\"mean_ns\":" << r.meanNs
+            << ",\"stddev_ns\":" << r.stddevNs
+            << ",\"min_ns\":" << r.minNs
+            << ",\"allocs_per_op\":" << r.allocsPerOp << "}\n";
+    }
+    cout << "\nResults written to " << path << endl;
+}
+
+static void printUsage() {
+    cout << "Usage: bank_ledger_bench [options]\n";
+    cout << "  --min-n N        Smallest ledger size (default 1000)\n";
+    cout << "  --max-n N        Largest ledger size, up to 1e8 (default 1e6)\n";
+    cout << "  --samples K      Timed samples per case (default: scales with N)\n";
+    cout << "  --warmup K       Untimed warmup samples (default 2)\n";
+    cout << "  --filter TEXT    Only run operations containing TEXT\n";
+    cout << "  --json FILE      Write machine-readable results (JSON lines)\n";
+}
+
+// -------------------- MAIN --------------------
+int main(int argc, char** argv) {
+    BenchOptions opt;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--min-n" && hasValue) opt.minN = (long long)atof(argv[++i]);
+        else if (arg == "--max-n" && hasValue) opt.maxN = (long long)atof(argv[++i]);
+        else if (arg == "--samples" && hasValue) opt.samples = atoi(argv[++i]);
+        else if (arg == "--warmup" && hasValue) opt.warmup = atoi(argv[++i]);
+        else if (arg == "--filter" && hasValue) opt.filter = argv[++i];
+        else if (arg == "--json" && hasValue) opt.jsonPath = argv[++i];
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    cout << "===== BANK LEDGER BENCHMARKS =====\n";
+    cout << "Build: " << buildType() << " | Aggregation kernel: "
+         << aggregationKernelName(detectAggregationKernel()) << "\n\n";
+    cout << left << setw(24) << "Operation" << right
+         << setw(12) << "N"
+         << setw(14) << "Median ns/op"
+         << setw(14) << "p99 ns/op"
+         << setw(14) << "Stddev"
+         << setw(12) << "Allocs/op" << endl;
+
+    vector<BenchResult> all;
+    for (long long n = opt.minN; n <= opt.maxN; n *= 10) {
+        vector<BenchResult> r = runSize(n, opt);
+        all.insert(all.end(), r.begin(), r.end());
+    }
+
+    if (!opt.jsonPath.empty()) writeJson(opt.jsonPath, all);
+    return 0;
+}
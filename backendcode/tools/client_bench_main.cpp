@@ -0,0 +1,183 @@
+#include "../include/ledger_protocol.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace std::chrono;
+
+struct ClientResult {
+    long long requests = 0;
+    long long rejected = 0;
+    bool failed = false;
+    vector<double> roundTripUs;    // one per pipelined window
+};
+
+// -------------------- Usage --------------------
+static void printUsage() {
+    cout << "Usage: bank_ledger_clientbench [options]\n";
+    cout << "  --socket PATH         Daemon socket (default: " << PROTOCOL_DEFAULT_SOCKET << ")\n";
+    cout << "  --clients N           Concurrent connections (default: 8)\n";
+    cout << "  --ops N               Postings in total (default: 1000000)\n";
+    cout << "  --pipeline N          Requests in flight per connection (default: 64)\n";
+}
+
+static int connectTo(const string& path) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) return -1;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool sendAll(int fd, const string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += (size_t)n;
+    }
+    return true;
+}
+
+// Read `count` response frames; counts the rejected ones
+static bool readResponses(int fd, string& buffer, long long count, long long& rejected) {
+    size_t pos = 0;
+    char chunk[65536];
+    FrameHeader h;
+
+    while (count > 0) {
+        while (count > 0 && readFrameHeader(buffer.data() + pos, buffer.size() - pos, h) &&
+               buffer.size() - pos >= PROTOCOL_HEADER_SIZE + h.length) {
+            if (h.status == RESP_BAD_REQUEST) return false;
+            if (h.status == RESP_REJECTED) rejected++;
+            pos += PROTOCOL_HEADER_SIZE + h.length;
+            count--;
+        }
+        if (count == 0) break;
+
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, (size_t)n);
+    }
+
+    buffer.erase(0, pos);
+    return true;
+}
+
+static void runClient(const string& path, long long ops, int pipeline, ClientResult& result) {
+    int fd = connectTo(path);
+    if (fd < 0) {
+        result.failed = true;
+        return;
+    }
+
+    string request, response;
+    uint32_t tag = 0;
+    long long done = 0;
+
+    while (done < ops) {
+        long long window = min((long long)pipeline, ops - done);
+
+        // Three deposits to one withdrawal keeps the balance growing
+        request.clear();
+        for (long long i = 0; i < window; i++, tag++) {
+            bool withdraw = (tag % 4 == 3);
+            appendPostingRequest(request, withdraw ? REQ_WITHDRAW : REQ_DEPOSIT, tag,
+                                 withdraw ? 1.0 : 2.5, withdraw ? "Client withdrawal" : "Client deposit");
+        }
+
+        auto start = steady_clock::now();
+        if (!sendAll(fd, request) || !readResponses(fd, response, window, result.rejected)) {
+            result.failed = true;
+            break;
+        }
+        result.roundTripUs.push_back(duration<double, micro>(steady_clock::now() - start).count());
+
+        done += window;
+    }
+
+    result.requests = done;
+    close(fd);
+}
+
+static double percentile(vector<double>& v, double p) {
+    if (v.empty()) return 0.0;
+    size_t k = (size_t)(p * (v.size() - 1));
+    nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+// -------------------- MAIN --------------------
+int main(int argc, char** argv) {
+    string socketPath = PROTOCOL_DEFAULT_SOCKET;
+    int clients = 8;
+    long long ops = 1000000;
+    int pipeline = 64;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--socket" && hasValue) socketPath = argv[++i];
+        else if (arg == "--clients" && hasValue) clients = max(1, atoi(argv[++i]));
+        else if (arg == "--ops" && hasValue) ops = (long long)atof(argv[++i]);
+        else if (arg == "--pipeline" && hasValue) pipeline = max(1, atoi(argv[++i]));
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    vector<ClientResult> results(clients);
+    vector<thread> threads;
+
+    auto start = steady_clock::now();
+    for (int c = 0; c < clients; c++) {
+        long long share = ops / clients + (c < ops % clients ? 1 : 0);
+        threads.emplace_back(runClient, socketPath, share, pipeline, ref(results[c]));
+    }
+    for (thread& t : threads) t.join();
+    double seconds = duration<double>(steady_clock::now() - start).count();
+
+    long long requests = 0, rejected = 0;
+    int failed = 0;
+    vector<double> rtt;
+    for (ClientResult& r : results) {
+        requests += r.requests;
+        rejected += r.rejected;
+        if (r.failed) failed++;
+        rtt.insert(rtt.end(), r.roundTripUs.begin(), r.roundTripUs.end());
+    }
+
+    cout << "\n=== Client Benchmark ===" << endl;
+    cout << "Clients:        " << clients << " x pipeline " << pipeline << endl;
+    cout << "Requests:       " << requests << " (" << rejected << " rejected)" << endl;
+    if (failed > 0) cout << "Failed clients: " << failed << endl;
+    cout << fixed << setprecision(3);
+    cout << "Elapsed:        " << seconds << " s" << endl;
+    cout << setprecision(0);
+    cout << "Throughput:     " << requests / seconds << " postings/s" << endl;
+    cout << setprecision(1);
+    cout << "Window RTT:     p50 " << percentile(rtt, 0.50) << " us, p99 "
+         << percentile(rtt, 0.99) << " us" << endl;
+
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,126 @@
+#include "../include/bank_ledger.h"
+#include "../include/importer.h"
+#include "../include/reconcile.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+
+using namespace std;
+
+// -------------------- Usage --------------------
+static void printUsage() {
+    cout << "Usage: bank_ledger_import <file> [options]\n";
+    cout << "  --format csv|ndjson|auto   Input format (default: auto)\n";
+    cout << "  --threads N                Parser threads (default: all cores)\n";
+    cout << "  --balance X                Initial balance (default: 0)\n";
+    cout << "  --trace FILE               Write a Chrome trace of the import to FILE\n";
+    cout << "  --reconcile FILE           Then reconcile the ledger against a bank statement\n";
+    cout << "  --window DAYS              Date tolerance for statement matches (default: 3)\n";
+    cout << "  --report FILE              Write the missing and extra rows to FILE as CSV\n";
+    cout << "\nCSV rows:    type,amount,description[,timestamp]\n";
+    cout << "NDJSON rows: {\"type\":\"DEPOSIT\",\"amount\":10.5,\"description\":\"..\",\"timestamp\":0}\n";
+}
+
+// -------------------- MAIN --------------------
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    string path = argv[1];
+    ImportFormat format = IMPORT_AUTO;
+    int threads = 0;
+    double initialBalance = 0.0;
+    string tracePath;
+    string statementPath;
+    string reportPath;
+    Timestamp window = RECONCILE_DEFAULT_WINDOW;
+
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc) {
+            string f = argv[++i];
+            if (f == "csv") format = IMPORT_CSV;
+            else if (f == "ndjson") format = IMPORT_NDJSON;
+            else format = IMPORT_AUTO;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (arg == "--balance" && i + 1 < argc) {
+            initialBalance = atof(argv[++i]);
+        } else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (arg == "--reconcile" && i + 1 < argc) {
+            statementPath = argv[++i];
+        } else if (arg == "--window" && i + 1 < argc) {
+            window = (Timestamp)(atof(argv[++i]) * MICROS_PER_DAY);
+        } else if (arg == "--report" && i + 1 < argc) {
+            reportPath = argv[++i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    BankLedger ledger(initialBalance);
+    ImportReport report;
+
+    if (!tracePath.empty()) setTracingEnabled(true);
+    bool opened = importFile(ledger, path, format, threads, report);
+
+    // The statement is reconciled against what was just imported
+    ReconcileResult reconciled;
+    bool reconciledOpened = opened && !statementPath.empty() &&
+        reconcileFile(ledger, statementPath, IMPORT_AUTO, window, threads, reconciled);
+    setTracingEnabled(false);
+
+    if (!opened) {
+        cout << "Error: Cannot open " << path << endl;
+        return 1;
+    }
+
+    cout << "\n=== Import Report ===" << endl;
+    cout << "Rows read:      " << report.rowsRead << endl;
+    cout << "Rows applied:   " << report.rowsApplied << endl;
+    cout << "Rows rejected:  " << report.rowsRejected << endl;
+    cout << fixed << setprecision(3);
+    cout << "Elapsed:        " << report.seconds << " s" << endl;
+    cout << setprecision(0);
+    cout << "Throughput:     " << report.rowsPerSecond << " rows/s" << endl;
+    cout << setprecision(2);
+    cout << "Final balance:  $" << ledger.getBalance() << endl;
+
+    if (!tracePath.empty() && !writeChromeTrace(tracePath)) {
+        cout << "Error: Cannot write trace " << tracePath << endl;
+    }
+
+    if (statementPath.empty()) return report.rowsRejected == 0 ? 0 : 2;
+    if (!reconciledOpened) {
+        cout << "Error: Cannot open " << statementPath << endl;
+        return 1;
+    }
+
+    const ReconcileReport& r = reconciled.report;
+    cout << "\n=== Reconciliation Report ===" << endl;
+    cout << "Statement rows: " << r.statementRows << endl;
+    cout << "Ledger rows:    " << r.ledgerRows << endl;
+    cout << "Matched:        " << r.matched << endl;
+    cout << "Missing:        " << r.missing << " (on the statement, not in the ledger)" << endl;
+    cout << "Extra:          " << r.extra << " (in the ledger, not on the statement)" << endl;
+    cout << "Rejected:       " << r.rejected << endl;
+    cout << setprecision(3);
+    cout << "Elapsed:        " << r.seconds << " s" << endl;
+    cout << setprecision(0);
+    cout << "Throughput:     " << r.rowsPerSecond << " rows/s" << endl;
+
+    if (!reportPath.empty()) {
+        if (!writeReconcileCsv(reportPath, reconciled)) {
+            cout << "Error: Cannot write report " << reportPath << endl;
+            return 1;
+        }
+        cout << "Discrepancies written to " << reportPath << endl;
+    }
+
+    return (r.missing == 0 && r.extra == 0 && r.rejected == 0) ? 0 : 3;
+}
@@ -0,0 +1,80 @@
+#include "../include/bank_ledger.h"
+#include "../include/ledger_server.h"
+#include <csignal>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static LedgerServer* activeServer = nullptr;
+
+static void onSignal(int) {
+    if (activeServer) activeServer->stop();
+}
+
+// -------------------- Usage --------------------
+static void printUsage() {
+    cout << "Usage: bank_ledgerd [options]\n";
+    cout << "  --socket PATH         Unix socket to listen on (default: " << PROTOCOL_DEFAULT_SOCKET << ")\n";
+    cout << "  --balance X           Initial balance (default: 0)\n";
+    cout << "  --archive DIR         Archive cold history into segments under DIR\n";
+    cout << "  --hot N               Postings kept in memory with --archive (default: 10000)\n";
+}
+
+// -------------------- MAIN --------------------
+int main(int argc, char** argv) {
+    string socketPath = PROTOCOL_DEFAULT_SOCKET;
+    string archiveDir;
+    double initialBalance = 0.0;
+    int hotLimit = 10000;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--socket" && hasValue) socketPath = argv[++i];
+        else if (arg == "--balance" && hasValue) initialBalance = atof(argv[++i]);
+        else if (arg == "--archive" && hasValue) archiveDir = argv[++i];
+        else if (arg == "--hot" && hasValue) hotLimit = atoi(argv[++i]);
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    BankLedger ledger(initialBalance, true);
+    if (!archiveDir.empty() && !ledger.enableArchive(archiveDir, hotLimit)) {
+        cout << "Error: Cannot archive into " << archiveDir << endl;
+        return 1;
+    }
+
+    LedgerServer server(ledger);
+    if (!server.listen(socketPath)) {
+        cout << "Error: Cannot listen on " << socketPath << endl;
+        return 1;
+    }
+
+    activeServer = &server;
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    cout << "Listening on " << socketPath << " (Ctrl+C to stop)" << endl;
+    server.run();
+    activeServer = nullptr;
+
+    const ServerStats& s = server.getStats();
+    cout << "\n=== Server Report ===" << endl;
+    cout << "Connections:    " << s.connections << endl;
+    cout << "Requests:       " << s.requests << endl;
+    cout << "Apply rounds:   " << s.rounds << endl;
+    cout << fixed << setprecision(1);
+    cout << "Requests/round: " << (s.rounds ? (double)s.requests / s.rounds : 0.0) << endl;
+    cout << "Bytes in/out:   " << s.bytesIn << " / " << s.bytesOut << endl;
+    cout << setprecision(2);
+    cout << "Final balance:  $" << ledger.getBalance() << endl;
+
+    ledger.showMetrics();
+    return 0;
+}
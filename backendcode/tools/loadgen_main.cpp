@@ -0,0 +1,155 @@
+#include "../include/bank_ledger.h"
+#include "../include/workload.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+
+using namespace std;
+
+// -------------------- Usage --------------------
+static void printUsage() {
+    cout << "Usage: bank_ledger_loadgen [options]\n";
+    cout << "  --seed N              Random seed (default: 42)\n";
+    cout << "  --ops N               Operations to generate (default: 100000)\n";
+    cout << "  --mix D,W,U,Q         Deposit/withdraw/undo/query weights (default: 55,30,5,10)\n";
+    cout << "  --overdraft P         Fraction of withdrawals above the balance (default: 0.02)\n";
+    cout << "  --vocab N             Distinct descriptions (default: 500)\n";
+    cout << "  --zipf S              Zipf exponent for descriptions (default: 1.1)\n";
+    cout << "  --rate R              Mean arrivals per second (default: 2000)\n";
+    cout << "  --burst F             Rate multiplier during bursts (default: 20)\n";
+    cout << "  --balance X           Initial balance (default: 1000)\n";
+    cout << "  --record FILE         Write the generated trace to FILE\n";
+    cout << "  --replay FILE         Replay a recorded trace instead of generating one\n";
+    cout << "  --paced               Honour arrival times instead of running flat out\n";
+    cout << "  --no-run              Only generate/record, don't execute\n";
+    cout << "  --trace FILE          Write a Chrome trace of the replay to FILE\n";
+    cout << "  --archive DIR         Archive cold history into segments under DIR\n";
+    cout << "  --hot N               Postings kept in memory with --archive (default: 10000)\n";
+}
+
+static bool parseMix(const string& s, WorkloadConfig& config) {
+    double w[4];
+    const char* p = s.c_str();
+    for (int i = 0; i < 4; i++) {
+        char* end;
+        w[i] = strtod(p, &end);
+        if (end == p || w[i] < 0) return false;
+        p = (*end == ',') ? end + 1 : end;
+    }
+    config.depositWeight = w[0];
+    config.withdrawWeight = w[1];
+    config.undoWeight = w[2];
+    config.queryWeight = w[3];
+    return true;
+}
+
+// -------------------- MAIN --------------------
+int main(int argc, char** argv) {
+    WorkloadConfig config;
+    string recordPath, replayPath, tracePath, archiveDir;
+    int hotLimit = 10000;
+    bool paced = false;
+    bool run = true;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--seed" && hasValue) config.seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--ops" && hasValue) config.operations = (long long)atof(argv[++i]);
+        else if (arg == "--mix" && hasValue) {
+            if (!parseMix(argv[++i], config)) {
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--overdraft" && hasValue) config.overdraftRate = atof(argv[++i]);
+        else if (arg == "--vocab" && hasValue) config.vocabularySize = atoi(argv[++i]);
+        else if (arg == "--zipf" && hasValue) config.zipfExponent = atof(argv[++i]);
+        else if (arg == "--rate" && hasValue) config.ratePerSecond = atof(argv[++i]);
+        else if (arg == "--burst" && hasValue) config.burstFactor = atof(argv[++i]);
+        else if (arg == "--balance" && hasValue) config.initialBalance = atof(argv[++i]);
+        else if (arg == "--record" && hasValue) recordPath = argv[++i];
+        else if (arg == "--replay" && hasValue) replayPath = argv[++i];
+        else if (arg == "--paced") paced = true;
+        else if (arg == "--no-run") run = false;
+        else if (arg == "--trace" && hasValue) tracePath = argv[++i];
+        else if (arg == "--archive" && hasValue) archiveDir = argv[++i];
+        else if (arg == "--hot" && hasValue) hotLimit = atoi(argv[++i]);
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    vector<TraceOp> ops;
+    TraceHeader header;
+
+    if (!replayPath.empty()) {
+        if (!readTrace(replayPath, header, ops)) {
+            cout << "Error: Cannot read trace " << replayPath << endl;
+            return 1;
+        }
+        cout << "Loaded " << ops.size() << " operations (seed " << header.seed << ")" << endl;
+    } else {
+        header.seed = config.seed;
+        header.initialBalance = config.initialBalance;
+        generateWorkload(config, ops);
+        cout << "Generated " << ops.size() << " operations (seed " << header.seed << ")" << endl;
+    }
+
+    if (!recordPath.empty()) {
+        if (!writeTrace(recordPath, header, ops)) {
+            cout << "Error: Cannot write trace " << recordPath << endl;
+            return 1;
+        }
+        cout << "Trace written to " << recordPath << endl;
+    }
+
+    if (!run) return 0;
+
+    BankLedger ledger(header.initialBalance, true);
+    // Flat-out replays get fixed timestamps, so the same trace always ends in
+    // the same audit root; paced replays keep wall-clock time
+    if (!paced) ledger.setClock(LedgerClock::fake(secondsToTimestamp(1600000000), 1000));
+    if (!archiveDir.empty() && !ledger.enableArchive(archiveDir, hotLimit)) {
+        cout << "Error: Cannot archive into " << archiveDir << endl;
+        return 1;
+    }
+
+    if (!tracePath.empty()) setTracingEnabled(true);
+    ReplayReport report = replayTrace(ledger, ops, paced);
+    setTracingEnabled(false);
+
+    cout << "\n=== Replay Report ===" << endl;
+    cout << "Operations:     " << report.operations << endl;
+    cout << "Postings:       " << report.postings << endl;
+    cout << "Undos:          " << report.undos << endl;
+    cout << "Queries:        " << report.queries << endl;
+    cout << "Rejected:       " << report.rejected << endl;
+    cout << fixed << setprecision(3);
+    cout << "Elapsed:        " << report.seconds << " s" << endl;
+    cout << setprecision(0);
+    cout << "Throughput:     " << report.opsPerSecond << " ops/s" << endl;
+    cout << setprecision(2);
+    cout << "Final balance:  $" << report.finalBalance << endl;
+    cout << "Audit root:     " << ledger.getAuditRoot() << endl;
+    if (!archiveDir.empty()) {
+        cout << "Archived:       " << ledger.getArchivedCount() << " of "
+             << ledger.getTransactionCount() << " postings" << endl;
+        cout << "Verified:       "
+             << (ledger.verifyHistory(1, report.postings + report.undos) ? "yes" : "NO") << endl;
+    }
+
+    ledger.showMetrics();
+
+    if (!tracePath.empty()) {
+        if (!writeChromeTrace(tracePath)) {
+            cout << "Error: Cannot write trace " << tracePath << endl;
+            return 1;
+        }
+        cout << "Chrome trace written to " << tracePath << endl;
+    }
+    return 0;
+}
@@ -1,3 +1,4 @@
+import 'dart:async';
 import 'dart:convert';
 import 'dart:io';
 import 'dart:ffi'; // REQUIRED for Pointer types
@@ -10,19 +11,38 @@ import '../models/transaction_model.dart';
 class BankProvider extends ChangeNotifier {
   BankLedgerFFI? _ffi;
   Pointer<Void>? _ledger;
+  Pointer<Void>? _scheduler;     // recurring postings (rent, salary, ...)
+  Timer? _scheduleTimer;
 
   double _currentBalance = 0.0;
+  double _availableBalance = 0.0; // balance minus authorization holds
   String _lastMessage = "Welcome";
-  int _transactionIdCounter = 0; // Local counter for IDs
-
-  // Local list mirrors C++ data for UI display
+  // Local list mirrors C++ data for UI display; kept in step with the
+  // native change feed. UI IDs are backend IDs + 1 (ID 1 is "Account Opened").
   List<TransactionItem> _transactions = [];
+  int _changeSeq = 0; // last change applied to _transactions
+  int _lastBackendID = 0; // newest posting in _transactions (IDs only grow)
+
+  // Summary counters maintained natively (one FFI call per refresh)
+  double _totalDeposits = 0.0;
+  double _totalWithdrawals = 0.0;
+  double _largestTransaction = 0.0;
+
+  // Balance chart for the dashboard, re-read natively on every refresh
+  static const int chartPoints = 120;
+  List<BalancePoint> _balanceTimeline = [];
+  DateTime _openedAt = DateTime.now();
 
   // --- Getters ---
   double get currentBalance => _currentBalance;
+  double get availableBalance => _availableBalance;
   String get lastMessage => _lastMessage;
   List<TransactionItem> get transactions => List.unmodifiable(_transactions);
   bool get isInitialized => _ledger != null;
+  double get totalDeposits => _totalDeposits;
+  double get totalWithdrawals => _totalWithdrawals;
+  double get largestTransaction => _largestTransaction;
+  List<BalancePoint> get balanceTimeline => List.unmodifiable(_balanceTimeline);
 
   // --- FIX: USE LOCAL LIST LENGTH ---
   // Previously: return _ffi!.getTransactionCount(_ledger!);
@@ -51,15 +71,20 @@ class BankProvider extends ChangeNotifier {
       print("✅ DEBUG: DLL Loaded Successfully!");
 
       _ledger = _ffi!.createLedger(startingBalance);
+      _scheduler = _ffi!.createScheduler();
+      _scheduleTimer = Timer.periodic(const Duration(minutes: 1), (_) => runSchedules());
 
       _currentBalance = startingBalance;
+      _availableBalance = startingBalance;
       _transactions.clear();
-      _transactionIdCounter = 0;
+      _changeSeq = _ffi!.getChangeSeq(_ledger!);
+      _lastBackendID = 0;
+      _openedAt = DateTime.now();
+      _balanceTimeline = [];
 
       // Add initial entry (ID: 1) - Local only
-      _transactionIdCounter++;
       _transactions.add(TransactionItem(
-          id: _transactionIdCounter,
+          id: 1,
           type: "deposit",
           amount: startingBalance,
           description: "Account Opened",
@@ -74,19 +99,16 @@ class BankProvider extends ChangeNotifier {
   }
 
   // --- CORE TRANSACTIONS ---
-  void performDeposit(double amount, String desc) {
+  // [requestKey] makes a repeated submit (double tap, retry) a no-op
+  void performDeposit(double amount, String desc, {String? requestKey}) {
     if (_ledger == null) return;
 
-    bool success = _ffi!.addDeposit(_ledger!, amount, desc);
+    final result = requestKey == null
+        ? (id: _ffi!.addDeposit(_ledger!, amount, desc) ? 1 : 0, duplicate: false)
+        : _ffi!.postWithKey(_ledger!, withdrawal: false, amount: amount, description: desc, key: requestKey);
+    bool success = result.id != 0;
     if (success) {
-      _transactionIdCounter++;
-      _transactions.insert(0, TransactionItem(
-          id: _transactionIdCounter,
-          type: 'deposit',
-          amount: amount,
-          description: desc,
-          timestamp: DateTime.now()));
-      _lastMessage = "Deposit Successful";
+      _lastMessage = result.duplicate ? "Deposit already made" : "Deposit Successful";
       _refreshData();
     } else {
       _lastMessage = "Deposit Failed";
@@ -94,19 +116,15 @@ class BankProvider extends ChangeNotifier {
     }
   }
 
-  void performWithdrawal(double amount, String desc) {
+  void performWithdrawal(double amount, String desc, {String? requestKey}) {
     if (_ledger == null) return;
 
-    bool success = _ffi!.addWithdrawal(_ledger!, amount, desc);
+    final result = requestKey == null
+        ? (id: _ffi!.addWithdrawal(_ledger!, amount, desc) ? 1 : 0, duplicate: false)
+        : _ffi!.postWithKey(_ledger!, withdrawal: true, amount: amount, description: desc, key: requestKey);
+    bool success = result.id != 0;
     if (success) {
-      _transactionIdCounter++;
-      _transactions.insert(0, TransactionItem(
-          id: _transactionIdCounter,
-          type: 'withdrawal',
-          amount: amount,
-          description: desc,
-          timestamp: DateTime.now()));
-      _lastMessage = "Withdrawal Successful";
+      _lastMessage = result.duplicate ? "Withdrawal already made" : "Withdrawal Successful";
       _refreshData();
     } else {
       _lastMessage = _ffi!.getLastMessage();
@@ -119,10 +137,6 @@ class BankProvider extends ChangeNotifier {
 
     bool success = _ffi!.undoLastTransaction(_ledger!);
     if (success) {
-      if (_transactions.isNotEmpty) {
-        _transactions.removeAt(0); // Remove newest from UI
-        _transactionIdCounter--;
-      }
       _lastMessage = "Transaction Undone";
       _refreshData();
     } else {
@@ -131,17 +145,99 @@ class BankProvider extends ChangeNotifier {
     }
   }
 
+  // --- AUTHORIZATION HOLDS ---
+  int placeHold(double amount, String desc, Duration validFor) {
+    if (_ledger == null) return 0;
+    final id = _ffi!.placeHold(_ledger!, amount, desc, DateTime.now().add(validFor));
+    _lastMessage = id != 0 ? "Hold #$id placed" : _ffi!.getLastMessage();
+    _refreshData();
+    return id;
+  }
+
+  void settleHold(int holdID, {double amount = 0}) {
+    if (_ledger == null) return;
+    final ok = _ffi!.settleHold(_ledger!, holdID, amount: amount);
+    _lastMessage = ok ? "Hold Settled" : _ffi!.getLastMessage();
+    _refreshData();
+  }
+
+  void releaseHold(int holdID) {
+    if (_ledger == null) return;
+    final ok = _ffi!.releaseHold(_ledger!, holdID);
+    _lastMessage = ok ? "Hold Released" : _ffi!.getLastMessage();
+    _refreshData();
+  }
+
+  // --- QUERIES ---
+  /// Ad-hoc filter over the full history; null rows mean a syntax error
+  QueryResult? runQuery(String query, {int limit = 500}) {
+    if (_ledger == null) return null;
+    final result = _ffi!.runQuery(_ledger!, query, limit: limit);
+    _lastMessage = _ffi!.getLastMessage();
+    notifyListeners();
+    return result;
+  }
+
+  // --- RECONCILIATION ---
+  /// Match a bank statement file against the ledger; null if it can't be read
+  ReconcileSummary? reconcileStatement(String statementPath, {Duration window = const Duration(days: 3),
+      String? reportPath}) {
+    if (_ledger == null) return null;
+    final result = _ffi!.reconcileStatement(_ledger!, statementPath, window: window, reportPath: reportPath);
+    _lastMessage = _ffi!.getLastMessage();
+    notifyListeners();
+    return result;
+  }
+
+  // --- VELOCITY LIMITS ---
+  List<VelocityLimit> get velocityLimits =>
+      _ledger == null ? const [] : _ffi!.getVelocityLimits(_ledger!);
+
+  void setVelocityLimits(List<VelocityLimit> limits) {
+    if (_ledger == null) return;
+    _ffi!.setVelocityLimits(_ledger!, limits);
+    _lastMessage = _ffi!.getLastMessage();
+    notifyListeners();
+  }
+
+  // --- SCHEDULED POSTINGS ---
+  int addRecurring(bool withdrawal, double amount, String desc, DateTime firstDue,
+      {Duration? interval, int months = 0, int count = 0}) {
+    if (_scheduler == null) return 0;
+    final id = _ffi!.addSchedule(_scheduler!, _ledger!,
+        withdrawal: withdrawal, amount: amount, description: desc, firstDue: firstDue,
+        interval: interval, months: months, count: count);
+    runSchedules(); // a first due date in the past posts right away
+    return id;
+  }
+
+  void cancelRecurring(int scheduleID) {
+    if (_scheduler == null) return;
+    _ffi!.cancelSchedule(_scheduler!, scheduleID);
+  }
+
+  // Post what came due since the last run (all of it after the app was closed)
+  void runSchedules() {
+    if (_scheduler == null) return;
+    final result = _ffi!.runDueSchedules(_scheduler!);
+    if (result.posted > 0 || result.rejected > 0) {
+      _lastMessage = "${result.posted} scheduled postings made"
+          "${result.rejected > 0 ? ", ${result.rejected} declined" : ""}";
+      _refreshData();
+    }
+  }
+
   // --- SORTING ---
   void sortHistoryByDate() {
     if (_ledger == null) return;
-    _ffi!.sortTransactionsByDate(_ledger!);
+    _ffi!.sortTransactionsAsync(_ledger!);   // native sort runs off the UI thread
     _transactions.sort((a, b) => b.timestamp.compareTo(a.timestamp));
     notifyListeners();
   }
 
   void sortHistoryByAmount() {
     if (_ledger == null) return;
-    _ffi!.sortTransactionsByAmount(_ledger!);
+    _ffi!.sortTransactionsAsync(_ledger!, byAmount: true);
     _transactions.sort((a, b) => b.amount.compareTo(a.amount));
     notifyListeners();
   }
@@ -177,14 +273,86 @@ class BankProvider extends ChangeNotifier {
   }
 
   // --- HELPERS ---
+  // Apply native changes since _changeSeq; cost is per change, not per
+  // transaction. Picks up postings made by anything, not just this UI.
+  void _syncChanges() {
+    while (true) {
+      final batch = _ffi!.getChangesSince(_ledger!, _changeSeq);
+      final changes = batch.changes;
+      if (changes == null) {
+        _reloadSnapshot();
+        return;
+      }
+      if (changes.isEmpty) return;
+
+      // Descriptions aren't in the feed: fetch the appended rows in one call
+      final appended = [for (final c in changes) if (c.kind == 0) c.transactionID];
+      final rows = appended.isEmpty ? const <TransactionItem?>[] : _ffi!.getTransactionsByIDs(_ledger!, appended);
+      final byID = {for (final r in rows) if (r != null) r.id: r};
+
+      for (final c in changes) {
+        if (c.kind == 0) {
+          if (c.transactionID <= _lastBackendID) continue; // already in a snapshot
+          _lastBackendID = c.transactionID;
+          _transactions.insert(0, TransactionItem(
+              id: c.transactionID + 1,
+              type: c.isWithdrawal ? 'withdrawal' : 'deposit',
+              amount: c.amount,
+              description: byID[c.transactionID]?.description ?? '',
+              timestamp: c.timestamp));
+        } else {
+          _transactions.removeWhere((t) => t.id == c.transactionID + 1);
+        }
+      }
+      _changeSeq = changes.last.seq;
+    }
+  }
+
+  // Fell too far behind the feed: rebuild from history. The seq is read
+  // first, so changes racing with the read are re-applied by ID afterwards.
+  void _reloadSnapshot() {
+    _changeSeq = _ffi!.getChangeSeq(_ledger!);
+    final opened = _transactions.isNotEmpty ? _transactions.last : null;
+    final history = <TransactionItem>[];
+    _ffi!.readHistory(_ledger!, (chunk) {
+      history.addAll(chunk);
+      return true;
+    });
+
+    _transactions = [
+      for (final t in history.reversed)
+        TransactionItem(
+            id: t.id + 1,
+            type: t.type,
+            amount: t.amount,
+            description: t.description,
+            timestamp: t.timestamp),
+      if (opened != null && opened.id == 1) opened,
+    ];
+    _lastBackendID = history.isEmpty ? 0 : history.last.id;
+    _syncChanges();
+  }
+
   void _refreshData() {
+    _syncChanges();
     _currentBalance = _ffi!.getCurrentBalance(_ledger!);
+    _availableBalance = _ffi!.getAvailableBalance(_ledger!);
+    final stats = _ffi!.getLedgerStats(_ledger!);
+    if (stats != null) {
+      _totalDeposits = stats.deposits;
+      _totalWithdrawals = stats.withdrawals;
+      _largestTransaction = stats.largest;
+    }
+    _balanceTimeline = _ffi!.getBalanceTimeline(_ledger!, _openedAt, DateTime.now(), chartPoints);
     notifyListeners();
   }
 
   @override
   void dispose() {
+    _scheduleTimer?.cancel();
+    if (_scheduler != null && _ffi != null) _ffi!.deleteScheduler(_scheduler!);
     if (_ledger != null && _ffi != null) {
+      _ffi!.closeCompletionPort();
       _ffi!.deleteLedger(_ledger!);
     }
     super.dispose();
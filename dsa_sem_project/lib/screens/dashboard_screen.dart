@@ -3,6 +3,7 @@ import 'package:flutter/material.dart';
 import 'package:provider/provider.dart';
 import 'package:intl/intl.dart';
 import '../providers/bank_provider.dart';
+import '../src/bank_ledger_ffi.dart' show BalancePoint;
 import 'history_screen.dart';
 
 final currencyFmt = NumberFormat.currency(locale: 'en_PK', symbol: 'PKR ');
@@ -56,6 +57,13 @@ class DashboardScreen extends StatelessWidget {
                     currencyFmt.format(provider.currentBalance),
                     style: const TextStyle(color: Colors.white, fontSize: 32, fontWeight: FontWeight.bold),
                   ),
+                  if (provider.availableBalance != provider.currentBalance) ...[
+                    const SizedBox(height: 4),
+                    Text(
+                      "Available: ${currencyFmt.format(provider.availableBalance)}",
+                      style: const TextStyle(color: Colors.white70, fontSize: 14),
+                    ),
+                  ],
                   const SizedBox(height: 20),
                   Row(
                     children: [
@@ -68,7 +76,17 @@ class DashboardScreen extends StatelessWidget {
               ),
             ),
 
-            const SizedBox(height: 30),
+            const SizedBox(height: 20),
+
+            // --- BALANCE CHART (points come pre-aggregated from C++) ---
+            if (provider.balanceTimeline.any((p) => p.count > 0)) ...[
+              SizedBox(
+                height: 90,
+                width: double.infinity,
+                child: CustomPaint(painter: _BalanceChartPainter(provider.balanceTimeline)),
+              ),
+              const SizedBox(height: 20),
+            ],
 
             // --- ACTIONS GRID ---
             Expanded(
@@ -121,6 +139,8 @@ class DashboardScreen extends StatelessWidget {
   void _showDialog(BuildContext context, {required bool isDeposit}) {
     final amountCtrl = TextEditingController();
     final descCtrl = TextEditingController();
+    // One key per dialog: a second tap on confirm can't post twice
+    final requestKey = "${isDeposit ? 'dep' : 'wd'}-${DateTime.now().microsecondsSinceEpoch}";
 
     showModalBottomSheet(
       context: context,
@@ -159,9 +179,9 @@ class DashboardScreen extends StatelessWidget {
                 if (amount != null) {
                   final provider = Provider.of<BankProvider>(context, listen: false);
                   if (isDeposit) {
-                    provider.performDeposit(amount, descCtrl.text);
+                    provider.performDeposit(amount, descCtrl.text, requestKey: requestKey);
                   } else {
-                    provider.performWithdrawal(amount, descCtrl.text);
+                    provider.performWithdrawal(amount, descCtrl.text, requestKey: requestKey);
                   }
                   Navigator.pop(ctx);
                 }
@@ -219,4 +239,47 @@ class _ActionButton extends StatelessWidget {
       ),
     );
   }
-}
\ No newline at end of file
+}
+
+// Draws the min/max band of each slice with the closing balance as a line
+class _BalanceChartPainter extends CustomPainter {
+  final List<BalancePoint> points;
+
+  _BalanceChartPainter(this.points);
+
+  @override
+  void paint(Canvas canvas, Size size) {
+    if (points.isEmpty) return;
+    var lo = points.first.min, hi = points.first.max;
+    for (final p in points) {
+      if (p.min < lo) lo = p.min;
+      if (p.max > hi) hi = p.max;
+    }
+    final range = (hi - lo) == 0 ? 1.0 : hi - lo;
+    final step = points.length > 1 ? size.width / (points.length - 1) : 0.0;
+    double y(double v) => size.height - (v - lo) / range * size.height;
+
+    final band = Paint()
+      ..color = Colors.blue.withOpacity(0.15)
+      ..strokeWidth = step < 2 ? 2 : step;
+    final line = Paint()
+      ..color = Colors.blue.shade700
+      ..strokeWidth = 2
+      ..style = PaintingStyle.stroke;
+
+    final path = Path();
+    for (var i = 0; i < points.length; i++) {
+      final x = i * step;
+      canvas.drawLine(Offset(x, y(points[i].min)), Offset(x, y(points[i].max)), band);
+      if (i == 0) {
+        path.moveTo(x, y(points[i].close));
+      } else {
+        path.lineTo(x, y(points[i].close));
+      }
+    }
+    canvas.drawPath(path, line);
+  }
+
+  @override
+  bool shouldRepaint(_BalanceChartPainter old) => !identical(old.points, points);
+}
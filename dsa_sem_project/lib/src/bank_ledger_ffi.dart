@@ -1,6 +1,219 @@
+import 'dart:async';
+import 'dart:convert';
 import 'dart:ffi';
 import 'dart:io';
+import 'dart:isolate';
 import 'package:ffi/ffi.dart';
+import '../models/transaction_model.dart';
+
+/// Mirrors the C `LedgerStats` struct (ledger_stats.h)
+final class LedgerStats extends Struct {
+  @Double()
+  external double depositTotal;
+  @Double()
+  external double withdrawalTotal;
+  @Int32()
+  external int depositCount;
+  @Int32()
+  external int withdrawalCount;
+  @Double()
+  external double largestTransaction;
+  @Int32()
+  external int largestTransactionID;
+  @Double()
+  external double minBalance;
+  @Double()
+  external double maxBalance;
+}
+
+/// Mirrors the C `LedgerStateAt` struct (event_log.h)
+final class LedgerStateAt extends Struct {
+  @Uint64()
+  external int events;
+  @Int64()
+  external int asOf;
+  @Double()
+  external double balance;
+  @Int64()
+  external int newestLive;
+  @Int32()
+  external int livePostings;
+  @Int32()
+  external int undonePostings;
+  @Double()
+  external double depositTotal;
+  @Double()
+  external double withdrawalTotal;
+  @Int32()
+  external int depositCount;
+  @Int32()
+  external int withdrawalCount;
+  @Int32()
+  external int lastTransactionID;
+}
+
+/// Mirrors the C `TransactionRecord` struct (history_cursor.h)
+final class TransactionRecord extends Struct {
+  @Int32()
+  external int id;
+  @Int32()
+  external int kind;
+  @Double()
+  external double amount;
+  @Double()
+  external double balanceAfter;
+  @Int64()
+  external int timestamp;
+  @Int32()
+  external int descriptionLength;
+  @Array(64)
+  external Array<Uint8> description;
+}
+
+/// Mirrors the C `QueryReport` struct (query.h)
+final class QueryReport extends Struct {
+  @Int64()
+  external int rowsScanned;
+  @Int64()
+  external int rowsMatched;
+  @Int64()
+  external int segmentsSkipped;
+  @Double()
+  external double seconds;
+  @Double()
+  external double rowsPerSecond;
+}
+
+/// Result of a filter query: the first rows, plus totals over all matches.
+/// `rows` is null on a syntax error (see getLastMessage).
+typedef QueryResult = ({List<TransactionItem>? rows, int matched, int scanned, double rowsPerSecond});
+
+/// Mirrors the C `ReconcileReport` struct (reconcile.h)
+final class ReconcileReport extends Struct {
+  @Int64()
+  external int statementRows;
+  @Int64()
+  external int ledgerRows;
+  @Int64()
+  external int matched;
+  @Int64()
+  external int missing;
+  @Int64()
+  external int extra;
+  @Int64()
+  external int rejected;
+  @Double()
+  external double seconds;
+  @Double()
+  external double rowsPerSecond;
+}
+
+/// Totals of a statement reconciliation; null when the file couldn't be read
+typedef ReconcileSummary = ({int statementRows, int ledgerRows, int matched, int missing, int extra,
+    int rejected, double seconds});
+
+/// Mirrors the C `HistoryFilter` struct (history_cursor.h); zero fields don't filter
+final class HistoryFilter extends Struct {
+  @Int32()
+  external int typeMask;
+  @Int32()
+  external int fromID;
+  @Int32()
+  external int toID;
+  @Int64()
+  external int fromTs;
+  @Int64()
+  external int toTs;
+  @Double()
+  external double minAmount;
+  @Double()
+  external double maxAmount;
+}
+
+/// Mirrors the C `ChangeRecord` struct (change_feed.h)
+final class ChangeRecord extends Struct {
+  @Uint64()
+  external int seq;
+  @Int32()
+  external int kind;
+  @Int32()
+  external int transactionID;
+  @Int32()
+  external int postingKind;
+  @Double()
+  external double amount;
+  @Double()
+  external double balanceAfter;
+  @Int64()
+  external int timestamp;
+}
+
+/// A change copied out of native memory (kind: 0 = append, 1 = undo)
+typedef LedgerChange = ({int seq, int kind, int transactionID, bool isWithdrawal,
+    double amount, double balanceAfter, DateTime timestamp});
+
+/// One batch from the change feed; `changes` is null when a snapshot is needed
+typedef ChangeBatch = ({List<LedgerChange>? changes, int latest});
+
+/// Mirrors the C `TimelinePoint` struct (balance_timeline.h)
+final class TimelinePoint extends Struct {
+  @Int64()
+  external int timestamp;
+  @Double()
+  external double minBalance;
+  @Double()
+  external double maxBalance;
+  @Double()
+  external double closeBalance;
+  @Int32()
+  external int count;
+}
+
+/// One chart point: the balance range and closing balance of a time slice
+typedef BalancePoint = ({DateTime time, double min, double max, double close, int count});
+
+/// Mirrors the C `HoldRecord` struct (holds.h)
+final class HoldRecord extends Struct {
+  @Int32()
+  external int id;
+  @Int32()
+  external int state;
+  @Double()
+  external double amount;
+  @Int64()
+  external int createdAt;
+  @Int64()
+  external int expiresAt;
+}
+
+/// Mirrors the C `VelocityRule` struct (velocity_limits.h)
+final class VelocityRule extends Struct {
+  @Int32()
+  external int metric; // 0 = amount, 1 = count
+  @Double()
+  external double limit;
+  @Int64()
+  external int window; // microseconds
+}
+
+/// A withdrawal cap: at most [limit] dollars (or [limit] withdrawals, when
+/// [count] is set) within any [window]
+typedef VelocityLimit = ({bool count, double limit, Duration window});
+
+/// Mirrors the C `AsyncCompletion` struct (async_executor.h)
+final class AsyncCompletion extends Struct {
+  @Int64()
+  external int requestId;
+  @Int32()
+  external int status;
+  @Int64()
+  external int value;
+  @Array(128)
+  external Array<Uint8> message;
+}
+
+/// Result of an async native call
+typedef AsyncOutcome = ({bool ok, int value, String message});
 
 /// Dart wrapper for your BankLedger C++ DLL
 class BankLedgerFFI {
@@ -19,6 +232,44 @@ class BankLedgerFFI {
   late final int Function(Pointer<Void>) _sortTransactionsByAmount;
   late final Pointer<Utf8> Function(Pointer<Void>, int) _searchTransactionByID;
   late final Pointer<Utf8> Function() _getLastMessage;
+  late final int Function(Pointer<Void>, Pointer<LedgerStats>) _getLedgerStats;
+  late final int Function(int) _enableTracing;
+  late final int Function(Pointer<Void>, Pointer<Utf8>, int) _enableHistoryArchive;
+  late final int Function(Pointer<Void>, int, Pointer<LedgerStateAt>) _getLedgerStateAt;
+  late final int Function(Pointer<Void>, Pointer<Int32>, int, Pointer<TransactionRecord>) _getTransactionsByIDs;
+  late final Pointer<Void> Function(Pointer<Void>, Pointer<HistoryFilter>, int) _openHistoryCursor;
+  late final int Function(Pointer<Void>, Pointer<TransactionRecord>) _nextChunk;
+  late final void Function(Pointer<Void>) _closeCursor;
+  late final int Function(Pointer<Void>, Pointer<Utf8>, Pointer<TransactionRecord>, int, Pointer<QueryReport>)
+      _runQuery;
+  late final int Function(Pointer<Void>, Pointer<Utf8>, int, int, int, Pointer<Utf8>, Pointer<ReconcileReport>)
+      _reconcileStatement;
+  late final int Function(Pointer<Void>, int, Pointer<ChangeRecord>, int, Pointer<Uint64>) _getChangesSince;
+  late final int Function(Pointer<Void>) _getChangeSeq;
+  late final int Function(Pointer<Void>, int, int, int, Pointer<TimelinePoint>) _getBalanceTimeline;
+  late final int Function(Pointer<Void>, double, Pointer<Utf8>, int) _placeHold;
+  late final int Function(Pointer<Void>, int, double) _settleHold;
+  late final int Function(Pointer<Void>, int) _releaseHold;
+  late final int Function(Pointer<Void>, int, Pointer<HoldRecord>) _getHold;
+  late final double Function(Pointer<Void>) _getAvailableBalance;
+  late final int Function(Pointer<Void>, Pointer<VelocityRule>, int) _setVelocityLimits;
+  late final int Function(Pointer<Void>, Pointer<VelocityRule>) _getVelocityLimits;
+  late final int Function(Pointer<Void>, double, Pointer<Utf8>, Pointer<Utf8>, Pointer<Int32>) _addDepositWithKey;
+  late final int Function(Pointer<Void>, double, Pointer<Utf8>, Pointer<Utf8>, Pointer<Int32>) _addWithdrawalWithKey;
+  late final Pointer<Void> Function() _createScheduler;
+  late final void Function(Pointer<Void>) _deleteScheduler;
+  late final int Function(Pointer<Void>, Pointer<Void>, int, double, Pointer<Utf8>, int, int, int, int) _addSchedule;
+  late final int Function(Pointer<Void>, int) _cancelSchedule;
+  late final int Function(Pointer<Void>, int, Pointer<Int32>) _runDueSchedules;
+  late final int Function(int, Pointer<Void>) _setCompletionPort;
+  late final int Function(Pointer<Void>, int) _asyncSortTransactions;
+  late final int Function(Pointer<Void>, Pointer<Utf8>, int) _asyncExportStatement;
+  late final int Function(int, int, Pointer<AsyncCompletion>) _waitCompletion;
+
+  // Completions arrive on this port as request ids (posted from native workers)
+  ReceivePort? _completionPort;
+  final Map<int, Completer<AsyncOutcome>> _pending = {};
+  late final int Function(Pointer<Utf8>) _exportChromeTrace;
 
   /// Load the DLL
   BankLedgerFFI(String dllPath) {
@@ -52,6 +303,76 @@ class BankLedgerFFI {
         Pointer<Utf8> Function(Pointer<Void>, int)>('searchTransactionByID');
     _getLastMessage =
         _dll.lookupFunction<Pointer<Utf8> Function(), Pointer<Utf8> Function()>('getLastMessage');
+    _getLedgerStats = _dll.lookupFunction<Int32 Function(Pointer<Void>, Pointer<LedgerStats>),
+        int Function(Pointer<Void>, Pointer<LedgerStats>)>('getLedgerStats');
+    _enableTracing = _dll.lookupFunction<Int32 Function(Int32), int Function(int)>('enableTracing');
+    _enableHistoryArchive = _dll.lookupFunction<Int32 Function(Pointer<Void>, Pointer<Utf8>, Int32),
+        int Function(Pointer<Void>, Pointer<Utf8>, int)>('enableHistoryArchive');
+    _getLedgerStateAt = _dll.lookupFunction<Int32 Function(Pointer<Void>, Int64, Pointer<LedgerStateAt>),
+        int Function(Pointer<Void>, int, Pointer<LedgerStateAt>)>('getLedgerStateAt');
+    _getTransactionsByIDs = _dll.lookupFunction<
+        Int32 Function(Pointer<Void>, Pointer<Int32>, Int32, Pointer<TransactionRecord>),
+        int Function(Pointer<Void>, Pointer<Int32>, int, Pointer<TransactionRecord>)>('getTransactionsByIDs');
+    _openHistoryCursor = _dll.lookupFunction<Pointer<Void> Function(Pointer<Void>, Pointer<HistoryFilter>, Int32),
+        Pointer<Void> Function(Pointer<Void>, Pointer<HistoryFilter>, int)>('openHistoryCursor');
+    _nextChunk = _dll.lookupFunction<Int32 Function(Pointer<Void>, Pointer<TransactionRecord>),
+        int Function(Pointer<Void>, Pointer<TransactionRecord>)>('nextChunk');
+    _runQuery = _dll.lookupFunction<
+        Int32 Function(Pointer<Void>, Pointer<Utf8>, Pointer<TransactionRecord>, Int32, Pointer<QueryReport>),
+        int Function(Pointer<Void>, Pointer<Utf8>, Pointer<TransactionRecord>, int, Pointer<QueryReport>)>('runQuery');
+    _reconcileStatement = _dll.lookupFunction<
+        Int32 Function(Pointer<Void>, Pointer<Utf8>, Int32, Int64, Int32, Pointer<Utf8>, Pointer<ReconcileReport>),
+        int Function(Pointer<Void>, Pointer<Utf8>, int, int, int, Pointer<Utf8>, Pointer<ReconcileReport>)>(
+        'reconcileStatement');
+    _closeCursor = _dll.lookupFunction<Void Function(Pointer<Void>), void Function(Pointer<Void>)>('closeCursor');
+    _getChangesSince = _dll.lookupFunction<
+        Int32 Function(Pointer<Void>, Uint64, Pointer<ChangeRecord>, Int32, Pointer<Uint64>),
+        int Function(Pointer<Void>, int, Pointer<ChangeRecord>, int, Pointer<Uint64>)>('getChangesSince');
+    _getChangeSeq =
+        _dll.lookupFunction<Uint64 Function(Pointer<Void>), int Function(Pointer<Void>)>('getChangeSeq');
+    _getBalanceTimeline = _dll.lookupFunction<
+        Int32 Function(Pointer<Void>, Int64, Int64, Int32, Pointer<TimelinePoint>),
+        int Function(Pointer<Void>, int, int, int, Pointer<TimelinePoint>)>('getBalanceTimeline');
+    _placeHold = _dll.lookupFunction<Int32 Function(Pointer<Void>, Double, Pointer<Utf8>, Int64),
+        int Function(Pointer<Void>, double, Pointer<Utf8>, int)>('placeHold');
+    _settleHold = _dll.lookupFunction<Int32 Function(Pointer<Void>, Int32, Double),
+        int Function(Pointer<Void>, int, double)>('settleHold');
+    _releaseHold =
+        _dll.lookupFunction<Int32 Function(Pointer<Void>, Int32), int Function(Pointer<Void>, int)>('releaseHold');
+    _getHold = _dll.lookupFunction<Int32 Function(Pointer<Void>, Int32, Pointer<HoldRecord>),
+        int Function(Pointer<Void>, int, Pointer<HoldRecord>)>('getHold');
+    _getAvailableBalance =
+        _dll.lookupFunction<Double Function(Pointer<Void>), double Function(Pointer<Void>)>('getAvailableBalance');
+    _setVelocityLimits = _dll.lookupFunction<Int32 Function(Pointer<Void>, Pointer<VelocityRule>, Int32),
+        int Function(Pointer<Void>, Pointer<VelocityRule>, int)>('setVelocityLimits');
+    _getVelocityLimits = _dll.lookupFunction<Int32 Function(Pointer<Void>, Pointer<VelocityRule>),
+        int Function(Pointer<Void>, Pointer<VelocityRule>)>('getVelocityLimits');
+    _addDepositWithKey = _dll.lookupFunction<
+        Int32 Function(Pointer<Void>, Double, Pointer<Utf8>, Pointer<Utf8>, Pointer<Int32>),
+        int Function(Pointer<Void>, double, Pointer<Utf8>, Pointer<Utf8>, Pointer<Int32>)>('addDepositWithKey');
+    _addWithdrawalWithKey = _dll.lookupFunction<
+        Int32 Function(Pointer<Void>, Double, Pointer<Utf8>, Pointer<Utf8>, Pointer<Int32>),
+        int Function(Pointer<Void>, double, Pointer<Utf8>, Pointer<Utf8>, Pointer<Int32>)>('addWithdrawalWithKey');
+    _createScheduler = _dll.lookupFunction<Pointer<Void> Function(), Pointer<Void> Function()>('createScheduler');
+    _deleteScheduler =
+        _dll.lookupFunction<Void Function(Pointer<Void>), void Function(Pointer<Void>)>('deleteScheduler');
+    _addSchedule = _dll.lookupFunction<
+        Int32 Function(Pointer<Void>, Pointer<Void>, Int32, Double, Pointer<Utf8>, Int64, Int32, Int64, Int32),
+        int Function(Pointer<Void>, Pointer<Void>, int, double, Pointer<Utf8>, int, int, int, int)>('addSchedule');
+    _cancelSchedule =
+        _dll.lookupFunction<Int32 Function(Pointer<Void>, Int32), int Function(Pointer<Void>, int)>('cancelSchedule');
+    _runDueSchedules = _dll.lookupFunction<Int32 Function(Pointer<Void>, Int64, Pointer<Int32>),
+        int Function(Pointer<Void>, int, Pointer<Int32>)>('runDueSchedules');
+    _exportChromeTrace =
+        _dll.lookupFunction<Int32 Function(Pointer<Utf8>), int Function(Pointer<Utf8>)>('exportChromeTrace');
+    _setCompletionPort = _dll.lookupFunction<Int32 Function(Int64, Pointer<Void>),
+        int Function(int, Pointer<Void>)>('setCompletionPort');
+    _asyncSortTransactions = _dll.lookupFunction<Int64 Function(Pointer<Void>, Int32),
+        int Function(Pointer<Void>, int)>('asyncSortTransactions');
+    _asyncExportStatement = _dll.lookupFunction<Int64 Function(Pointer<Void>, Pointer<Utf8>, Int32),
+        int Function(Pointer<Void>, Pointer<Utf8>, int)>('asyncExportStatement');
+    _waitCompletion = _dll.lookupFunction<Int32 Function(Int64, Int32, Pointer<AsyncCompletion>),
+        int Function(int, int, Pointer<AsyncCompletion>)>('waitCompletion');
   }
 
   /// Create a new ledger
@@ -76,6 +397,25 @@ class BankLedgerFFI {
     return result;
   }
 
+  /// Post that is safe to retry: reusing [key] within 24h posts nothing and
+  /// returns the original transaction (duplicate = true). id is 0 if rejected.
+  ({int id, bool duplicate}) postWithKey(Pointer<Void> ledger,
+      {required bool withdrawal, required double amount, required String description, required String key}) {
+    final descPtr = description.toNativeUtf8();
+    final keyPtr = key.toNativeUtf8();
+    final duplicate = calloc<Int32>();
+    try {
+      final id = withdrawal
+          ? _addWithdrawalWithKey(ledger, amount, descPtr, keyPtr, duplicate)
+          : _addDepositWithKey(ledger, amount, descPtr, keyPtr, duplicate);
+      return (id: id, duplicate: duplicate.value != 0);
+    } finally {
+      malloc.free(descPtr);
+      malloc.free(keyPtr);
+      calloc.free(duplicate);
+    }
+  }
+
   /// Undo last transaction
   bool undoLastTransaction(Pointer<Void> ledger) => _undoLastTransaction(ledger) != 0;
 
@@ -96,6 +436,399 @@ class BankLedgerFFI {
   String searchTransactionByID(Pointer<Void> ledger, int id) =>
       _searchTransactionByID(ledger, id).toDartString();
 
+  /// Running statistics (copied out of native memory)
+  ({double deposits, double withdrawals, int depositCount, int withdrawalCount,
+      double largest, double minBalance, double maxBalance})? getLedgerStats(Pointer<Void> ledger) {
+    final out = calloc<LedgerStats>();
+    try {
+      if (_getLedgerStats(ledger, out) == 0) return null;
+      final s = out.ref;
+      return (
+        deposits: s.depositTotal,
+        withdrawals: s.withdrawalTotal,
+        depositCount: s.depositCount,
+        withdrawalCount: s.withdrawalCount,
+        largest: s.largestTransaction,
+        minBalance: s.minBalance,
+        maxBalance: s.maxBalance,
+      );
+    } finally {
+      calloc.free(out);
+    }
+  }
+
+  /// Ledger as it was at [asOf], undone postings included
+  ({double balance, int live, int undone, double deposits, double withdrawals})? getLedgerStateAt(
+      Pointer<Void> ledger, DateTime asOf) {
+    final out = calloc<LedgerStateAt>();
+    try {
+      if (_getLedgerStateAt(ledger, asOf.microsecondsSinceEpoch, out) == 0) return null;
+      final s = out.ref;
+      return (
+        balance: s.balance,
+        live: s.livePostings,
+        undone: s.undonePostings,
+        deposits: s.depositTotal,
+        withdrawals: s.withdrawalTotal,
+      );
+    } finally {
+      calloc.free(out);
+    }
+  }
+
+  /// Balance over [from, to] as at most [points] points, computed natively
+  /// from a pre-aggregated pyramid: cost depends on [points], not history size
+  List<BalancePoint> getBalanceTimeline(Pointer<Void> ledger, DateTime from, DateTime to, int points) {
+    if (points <= 0) return [];
+    final out = calloc<TimelinePoint>(points);
+    try {
+      final n = _getBalanceTimeline(ledger, from.microsecondsSinceEpoch, to.microsecondsSinceEpoch, points, out);
+      return [
+        for (var i = 0; i < n; i++)
+          (
+            time: DateTime.fromMicrosecondsSinceEpoch(out[i].timestamp),
+            min: out[i].minBalance,
+            max: out[i].maxBalance,
+            close: out[i].closeBalance,
+            count: out[i].count,
+          )
+      ];
+    } finally {
+      calloc.free(out);
+    }
+  }
+
+  /// Reserve [amount] until [expiresAt]; returns the hold ID, or 0 if that
+  /// much isn't available
+  int placeHold(Pointer<Void> ledger, double amount, String description, DateTime expiresAt) {
+    final ptr = description.toNativeUtf8();
+    final id = _placeHold(ledger, amount, ptr, expiresAt.microsecondsSinceEpoch);
+    malloc.free(ptr);
+    return id;
+  }
+
+  /// Withdraw [amount] of a hold (0 = all of it) and release the rest
+  bool settleHold(Pointer<Void> ledger, int holdID, {double amount = 0}) =>
+      _settleHold(ledger, holdID, amount) != 0;
+
+  bool releaseHold(Pointer<Void> ledger, int holdID) => _releaseHold(ledger, holdID) != 0;
+
+  /// An active hold, or null once it was settled, released or expired
+  ({double amount, DateTime createdAt, DateTime expiresAt})? getHold(Pointer<Void> ledger, int holdID) {
+    final out = calloc<HoldRecord>();
+    try {
+      if (_getHold(ledger, holdID, out) == 0) return null;
+      return (
+        amount: out.ref.amount,
+        createdAt: DateTime.fromMicrosecondsSinceEpoch(out.ref.createdAt),
+        expiresAt: DateTime.fromMicrosecondsSinceEpoch(out.ref.expiresAt),
+      );
+    } finally {
+      calloc.free(out);
+    }
+  }
+
+  /// Balance minus active holds (due holds are expired first)
+  double getAvailableBalance(Pointer<Void> ledger) => _getAvailableBalance(ledger);
+
+  /// Replace the withdrawal velocity limits (empty clears them); returns how
+  /// many are in effect. Withdrawals breaking one fail with a
+  /// "Velocity limit exceeded" message.
+  int setVelocityLimits(Pointer<Void> ledger, List<VelocityLimit> limits) {
+    final rules = calloc<VelocityRule>(limits.isEmpty ? 1 : limits.length);
+    try {
+      for (var i = 0; i < limits.length; i++) {
+        rules[i].metric = limits[i].count ? 1 : 0;
+        rules[i].limit = limits[i].limit;
+        rules[i].window = limits[i].window.inMicroseconds;
+      }
+      return _setVelocityLimits(ledger, rules, limits.length);
+    } finally {
+      calloc.free(rules);
+    }
+  }
+
+  List<VelocityLimit> getVelocityLimits(Pointer<Void> ledger) {
+    final rules = calloc<VelocityRule>(_maxVelocityRules);
+    try {
+      final n = _getVelocityLimits(ledger, rules);
+      return [
+        for (var i = 0; i < n; i++)
+          (
+            count: rules[i].metric == 1,
+            limit: rules[i].limit,
+            window: Duration(microseconds: rules[i].window),
+          )
+      ];
+    } finally {
+      calloc.free(rules);
+    }
+  }
+
+  static const _maxVelocityRules = 8; // VELOCITY_MAX_RULES
+
+  /// Scheduler for future-dated / recurring postings (one can serve many ledgers)
+  Pointer<Void> createScheduler() => _createScheduler();
+  void deleteScheduler(Pointer<Void> scheduler) => _deleteScheduler(scheduler);
+
+  /// Post [amount] at [firstDue], then every [interval] or every [months]
+  /// calendar months (neither = once), [count] times in total (0 = until
+  /// cancelled). Returns the schedule ID, 0 if invalid.
+  int addSchedule(Pointer<Void> scheduler, Pointer<Void> ledger,
+      {required bool withdrawal, required double amount, required String description,
+      required DateTime firstDue, Duration? interval, int months = 0, int count = 0}) {
+    final repeat = months > 0 ? 2 : (interval != null ? 1 : 0);
+    final every = months > 0 ? months : (interval?.inMicroseconds ?? 0);
+    final ptr = description.toNativeUtf8();
+    final id = _addSchedule(scheduler, ledger, withdrawal ? 1 : 0, amount, ptr,
+        firstDue.microsecondsSinceEpoch, repeat, every, count);
+    malloc.free(ptr);
+    return id;
+  }
+
+  bool cancelSchedule(Pointer<Void> scheduler, int scheduleID) => _cancelSchedule(scheduler, scheduleID) != 0;
+
+  /// Post everything due by [now] (default: the scheduler clock), including
+  /// occurrences missed while the app was closed
+  ({int posted, int rejected}) runDueSchedules(Pointer<Void> scheduler, {DateTime? now}) {
+    final rejected = calloc<Int32>();
+    try {
+      final posted = _runDueSchedules(scheduler, now?.microsecondsSinceEpoch ?? 0, rejected);
+      return (posted: posted, rejected: rejected.value);
+    } finally {
+      calloc.free(rejected);
+    }
+  }
+
+  static TransactionItem _toItem(TransactionRecord r) {
+    final bytes = <int>[];
+    for (var i = 0; i < 64 && r.description[i] != 0; i++) {
+      bytes.add(r.description[i]);
+    }
+    return TransactionItem(
+      id: r.id,
+      type: r.kind == 1 ? 'withdrawal' : 'deposit',
+      amount: r.amount,
+      description: utf8.decode(bytes, allowMalformed: true),
+      timestamp: DateTime.fromMicrosecondsSinceEpoch(r.timestamp),
+    );
+  }
+
+  /// Look up many transactions in one native call; null where an ID doesn't exist
+  List<TransactionItem?> getTransactionsByIDs(Pointer<Void> ledger, List<int> ids) {
+    if (ids.isEmpty) return [];
+    final idPtr = calloc<Int32>(ids.length);
+    final out = calloc<TransactionRecord>(ids.length);
+    try {
+      for (var i = 0; i < ids.length; i++) {
+        idPtr[i] = ids[i];
+      }
+      if (_getTransactionsByIDs(ledger, idPtr, ids.length, out) < 0) return List.filled(ids.length, null);
+      return [for (var i = 0; i < ids.length; i++) out[i].id == 0 ? null : _toItem(out[i])];
+    } finally {
+      calloc.free(idPtr);
+      calloc.free(out);
+    }
+  }
+
+  /// Stream history in ID order, [chunkSize] transactions per call to
+  /// [onChunk] (return false to stop early). Descriptions longer than 63
+  /// bytes are truncated. Returns how many transactions were delivered.
+  int readHistory(Pointer<Void> ledger, bool Function(List<TransactionItem> chunk) onChunk,
+      {int chunkSize = 1000, int typeMask = 0, int fromID = 0, int toID = 0,
+      DateTime? from, DateTime? to, double minAmount = 0, double maxAmount = 0}) {
+    final filter = calloc<HistoryFilter>();
+    final out = calloc<TransactionRecord>(chunkSize);
+    var delivered = 0;
+    Pointer<Void> cursor = nullptr;
+    try {
+      filter.ref
+        ..typeMask = typeMask
+        ..fromID = fromID
+        ..toID = toID
+        ..fromTs = from?.microsecondsSinceEpoch ?? 0
+        ..toTs = to?.microsecondsSinceEpoch ?? 0
+        ..minAmount = minAmount
+        ..maxAmount = maxAmount;
+      cursor = _openHistoryCursor(ledger, filter, chunkSize);
+      if (cursor == nullptr) return 0;
+
+      while (true) {
+        final n = _nextChunk(cursor, out);
+        if (n <= 0) break;
+        delivered += n;
+        if (!onChunk([for (var i = 0; i < n; i++) _toItem(out[i])])) break;
+      }
+      return delivered;
+    } finally {
+      if (cursor != nullptr) _closeCursor(cursor);
+      calloc.free(filter);
+      calloc.free(out);
+    }
+  }
+
+  /// Filter query, e.g. `type = WITHDRAWAL AND amount > 100 AND desc ~ "rent"`
+  /// (grammar in query.h). Returns up to [limit] matching rows, oldest first;
+  /// fields left out of a SELECT list come back empty.
+  QueryResult runQuery(Pointer<Void> ledger, String query, {int limit = 500}) {
+    final text = query.toNativeUtf8();
+    final out = calloc<TransactionRecord>(limit > 0 ? limit : 1);
+    final report = calloc<QueryReport>();
+    try {
+      final n = _runQuery(ledger, text, out, limit, report);
+      if (n < 0) return (rows: null, matched: 0, scanned: 0, rowsPerSecond: 0.0);
+      return (
+        rows: [for (var i = 0; i < n; i++) _toItem(out[i])],
+        matched: report.ref.rowsMatched,
+        scanned: report.ref.rowsScanned,
+        rowsPerSecond: report.ref.rowsPerSecond,
+      );
+    } finally {
+      malloc.free(text);
+      calloc.free(out);
+      calloc.free(report);
+    }
+  }
+
+  /// Match a bank statement file (CSV or NDJSON, as for import) against the
+  /// ledger: same type, amount and description, dated within [window].
+  /// [reportPath] receives the missing and extra rows as CSV.
+  ReconcileSummary? reconcileStatement(Pointer<Void> ledger, String statementPath,
+      {Duration window = const Duration(days: 3), String? reportPath}) {
+    final path = statementPath.toNativeUtf8();
+    final report = reportPath?.toNativeUtf8() ?? nullptr;
+    final out = calloc<ReconcileReport>();
+    try {
+      if (_reconcileStatement(ledger, path, 0, window.inSeconds, 0, report, out) == 0) return null;
+      final r = out.ref;
+      return (
+        statementRows: r.statementRows,
+        ledgerRows: r.ledgerRows,
+        matched: r.matched,
+        missing: r.missing,
+        extra: r.extra,
+        rejected: r.rejected,
+        seconds: r.seconds,
+      );
+    } finally {
+      malloc.free(path);
+      if (report != nullptr) malloc.free(report);
+      calloc.free(out);
+    }
+  }
+
+  /// Changes after seq [after], oldest first, at most [max] per call.
+  /// `changes` is null when they were already dropped from the feed: re-read
+  /// the history and continue from `latest`.
+  ChangeBatch getChangesSince(Pointer<Void> ledger, int after, {int max = 256}) {
+    final out = calloc<ChangeRecord>(max);
+    final latest = calloc<Uint64>();
+    try {
+      final n = _getChangesSince(ledger, after, out, max, latest);
+      if (n < 0) return (changes: null, latest: latest.value);
+      final changes = [
+        for (var i = 0; i < n; i++)
+          (
+            seq: out[i].seq,
+            kind: out[i].kind,
+            transactionID: out[i].transactionID,
+            isWithdrawal: out[i].postingKind == 1,
+            amount: out[i].amount,
+            balanceAfter: out[i].balanceAfter,
+            timestamp: DateTime.fromMicrosecondsSinceEpoch(out[i].timestamp),
+          )
+      ];
+      return (changes: changes, latest: latest.value);
+    } finally {
+      calloc.free(out);
+      calloc.free(latest);
+    }
+  }
+
+  /// Newest change seq (0 before the first change)
+  int getChangeSeq(Pointer<Void> ledger) => _getChangeSeq(ledger);
+
+  /// Keep only the newest [hotLimit] postings in memory; older ones go to
+  /// segment files under [directory]
+  bool enableHistoryArchive(Pointer<Void> ledger, String directory, int hotLimit) {
+    final ptr = directory.toNativeUtf8();
+    final result = _enableHistoryArchive(ledger, ptr, hotLimit) != 0;
+    malloc.free(ptr);
+    return result;
+  }
+
+  /// Start/stop recording tracing spans (false if compiled out)
+  bool enableTracing(bool enabled) => _enableTracing(enabled ? 1 : 0) != 0;
+
+  /// Stop tracing and write Chrome trace_event JSON for Perfetto
+  bool exportChromeTrace(String path) {
+    final ptr = path.toNativeUtf8();
+    final result = _exportChromeTrace(ptr) != 0;
+    malloc.free(ptr);
+    return result;
+  }
+
+  // --- Async (runs on native workers, never blocks a frame) ---
+
+  void _ensureCompletionPort() {
+    if (_completionPort != null) return;
+    _completionPort = ReceivePort()
+      ..listen((message) {
+        final id = message as int;
+        final completer = _pending.remove(id);
+        if (completer == null) return;
+
+        final out = calloc<AsyncCompletion>();
+        try {
+          if (_waitCompletion(id, 0, out) == 0) {
+            completer.complete((ok: false, value: 0, message: 'Completion lost'));
+            return;
+          }
+          final c = out.ref;
+          final bytes = <int>[];
+          for (var i = 0; i < 128 && c.message[i] != 0; i++) {
+            bytes.add(c.message[i]);
+          }
+          completer.complete((ok: c.status != 0, value: c.value, message: String.fromCharCodes(bytes)));
+        } finally {
+          calloc.free(out);
+        }
+      });
+    _setCompletionPort(_completionPort!.sendPort.nativePort, NativeApi.postCObject.cast());
+  }
+
+  Future<AsyncOutcome> _track(int requestId) {
+    if (requestId == 0) {
+      return Future.value((ok: false, value: 0, message: 'Request rejected'));
+    }
+    final completer = Completer<AsyncOutcome>();
+    _pending[requestId] = completer;
+    return completer.future;
+  }
+
+  /// Sort on a native worker (merge sort of the whole history)
+  Future<AsyncOutcome> sortTransactionsAsync(Pointer<Void> ledger, {bool byAmount = false}) {
+    _ensureCompletionPort();
+    return _track(_asyncSortTransactions(ledger, byAmount ? 1 : 0));
+  }
+
+  /// Export a statement on a native worker (0 = CSV, 1 = JSON lines, 2 = binary)
+  Future<AsyncOutcome> exportStatementAsync(Pointer<Void> ledger, String path, int format) {
+    _ensureCompletionPort();
+    final ptr = path.toNativeUtf8();
+    final id = _asyncExportStatement(ledger, ptr, format);
+    malloc.free(ptr);
+    return _track(id);
+  }
+
+  /// Stop receiving completions (call before unloading)
+  void closeCompletionPort() {
+    if (_completionPort == null) return;
+    _setCompletionPort(0, nullptr);
+    _completionPort!.close();
+    _completionPort = null;
+  }
+
   /// Last operation message
   String getLastMessage() => _getLastMessage().toDartString();
 }